@@ -79,6 +79,8 @@ struct _GstVP8Dec
   enum vp8_postproc_level post_processing_flags;
   gint deblocking_level;
   gint noise_level;
+  guint threads;
+  guint pipeline_depth;
 };
 
 struct _GstVP8DecClass
@@ -98,6 +100,9 @@ enum
 #define DEFAULT_POST_PROCESSING_FLAGS (VP8_DEBLOCK | VP8_DEMACROBLOCK)
 #define DEFAULT_DEBLOCKING_LEVEL 4
 #define DEFAULT_NOISE_LEVEL 0
+#define DEFAULT_THREADS 0
+#define DEFAULT_PIPELINE_DEPTH 0
+#define MAX_THREADS 16
 
 enum
 {
@@ -105,7 +110,9 @@ enum
   PROP_POST_PROCESSING,
   PROP_POST_PROCESSING_FLAGS,
   PROP_DEBLOCKING_LEVEL,
-  PROP_NOISE_LEVEL
+  PROP_NOISE_LEVEL,
+  PROP_THREADS,
+  PROP_PIPELINE_DEPTH
 };
 
 #define C_FLAGS(v) ((guint) v)
@@ -135,13 +142,11 @@ gst_vp8_dec_post_processing_flags_get_type (void)
 #undef C_FLAGS
 
 static void gst_vp8_dec_finalize (GObject * object);
-#ifndef OPERA_MINIMAL_GST
 static void gst_vp8_dec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_vp8_dec_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
-#endif /* OPERA_MINIMAL_GST */
 static gboolean gst_vp8_dec_start (GstBaseVideoDecoder * decoder);
 static gboolean gst_vp8_dec_stop (GstBaseVideoDecoder * decoder);
 static gboolean gst_vp8_dec_reset (GstBaseVideoDecoder * decoder);
@@ -196,10 +201,8 @@ gst_vp8_dec_class_init (GstVP8DecClass * klass)
   element_class = GST_ELEMENT_CLASS (klass);
   base_video_decoder_class = GST_BASE_VIDEO_DECODER_CLASS (klass);
 
-#ifndef OPERA_MINIMAL_GST
   gobject_class->set_property = gst_vp8_dec_set_property;
   gobject_class->get_property = gst_vp8_dec_get_property;
-#endif /* OPERA_MINIMAL_GST */
   gobject_class->finalize = gst_vp8_dec_finalize;
 
 #ifndef OPERA_MINIMAL_GST
@@ -227,6 +230,19 @@ gst_vp8_dec_class_init (GstVP8DecClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 #endif /* OPERA_MINIMAL_GST */
 
+  g_object_class_install_property (gobject_class, PROP_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Maximum number of decoding threads (0 = number of CPUs)",
+          0, MAX_THREADS, DEFAULT_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PIPELINE_DEPTH,
+      g_param_spec_uint ("pipeline-depth", "Pipeline Depth",
+          "Number of frames queued for a separate decoding thread "
+          "(0 = decode in the streaming thread)",
+          0, 16, DEFAULT_PIPELINE_DEPTH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   base_video_decoder_class->start = gst_vp8_dec_start;
   base_video_decoder_class->stop = gst_vp8_dec_stop;
   base_video_decoder_class->reset = gst_vp8_dec_reset;
@@ -247,6 +263,14 @@ gst_vp8_dec_init (GstVP8Dec * gst_vp8_dec, GstVP8DecClass * klass)
   gst_vp8_dec->post_processing_flags = DEFAULT_POST_PROCESSING_FLAGS;
   gst_vp8_dec->deblocking_level = DEFAULT_DEBLOCKING_LEVEL;
   gst_vp8_dec->noise_level = DEFAULT_NOISE_LEVEL;
+  gst_vp8_dec->threads = DEFAULT_THREADS;
+  gst_vp8_dec->pipeline_depth = DEFAULT_PIPELINE_DEPTH;
+
+#ifdef GST_PAD_ALLOC_POOLED
+  /* every frame is the same size, recycle their memory */
+  GST_OBJECT_FLAG_SET (GST_BASE_VIDEO_CODEC_SRC_PAD (decoder),
+      GST_PAD_ALLOC_POOLED);
+#endif
 }
 
 static void
@@ -262,8 +286,6 @@ gst_vp8_dec_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-#ifndef OPERA_MINIMAL_GST
-
 static void
 gst_vp8_dec_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -287,6 +309,12 @@ gst_vp8_dec_set_property (GObject * object, guint prop_id,
     case PROP_NOISE_LEVEL:
       dec->noise_level = g_value_get_uint (value);
       break;
+    case PROP_THREADS:
+      dec->threads = g_value_get_uint (value);
+      break;
+    case PROP_PIPELINE_DEPTH:
+      dec->pipeline_depth = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -315,14 +343,18 @@ gst_vp8_dec_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_NOISE_LEVEL:
       g_value_set_uint (value, dec->noise_level);
       break;
+    case PROP_THREADS:
+      g_value_set_uint (value, dec->threads);
+      break;
+    case PROP_PIPELINE_DEPTH:
+      g_value_set_uint (value, dec->pipeline_depth);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
-#endif /* OPERA_MINIMAL_GST */
-
 static gboolean
 gst_vp8_dec_start (GstBaseVideoDecoder * decoder)
 {
@@ -330,6 +362,7 @@ gst_vp8_dec_start (GstBaseVideoDecoder * decoder)
 
   GST_DEBUG_OBJECT (gst_vp8_dec, "start");
   gst_vp8_dec->decoder_inited = FALSE;
+  decoder->pipeline_depth = gst_vp8_dec->pipeline_depth;
 
   return TRUE;
 }
@@ -383,6 +416,9 @@ gst_vp8_dec_send_tags (GstVP8Dec * dec)
 }
 #endif /* OPERA_MINIMAL_GST */
 
+/* The planes of a libvpx frame have a 32 pixel border, so their strides
+ * never match the I420 layout of our caps, and libvpx reuses the frame for
+ * its next reference frames. Every decoded frame is copied out row by row. */
 static void
 gst_vp8_dec_image_to_buffer (GstVP8Dec * dec, const vpx_image_t * img,
     GstBuffer * buffer)
@@ -452,6 +488,7 @@ gst_vp8_dec_handle_frame (GstBaseVideoDecoder * decoder, GstVideoFrame * frame,
     int flags = 0;
     vpx_codec_stream_info_t stream_info;
     vpx_codec_caps_t caps;
+    vpx_codec_dec_cfg_t cfg = { 0, };
 
     memset (&stream_info, 0, sizeof (stream_info));
     stream_info.sz = sizeof (stream_info);
@@ -488,8 +525,16 @@ gst_vp8_dec_handle_frame (GstBaseVideoDecoder * decoder, GstVideoFrame * frame,
       }
     }
 
+    /* libvpx decodes the token partitions of a frame in parallel */
+    cfg.threads = dec->threads;
+    if (cfg.threads == 0)
+      cfg.threads = MIN (gst_util_get_num_cpus (), MAX_THREADS);
+    cfg.w = stream_info.w;
+    cfg.h = stream_info.h;
+    GST_DEBUG_OBJECT (dec, "using %u decoding threads", cfg.threads);
+
     status =
-        vpx_codec_dec_init (&dec->decoder, vpx_codec_vp8_dx(), NULL, flags);
+        vpx_codec_dec_init (&dec->decoder, vpx_codec_vp8_dx(), &cfg, flags);
     if (status != VPX_CODEC_OK) {
       GST_ELEMENT_ERROR (dec, LIBRARY, INIT,
           ("Failed to initialize VP8 decoder"), ("%s",
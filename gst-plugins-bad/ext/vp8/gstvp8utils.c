@@ -34,6 +34,14 @@
 
 #include "gstvp8utils.h"
 
+#ifdef GST_VP8_NEED_GET_NUM_CPUS
+#ifdef G_OS_WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#endif
+
 const char *
 gst_vpx_error_name (vpx_codec_err_t status)
 {
@@ -60,3 +68,23 @@ gst_vpx_error_name (vpx_codec_err_t status)
       return "unknown";
   }
 }
+
+#ifdef GST_VP8_NEED_GET_NUM_CPUS
+/* Same as gst_util_get_num_cpus() */
+guint
+gst_vp8_get_num_cpus (void)
+{
+  glong n_cpus = 1;
+
+#ifdef G_OS_WIN32
+  SYSTEM_INFO info;
+
+  GetSystemInfo (&info);
+  n_cpus = info.dwNumberOfProcessors;
+#elif defined (_SC_NPROCESSORS_ONLN)
+  n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+
+  return MAX (n_cpus, 1);
+}
+#endif
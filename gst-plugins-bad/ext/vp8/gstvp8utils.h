@@ -44,4 +44,11 @@ G_BEGIN_DECLS
 
 const char * gst_vpx_error_name (vpx_codec_err_t status);
 
+/* unix/Makefile builds against GStreamer releases that don't have it yet */
+#ifndef gst_util_get_num_cpus
+#define GST_VP8_NEED_GET_NUM_CPUS
+#define gst_util_get_num_cpus gst_vp8_get_num_cpus
+guint gst_vp8_get_num_cpus (void);
+#endif
+
 G_END_DECLS
@@ -36,6 +36,8 @@ static gboolean gst_base_video_decoder_sink_event (GstPad * pad,
     GstEvent * event);
 static gboolean gst_base_video_decoder_src_event (GstPad * pad,
     GstEvent * event);
+static gboolean gst_base_video_decoder_src_activate_push (GstPad * pad,
+    gboolean active);
 static GstFlowReturn gst_base_video_decoder_chain (GstPad * pad,
     GstBuffer * buf);
 static gboolean gst_base_video_decoder_sink_query (GstPad * pad,
@@ -67,6 +69,10 @@ static guint64 gst_base_video_decoder_get_field_duration (GstBaseVideoDecoder *
 static GstVideoFrame *gst_base_video_decoder_new_frame (GstBaseVideoDecoder *
     base_video_decoder);
 static void gst_base_video_decoder_free_frame (GstVideoFrame * frame);
+static gboolean gst_base_video_decoder_drain (GstBaseVideoDecoder *
+    base_video_decoder);
+static void gst_base_video_decoder_flush_pending (GstBaseVideoDecoder *
+    base_video_decoder);
 
 GST_BOILERPLATE (GstBaseVideoDecoder, gst_base_video_decoder,
     GstBaseVideoCodec, GST_TYPE_BASE_VIDEO_CODEC);
@@ -113,6 +119,8 @@ gst_base_video_decoder_init (GstBaseVideoDecoder * base_video_decoder,
   pad = GST_BASE_VIDEO_CODEC_SRC_PAD (base_video_decoder);
 
   gst_pad_set_event_function (pad, gst_base_video_decoder_src_event);
+  gst_pad_set_activatepush_function (pad,
+      gst_base_video_decoder_src_activate_push);
   gst_pad_set_query_type_function (pad, gst_base_video_decoder_get_query_types);
   gst_pad_set_query_function (pad, gst_base_video_decoder_src_query);
   gst_pad_use_fixed_caps (pad);
@@ -127,6 +135,11 @@ gst_base_video_decoder_init (GstBaseVideoDecoder * base_video_decoder,
       gst_base_video_decoder_new_frame (base_video_decoder);
 
   base_video_decoder->sink_clipping = TRUE;
+
+  base_video_decoder->pipeline_lock = g_mutex_new ();
+  base_video_decoder->pipeline_cond = g_cond_new ();
+  g_queue_init (&base_video_decoder->pending_frames);
+  base_video_decoder->pipeline_result = GST_FLOW_OK;
 }
 
 static gboolean
@@ -145,6 +158,12 @@ gst_base_video_decoder_sink_setcaps (GstPad * pad, GstCaps * caps)
 
   GST_DEBUG ("setcaps %" GST_PTR_FORMAT, caps);
 
+  /* the decoding thread might still use the old state */
+  if (!gst_base_video_decoder_drain (base_video_decoder)) {
+    g_object_unref (base_video_decoder);
+    return FALSE;
+  }
+
   state = &base_video_decoder->state;
 
   if (state->codec_data) {
@@ -202,6 +221,10 @@ gst_base_video_decoder_finalize (GObject * object)
     base_video_decoder->output_adapter = NULL;
   }
 
+  gst_base_video_decoder_flush_pending (base_video_decoder);
+  g_mutex_free (base_video_decoder->pipeline_lock);
+  g_cond_free (base_video_decoder->pipeline_cond);
+
   GST_DEBUG_OBJECT (object, "finalize");
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -218,6 +241,18 @@ gst_base_video_decoder_sink_event (GstPad * pad, GstEvent * event)
   base_video_decoder_class =
       GST_BASE_VIDEO_DECODER_GET_CLASS (base_video_decoder);
 
+  /* let the decoding thread catch up so the event stays in order with the
+   * frames queued before it. Failures of the decoding thread are kept for
+   * the next buffer, the event is only dropped if we started flushing */
+  if (GST_EVENT_IS_SERIALIZED (event)
+      && GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP
+      && !gst_base_video_decoder_drain (base_video_decoder)) {
+    GST_DEBUG_OBJECT (base_video_decoder, "flushing, dropping %s event",
+        GST_EVENT_TYPE_NAME (event));
+    gst_event_unref (event);
+    goto done;
+  }
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
     {
@@ -279,11 +314,35 @@ gst_base_video_decoder_sink_event (GstPad * pad, GstEvent * event)
           event);
     }
       break;
+    case GST_EVENT_FLUSH_START:{
+      ret =
+          gst_pad_push_event (GST_BASE_VIDEO_CODEC_SRC_PAD (base_video_decoder),
+          event);
+
+      /* unblock the chain function and the decoding thread */
+      g_mutex_lock (base_video_decoder->pipeline_lock);
+      base_video_decoder->pipeline_flushing = TRUE;
+      g_cond_broadcast (base_video_decoder->pipeline_cond);
+      g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+      /* downstream is flushing too, so this can't block for long */
+      gst_pad_pause_task (GST_BASE_VIDEO_CODEC_SRC_PAD (base_video_decoder));
+      g_mutex_lock (base_video_decoder->pipeline_lock);
+      base_video_decoder->pipeline_started = FALSE;
+      g_mutex_unlock (base_video_decoder->pipeline_lock);
+    }
+      break;
     case GST_EVENT_FLUSH_STOP:{
       GST_OBJECT_LOCK (base_video_decoder);
       base_video_decoder->earliest_time = GST_CLOCK_TIME_NONE;
       base_video_decoder->proportion = 0.5;
       GST_OBJECT_UNLOCK (base_video_decoder);
+
+      gst_base_video_decoder_flush_pending (base_video_decoder);
+      g_mutex_lock (base_video_decoder->pipeline_lock);
+      base_video_decoder->pipeline_flushing = FALSE;
+      base_video_decoder->pipeline_result = GST_FLOW_OK;
+      g_mutex_unlock (base_video_decoder->pipeline_lock);
     }
     default:
       /* FIXME this changes the order of events */
@@ -723,6 +782,7 @@ gst_base_video_decoder_reset (GstBaseVideoDecoder * base_video_decoder)
   base_video_decoder->have_sync = FALSE;
 
   base_video_decoder->timestamp_offset = GST_CLOCK_TIME_NONE;
+  base_video_decoder->field_index = 0;
   base_video_decoder->system_frame_number = 0;
   base_video_decoder->presentation_frame_number = 0;
   base_video_decoder->base_picture_number = 0;
@@ -819,6 +879,12 @@ gst_base_video_decoder_chain (GstPad * pad, GstBuffer * buf)
 
   if (G_UNLIKELY (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT))) {
     GST_DEBUG_OBJECT (base_video_decoder, "received DISCONT buffer");
+    if (!gst_base_video_decoder_drain (base_video_decoder)) {
+      GST_DEBUG_OBJECT (base_video_decoder, "flushing, dropping buffer");
+      gst_buffer_unref (buf);
+      gst_object_unref (base_video_decoder);
+      return GST_FLOW_WRONG_STATE;
+    }
     gst_base_video_decoder_reset (base_video_decoder);
   }
 
@@ -934,6 +1000,34 @@ gst_base_video_decoder_change_state (GstElement * element,
   return ret;
 }
 
+static gboolean
+gst_base_video_decoder_src_activate_push (GstPad * pad, gboolean active)
+{
+  GstBaseVideoDecoder *base_video_decoder;
+  gboolean result = TRUE;
+
+  base_video_decoder = GST_BASE_VIDEO_DECODER (gst_pad_get_parent (pad));
+
+  /* the decoding thread is started when the first frame is queued */
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  base_video_decoder->pipeline_flushing = !active;
+  base_video_decoder->pipeline_result = GST_FLOW_OK;
+  g_cond_broadcast (base_video_decoder->pipeline_cond);
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+  if (!active) {
+    result = gst_pad_stop_task (pad);
+    g_mutex_lock (base_video_decoder->pipeline_lock);
+    base_video_decoder->pipeline_started = FALSE;
+    g_mutex_unlock (base_video_decoder->pipeline_lock);
+    gst_base_video_decoder_flush_pending (base_video_decoder);
+  }
+
+  gst_object_unref (base_video_decoder);
+
+  return result;
+}
+
 static void
 gst_base_video_decoder_free_frame (GstVideoFrame * frame)
 {
@@ -1329,29 +1423,20 @@ gst_base_video_decoder_have_frame (GstBaseVideoDecoder * base_video_decoder)
   return gst_base_video_decoder_have_frame_2 (base_video_decoder);
 }
 
+/* Hands @frame to the subclass. Called from the streaming thread, or from
+ * the decoding thread when pipelining is enabled. */
 static GstFlowReturn
-gst_base_video_decoder_have_frame_2 (GstBaseVideoDecoder * base_video_decoder)
+gst_base_video_decoder_handle_frame (GstBaseVideoDecoder * base_video_decoder,
+    GstVideoFrame * frame)
 {
-  GstVideoFrame *frame = base_video_decoder->current_frame;
   GstBaseVideoDecoderClass *base_video_decoder_class;
-  GstFlowReturn ret = GST_FLOW_OK;
+  GstFlowReturn ret;
   GstClockTime running_time;
   GstClockTimeDiff deadline;
 
   base_video_decoder_class =
       GST_BASE_VIDEO_DECODER_GET_CLASS (base_video_decoder);
 
-  frame->distance_from_sync = base_video_decoder->distance_from_sync;
-  base_video_decoder->distance_from_sync++;
-
-  frame->presentation_timestamp = GST_BUFFER_TIMESTAMP (frame->sink_buffer);
-  frame->presentation_duration = GST_BUFFER_DURATION (frame->sink_buffer);
-
-  GST_DEBUG ("pts %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (frame->presentation_timestamp));
-  GST_DEBUG ("dts %" GST_TIME_FORMAT, GST_TIME_ARGS (frame->decode_timestamp));
-  GST_DEBUG ("dist %d", frame->distance_from_sync);
-
   base_video_decoder->frames = g_list_append (base_video_decoder->frames,
       frame);
 
@@ -1370,6 +1455,150 @@ gst_base_video_decoder_have_frame_2 (GstBaseVideoDecoder * base_video_decoder)
     GST_DEBUG ("flow error!");
   }
 
+  return ret;
+}
+
+static void
+gst_base_video_decoder_loop (GstBaseVideoDecoder * base_video_decoder)
+{
+  GstVideoFrame *frame;
+  GstFlowReturn ret;
+
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  while (!base_video_decoder->pipeline_flushing &&
+      g_queue_is_empty (&base_video_decoder->pending_frames))
+    g_cond_wait (base_video_decoder->pipeline_cond,
+        base_video_decoder->pipeline_lock);
+
+  if (base_video_decoder->pipeline_flushing)
+    goto pause;
+
+  frame = g_queue_pop_head (&base_video_decoder->pending_frames);
+  base_video_decoder->pipeline_busy = TRUE;
+  g_cond_broadcast (base_video_decoder->pipeline_cond);
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+  ret = gst_base_video_decoder_handle_frame (base_video_decoder, frame);
+
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  base_video_decoder->pipeline_busy = FALSE;
+  /* upstream gets it with the next frame it hands us, and decides whether
+   * to go on, like it would for the frame itself without pipelining */
+  if (ret != GST_FLOW_OK && base_video_decoder->pipeline_result == GST_FLOW_OK) {
+    GST_DEBUG_OBJECT (base_video_decoder, "decoding frame returned %s",
+        gst_flow_get_name (ret));
+    base_video_decoder->pipeline_result = ret;
+  }
+  g_cond_broadcast (base_video_decoder->pipeline_cond);
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+  return;
+
+pause:
+  {
+    GST_DEBUG_OBJECT (base_video_decoder, "flushing, pausing decoding thread");
+    base_video_decoder->pipeline_started = FALSE;
+    gst_pad_pause_task (GST_BASE_VIDEO_CODEC_SRC_PAD (base_video_decoder));
+    g_mutex_unlock (base_video_decoder->pipeline_lock);
+    return;
+  }
+}
+
+/* Queues @frame for the decoding thread, waiting while pipeline_depth
+ * frames are already pending. Returns the first failure of the decoding
+ * thread since the last call, and clears it. */
+static GstFlowReturn
+gst_base_video_decoder_queue_frame (GstBaseVideoDecoder * base_video_decoder,
+    GstVideoFrame * frame)
+{
+  GstFlowReturn ret;
+
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  while (!base_video_decoder->pipeline_flushing &&
+      base_video_decoder->pending_frames.length >=
+      base_video_decoder->pipeline_depth)
+    g_cond_wait (base_video_decoder->pipeline_cond,
+        base_video_decoder->pipeline_lock);
+
+  if (base_video_decoder->pipeline_flushing) {
+    g_mutex_unlock (base_video_decoder->pipeline_lock);
+    GST_DEBUG_OBJECT (base_video_decoder, "flushing, not queueing frame");
+    gst_base_video_decoder_free_frame (frame);
+    return GST_FLOW_WRONG_STATE;
+  }
+
+  g_queue_push_tail (&base_video_decoder->pending_frames, frame);
+  g_cond_broadcast (base_video_decoder->pipeline_cond);
+
+  if (!base_video_decoder->pipeline_started) {
+    GST_DEBUG_OBJECT (base_video_decoder, "starting decoding thread");
+    base_video_decoder->pipeline_started =
+        gst_pad_start_task (GST_BASE_VIDEO_CODEC_SRC_PAD (base_video_decoder),
+        (GstTaskFunction) gst_base_video_decoder_loop, base_video_decoder);
+  }
+
+  ret = base_video_decoder->pipeline_result;
+  base_video_decoder->pipeline_result = GST_FLOW_OK;
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+  return ret;
+}
+
+/* Waits until the decoding thread has handled all queued frames and is
+ * idle, so the streaming thread may touch the decoder state again. Returns
+ * FALSE if flushing started meanwhile, the pending frames are then dropped
+ * on FLUSH_STOP, but the decoding thread is idle all the same. */
+static gboolean
+gst_base_video_decoder_drain (GstBaseVideoDecoder * base_video_decoder)
+{
+  gboolean ret;
+
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  while (base_video_decoder->pipeline_busy ||
+      (!base_video_decoder->pipeline_flushing &&
+          !g_queue_is_empty (&base_video_decoder->pending_frames)))
+    g_cond_wait (base_video_decoder->pipeline_cond,
+        base_video_decoder->pipeline_lock);
+  ret = !base_video_decoder->pipeline_flushing;
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+
+  return ret;
+}
+
+static void
+gst_base_video_decoder_flush_pending (GstBaseVideoDecoder * base_video_decoder)
+{
+  GstVideoFrame *frame;
+
+  g_mutex_lock (base_video_decoder->pipeline_lock);
+  while ((frame = g_queue_pop_head (&base_video_decoder->pending_frames)))
+    gst_base_video_decoder_free_frame (frame);
+  g_cond_broadcast (base_video_decoder->pipeline_cond);
+  g_mutex_unlock (base_video_decoder->pipeline_lock);
+}
+
+static GstFlowReturn
+gst_base_video_decoder_have_frame_2 (GstBaseVideoDecoder * base_video_decoder)
+{
+  GstVideoFrame *frame = base_video_decoder->current_frame;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  frame->distance_from_sync = base_video_decoder->distance_from_sync;
+  base_video_decoder->distance_from_sync++;
+
+  frame->presentation_timestamp = GST_BUFFER_TIMESTAMP (frame->sink_buffer);
+  frame->presentation_duration = GST_BUFFER_DURATION (frame->sink_buffer);
+
+  GST_DEBUG ("pts %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (frame->presentation_timestamp));
+  GST_DEBUG ("dts %" GST_TIME_FORMAT, GST_TIME_ARGS (frame->decode_timestamp));
+  GST_DEBUG ("dist %d", frame->distance_from_sync);
+
+  if (base_video_decoder->pipeline_depth > 0)
+    ret = gst_base_video_decoder_queue_frame (base_video_decoder, frame);
+  else
+    ret = gst_base_video_decoder_handle_frame (base_video_decoder, frame);
+
   /* create new frame */
   base_video_decoder->current_frame =
       gst_base_video_decoder_new_frame (base_video_decoder);
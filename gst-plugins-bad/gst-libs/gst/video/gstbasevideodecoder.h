@@ -121,6 +121,25 @@ struct _GstBaseVideoDecoder
 
   GList *timestamps;
   gboolean have_segment;
+
+  /* Number of frames that may be queued for decoding in a separate thread,
+   * so that parsing upstream overlaps with decoding. 0 (the default) calls
+   * handle_frame from the streaming thread. Set by subclasses before data
+   * starts flowing. While frames are queued or being decoded, the decoding
+   * thread owns frames, timestamp_offset, field_index and state. The
+   * streaming thread waits for it to go idle before touching them, so
+   * subclasses may only use them from handle_frame and reset. */
+  int pipeline_depth;
+
+  /* protected by pipeline_lock */
+  GMutex *pipeline_lock;
+  GCond *pipeline_cond;
+  GQueue pending_frames;
+  gboolean pipeline_busy;
+  gboolean pipeline_started;
+  gboolean pipeline_flushing;
+  /* first failure of the decoding thread not yet returned upstream */
+  GstFlowReturn pipeline_result;
 };
 
 struct _GstBaseVideoDecoderClass
@@ -0,0 +1,344 @@
+/* GStreamer unit tests for GstBaseVideoDecoder
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/gstbasevideodecoder.h>
+
+#define FRAME_DURATION (GST_SECOND / 25)
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-test"));
+
+/* the decoding thread blocks in handle_frame while the gate is closed */
+static GMutex *gate_lock;
+static GCond *gate_cond;
+static gboolean gate_open;
+
+/* number of buffers received when EOS arrived, or -1 */
+static gint buffers_at_eos;
+
+static void
+set_gate (gboolean open)
+{
+  g_mutex_lock (gate_lock);
+  gate_open = open;
+  g_cond_broadcast (gate_cond);
+  g_mutex_unlock (gate_lock);
+}
+
+typedef struct _GstTestVideoDec GstTestVideoDec;
+typedef struct _GstTestVideoDecClass GstTestVideoDecClass;
+
+struct _GstTestVideoDec
+{
+  GstBaseVideoDecoder base_video_decoder;
+};
+
+struct _GstTestVideoDecClass
+{
+  GstBaseVideoDecoderClass base_video_decoder_class;
+};
+
+static GstStaticPadTemplate gst_test_video_dec_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-test"));
+
+static GstStaticPadTemplate gst_test_video_dec_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_YUV ("I420")));
+
+GType gst_test_video_dec_get_type (void);
+GST_BOILERPLATE (GstTestVideoDec, gst_test_video_dec, GstBaseVideoDecoder,
+    GST_TYPE_BASE_VIDEO_DECODER);
+
+static gboolean
+gst_test_video_dec_start (GstBaseVideoDecoder * decoder)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_test_video_dec_stop (GstBaseVideoDecoder * decoder)
+{
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_test_video_dec_handle_frame (GstBaseVideoDecoder * decoder,
+    GstVideoFrame * frame, GstClockTimeDiff deadline)
+{
+  GstVideoState *state = &decoder->state;
+  GstFlowReturn ret;
+
+  g_mutex_lock (gate_lock);
+  while (!gate_open)
+    g_cond_wait (gate_cond, gate_lock);
+  g_mutex_unlock (gate_lock);
+
+  /* the decoding thread owns the state, like a real decoder parsing the
+   * stream headers it would set it up here */
+  if (state->format == GST_VIDEO_FORMAT_UNKNOWN) {
+    state->format = GST_VIDEO_FORMAT_I420;
+    state->width = 16;
+    state->height = 16;
+    state->fps_n = 25;
+    state->fps_d = 1;
+    state->par_n = 1;
+    state->par_d = 1;
+  }
+
+  ret = gst_base_video_decoder_alloc_src_frame (decoder, frame);
+  if (ret != GST_FLOW_OK) {
+    gst_base_video_decoder_skip_frame (decoder, frame);
+    return ret;
+  }
+
+  return gst_base_video_decoder_finish_frame (decoder, frame);
+}
+
+static void
+gst_test_video_dec_base_init (gpointer g_class)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_test_video_dec_src_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&gst_test_video_dec_sink_template));
+
+  gst_element_class_set_details_simple (element_class,
+      "Pipelined test decoder", "Codec/Decoder/Video",
+      "Decodes test frames in a separate thread", "Foo Bar <foo@bar.com>");
+}
+
+static void
+gst_test_video_dec_class_init (GstTestVideoDecClass * klass)
+{
+  GstBaseVideoDecoderClass *base_video_decoder_class =
+      GST_BASE_VIDEO_DECODER_CLASS (klass);
+
+  base_video_decoder_class->start = gst_test_video_dec_start;
+  base_video_decoder_class->stop = gst_test_video_dec_stop;
+  base_video_decoder_class->handle_frame = gst_test_video_dec_handle_frame;
+}
+
+static void
+gst_test_video_dec_init (GstTestVideoDec * dec, GstTestVideoDecClass * klass)
+{
+  GstBaseVideoDecoder *decoder = GST_BASE_VIDEO_DECODER (dec);
+
+  decoder->packetized = TRUE;
+  decoder->pipeline_depth = 2;
+}
+
+static gboolean
+sinkpad_event (GstPad * pad, GstEvent * event)
+{
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      /* let the frame being decoded go, it is dropped downstream */
+      set_gate (TRUE);
+      break;
+    case GST_EVENT_EOS:
+      buffers_at_eos = g_list_length (buffers);
+      break;
+    default:
+      break;
+  }
+
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static GstElement *
+setup_decoder (void)
+{
+  GstElement *decoder;
+
+  GST_DEBUG ("setup_decoder");
+
+  gate_lock = g_mutex_new ();
+  gate_cond = g_cond_new ();
+  gate_open = TRUE;
+  buffers_at_eos = -1;
+
+  fail_unless (gst_element_register (NULL, "testvideodec", GST_RANK_NONE,
+          gst_test_video_dec_get_type ()));
+
+  decoder = gst_check_setup_element ("testvideodec");
+  mysrcpad = gst_check_setup_src_pad (decoder, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (decoder, &sinktemplate, NULL);
+  gst_pad_set_event_function (mysinkpad, sinkpad_event);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (decoder,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  return decoder;
+}
+
+static void
+cleanup_decoder (GstElement * decoder)
+{
+  GST_DEBUG ("cleanup_decoder");
+
+  /* never leave the decoding thread blocked */
+  set_gate (TRUE);
+
+  fail_unless (gst_element_set_state (decoder,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (decoder);
+  gst_check_teardown_sink_pad (decoder);
+  gst_check_teardown_element (decoder);
+
+  g_mutex_free (gate_lock);
+  g_cond_free (gate_cond);
+}
+
+static void
+push_newsegment (void)
+{
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+}
+
+static void
+push_frames (gint n)
+{
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_from_string ("video/x-test");
+  for (i = 0; i < n; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (16);
+
+    memset (GST_BUFFER_DATA (buffer), i, 16);
+    GST_BUFFER_TIMESTAMP (buffer) = i * FRAME_DURATION;
+    GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+    gst_buffer_set_caps (buffer, caps);
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+  gst_caps_unref (caps);
+}
+
+static void
+check_output (gint n)
+{
+  GList *l;
+  gint i;
+
+  fail_unless_equals_int (g_list_length (buffers), n);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buffer = GST_BUFFER (l->data);
+
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer),
+        i * FRAME_DURATION);
+  }
+}
+
+GST_START_TEST (test_pipelined_eos)
+{
+  GstElement *decoder;
+
+  decoder = setup_decoder ();
+
+  push_newsegment ();
+  push_frames (10);
+
+  /* EOS has to wait for the frames queued before it */
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  fail_unless_equals_int (buffers_at_eos, 10);
+  check_output (10);
+
+  cleanup_decoder (decoder);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pipelined_flush)
+{
+  GstElement *decoder;
+
+  decoder = setup_decoder ();
+
+  push_newsegment ();
+
+  /* with the decoding thread stuck on the first frame, the next two are
+   * left in the queue when flushing starts */
+  set_gate (FALSE);
+  push_frames (3);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+  /* the decoding thread is paused now, nothing can come out anymore */
+  fail_unless_equals_int (g_list_length (buffers), 0);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop ()));
+
+  /* the flush must not leave a stale flow return or a stopped thread
+   * behind, decoding goes on normally with the new segment */
+  push_newsegment ();
+  push_frames (3);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  fail_unless_equals_int (buffers_at_eos, 3);
+  check_output (3);
+
+  cleanup_decoder (decoder);
+}
+
+GST_END_TEST;
+
+static Suite *
+basevideodecoder_suite (void)
+{
+  Suite *s = suite_create ("basevideodecoder");
+  TCase *tc_chain = tcase_create ("pipelined");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pipelined_eos);
+  tcase_add_test (tc_chain, test_pipelined_flush);
+
+  return s;
+}
+
+GST_CHECK_MAIN (basevideodecoder);
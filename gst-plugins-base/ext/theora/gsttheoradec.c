@@ -49,12 +49,20 @@
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
 #define THEORA_DEF_CROP         TRUE
+#define THEORA_DEF_THREADS      0
+#define THEORA_MAX_THREADS      16
 enum
 {
   ARG_0,
-  ARG_CROP
+  ARG_CROP,
+  ARG_THREADS
 };
 
+/* Requests worker threads from libtheora; older headers don't have it */
+#ifndef TH_DECCTL_SET_THREADS
+#define TH_DECCTL_SET_THREADS (17)
+#endif
+
 static GstStaticPadTemplate theora_dec_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -127,6 +135,11 @@ gst_theora_dec_class_init (GstTheoraDecClass * klass)
       g_param_spec_boolean ("crop", "Crop",
           "Crop the image to the visible region", THEORA_DEF_CROP,
           (GParamFlags) G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_THREADS,
+      g_param_spec_uint ("threads", "Threads",
+          "Maximum number of decoding threads (0 = number of CPUs)",
+          0, THEORA_MAX_THREADS, THEORA_DEF_THREADS,
+          (GParamFlags) G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state = theora_dec_change_state;
 
@@ -149,10 +162,13 @@ gst_theora_dec_init (GstTheoraDec * dec, GstTheoraDecClass * g_class)
   gst_pad_set_query_type_function (dec->srcpad, theora_get_query_types);
   gst_pad_set_query_function (dec->srcpad, theora_dec_src_query);
   gst_pad_use_fixed_caps (dec->srcpad);
+  /* every frame is the same size, recycle their memory */
+  GST_OBJECT_FLAG_SET (dec->srcpad, GST_PAD_ALLOC_POOLED);
 
   gst_element_add_pad (GST_ELEMENT (dec), dec->srcpad);
 
   dec->crop = THEORA_DEF_CROP;
+  dec->threads = THEORA_DEF_THREADS;
   dec->gather = NULL;
   dec->decode = NULL;
   dec->queued = NULL;
@@ -830,6 +846,19 @@ theora_handle_type_packet (GstTheoraDec * dec, ogg_packet * packet)
   /* done */
   dec->decoder = th_decode_alloc (&dec->info, dec->setup);
 
+  if (dec->decoder) {
+    gint threads = dec->threads;
+
+    if (threads == 0)
+      threads = MIN (gst_util_get_num_cpus (), THEORA_MAX_THREADS);
+    if (threads > 1 && th_decode_ctl (dec->decoder, TH_DECCTL_SET_THREADS,
+            &threads, sizeof (threads)) < 0) {
+      GST_WARNING_OBJECT (dec, "could not decode with %d threads", threads);
+    } else {
+      GST_DEBUG_OBJECT (dec, "decoding with %d threads", threads);
+    }
+  }
+
   caps = gst_caps_new_simple ("video/x-raw-yuv",
       "format", GST_TYPE_FOURCC, fourcc,
       "framerate", GST_TYPE_FRACTION,
@@ -1479,6 +1508,9 @@ theora_dec_set_property (GObject * object, guint prop_id,
     case ARG_CROP:
       dec->crop = g_value_get_boolean (value);
       break;
+    case ARG_THREADS:
+      dec->threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1495,6 +1527,9 @@ theora_dec_get_property (GObject * object, guint prop_id,
     case ARG_CROP:
       g_value_set_boolean (value, dec->crop);
       break;
+    case ARG_THREADS:
+      g_value_set_uint (value, dec->threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
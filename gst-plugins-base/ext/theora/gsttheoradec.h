@@ -74,6 +74,7 @@ struct _GstTheoraDec
   gint output_bpp;
 
   gboolean crop;
+  guint threads;
 
   /* list of buffers that need timestamps */
   GList *queued;
@@ -51,6 +51,13 @@
 GST_DEBUG_CATEGORY_EXTERN (vorbisdec_debug);
 #define GST_CAT_DEFAULT vorbisdec_debug
 
+/* libvorbis can write float samples interleaved straight into our output
+ * buffers, saving a copy_samples() pass over each of them */
+#if defined (HAVE_VORBIS_SYNTHESIS_BLOCKIN_INTERLEAVED) && !defined (TREMOR)
+#define DECODE_INTERLEAVED
+#include <vorbis/codec_interleaved.h>
+#endif
+
 static GstStaticPadTemplate vorbis_dec_src_factory =
 GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -844,7 +851,11 @@ static GstFlowReturn
 vorbis_handle_data_packet (GstVorbisDec * vd, ogg_packet * packet,
     GstClockTime timestamp, GstClockTime duration)
 {
+#ifndef DECODE_INTERLEAVED
   vorbis_sample_t **pcm;
+#else
+  gint ret;
+#endif
   guint sample_count;
   GstBuffer *out;
   GstFlowReturn result;
@@ -862,6 +873,37 @@ vorbis_handle_data_packet (GstVorbisDec * vd, ogg_packet * packet,
   if (G_UNLIKELY (vorbis_synthesis (&vd->vb, packet)))
     goto could_not_read;
 
+#ifdef DECODE_INTERLEAVED
+  /* a block completes at most half a long block worth of samples, alloc
+   * for that much and let the decoder fill in what it has */
+  size = vorbis_info_blocksize (&vd->vi, 1) / 2 * vd->vi.channels * vd->width;
+
+  result =
+      gst_pad_alloc_buffer_and_set_caps (vd->srcpad, GST_BUFFER_OFFSET_NONE,
+      size, GST_PAD_CAPS (vd->srcpad), &out);
+  if (G_UNLIKELY (result != GST_FLOW_OK)) {
+    /* the block is still needed to decode the next one */
+    if (G_UNLIKELY (vorbis_synthesis_blockin (&vd->vd, &vd->vb) < 0))
+      goto not_accepted;
+    vorbis_synthesis_read (&vd->vd, vorbis_synthesis_pcmout (&vd->vd, NULL));
+    return result;
+  }
+
+  ret = vorbis_synthesis_blockin_interleaved (&vd->vd, &vd->vb,
+      (float *) GST_BUFFER_DATA (out));
+  if (G_UNLIKELY (ret < 0)) {
+    gst_buffer_unref (out);
+    goto not_accepted;
+  }
+
+  if ((sample_count = ret) == 0) {
+    gst_buffer_unref (out);
+    return GST_FLOW_OK;
+  }
+
+  size = sample_count * vd->vi.channels * vd->width;
+  GST_LOG_OBJECT (vd, "decoded %d samples, size %d", sample_count, size);
+#else
   if (G_UNLIKELY (vorbis_synthesis_blockin (&vd->vd, &vd->vb) < 0))
     goto not_accepted;
 
@@ -890,6 +932,7 @@ vorbis_handle_data_packet (GstVorbisDec * vd, ogg_packet * packet,
   /* copy samples in buffer */
   copy_samples ((vorbis_sample_t *) GST_BUFFER_DATA (out), pcm, sample_count,
       vd->vi.channels, vd->width);
+#endif
 
   GST_LOG_OBJECT (vd, "setting output size to %d", size);
   GST_BUFFER_SIZE (out) = size;
@@ -905,8 +948,10 @@ vorbis_handle_data_packet (GstVorbisDec * vd, ogg_packet * packet,
   else
     result = vorbis_dec_push_reverse (vd, out);
 
+#ifndef DECODE_INTERLEAVED
 done:
   vorbis_synthesis_read (&vd->vd, sample_count);
+#endif
 
   return result;
 
@@ -929,6 +974,7 @@ not_accepted:
         (NULL), ("vorbis decoder did not accept data packet"));
     return GST_FLOW_ERROR;
   }
+#ifndef DECODE_INTERLEAVED
 wrong_samples:
   {
     gst_buffer_unref (out);
@@ -936,6 +982,7 @@ wrong_samples:
         (NULL), ("vorbis decoder reported wrong number of samples"));
     return GST_FLOW_ERROR;
   }
+#endif
 }
 
 static GstFlowReturn
@@ -28,6 +28,7 @@
 
 #include "gstchannelmix.h"
 #include "gstaudioquantize.h"
+#include "gstaudiodirect.h"
 #include "audioconvert.h"
 #include "gst/floatcast/floatcast.h"
 
@@ -479,6 +480,9 @@ audio_convert_prepare_context (AudioConvertCtx * ctx, AudioConvertFmt * in,
 
   gst_audio_quantize_setup (ctx);
 
+  if (gst_audio_direct_setup (ctx))
+    GST_INFO ("use direct conversion");
+
   return TRUE;
 }
 
@@ -495,6 +499,7 @@ audio_convert_clean_context (AudioConvertCtx * ctx)
   g_free (ctx->tmpbuf);
   ctx->tmpbuf = NULL;
   ctx->tmpbufsize = 0;
+  ctx->direct = NULL;
 
   return TRUE;
 }
@@ -529,6 +534,11 @@ audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
   if (samples == 0)
     return TRUE;
 
+  if (ctx->direct) {
+    ctx->direct (ctx, src, dst, samples);
+    return TRUE;
+  }
+
   insize = ctx->in.unit_size * samples;
   outsize = ctx->out.unit_size * samples;
 
@@ -589,6 +599,8 @@ audio_convert_convert (AudioConvertCtx * ctx, gpointer src,
     else
       outbuf = tmpbuf;
     ctx->quantize (ctx, src, outbuf, samples);
+
+    src = outbuf;
   }
 
   if (!ctx->out_default) {
@@ -93,6 +93,8 @@ typedef void (*AudioConvertPack) (gpointer src, gpointer dst, gint scale,
 typedef void (*AudioConvertMix) (AudioConvertCtx *, gpointer, gpointer, gint);
 typedef void (*AudioConvertQuantize) (AudioConvertCtx * ctx, gpointer src,
     gpointer dst, gint count);
+typedef void (*AudioConvertDirect) (AudioConvertCtx * ctx, gpointer src,
+    gpointer dst, gint samples);
 
 struct _AudioConvertCtx
 {
@@ -128,6 +130,10 @@ struct _AudioConvertCtx
   gpointer last_random;
   /* contains the past quantization errors, error[out_channels][count] */
   gdouble *error_buf;
+
+  /* converts from the input to the output format in one pass, replaces all
+   * of the above if not NULL */
+  AudioConvertDirect direct;
 };
 
 gboolean audio_convert_clean_fmt (AudioConvertFmt * fmt);
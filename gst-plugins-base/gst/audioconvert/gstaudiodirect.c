@@ -0,0 +1,516 @@
+/* GStreamer
+ *
+ * gstaudiodirect.c: direct conversions between common formats that don't
+ *                   go through the intermediate format.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The unpack, channel mix, quantize and pack steps of audio_convert_convert()
+ * each make a pass over the samples. For native endian S16, S32 and F32 and
+ * for the default mono <-> stereo mixing the functions here do the whole
+ * conversion in one pass instead. They give exactly the same output as the
+ * generic path, which is why conversions to S16 are only done here without
+ * dithering and noise shaping.
+ *
+ * The SSE2 routines are selected at compile time, the few samples at the end
+ * of a buffer that don't fill a vector are converted by the C code.
+ */
+
+#include <gst/gst.h>
+#include <math.h>
+#include "audioconvert.h"
+#include "gstaudiodirect.h"
+
+/* MSVC has no __SSE2__, it targets SSE2 on x64 and with /arch:SSE2 */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_AUDIO_DIRECT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+enum
+{
+  FORMAT_OTHER = 0,
+  FORMAT_S16,
+  FORMAT_S32,
+  FORMAT_F32
+};
+
+#define INT_TO_FLOAT (1.0 / 2147483647.0)
+
+/* like the float unpack functions */
+static inline gint32
+float_to_s32 (gfloat f)
+{
+  gdouble temp = floor ((f * 2147483647.0) + 0.5);
+
+  return (gint32) CLAMP (temp, G_MININT32, G_MAXINT32);
+}
+
+/* like the quantize function without dither and noise shaping followed by
+ * the S16 pack function */
+static inline gint16
+s32_to_s16 (gint32 s)
+{
+  if (s > 0 && G_MAXINT32 - s <= (1 << 15))
+    s = G_MAXINT32;
+  else
+    s += (1 << 15);
+
+  return (gint16) (s >> 16);
+}
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+static inline __m128i
+s32_to_s16_sse2 (__m128i a, __m128i b)
+{
+  const __m128i one = _mm_set1_epi32 (1);
+
+  /* rounds to nearest, the pack saturates what rounds up to 32768 */
+  a = _mm_add_epi32 (_mm_srai_epi32 (a, 16),
+      _mm_and_si128 (_mm_srai_epi32 (a, 15), one));
+  b = _mm_add_epi32 (_mm_srai_epi32 (b, 16),
+      _mm_and_si128 (_mm_srai_epi32 (b, 15), one));
+
+  return _mm_packs_epi32 (a, b);
+}
+
+static inline __m128
+s32_to_f32_sse2 (__m128i x)
+{
+  const __m128d scale = _mm_set1_pd (INT_TO_FLOAT);
+  __m128 lo, hi;
+
+  lo = _mm_cvtpd_ps (_mm_mul_pd (_mm_cvtepi32_pd (x), scale));
+  hi = _mm_cvtpd_ps (_mm_mul_pd (_mm_cvtepi32_pd (_mm_srli_si128 (x, 8)),
+          scale));
+
+  return _mm_movelh_ps (lo, hi);
+}
+
+/* converts the 2 floats in the low half of x, the result is in the low half
+ * of the return value */
+static inline __m128i
+f32_to_s32_half_sse2 (__m128 x)
+{
+  const __m128d factor = _mm_set1_pd (2147483647.0);
+  const __m128d half = _mm_set1_pd (0.5);
+  const __m128d min = _mm_set1_pd (G_MININT32);
+  const __m128d max = _mm_set1_pd (G_MAXINT32);
+  __m128d t, gt;
+  __m128i i;
+
+  t = _mm_add_pd (_mm_mul_pd (_mm_cvtps_pd (x), factor), half);
+  /* clamping to integers before the floor gives the same result, NaN
+   * becomes G_MININT32 like with the C cast */
+  t = _mm_min_pd (_mm_max_pd (t, min), max);
+  i = _mm_cvttpd_epi32 (t);
+  /* floor of negative values that were truncated towards zero */
+  gt = _mm_cmpgt_pd (_mm_cvtepi32_pd (i), t);
+
+  return _mm_add_epi32 (i, _mm_shuffle_epi32 (_mm_castpd_si128 (gt),
+          _MM_SHUFFLE (3, 3, 2, 0)));
+}
+
+static inline __m128i
+f32_to_s32_sse2 (__m128 x)
+{
+  return _mm_unpacklo_epi64 (f32_to_s32_half_sse2 (x),
+      f32_to_s32_half_sse2 (_mm_movehl_ps (x, x)));
+}
+
+/* truncates like the cast to gint64 in the int channel mixer followed by the
+ * clipping, 2^31 is the only value that is out of range */
+static inline __m128i
+mix_f32_to_s32_sse2 (__m128 f)
+{
+  const __m128 limit = _mm_set1_ps (2147483648.0f);
+
+  return _mm_xor_si128 (_mm_cvttps_epi32 (f),
+      _mm_castps_si128 (_mm_cmpge_ps (f, limit)));
+}
+#endif
+
+/* format conversions, these work on all channels of a sample the same way */
+
+static void
+gst_audio_direct_s16_s32 (AudioConvertCtx * ctx, gint16 * src, gint32 * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i x;
+
+  for (; i + 8 <= n; i += 8) {
+    x = _mm_loadu_si128 ((const __m128i *) (src + i));
+    _mm_storeu_si128 ((__m128i *) (dst + i), _mm_unpacklo_epi16 (zero, x));
+    _mm_storeu_si128 ((__m128i *) (dst + i + 4), _mm_unpackhi_epi16 (zero, x));
+  }
+#endif
+  for (; i < n; i++)
+    dst[i] = ((gint32) src[i]) << 16;
+}
+
+static void
+gst_audio_direct_s16_f32 (AudioConvertCtx * ctx, gint16 * src, gfloat * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i x;
+
+  for (; i + 8 <= n; i += 8) {
+    x = _mm_loadu_si128 ((const __m128i *) (src + i));
+    _mm_storeu_ps (dst + i, s32_to_f32_sse2 (_mm_unpacklo_epi16 (zero, x)));
+    _mm_storeu_ps (dst + i + 4, s32_to_f32_sse2 (_mm_unpackhi_epi16 (zero,
+                x)));
+  }
+#endif
+  for (; i < n; i++)
+    dst[i] = (gfloat) ((((gint32) src[i]) << 16) * INT_TO_FLOAT);
+}
+
+static void
+gst_audio_direct_s32_s16 (AudioConvertCtx * ctx, gint32 * src, gint16 * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        s32_to_s16_sse2 (_mm_loadu_si128 ((const __m128i *) (src + i)),
+            _mm_loadu_si128 ((const __m128i *) (src + i + 4))));
+#endif
+  for (; i < n; i++)
+    dst[i] = s32_to_s16 (src[i]);
+}
+
+static void
+gst_audio_direct_s32_f32 (AudioConvertCtx * ctx, gint32 * src, gfloat * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps (dst + i,
+        s32_to_f32_sse2 (_mm_loadu_si128 ((const __m128i *) (src + i))));
+#endif
+  for (; i < n; i++)
+    dst[i] = (gfloat) (src[i] * INT_TO_FLOAT);
+}
+
+static void
+gst_audio_direct_f32_s16 (AudioConvertCtx * ctx, gfloat * src, gint16 * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        s32_to_s16_sse2 (f32_to_s32_sse2 (_mm_loadu_ps (src + i)),
+            f32_to_s32_sse2 (_mm_loadu_ps (src + i + 4))));
+#endif
+  for (; i < n; i++)
+    dst[i] = s32_to_s16 (float_to_s32 (src[i]));
+}
+
+static void
+gst_audio_direct_f32_s32 (AudioConvertCtx * ctx, gfloat * src, gint32 * dst,
+    gint samples)
+{
+  gint i = 0, n = samples * ctx->in.channels;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        f32_to_s32_sse2 (_mm_loadu_ps (src + i)));
+#endif
+  for (; i < n; i++)
+    dst[i] = float_to_s32 (src[i]);
+}
+
+/* mono to stereo and stereo to mono, these do the same calculations as the
+ * channel mixer with a matrix of 1.0 and 0.5 respectively */
+
+static void
+gst_audio_direct_s16_upmix (AudioConvertCtx * ctx, gint16 * src,
+    gint16 * dst, gint samples)
+{
+  gint i = 0;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  __m128i x;
+
+  for (; i + 8 <= samples; i += 8) {
+    x = _mm_loadu_si128 ((const __m128i *) (src + i));
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i), _mm_unpacklo_epi16 (x, x));
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i + 8),
+        _mm_unpackhi_epi16 (x, x));
+  }
+#endif
+  for (; i < samples; i++)
+    dst[2 * i] = dst[2 * i + 1] = src[i];
+}
+
+/* the mixer gives exactly (L + R) << 15, which the quantizer rounds to
+ * 16 bits */
+static void
+gst_audio_direct_s16_downmix (AudioConvertCtx * ctx, gint16 * src,
+    gint16 * dst, gint samples)
+{
+  gint i = 0;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128i one = _mm_set1_epi32 (1);
+  __m128i a, b;
+
+  for (; i + 8 <= samples; i += 8) {
+    a = _mm_loadu_si128 ((const __m128i *) (src + 2 * i));
+    b = _mm_loadu_si128 ((const __m128i *) (src + 2 * i + 8));
+    a = _mm_add_epi32 (_mm_srai_epi32 (_mm_slli_epi32 (a, 16), 16),
+        _mm_srai_epi32 (a, 16));
+    b = _mm_add_epi32 (_mm_srai_epi32 (_mm_slli_epi32 (b, 16), 16),
+        _mm_srai_epi32 (b, 16));
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        _mm_packs_epi32 (_mm_srai_epi32 (_mm_add_epi32 (a, one), 1),
+            _mm_srai_epi32 (_mm_add_epi32 (b, one), 1)));
+  }
+#endif
+  for (; i < samples; i++)
+    dst[i] = (src[2 * i] + src[2 * i + 1] + 1) >> 1;
+}
+
+static void
+gst_audio_direct_s32_upmix (AudioConvertCtx * ctx, gint32 * src,
+    gint32 * dst, gint samples)
+{
+  gint i = 0;
+  gint64 res;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  __m128i x;
+
+  for (; i + 4 <= samples; i += 4) {
+    x = mix_f32_to_s32_sse2 (_mm_cvtepi32_ps (_mm_loadu_si128 ((const __m128i
+                    *) (src + i))));
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i), _mm_unpacklo_epi32 (x, x));
+    _mm_storeu_si128 ((__m128i *) (dst + 2 * i + 4),
+        _mm_unpackhi_epi32 (x, x));
+  }
+#endif
+  for (; i < samples; i++) {
+    res = 0;
+    res += src[i] * 1.0f;
+    dst[2 * i] = dst[2 * i + 1] = CLAMP (res, G_MININT32, G_MAXINT32);
+  }
+}
+
+static void
+gst_audio_direct_s32_downmix (AudioConvertCtx * ctx, gint32 * src,
+    gint32 * dst, gint samples)
+{
+  gint i = 0;
+  gint64 res;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128 half = _mm_set1_ps (0.5f);
+  __m128 a, b, l, r;
+
+  for (; i + 4 <= samples; i += 4) {
+    a = _mm_castsi128_ps (_mm_loadu_si128 ((const __m128i *) (src + 2 * i)));
+    b = _mm_castsi128_ps (_mm_loadu_si128 ((const __m128i *) (src + 2 * i +
+                4)));
+    l = _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0));
+    r = _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1));
+    /* the mixer truncates to an integer after every channel */
+    l = _mm_cvtepi32_ps (_mm_cvttps_epi32 (_mm_mul_ps (_mm_cvtepi32_ps
+                (_mm_castps_si128 (l)), half)));
+    r = _mm_mul_ps (_mm_cvtepi32_ps (_mm_castps_si128 (r)), half);
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        mix_f32_to_s32_sse2 (_mm_add_ps (l, r)));
+  }
+#endif
+  for (; i < samples; i++) {
+    res = 0;
+    res += src[2 * i] * 0.5f;
+    res += src[2 * i + 1] * 0.5f;
+    dst[i] = CLAMP (res, G_MININT32, G_MAXINT32);
+  }
+}
+
+static void
+gst_audio_direct_f32_upmix (AudioConvertCtx * ctx, gfloat * src,
+    gfloat * dst, gint samples)
+{
+  gint i = 0;
+  gdouble res;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128 min = _mm_set1_ps (-1.0f);
+  const __m128 max = _mm_set1_ps (1.0f);
+  __m128 x;
+
+  for (; i + 4 <= samples; i += 4) {
+    /* adding to 0.0 turns -0.0 into 0.0 like in the mixer, NaN is kept by
+     * the order of the operands of min and max */
+    x = _mm_add_ps (_mm_setzero_ps (), _mm_loadu_ps (src + i));
+    x = _mm_min_ps (max, _mm_max_ps (min, x));
+    _mm_storeu_ps (dst + 2 * i, _mm_unpacklo_ps (x, x));
+    _mm_storeu_ps (dst + 2 * i + 4, _mm_unpackhi_ps (x, x));
+  }
+#endif
+  for (; i < samples; i++) {
+    res = 0.0;
+    res += src[i] * 1.0;
+    if (res < -1.0)
+      res = -1.0;
+    else if (res > 1.0)
+      res = 1.0;
+    dst[2 * i] = dst[2 * i + 1] = (gfloat) res;
+  }
+}
+
+static void
+gst_audio_direct_f32_downmix (AudioConvertCtx * ctx, gfloat * src,
+    gfloat * dst, gint samples)
+{
+  gint i = 0;
+  gdouble res;
+
+#ifdef HAVE_AUDIO_DIRECT_SSE2
+  const __m128d half = _mm_set1_pd (0.5);
+  const __m128d min = _mm_set1_pd (-1.0);
+  const __m128d max = _mm_set1_pd (1.0);
+  __m128d m[2], d0, d1;
+  __m128 x;
+  gint k;
+
+  for (; i + 4 <= samples; i += 4) {
+    for (k = 0; k < 2; k++) {
+      x = _mm_loadu_ps (src + 2 * i + 4 * k);
+      d0 = _mm_cvtps_pd (x);
+      d1 = _mm_cvtps_pd (_mm_movehl_ps (x, x));
+      m[k] = _mm_add_pd (_mm_add_pd (_mm_setzero_pd (),
+              _mm_mul_pd (_mm_unpacklo_pd (d0, d1), half)),
+          _mm_mul_pd (_mm_unpackhi_pd (d0, d1), half));
+      m[k] = _mm_min_pd (max, _mm_max_pd (min, m[k]));
+    }
+    _mm_storeu_ps (dst + i, _mm_movelh_ps (_mm_cvtpd_ps (m[0]),
+            _mm_cvtpd_ps (m[1])));
+  }
+#endif
+  for (; i < samples; i++) {
+    res = 0.0;
+    res += src[2 * i] * 0.5;
+    res += src[2 * i + 1] * 0.5;
+    if (res < -1.0)
+      res = -1.0;
+    else if (res > 1.0)
+      res = 1.0;
+    dst[i] = (gfloat) res;
+  }
+}
+
+/* indexed by input and output format */
+static const AudioConvertDirect format_funcs[3][3] = {
+  {NULL, (AudioConvertDirect) gst_audio_direct_s16_s32,
+      (AudioConvertDirect) gst_audio_direct_s16_f32},
+  {(AudioConvertDirect) gst_audio_direct_s32_s16, NULL,
+      (AudioConvertDirect) gst_audio_direct_s32_f32},
+  {(AudioConvertDirect) gst_audio_direct_f32_s16,
+      (AudioConvertDirect) gst_audio_direct_f32_s32, NULL}
+};
+
+static const AudioConvertDirect upmix_funcs[3] = {
+  (AudioConvertDirect) gst_audio_direct_s16_upmix,
+  (AudioConvertDirect) gst_audio_direct_s32_upmix,
+  (AudioConvertDirect) gst_audio_direct_f32_upmix
+};
+
+static const AudioConvertDirect downmix_funcs[3] = {
+  (AudioConvertDirect) gst_audio_direct_s16_downmix,
+  (AudioConvertDirect) gst_audio_direct_s32_downmix,
+  (AudioConvertDirect) gst_audio_direct_f32_downmix
+};
+
+static gint
+gst_audio_direct_get_format (AudioConvertFmt * fmt)
+{
+  if (fmt->endianness != G_BYTE_ORDER)
+    return FORMAT_OTHER;
+
+  if (fmt->is_int) {
+    if (!fmt->sign || fmt->depth != fmt->width)
+      return FORMAT_OTHER;
+    if (fmt->width == 16)
+      return FORMAT_S16;
+    if (fmt->width == 32)
+      return FORMAT_S32;
+  } else if (fmt->width == 32) {
+    return FORMAT_F32;
+  }
+
+  return FORMAT_OTHER;
+}
+
+gboolean
+gst_audio_direct_setup (AudioConvertCtx * ctx)
+{
+  gint in, out;
+
+  ctx->direct = NULL;
+
+  in = gst_audio_direct_get_format (&ctx->in);
+  out = gst_audio_direct_get_format (&ctx->out);
+
+  if (in == FORMAT_OTHER || out == FORMAT_OTHER ||
+      ctx->ns != NOISE_SHAPING_NONE)
+    return FALSE;
+
+  if (ctx->in.channels == ctx->out.channels) {
+    if (in == out || !ctx->mix_passthrough)
+      return FALSE;
+    if (out == FORMAT_S16 && ctx->dither != DITHER_NONE)
+      return FALSE;
+
+    ctx->direct = format_funcs[in - 1][out - 1];
+  } else if (in == out && ctx->in.channels == 1 && ctx->out.channels == 2) {
+    if (ctx->matrix[0][0] != 1.0f || ctx->matrix[0][1] != 1.0f)
+      return FALSE;
+    if (out == FORMAT_S16 && ctx->dither != DITHER_NONE)
+      return FALSE;
+
+    ctx->direct = upmix_funcs[in - 1];
+  } else if (in == out && ctx->in.channels == 2 && ctx->out.channels == 1) {
+    if (ctx->matrix[0][0] != 0.5f || ctx->matrix[1][0] != 0.5f)
+      return FALSE;
+    if (out == FORMAT_S16 && ctx->dither != DITHER_NONE)
+      return FALSE;
+
+    ctx->direct = downmix_funcs[in - 1];
+  }
+
+  return ctx->direct != NULL;
+}
@@ -31,10 +31,17 @@
 #include "avcodec.h"
 #include "dsputil.h"
 #include "gstffmpegcodecmap.h"
+#include "imgconvert_sse2.h"
 
 #include <string.h>
 #include <stdlib.h>
 
+#ifdef HAVE_IMGCONVERT_SSE2
+#include <liboil/liboil.h>
+#include <liboil/liboilcpu.h>
+#include <liboil/liboilfunction.h>
+#endif
+
 GST_DEBUG_CATEGORY_EXTERN (ffmpegcolorspace_performance);
 
 #define xglue(x, y) x ## y
@@ -797,61 +804,6 @@ img_copy (AVPicture * dst, const AVPicture * src,
 
 /* XXX: totally non optimized */
 
-static void
-yuv422_to_yuv420p (AVPicture * dst, const AVPicture * src,
-    int width, int height)
-{
-  const uint8_t *p, *p1;
-  uint8_t *lum, *cr, *cb, *lum1, *cr1, *cb1;
-  int w;
-
-  p1 = src->data[0];
-  lum1 = dst->data[0];
-  cb1 = dst->data[1];
-  cr1 = dst->data[2];
-
-  for (; height >= 1; height -= 2) {
-    p = p1;
-    lum = lum1;
-    cb = cb1;
-    cr = cr1;
-    for (w = width; w >= 2; w -= 2) {
-      lum[0] = p[0];
-      cb[0] = p[1];
-      lum[1] = p[2];
-      cr[0] = p[3];
-      p += 4;
-      lum += 2;
-      cb++;
-      cr++;
-    }
-    if (w) {
-      lum[0] = p[0];
-      cb[0] = p[1];
-      cr[0] = p[3];
-    }
-    p1 += src->linesize[0];
-    lum1 += dst->linesize[0];
-    if (height > 1) {
-      p = p1;
-      lum = lum1;
-      for (w = width; w >= 2; w -= 2) {
-        lum[0] = p[0];
-        lum[1] = p[2];
-        p += 4;
-        lum += 2;
-      }
-      if (w) {
-        lum[0] = p[0];
-      }
-      p1 += src->linesize[0];
-      lum1 += dst->linesize[0];
-    }
-    cb1 += dst->linesize[1];
-    cr1 += dst->linesize[2];
-  }
-}
-
 static void
 uyvy422_to_gray (AVPicture * dst, const AVPicture * src, int width, int height)
 {
@@ -877,63 +829,6 @@ uyvy422_to_gray (AVPicture * dst, const AVPicture * src, int width, int height)
 }
 
 
-static void
-uyvy422_to_yuv420p (AVPicture * dst, const AVPicture * src,
-    int width, int height)
-{
-  const uint8_t *p, *p1;
-  uint8_t *lum, *cr, *cb, *lum1, *cr1, *cb1;
-  int w;
-
-  p1 = src->data[0];
-
-  lum1 = dst->data[0];
-  cb1 = dst->data[1];
-  cr1 = dst->data[2];
-
-  for (; height >= 1; height -= 2) {
-    p = p1;
-    lum = lum1;
-    cb = cb1;
-    cr = cr1;
-    for (w = width; w >= 2; w -= 2) {
-      lum[0] = p[1];
-      cb[0] = p[0];
-      lum[1] = p[3];
-      cr[0] = p[2];
-      p += 4;
-      lum += 2;
-      cb++;
-      cr++;
-    }
-    if (w) {
-      lum[0] = p[1];
-      cb[0] = p[0];
-      cr[0] = p[2];
-    }
-    p1 += src->linesize[0];
-    lum1 += dst->linesize[0];
-    if (height > 1) {
-      p = p1;
-      lum = lum1;
-      for (w = width; w >= 2; w -= 2) {
-        lum[0] = p[1];
-        lum[1] = p[3];
-        p += 4;
-        lum += 2;
-      }
-      if (w) {
-        lum[0] = p[1];
-      }
-      p1 += src->linesize[0];
-      lum1 += dst->linesize[0];
-    }
-    cb1 += dst->linesize[1];
-    cr1 += dst->linesize[2];
-  }
-}
-
-
 static void
 uyvy422_to_yuv422p (AVPicture * dst, const AVPicture * src,
     int width, int height)
@@ -993,62 +888,6 @@ yvyu422_to_gray (AVPicture * dst, const AVPicture * src, int width, int height)
 }
 
 
-static void
-yvyu422_to_yuv420p (AVPicture * dst, const AVPicture * src,
-    int width, int height)
-{
-  const uint8_t *p, *p1;
-  uint8_t *lum, *cr, *cb, *lum1, *cr1, *cb1;
-  int w;
-
-  p1 = src->data[0];
-
-  lum1 = dst->data[0];
-  cb1 = dst->data[1];
-  cr1 = dst->data[2];
-
-  for (; height >= 1; height -= 2) {
-    p = p1;
-    lum = lum1;
-    cb = cb1;
-    cr = cr1;
-    for (w = width; w >= 2; w -= 2) {
-      lum[0] = p[0];
-      cb[0] = p[3];
-      lum[1] = p[2];
-      cr[0] = p[1];
-      p += 4;
-      lum += 2;
-      cb++;
-      cr++;
-    }
-    if (w) {
-      lum[0] = p[0];
-      cb[0] = p[3];
-      cr[0] = p[1];
-    }
-    p1 += src->linesize[0];
-    lum1 += dst->linesize[0];
-    if (height > 1) {
-      p = p1;
-      lum = lum1;
-      for (w = width; w >= 2; w -= 2) {
-        lum[0] = p[0];
-        lum[1] = p[2];
-        p += 4;
-        lum += 2;
-      }
-      if (w) {
-        lum[0] = p[0];
-      }
-      p1 += src->linesize[0];
-      lum1 += dst->linesize[0];
-    }
-    cb1 += dst->linesize[1];
-    cr1 += dst->linesize[2];
-  }
-}
-
 static void
 yvyu422_to_yuv422p (AVPicture * dst, const AVPicture * src,
     int width, int height)
@@ -1259,67 +1098,6 @@ uyvy411_to_yuv411p (AVPicture * dst, const AVPicture * src,
   }
 }
 
-static void
-yuv420p_to_yuv422 (AVPicture * dst, const AVPicture * src,
-    int width, int height)
-{
-  int w, h;
-  uint8_t *line1, *line2, *linesrc = dst->data[0];
-  uint8_t *lum1, *lum2, *lumsrc = src->data[0];
-  uint8_t *cb1, *cb2 = src->data[1];
-  uint8_t *cr1, *cr2 = src->data[2];
-
-  for (h = height / 2; h--;) {
-    line1 = linesrc;
-    line2 = linesrc + dst->linesize[0];
-
-    lum1 = lumsrc;
-    lum2 = lumsrc + src->linesize[0];
-
-    cb1 = cb2;
-    cr1 = cr2;
-
-    for (w = width / 2; w--;) {
-      *line1++ = *lum1++;
-      *line2++ = *lum2++;
-      *line1++ = *line2++ = *cb1++;
-      *line1++ = *lum1++;
-      *line2++ = *lum2++;
-      *line1++ = *line2++ = *cr1++;
-    }
-    /* odd width */
-    if (width % 2 != 0) {
-      *line1++ = *lum1++;
-      *line2++ = *lum2++;
-      *line1++ = *line2++ = *cb1++;
-    }
-
-    linesrc += dst->linesize[0] * 2;
-    lumsrc += src->linesize[0] * 2;
-    cb2 += src->linesize[1];
-    cr2 += src->linesize[2];
-  }
-  /* odd height */
-  if (height % 2 != 0) {
-    line1 = linesrc;
-    lum1 = lumsrc;
-    cb1 = cb2;
-    cr1 = cr2;
-
-    for (w = width / 2; w--;) {
-      *line1++ = *lum1++;
-      *line1++ = *cb1++;
-      *line1++ = *lum1++;
-      *line1++ = *cr1++;
-    }
-    /* odd width */
-    if (width % 2 != 0) {
-      *line1++ = *lum1++;
-      *line1++ = *cb1++;
-    }
-  }
-}
-
 static void
 nv12_to_nv21 (AVPicture * dst, const AVPicture * src, int width, int height)
 {
@@ -1540,6 +1318,406 @@ nv21_to_yuv444p (AVPicture * dst, const AVPicture * src, int width, int height)
   }
 }
 
+/* Direct conversions between the 4:2:0, packed 4:2:2 and AYUV formats.
+ * Without them these pairs go through an intermediate picture, which costs
+ * an allocation and a second pass over every frame. */
+
+/* a 4:2:0 picture with planar (I420) or interleaved (NV12, NV21) chroma */
+typedef struct YUV420Picture
+{
+  uint8_t *lum, *cb, *cr;
+  int lum_wrap, cb_wrap, cr_wrap;
+  /* distance between two chroma samples on a line */
+  int c_step;
+} YUV420Picture;
+
+static void
+yuv420_picture_init (YUV420Picture * pic, const AVPicture * p, int pix_fmt)
+{
+  pic->lum = p->data[0];
+  pic->lum_wrap = p->linesize[0];
+  switch (pix_fmt) {
+    case PIX_FMT_NV12:
+      pic->cb = p->data[1];
+      pic->cr = p->data[1] + 1;
+      pic->cb_wrap = pic->cr_wrap = p->linesize[1];
+      pic->c_step = 2;
+      break;
+    case PIX_FMT_NV21:
+      pic->cb = p->data[1] + 1;
+      pic->cr = p->data[1];
+      pic->cb_wrap = pic->cr_wrap = p->linesize[1];
+      pic->c_step = 2;
+      break;
+    default:
+      pic->cb = p->data[1];
+      pic->cr = p->data[2];
+      pic->cb_wrap = p->linesize[1];
+      pic->cr_wrap = p->linesize[2];
+      pic->c_step = 1;
+      break;
+  }
+}
+
+/* offsets of Y0, U, Y1 and V in a packed 4:2:2 macropixel */
+#define YUY2_LAYOUT 0, 1, 2, 3
+#define UYVY_LAYOUT 1, 0, 3, 2
+#define YVYU_LAYOUT 0, 3, 2, 1
+
+/* each chroma line is used for two lines */
+static inline void
+yuv420_to_packed422 (AVPicture * dst, const YUV420Picture * src,
+    int width, int height, int y0, int u, int y1, int v)
+{
+  const uint8_t *lum, *cb, *cr;
+  uint8_t *d;
+  int w, h;
+
+  for (h = 0; h < height; h++) {
+    d = dst->data[0] + h * dst->linesize[0];
+    lum = src->lum + h * src->lum_wrap;
+    cb = src->cb + (h >> 1) * src->cb_wrap;
+    cr = src->cr + (h >> 1) * src->cr_wrap;
+    for (w = width; w >= 2; w -= 2) {
+      d[y0] = lum[0];
+      d[u] = cb[0];
+      d[y1] = lum[1];
+      d[v] = cr[0];
+      d += 4;
+      lum += 2;
+      cb += src->c_step;
+      cr += src->c_step;
+    }
+    /* odd width */
+    if (w) {
+      d[y0] = d[y1] = lum[0];
+      d[u] = cb[0];
+      d[v] = cr[0];
+    }
+  }
+}
+
+/* the chroma of the even lines is kept */
+static inline void
+packed422_to_yuv420 (YUV420Picture * dst, const AVPicture * src,
+    int width, int height, int y0, int u, int y1, int v)
+{
+  const uint8_t *s;
+  uint8_t *lum, *cb, *cr;
+  int w, h;
+
+  for (h = 0; h < height; h++) {
+    s = src->data[0] + h * src->linesize[0];
+    lum = dst->lum + h * dst->lum_wrap;
+    if (h & 1) {
+      for (w = width; w >= 2; w -= 2) {
+        lum[0] = s[y0];
+        lum[1] = s[y1];
+        s += 4;
+        lum += 2;
+      }
+      if (w)
+        lum[0] = s[y0];
+      continue;
+    }
+    cb = dst->cb + (h >> 1) * dst->cb_wrap;
+    cr = dst->cr + (h >> 1) * dst->cr_wrap;
+    for (w = width; w >= 2; w -= 2) {
+      lum[0] = s[y0];
+      cb[0] = s[u];
+      lum[1] = s[y1];
+      cr[0] = s[v];
+      s += 4;
+      lum += 2;
+      cb += dst->c_step;
+      cr += dst->c_step;
+    }
+    /* odd width */
+    if (w) {
+      lum[0] = s[y0];
+      cb[0] = s[u];
+      cr[0] = s[v];
+    }
+  }
+}
+
+static void
+yuv420_to_yuv420 (YUV420Picture * dst, const YUV420Picture * src,
+    int width, int height)
+{
+  const uint8_t *s_cb, *s_cr;
+  uint8_t *d_cb, *d_cr;
+  int w, h, width2, height2;
+
+  for (h = 0; h < height; h++)
+    memcpy (dst->lum + h * dst->lum_wrap, src->lum + h * src->lum_wrap, width);
+
+  width2 = (width + 1) >> 1;
+  height2 = (height + 1) >> 1;
+  for (h = 0; h < height2; h++) {
+    s_cb = src->cb + h * src->cb_wrap;
+    s_cr = src->cr + h * src->cr_wrap;
+    d_cb = dst->cb + h * dst->cb_wrap;
+    d_cr = dst->cr + h * dst->cr_wrap;
+    for (w = width2; w > 0; w--) {
+      d_cb[0] = s_cb[0];
+      d_cr[0] = s_cr[0];
+      s_cb += src->c_step;
+      s_cr += src->c_step;
+      d_cb += dst->c_step;
+      d_cr += dst->c_step;
+    }
+  }
+}
+
+static void
+yuv420_to_ayuv4444 (AVPicture * dst, const YUV420Picture * src,
+    int width, int height)
+{
+  const uint8_t *lum, *cb, *cr;
+  uint8_t *d;
+  int x, h, c;
+
+  for (h = 0; h < height; h++) {
+    d = dst->data[0] + h * dst->linesize[0];
+    lum = src->lum + h * src->lum_wrap;
+    cb = src->cb + (h >> 1) * src->cb_wrap;
+    cr = src->cr + (h >> 1) * src->cr_wrap;
+    for (x = 0; x < width; x++) {
+      c = (x >> 1) * src->c_step;
+      d[0] = 0xff;
+      d[1] = lum[x];
+      d[2] = cb[c];
+      d[3] = cr[c];
+      d += 4;
+    }
+  }
+}
+
+/* the chroma is averaged over 2x2 pixels like shrink22() does, pixels on
+ * an odd right or bottom edge count twice */
+static void
+ayuv4444_to_yuv420 (YUV420Picture * dst, const AVPicture * src,
+    int width, int height)
+{
+  const uint8_t *s1, *s2;
+  uint8_t *lum1, *lum2, *cb, *cr;
+  int x, h, n1, n2;
+
+  for (h = 0; h < height; h += 2) {
+    s1 = src->data[0] + h * src->linesize[0];
+    lum1 = dst->lum + h * dst->lum_wrap;
+    if (h + 1 < height) {
+      s2 = s1 + src->linesize[0];
+      lum2 = lum1 + dst->lum_wrap;
+    } else {
+      s2 = s1;
+      lum2 = NULL;
+    }
+    cb = dst->cb + (h >> 1) * dst->cb_wrap;
+    cr = dst->cr + (h >> 1) * dst->cr_wrap;
+    for (x = 0; x < width; x += 2) {
+      /* offset of the second pixel */
+      n1 = (x + 1 < width) ? 4 : 0;
+      n2 = n1 ? 1 : 0;
+      lum1[x] = s1[1];
+      lum1[x + n2] = s1[n1 + 1];
+      if (lum2) {
+        lum2[x] = s2[1];
+        lum2[x + n2] = s2[n1 + 1];
+      }
+      cb[0] = (s1[2] + s1[n1 + 2] + s2[2] + s2[n1 + 2] + 2) >> 2;
+      cr[0] = (s1[3] + s1[n1 + 3] + s2[3] + s2[n1 + 3] + 2) >> 2;
+      s1 += 8;
+      s2 += 8;
+      cb += dst->c_step;
+      cr += dst->c_step;
+    }
+  }
+}
+
+static inline void
+packed422_to_packed422 (AVPicture * dst, const AVPicture * src,
+    int width, int height, int sy0, int su, int sy1, int sv,
+    int dy0, int du, int dy1, int dv)
+{
+  const uint8_t *s;
+  uint8_t *d;
+  int w, h;
+
+  for (h = 0; h < height; h++) {
+    s = src->data[0] + h * src->linesize[0];
+    d = dst->data[0] + h * dst->linesize[0];
+    for (w = (width + 1) >> 1; w > 0; w--) {
+      d[dy0] = s[sy0];
+      d[du] = s[su];
+      d[dy1] = s[sy1];
+      d[dv] = s[sv];
+      s += 4;
+      d += 4;
+    }
+  }
+}
+
+static inline void
+packed422_to_ayuv4444 (AVPicture * dst, const AVPicture * src,
+    int width, int height, int y0, int u, int y1, int v)
+{
+  const uint8_t *s;
+  uint8_t *d;
+  int w, h;
+
+  for (h = 0; h < height; h++) {
+    s = src->data[0] + h * src->linesize[0];
+    d = dst->data[0] + h * dst->linesize[0];
+    for (w = width; w >= 2; w -= 2) {
+      d[0] = d[4] = 0xff;
+      d[1] = s[y0];
+      d[5] = s[y1];
+      d[2] = d[6] = s[u];
+      d[3] = d[7] = s[v];
+      s += 4;
+      d += 8;
+    }
+    /* odd width */
+    if (w) {
+      d[0] = 0xff;
+      d[1] = s[y0];
+      d[2] = s[u];
+      d[3] = s[v];
+    }
+  }
+}
+
+/* the chroma is averaged over 2 pixels */
+static inline void
+ayuv4444_to_packed422 (AVPicture * dst, const AVPicture * src,
+    int width, int height, int y0, int u, int y1, int v)
+{
+  const uint8_t *s;
+  uint8_t *d;
+  int w, h;
+
+  for (h = 0; h < height; h++) {
+    s = src->data[0] + h * src->linesize[0];
+    d = dst->data[0] + h * dst->linesize[0];
+    for (w = width; w >= 2; w -= 2) {
+      d[y0] = s[1];
+      d[y1] = s[5];
+      d[u] = (s[2] + s[6] + 1) >> 1;
+      d[v] = (s[3] + s[7] + 1) >> 1;
+      s += 8;
+      d += 4;
+    }
+    /* odd width */
+    if (w) {
+      d[y0] = d[y1] = s[1];
+      d[u] = s[2];
+      d[v] = s[3];
+    }
+  }
+}
+
+#define YUV420_TO_PACKED422(name, fmt, layout)                          \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  YUV420Picture s;                                                      \
+                                                                        \
+  yuv420_picture_init (&s, src, fmt);                                   \
+  yuv420_to_packed422 (dst, &s, width, height, layout);                 \
+}
+
+#define PACKED422_TO_YUV420(name, layout, fmt)                          \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  YUV420Picture d;                                                      \
+                                                                        \
+  yuv420_picture_init (&d, dst, fmt);                                   \
+  packed422_to_yuv420 (&d, src, width, height, layout);                 \
+}
+
+#define YUV420_TO_YUV420(name, src_fmt, dst_fmt)                        \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  YUV420Picture s, d;                                                   \
+                                                                        \
+  yuv420_picture_init (&s, src, src_fmt);                               \
+  yuv420_picture_init (&d, dst, dst_fmt);                               \
+  yuv420_to_yuv420 (&d, &s, width, height);                             \
+}
+
+#define YUV420_TO_AYUV(name, fmt)                                       \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  YUV420Picture s;                                                      \
+                                                                        \
+  yuv420_picture_init (&s, src, fmt);                                   \
+  yuv420_to_ayuv4444 (dst, &s, width, height);                          \
+}
+
+#define AYUV_TO_YUV420(name, fmt)                                       \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  YUV420Picture d;                                                      \
+                                                                        \
+  yuv420_picture_init (&d, dst, fmt);                                   \
+  ayuv4444_to_yuv420 (&d, src, width, height);                          \
+}
+
+#define PACKED422_TO_PACKED422(name, src_layout, dst_layout)            \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  packed422_to_packed422 (dst, src, width, height, src_layout,          \
+      dst_layout);                                                      \
+}
+
+#define PACKED422_TO_AYUV(name, layout)                                 \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  packed422_to_ayuv4444 (dst, src, width, height, layout);              \
+}
+
+#define AYUV_TO_PACKED422(name, layout)                                 \
+static void                                                             \
+name (AVPicture * dst, const AVPicture * src, int width, int height)    \
+{                                                                       \
+  ayuv4444_to_packed422 (dst, src, width, height, layout);              \
+}
+
+YUV420_TO_PACKED422 (yuv420p_to_yuv422, PIX_FMT_YUV420P, YUY2_LAYOUT)
+YUV420_TO_PACKED422 (yuv420p_to_uyvy422, PIX_FMT_YUV420P, UYVY_LAYOUT)
+YUV420_TO_PACKED422 (nv12_to_yuv422, PIX_FMT_NV12, YUY2_LAYOUT)
+YUV420_TO_PACKED422 (nv12_to_uyvy422, PIX_FMT_NV12, UYVY_LAYOUT)
+
+PACKED422_TO_YUV420 (yuv422_to_yuv420p, YUY2_LAYOUT, PIX_FMT_YUV420P)
+PACKED422_TO_YUV420 (uyvy422_to_yuv420p, UYVY_LAYOUT, PIX_FMT_YUV420P)
+PACKED422_TO_YUV420 (yvyu422_to_yuv420p, YVYU_LAYOUT, PIX_FMT_YUV420P)
+PACKED422_TO_YUV420 (yuv422_to_nv12, YUY2_LAYOUT, PIX_FMT_NV12)
+PACKED422_TO_YUV420 (uyvy422_to_nv12, UYVY_LAYOUT, PIX_FMT_NV12)
+
+YUV420_TO_YUV420 (yuv420p_to_nv12, PIX_FMT_YUV420P, PIX_FMT_NV12)
+YUV420_TO_YUV420 (nv12_to_yuv420p, PIX_FMT_NV12, PIX_FMT_YUV420P)
+
+YUV420_TO_AYUV (yuv420p_to_ayuv4444, PIX_FMT_YUV420P)
+YUV420_TO_AYUV (nv12_to_ayuv4444, PIX_FMT_NV12)
+AYUV_TO_YUV420 (ayuv4444_to_yuv420p, PIX_FMT_YUV420P)
+AYUV_TO_YUV420 (ayuv4444_to_nv12, PIX_FMT_NV12)
+
+PACKED422_TO_PACKED422 (yuv422_to_uyvy422, YUY2_LAYOUT, UYVY_LAYOUT)
+PACKED422_TO_PACKED422 (uyvy422_to_yuv422, UYVY_LAYOUT, YUY2_LAYOUT)
+
+PACKED422_TO_AYUV (yuv422_to_ayuv4444, YUY2_LAYOUT)
+PACKED422_TO_AYUV (uyvy422_to_ayuv4444, UYVY_LAYOUT)
+AYUV_TO_PACKED422 (ayuv4444_to_yuv422, YUY2_LAYOUT)
+AYUV_TO_PACKED422 (ayuv4444_to_uyvy422, UYVY_LAYOUT)
+
 #define SCALEBITS 10
 #define ONE_HALF  (1 << (SCALEBITS - 1))
 #define FIX(x)    ((int) ((x) * (1<<SCALEBITS) + 0.5))
@@ -1629,6 +1807,10 @@ static uint8_t y_jpeg_to_ccir[256];
 static uint8_t c_ccir_to_jpeg[256];
 static uint8_t c_jpeg_to_ccir[256];
 
+#ifdef HAVE_IMGCONVERT_SSE2
+static gboolean use_sse2;
+#endif
+
 /* init various conversion tables */
 static void
 img_convert_init (void)
@@ -1642,6 +1824,13 @@ img_convert_init (void)
     c_ccir_to_jpeg[i] = C_CCIR_TO_JPEG (i);
     c_jpeg_to_ccir[i] = C_JPEG_TO_CCIR (i);
   }
+
+#ifdef HAVE_IMGCONVERT_SSE2
+  oil_init ();
+  use_sse2 = (oil_cpu_get_flags () & OIL_IMPL_FLAG_SSE2) != 0;
+  GST_CAT_INFO (ffmpegcolorspace_performance, "%s SSE2 conversion routines",
+      use_sse2 ? "using" : "not using");
+#endif
 }
 
 /* apply to each pixel the given table */
@@ -2613,6 +2802,9 @@ typedef struct ConvertEntry
 */
 static ConvertEntry convert_table[] = {
   {PIX_FMT_YUV420P, PIX_FMT_YUV422, yuv420p_to_yuv422},
+  {PIX_FMT_YUV420P, PIX_FMT_UYVY422, yuv420p_to_uyvy422},
+  {PIX_FMT_YUV420P, PIX_FMT_NV12, yuv420p_to_nv12},
+  {PIX_FMT_YUV420P, PIX_FMT_AYUV4444, yuv420p_to_ayuv4444},
   {PIX_FMT_YUV420P, PIX_FMT_RGB555, yuv420p_to_rgb555},
   {PIX_FMT_YUV420P, PIX_FMT_RGB565, yuv420p_to_rgb565},
   {PIX_FMT_YUV420P, PIX_FMT_BGR24, yuv420p_to_bgr24},
@@ -2640,6 +2832,10 @@ static ConvertEntry convert_table[] = {
   {PIX_FMT_NV12, PIX_FMT_ABGR32, nv12_to_abgr32},
   {PIX_FMT_NV12, PIX_FMT_NV21, nv12_to_nv21},
   {PIX_FMT_NV12, PIX_FMT_YUV444P, nv12_to_yuv444p},
+  {PIX_FMT_NV12, PIX_FMT_YUV420P, nv12_to_yuv420p},
+  {PIX_FMT_NV12, PIX_FMT_YUV422, nv12_to_yuv422},
+  {PIX_FMT_NV12, PIX_FMT_UYVY422, nv12_to_uyvy422},
+  {PIX_FMT_NV12, PIX_FMT_AYUV4444, nv12_to_ayuv4444},
 
   {PIX_FMT_NV21, PIX_FMT_RGB555, nv21_to_rgb555},
   {PIX_FMT_NV21, PIX_FMT_RGB565, nv21_to_rgb565},
@@ -2679,9 +2875,27 @@ static ConvertEntry convert_table[] = {
 
   {PIX_FMT_YUV422, PIX_FMT_YUV420P, yuv422_to_yuv420p},
   {PIX_FMT_YUV422, PIX_FMT_YUV422P, yuv422_to_yuv422p},
+  {PIX_FMT_YUV422, PIX_FMT_UYVY422, yuv422_to_uyvy422},
+  {PIX_FMT_YUV422, PIX_FMT_NV12, yuv422_to_nv12},
+  {PIX_FMT_YUV422, PIX_FMT_AYUV4444, yuv422_to_ayuv4444},
+  {PIX_FMT_YUV422, PIX_FMT_RGB555, yuv422_to_rgb555},
+  {PIX_FMT_YUV422, PIX_FMT_RGB565, yuv422_to_rgb565},
+  {PIX_FMT_YUV422, PIX_FMT_BGR24, yuv422_to_bgr24},
+  {PIX_FMT_YUV422, PIX_FMT_RGB24, yuv422_to_rgb24},
+  {PIX_FMT_YUV422, PIX_FMT_RGB32, yuv422_to_rgb32},
+  {PIX_FMT_YUV422, PIX_FMT_BGR32, yuv422_to_bgr32},
+  {PIX_FMT_YUV422, PIX_FMT_xRGB32, yuv422_to_xrgb32},
+  {PIX_FMT_YUV422, PIX_FMT_BGRx32, yuv422_to_bgrx32},
+  {PIX_FMT_YUV422, PIX_FMT_RGBA32, yuv422_to_rgba32},
+  {PIX_FMT_YUV422, PIX_FMT_BGRA32, yuv422_to_bgra32},
+  {PIX_FMT_YUV422, PIX_FMT_ARGB32, yuv422_to_argb32},
+  {PIX_FMT_YUV422, PIX_FMT_ABGR32, yuv422_to_abgr32},
 
   {PIX_FMT_UYVY422, PIX_FMT_YUV420P, uyvy422_to_yuv420p},
   {PIX_FMT_UYVY422, PIX_FMT_YUV422P, uyvy422_to_yuv422p},
+  {PIX_FMT_UYVY422, PIX_FMT_YUV422, uyvy422_to_yuv422},
+  {PIX_FMT_UYVY422, PIX_FMT_NV12, uyvy422_to_nv12},
+  {PIX_FMT_UYVY422, PIX_FMT_AYUV4444, uyvy422_to_ayuv4444},
   {PIX_FMT_UYVY422, PIX_FMT_GRAY8, uyvy422_to_gray},
   {PIX_FMT_UYVY422, PIX_FMT_RGB555, uyvy422_to_rgb555},
   {PIX_FMT_UYVY422, PIX_FMT_RGB565, uyvy422_to_rgb565},
@@ -2907,23 +3121,83 @@ static ConvertEntry convert_table[] = {
   {PIX_FMT_AYUV4444, PIX_FMT_BGRA32, ayuv4444_to_bgra32},
   {PIX_FMT_AYUV4444, PIX_FMT_ABGR32, ayuv4444_to_abgr32},
   {PIX_FMT_AYUV4444, PIX_FMT_RGB24, ayuv4444_to_rgb24},
+  /* the padding byte of the x formats gets the alpha value */
+  {PIX_FMT_AYUV4444, PIX_FMT_RGB32, ayuv4444_to_rgba32},
+  {PIX_FMT_AYUV4444, PIX_FMT_BGR32, ayuv4444_to_bgra32},
+  {PIX_FMT_AYUV4444, PIX_FMT_xRGB32, ayuv4444_to_argb32},
+  {PIX_FMT_AYUV4444, PIX_FMT_BGRx32, ayuv4444_to_abgr32},
+  {PIX_FMT_AYUV4444, PIX_FMT_YUV420P, ayuv4444_to_yuv420p},
+  {PIX_FMT_AYUV4444, PIX_FMT_NV12, ayuv4444_to_nv12},
+  {PIX_FMT_AYUV4444, PIX_FMT_YUV422, ayuv4444_to_yuv422},
+  {PIX_FMT_AYUV4444, PIX_FMT_UYVY422, ayuv4444_to_uyvy422},
 };
 
+#ifdef HAVE_IMGCONVERT_SSE2
+/* used instead of the entries of convert_table when the CPU has SSE2. The
+ * x and alpha variants of the 32 bit RGB formats have the same layout, the
+ * alpha formats get an opaque alpha channel. */
+#define SSE2_YUV_TO_RGB(fmt,name) \
+  {fmt, PIX_FMT_RGB32, name ## _to_rgb32_sse2}, \
+  {fmt, PIX_FMT_RGBA32, name ## _to_rgb32_sse2}, \
+  {fmt, PIX_FMT_BGR32, name ## _to_bgr32_sse2}, \
+  {fmt, PIX_FMT_BGRA32, name ## _to_bgr32_sse2}, \
+  {fmt, PIX_FMT_xRGB32, name ## _to_xrgb32_sse2}, \
+  {fmt, PIX_FMT_ARGB32, name ## _to_xrgb32_sse2}, \
+  {fmt, PIX_FMT_BGRx32, name ## _to_bgrx32_sse2}, \
+  {fmt, PIX_FMT_ABGR32, name ## _to_bgrx32_sse2}
+
+static ConvertEntry sse2_convert_table[] = {
+  SSE2_YUV_TO_RGB (PIX_FMT_YUV420P, yuv420p),
+  SSE2_YUV_TO_RGB (PIX_FMT_NV12, nv12),
+  SSE2_YUV_TO_RGB (PIX_FMT_YUV422, yuv422),
+  SSE2_YUV_TO_RGB (PIX_FMT_UYVY422, uyvy422),
+
+  {PIX_FMT_YUV420P, PIX_FMT_YUV422, yuv420p_to_yuv422_sse2},
+  {PIX_FMT_YUV420P, PIX_FMT_UYVY422, yuv420p_to_uyvy422_sse2},
+  {PIX_FMT_YUV420P, PIX_FMT_NV12, yuv420p_to_nv12_sse2},
+  {PIX_FMT_NV12, PIX_FMT_YUV420P, nv12_to_yuv420p_sse2},
+  {PIX_FMT_YUV422, PIX_FMT_YUV420P, yuv422_to_yuv420p_sse2},
+  {PIX_FMT_UYVY422, PIX_FMT_YUV420P, uyvy422_to_yuv420p_sse2},
+};
+
+#undef SSE2_YUV_TO_RGB
+#endif
+
 static ConvertEntry *
-get_convert_table_entry (int src_pix_fmt, int dst_pix_fmt)
+find_convert_entry (ConvertEntry * table, int n_entries, int src_pix_fmt,
+    int dst_pix_fmt)
 {
   int i;
 
-  for (i = 0; i < sizeof (convert_table) / sizeof (convert_table[0]); i++) {
-    if (convert_table[i].src == src_pix_fmt &&
-        convert_table[i].dest == dst_pix_fmt) {
-      return convert_table + i;
+  for (i = 0; i < n_entries; i++) {
+    if (table[i].src == src_pix_fmt && table[i].dest == dst_pix_fmt) {
+      return table + i;
     }
   }
 
   return NULL;
 }
 
+static ConvertEntry *
+get_convert_table_entry (int src_pix_fmt, int dst_pix_fmt)
+{
+  ConvertEntry *ce;
+
+#ifdef HAVE_IMGCONVERT_SSE2
+  if (use_sse2) {
+    ce = find_convert_entry (sse2_convert_table,
+        G_N_ELEMENTS (sse2_convert_table), src_pix_fmt, dst_pix_fmt);
+    if (ce)
+      return ce;
+  }
+#endif
+
+  ce = find_convert_entry (convert_table, G_N_ELEMENTS (convert_table),
+      src_pix_fmt, dst_pix_fmt);
+
+  return ce;
+}
+
 static int
 avpicture_alloc (AVPicture * picture, int pix_fmt, int width, int height,
     int interlaced)
@@ -2979,6 +3253,13 @@ img_convert (AVPicture * dst, int dst_pix_fmt,
   dst_width = src_width;
   dst_height = src_height;
 
+  /* YV12 is I420 with the chroma planes swapped, which
+   * gst_ffmpegcsp_avpicture_fill() already took care of */
+  if (src_pix_fmt == PIX_FMT_YVU420P)
+    src_pix_fmt = PIX_FMT_YUV420P;
+  if (dst_pix_fmt == PIX_FMT_YVU420P)
+    dst_pix_fmt = PIX_FMT_YUV420P;
+
   dst_pix = get_pix_fmt_info (dst_pix_fmt);
   src_pix = get_pix_fmt_info (src_pix_fmt);
   if (G_UNLIKELY (src_pix_fmt == dst_pix_fmt)) {
@@ -0,0 +1,553 @@
+/*
+ * SSE2 image conversion routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file imgconvert_sse2.c
+ * SSE2 image conversion routines.
+ *
+ * The YUV to RGB routines use the integer arithmetic of YUV_TO_RGB1_CCIR()
+ * and YUV_TO_RGB2_CCIR() in imgconvert.c with 32 bit intermediates, so that
+ * the result is the same as that of the C routines, and convert 16 pixels
+ * per iteration. Whatever is left of a line is converted by scalar code.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "imgconvert_sse2.h"
+
+#ifdef HAVE_IMGCONVERT_SSE2
+
+#include <string.h>
+#include <emmintrin.h>
+
+#include "dsputil.h"
+
+#define SCALEBITS 10
+#define ONE_HALF  (1 << (SCALEBITS - 1))
+#define FIX(x)    ((int) ((x) * (1<<SCALEBITS) + 0.5))
+
+#define C_Y  FIX(255.0/219.0)
+#define C_RV FIX(1.40200*255.0/224.0)
+#define C_GU FIX(0.34414*255.0/224.0)
+#define C_GV FIX(0.71414*255.0/224.0)
+#define C_BU FIX(1.77200*255.0/224.0)
+
+/* two 16 bit coefficients for _mm_madd_epi16() */
+#define COEFF_PAIR(lo, hi) \
+  _mm_set1_epi32 ((int) (((unsigned int) (hi) << 16) | ((lo) & 0xffff)))
+
+/* the order of the components in memory */
+enum
+{
+  ORDER_BGRA,                   /* rgb32 */
+  ORDER_ARGB,                   /* bgr32 */
+  ORDER_ABGR,                   /* xrgb32 */
+  ORDER_RGBA                    /* bgrx32 */
+};
+
+static inline void
+store_rgb (uint8_t * d, __m128i r, __m128i g, __m128i b, int order)
+{
+  __m128i a = _mm_set1_epi8 ((char) 0xff);
+  __m128i c0, c1, c2, c3, lo, hi;
+
+  r = _mm_packus_epi16 (r, r);
+  g = _mm_packus_epi16 (g, g);
+  b = _mm_packus_epi16 (b, b);
+
+  switch (order) {
+    case ORDER_BGRA:
+      c0 = b;
+      c1 = g;
+      c2 = r;
+      c3 = a;
+      break;
+    case ORDER_ARGB:
+      c0 = a;
+      c1 = r;
+      c2 = g;
+      c3 = b;
+      break;
+    case ORDER_ABGR:
+      c0 = a;
+      c1 = b;
+      c2 = g;
+      c3 = r;
+      break;
+    case ORDER_RGBA:
+    default:
+      c0 = r;
+      c1 = g;
+      c2 = b;
+      c3 = a;
+      break;
+  }
+  lo = _mm_unpacklo_epi8 (c0, c1);
+  hi = _mm_unpacklo_epi8 (c2, c3);
+  _mm_storeu_si128 ((__m128i *) d, _mm_unpacklo_epi16 (lo, hi));
+  _mm_storeu_si128 ((__m128i *) (d + 16), _mm_unpackhi_epi16 (lo, hi));
+}
+
+/* converts 8 pixels, @y, @u and @v hold a 16 bit value for every pixel */
+static inline void
+yuv_to_rgb_8 (uint8_t * d, __m128i y, __m128i u, __m128i v, int order)
+{
+  const __m128i c_yv_r = COEFF_PAIR (C_Y, C_RV);
+  const __m128i c_yu_g = COEFF_PAIR (C_Y, -C_GU);
+  const __m128i c_v1_g = COEFF_PAIR (-C_GV, ONE_HALF);
+  const __m128i c_yu_b = COEFF_PAIR (C_Y, C_BU);
+  const __m128i half = _mm_set1_epi32 (ONE_HALF);
+  const __m128i one = _mm_set1_epi16 (1);
+  __m128i yv_lo, yv_hi, yu_lo, yu_hi, v1_lo, v1_hi;
+  __m128i lo, hi, r, g, b;
+
+  y = _mm_sub_epi16 (y, _mm_set1_epi16 (16));
+  u = _mm_sub_epi16 (u, _mm_set1_epi16 (128));
+  v = _mm_sub_epi16 (v, _mm_set1_epi16 (128));
+
+  yv_lo = _mm_unpacklo_epi16 (y, v);
+  yv_hi = _mm_unpackhi_epi16 (y, v);
+  yu_lo = _mm_unpacklo_epi16 (y, u);
+  yu_hi = _mm_unpackhi_epi16 (y, u);
+  v1_lo = _mm_unpacklo_epi16 (v, one);
+  v1_hi = _mm_unpackhi_epi16 (v, one);
+
+  lo = _mm_add_epi32 (_mm_madd_epi16 (yv_lo, c_yv_r), half);
+  hi = _mm_add_epi32 (_mm_madd_epi16 (yv_hi, c_yv_r), half);
+  r = _mm_packs_epi32 (_mm_srai_epi32 (lo, SCALEBITS),
+      _mm_srai_epi32 (hi, SCALEBITS));
+
+  lo = _mm_add_epi32 (_mm_madd_epi16 (yu_lo, c_yu_g),
+      _mm_madd_epi16 (v1_lo, c_v1_g));
+  hi = _mm_add_epi32 (_mm_madd_epi16 (yu_hi, c_yu_g),
+      _mm_madd_epi16 (v1_hi, c_v1_g));
+  g = _mm_packs_epi32 (_mm_srai_epi32 (lo, SCALEBITS),
+      _mm_srai_epi32 (hi, SCALEBITS));
+
+  lo = _mm_add_epi32 (_mm_madd_epi16 (yu_lo, c_yu_b), half);
+  hi = _mm_add_epi32 (_mm_madd_epi16 (yu_hi, c_yu_b), half);
+  b = _mm_packs_epi32 (_mm_srai_epi32 (lo, SCALEBITS),
+      _mm_srai_epi32 (hi, SCALEBITS));
+
+  store_rgb (d, r, g, b, order);
+}
+
+/* converts 16 pixels, @y points to the 16 bit luma of the first and the last
+ * 8 pixels, @u and @v hold one 16 bit value for two pixels. 32 bit MSVC
+ * can't pass more than three __m128i arguments by value. */
+static inline void
+yuv_to_rgb_16 (uint8_t * d, const __m128i * y, __m128i u, __m128i v,
+    int order)
+{
+  yuv_to_rgb_8 (d, y[0], _mm_unpacklo_epi16 (u, u), _mm_unpacklo_epi16 (v, v),
+      order);
+  yuv_to_rgb_8 (d + 32, y[1], _mm_unpackhi_epi16 (u, u),
+      _mm_unpackhi_epi16 (v, v), order);
+}
+
+static inline void
+yuv_to_rgb_1 (uint8_t * d, int y, int cb, int cr, int order)
+{
+  uint8_t *cm = cropTbl + MAX_NEG_CROP;
+  uint8_t r, g, b;
+
+  y = (y - 16) * C_Y;
+  cb -= 128;
+  cr -= 128;
+  r = cm[(y + C_RV * cr + ONE_HALF) >> SCALEBITS];
+  g = cm[(y - C_GU * cb - C_GV * cr + ONE_HALF) >> SCALEBITS];
+  b = cm[(y + C_BU * cb + ONE_HALF) >> SCALEBITS];
+
+  switch (order) {
+    case ORDER_BGRA:
+      d[0] = b;
+      d[1] = g;
+      d[2] = r;
+      d[3] = 0xff;
+      break;
+    case ORDER_ARGB:
+      d[0] = 0xff;
+      d[1] = r;
+      d[2] = g;
+      d[3] = b;
+      break;
+    case ORDER_ABGR:
+      d[0] = 0xff;
+      d[1] = b;
+      d[2] = g;
+      d[3] = r;
+      break;
+    case ORDER_RGBA:
+    default:
+      d[0] = r;
+      d[1] = g;
+      d[2] = b;
+      d[3] = 0xff;
+      break;
+  }
+}
+
+/* chroma in two planes, one sample for two pixels */
+static inline void
+planar_line_to_rgb (uint8_t * d, const uint8_t * y, const uint8_t * u,
+    const uint8_t * v, int width, int order)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i y8, u8, v8, y16[2];
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16) {
+    y8 = _mm_loadu_si128 ((const __m128i *) (y + x));
+    u8 = _mm_loadl_epi64 ((const __m128i *) (u + x / 2));
+    v8 = _mm_loadl_epi64 ((const __m128i *) (v + x / 2));
+    y16[0] = _mm_unpacklo_epi8 (y8, zero);
+    y16[1] = _mm_unpackhi_epi8 (y8, zero);
+    yuv_to_rgb_16 (d + 4 * x, y16, _mm_unpacklo_epi8 (u8, zero),
+        _mm_unpacklo_epi8 (v8, zero), order);
+  }
+  for (; x < width; x++)
+    yuv_to_rgb_1 (d + 4 * x, y[x], u[x >> 1], v[x >> 1], order);
+}
+
+/* chroma interleaved in one plane, one pair for two pixels */
+static inline void
+semiplanar_line_to_rgb (uint8_t * d, const uint8_t * y, const uint8_t * uv,
+    int width, int order)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i mask = _mm_set1_epi16 (0xff);
+  __m128i y8, c, y16[2];
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16) {
+    y8 = _mm_loadu_si128 ((const __m128i *) (y + x));
+    c = _mm_loadu_si128 ((const __m128i *) (uv + x));
+    y16[0] = _mm_unpacklo_epi8 (y8, zero);
+    y16[1] = _mm_unpackhi_epi8 (y8, zero);
+    yuv_to_rgb_16 (d + 4 * x, y16, _mm_and_si128 (c, mask),
+        _mm_srli_epi16 (c, 8), order);
+  }
+  for (; x < width; x++)
+    yuv_to_rgb_1 (d + 4 * x, y[x], uv[x & ~1], uv[x | 1], order);
+}
+
+/* packed 4:2:2, @y0 is the offset of the first luma sample and @u that of
+ * the U sample in a macropixel, V always follows U */
+static inline void
+packed_line_to_rgb (uint8_t * d, const uint8_t * s, int width, int y0,
+    int u, int order)
+{
+  const __m128i mask = _mm_set1_epi16 (0xff);
+  __m128i w0, w1, y16[2], c0, c1;
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16) {
+    w0 = _mm_loadu_si128 ((const __m128i *) (s + 2 * x));
+    w1 = _mm_loadu_si128 ((const __m128i *) (s + 2 * x + 16));
+    if (y0 == 0) {
+      y16[0] = _mm_and_si128 (w0, mask);
+      y16[1] = _mm_and_si128 (w1, mask);
+      c0 = _mm_srli_epi16 (w0, 8);
+      c1 = _mm_srli_epi16 (w1, 8);
+    } else {
+      y16[0] = _mm_srli_epi16 (w0, 8);
+      y16[1] = _mm_srli_epi16 (w1, 8);
+      c0 = _mm_and_si128 (w0, mask);
+      c1 = _mm_and_si128 (w1, mask);
+    }
+    /* U0 V0 U1 V1 U2 V2 U3 V3 -> U0 U1 U2 U3 V0 V1 V2 V3 */
+    c0 = _mm_shufflelo_epi16 (c0, _MM_SHUFFLE (3, 1, 2, 0));
+    c0 = _mm_shufflehi_epi16 (c0, _MM_SHUFFLE (3, 1, 2, 0));
+    c0 = _mm_shuffle_epi32 (c0, _MM_SHUFFLE (3, 1, 2, 0));
+    c1 = _mm_shufflelo_epi16 (c1, _MM_SHUFFLE (3, 1, 2, 0));
+    c1 = _mm_shufflehi_epi16 (c1, _MM_SHUFFLE (3, 1, 2, 0));
+    c1 = _mm_shuffle_epi32 (c1, _MM_SHUFFLE (3, 1, 2, 0));
+    yuv_to_rgb_16 (d + 4 * x, y16, _mm_unpacklo_epi64 (c0, c1),
+        _mm_unpackhi_epi64 (c0, c1), order);
+  }
+  for (; x < width; x++) {
+    const uint8_t *m = s + 4 * (x >> 1);
+
+    yuv_to_rgb_1 (d + 4 * x, m[y0 + 2 * (x & 1)], m[u], m[u + 2], order);
+  }
+}
+
+static inline void
+yuv420p_to_rgb (AVPicture * dst, const AVPicture * src, int width,
+    int height, int order)
+{
+  int h;
+
+  for (h = 0; h < height; h++)
+    planar_line_to_rgb (dst->data[0] + h * dst->linesize[0],
+        src->data[0] + h * src->linesize[0],
+        src->data[1] + (h >> 1) * src->linesize[1],
+        src->data[2] + (h >> 1) * src->linesize[2], width, order);
+}
+
+static inline void
+nv12_to_rgb (AVPicture * dst, const AVPicture * src, int width,
+    int height, int order)
+{
+  int h;
+
+  for (h = 0; h < height; h++)
+    semiplanar_line_to_rgb (dst->data[0] + h * dst->linesize[0],
+        src->data[0] + h * src->linesize[0],
+        src->data[1] + (h >> 1) * src->linesize[1], width, order);
+}
+
+static inline void
+packed_to_rgb (AVPicture * dst, const AVPicture * src, int width,
+    int height, int y0, int u, int order)
+{
+  int h;
+
+  for (h = 0; h < height; h++)
+    packed_line_to_rgb (dst->data[0] + h * dst->linesize[0],
+        src->data[0] + h * src->linesize[0], width, y0, u, order);
+}
+
+#define DEFINE_YUV_TO_RGB(name, order)                                  \
+void                                                                    \
+yuv420p_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src,   \
+    int width, int height)                                              \
+{                                                                       \
+  yuv420p_to_rgb (dst, src, width, height, order);                      \
+}                                                                       \
+                                                                        \
+void                                                                    \
+nv12_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src,      \
+    int width, int height)                                              \
+{                                                                       \
+  nv12_to_rgb (dst, src, width, height, order);                         \
+}                                                                       \
+                                                                        \
+void                                                                    \
+yuv422_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src,    \
+    int width, int height)                                              \
+{                                                                       \
+  packed_to_rgb (dst, src, width, height, 0, 1, order);                 \
+}                                                                       \
+                                                                        \
+void                                                                    \
+uyvy422_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src,   \
+    int width, int height)                                              \
+{                                                                       \
+  packed_to_rgb (dst, src, width, height, 1, 0, order);                 \
+}
+
+DEFINE_YUV_TO_RGB (rgb32, ORDER_BGRA)
+DEFINE_YUV_TO_RGB (bgr32, ORDER_ARGB)
+DEFINE_YUV_TO_RGB (xrgb32, ORDER_ABGR)
+DEFINE_YUV_TO_RGB (bgrx32, ORDER_RGBA)
+
+/* 4:2:0 to packed 4:2:2, the chroma lines are used twice. @y0 is 0 for
+ * YUY2 and 1 for UYVY, the chroma samples are at the other offsets. */
+static inline void
+yuv420p_to_packed (AVPicture * dst, const AVPicture * src, int width,
+    int height, int y0)
+{
+  const uint8_t *y, *u, *v;
+  uint8_t *d;
+  __m128i y8, uv;
+  int x, h, c0 = y0 ^ 1;
+
+  for (h = 0; h < height; h++) {
+    d = dst->data[0] + h * dst->linesize[0];
+    y = src->data[0] + h * src->linesize[0];
+    u = src->data[1] + (h >> 1) * src->linesize[1];
+    v = src->data[2] + (h >> 1) * src->linesize[2];
+    for (x = 0; x + 16 <= width; x += 16) {
+      y8 = _mm_loadu_si128 ((const __m128i *) (y + x));
+      uv = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i *) (u + x / 2)),
+          _mm_loadl_epi64 ((const __m128i *) (v + x / 2)));
+      if (y0 == 0) {
+        _mm_storeu_si128 ((__m128i *) (d + 2 * x), _mm_unpacklo_epi8 (y8, uv));
+        _mm_storeu_si128 ((__m128i *) (d + 2 * x + 16),
+            _mm_unpackhi_epi8 (y8, uv));
+      } else {
+        _mm_storeu_si128 ((__m128i *) (d + 2 * x), _mm_unpacklo_epi8 (uv, y8));
+        _mm_storeu_si128 ((__m128i *) (d + 2 * x + 16),
+            _mm_unpackhi_epi8 (uv, y8));
+      }
+    }
+    for (; x < width; x += 2) {
+      d[2 * x + y0] = y[x];
+      d[2 * x + y0 + 2] = y[x + 1 < width ? x + 1 : x];
+      d[2 * x + c0] = u[x / 2];
+      d[2 * x + c0 + 2] = v[x / 2];
+    }
+  }
+}
+
+/* packed 4:2:2 to 4:2:0, the chroma of the even lines is kept */
+static inline void
+packed_to_yuv420p (AVPicture * dst, const AVPicture * src, int width,
+    int height, int y0)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i mask = _mm_set1_epi16 (0xff);
+  const uint8_t *s;
+  uint8_t *y, *u, *v;
+  __m128i w0, w1, y0w, y1w, c;
+  int x, h, c0 = y0 ^ 1;
+
+  for (h = 0; h < height; h++) {
+    s = src->data[0] + h * src->linesize[0];
+    y = dst->data[0] + h * dst->linesize[0];
+    u = dst->data[1] + (h >> 1) * dst->linesize[1];
+    v = dst->data[2] + (h >> 1) * dst->linesize[2];
+    for (x = 0; x + 16 <= width; x += 16) {
+      w0 = _mm_loadu_si128 ((const __m128i *) (s + 2 * x));
+      w1 = _mm_loadu_si128 ((const __m128i *) (s + 2 * x + 16));
+      if (y0 == 0) {
+        y0w = _mm_and_si128 (w0, mask);
+        y1w = _mm_and_si128 (w1, mask);
+        w0 = _mm_srli_epi16 (w0, 8);
+        w1 = _mm_srli_epi16 (w1, 8);
+      } else {
+        y0w = _mm_srli_epi16 (w0, 8);
+        y1w = _mm_srli_epi16 (w1, 8);
+        w0 = _mm_and_si128 (w0, mask);
+        w1 = _mm_and_si128 (w1, mask);
+      }
+      _mm_storeu_si128 ((__m128i *) (y + x), _mm_packus_epi16 (y0w, y1w));
+      if (h & 1)
+        continue;
+      /* U0 V0 U1 V1 ... */
+      c = _mm_packus_epi16 (w0, w1);
+      _mm_storel_epi64 ((__m128i *) (u + x / 2),
+          _mm_packus_epi16 (_mm_and_si128 (c, mask), zero));
+      _mm_storel_epi64 ((__m128i *) (v + x / 2),
+          _mm_packus_epi16 (_mm_srli_epi16 (c, 8), zero));
+    }
+    for (; x < width; x += 2) {
+      y[x] = s[2 * x + y0];
+      if (x + 1 < width)
+        y[x + 1] = s[2 * x + y0 + 2];
+      if (!(h & 1)) {
+        u[x / 2] = s[2 * x + c0];
+        v[x / 2] = s[2 * x + c0 + 2];
+      }
+    }
+  }
+}
+
+void
+yuv420p_to_yuv422_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  yuv420p_to_packed (dst, src, width, height, 0);
+}
+
+void
+yuv420p_to_uyvy422_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  yuv420p_to_packed (dst, src, width, height, 1);
+}
+
+void
+yuv422_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  packed_to_yuv420p (dst, src, width, height, 0);
+}
+
+void
+uyvy422_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  packed_to_yuv420p (dst, src, width, height, 1);
+}
+
+static void
+copy_luma (AVPicture * dst, const AVPicture * src, int width, int height)
+{
+  int h;
+
+  for (h = 0; h < height; h++)
+    memcpy (dst->data[0] + h * dst->linesize[0],
+        src->data[0] + h * src->linesize[0], width);
+}
+
+void
+yuv420p_to_nv12_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  const uint8_t *u, *v;
+  uint8_t *uv;
+  __m128i u8, v8;
+  int x, h, width2 = (width + 1) >> 1, height2 = (height + 1) >> 1;
+
+  copy_luma (dst, src, width, height);
+
+  for (h = 0; h < height2; h++) {
+    u = src->data[1] + h * src->linesize[1];
+    v = src->data[2] + h * src->linesize[2];
+    uv = dst->data[1] + h * dst->linesize[1];
+    for (x = 0; x + 16 <= width2; x += 16) {
+      u8 = _mm_loadu_si128 ((const __m128i *) (u + x));
+      v8 = _mm_loadu_si128 ((const __m128i *) (v + x));
+      _mm_storeu_si128 ((__m128i *) (uv + 2 * x), _mm_unpacklo_epi8 (u8, v8));
+      _mm_storeu_si128 ((__m128i *) (uv + 2 * x + 16),
+          _mm_unpackhi_epi8 (u8, v8));
+    }
+    for (; x < width2; x++) {
+      uv[2 * x] = u[x];
+      uv[2 * x + 1] = v[x];
+    }
+  }
+}
+
+void
+nv12_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height)
+{
+  const __m128i mask = _mm_set1_epi16 (0xff);
+  const uint8_t *uv;
+  uint8_t *u, *v;
+  __m128i w0, w1;
+  int x, h, width2 = (width + 1) >> 1, height2 = (height + 1) >> 1;
+
+  copy_luma (dst, src, width, height);
+
+  for (h = 0; h < height2; h++) {
+    uv = src->data[1] + h * src->linesize[1];
+    u = dst->data[1] + h * dst->linesize[1];
+    v = dst->data[2] + h * dst->linesize[2];
+    for (x = 0; x + 16 <= width2; x += 16) {
+      w0 = _mm_loadu_si128 ((const __m128i *) (uv + 2 * x));
+      w1 = _mm_loadu_si128 ((const __m128i *) (uv + 2 * x + 16));
+      _mm_storeu_si128 ((__m128i *) (u + x),
+          _mm_packus_epi16 (_mm_and_si128 (w0, mask), _mm_and_si128 (w1,
+                  mask)));
+      _mm_storeu_si128 ((__m128i *) (v + x),
+          _mm_packus_epi16 (_mm_srli_epi16 (w0, 8), _mm_srli_epi16 (w1, 8)));
+    }
+    for (; x < width2; x++) {
+      u[x] = uv[2 * x];
+      v[x] = uv[2 * x + 1];
+    }
+  }
+}
+
+#endif /* HAVE_IMGCONVERT_SSE2 */
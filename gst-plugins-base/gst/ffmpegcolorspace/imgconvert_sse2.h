@@ -0,0 +1,70 @@
+/*
+ * SSE2 image conversion routines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * @file imgconvert_sse2.h
+ * SSE2 versions of the most used conversion routines. They produce exactly
+ * the same output as the C versions in imgconvert.c.
+ */
+
+#ifndef IMGCONVERT_SSE2_H
+#define IMGCONVERT_SSE2_H
+
+#include <glib.h>
+
+#include "avcodec.h"
+
+/* the routines store 32 bit pixels byte by byte, so they are only built for
+ * little endian x86, when the compiler targets SSE2. MSVC does not define
+ * __SSE2__, it is always there on x64 and with /arch:SSE2 on x86. */
+#if (defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+    G_BYTE_ORDER == G_LITTLE_ENDIAN
+#define HAVE_IMGCONVERT_SSE2 1
+
+#define IMGCONVERT_SSE2_DECLARE_RGB(name) \
+void yuv420p_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src, \
+    int width, int height); \
+void nv12_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src, \
+    int width, int height); \
+void yuv422_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src, \
+    int width, int height); \
+void uyvy422_to_ ## name ## _sse2 (AVPicture * dst, const AVPicture * src, \
+    int width, int height);
+
+IMGCONVERT_SSE2_DECLARE_RGB (rgb32)
+IMGCONVERT_SSE2_DECLARE_RGB (bgr32)
+IMGCONVERT_SSE2_DECLARE_RGB (xrgb32)
+IMGCONVERT_SSE2_DECLARE_RGB (bgrx32)
+
+void yuv420p_to_yuv422_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+void yuv420p_to_uyvy422_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+void yuv422_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+void uyvy422_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+void yuv420p_to_nv12_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+void nv12_to_yuv420p_sse2 (AVPicture * dst, const AVPicture * src,
+    int width, int height);
+
+#endif
+
+#endif /* IMGCONVERT_SSE2_H */
@@ -47,6 +47,51 @@ static void glue (uyvy422_to_, RGB_NAME)(AVPicture *dst, const AVPicture *src,
 
             s1 += 4;
         }
+        /* odd width */
+        if (w) {
+            YUV_TO_RGB1_CCIR(s1[0], s1[2]);
+
+            YUV_TO_RGB2_CCIR(r, g, b, s1[1]);
+            RGB_OUT(d1, r, g, b);
+        }
+        d += dst->linesize[0];
+        s += src->linesize[0];
+    }
+}
+
+static void glue (yuv422_to_, RGB_NAME)(AVPicture *dst, const AVPicture *src,
+                                        int width, int height)
+{
+    uint8_t *s, *d, *d1, *s1;
+    int w, y, cb, cr, r_add, g_add, b_add;
+    uint8_t *cm = cropTbl + MAX_NEG_CROP;
+    unsigned int r, g, b;
+
+    d = dst->data[0];
+    s = src->data[0];
+    for(;height > 0; height --) {
+        d1 = d;
+        s1 = s;
+        for(w = width; w >= 2; w -= 2) {
+            YUV_TO_RGB1_CCIR(s1[1], s1[3]);
+
+            YUV_TO_RGB2_CCIR(r, g, b, s1[0]);
+            RGB_OUT(d1, r, g, b);
+            d1 += BPP;
+
+            YUV_TO_RGB2_CCIR(r, g, b, s1[2]);
+            RGB_OUT(d1, r, g, b);
+            d1 += BPP;
+
+            s1 += 4;
+        }
+        /* odd width */
+        if (w) {
+            YUV_TO_RGB1_CCIR(s1[1], s1[3]);
+
+            YUV_TO_RGB2_CCIR(r, g, b, s1[0]);
+            RGB_OUT(d1, r, g, b);
+        }
         d += dst->linesize[0];
         s += src->linesize[0];
     }
@@ -3566,9 +3566,10 @@ G_BEGIN_DECLS{                                                          \
   sw_data->size = _size;                                                \
   sw_data->probability = _probability;                                  \
   sw_data->caps = gst_caps_new_simple (name, NULL);                     \
-  if (!gst_type_find_register (plugin, name, rank, start_with_type_find,\
-                      (char **) ext, sw_data->caps, sw_data,            \
-                     (GDestroyNotify) (sw_data_destroy))) {             \
+  if (!gst_type_find_register_with_signature (plugin, name, rank,      \
+                      start_with_type_find, (char **) ext, sw_data->caps, \
+                      sw_data, (GDestroyNotify) (sw_data_destroy),      \
+                      0, sw_data->data, sw_data->size)) {               \
     gst_caps_unref (sw_data->caps);                                     \
     g_free (sw_data);                                                   \
   }                                                                     \
@@ -3596,9 +3597,10 @@ G_BEGIN_DECLS{                                                          \
   sw_data->size = 4;                                                    \
   sw_data->probability = GST_TYPE_FIND_MAXIMUM;                         \
   sw_data->caps = gst_caps_new_simple (name, NULL);                     \
-  if (!gst_type_find_register (plugin, name, rank, riff_type_find,      \
-                      (char **) ext, sw_data->caps, sw_data,            \
-                      (GDestroyNotify) (sw_data_destroy))) {            \
+  if (!gst_type_find_register_with_signature (plugin, name, rank,      \
+                      riff_type_find, (char **) ext, sw_data->caps,     \
+                      sw_data, (GDestroyNotify) (sw_data_destroy),      \
+                      8, sw_data->data, 4)) {                           \
     gst_caps_unref (sw_data->caps);                                     \
     g_free (sw_data);                                                   \
   }                                                                     \
@@ -3613,6 +3615,14 @@ G_BEGIN_DECLS{\
     return FALSE; \
 }G_END_DECLS
 
+/* for functions that only suggest something when the stream has the
+ * _size bytes of _sig at _offset, so they can be skipped for other streams */
+#define TYPE_FIND_REGISTER_SIGNATURE(plugin,name,rank,func,ext,caps,priv,notify,_offset,_sig,_size) \
+G_BEGIN_DECLS{\
+  if (!gst_type_find_register_with_signature (plugin, name, rank, func, (char **) ext, caps, priv, notify, _offset, (const guint8 *) _sig, _size))\
+    return FALSE; \
+}G_END_DECLS
+
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -3783,8 +3793,8 @@ plugin_init (GstPlugin * plugin)
   TYPE_FIND_REGISTER (plugin, "video/mpegts", GST_RANK_PRIMARY,
       mpeg_ts_type_find, mpeg_ts_exts, MPEGTS_CAPS, NULL, NULL);
 #endif /* OPERA_MINIMAL_GST */
-  TYPE_FIND_REGISTER (plugin, "application/ogg", GST_RANK_PRIMARY,
-      ogganx_type_find, ogg_exts, OGGANX_CAPS, NULL, NULL);
+  TYPE_FIND_REGISTER_SIGNATURE (plugin, "application/ogg", GST_RANK_PRIMARY,
+      ogganx_type_find, ogg_exts, OGGANX_CAPS, NULL, NULL, 0, "OggS", 4);
 #ifndef OPERA_MINIMAL_GST
   TYPE_FIND_REGISTER (plugin, "video/mpeg-elementary", GST_RANK_MARGINAL,
       mpeg_video_stream_type_find, mpeg_video_exts, MPEG_VIDEO_CAPS, NULL,
@@ -3867,8 +3877,9 @@ plugin_init (GstPlugin * plugin)
   TYPE_FIND_REGISTER (plugin, "image/x-portable-pixmap", GST_RANK_SECONDARY,
       pnm_type_find, pnm_exts, PNM_CAPS, NULL, NULL);
 #endif /* OPERA_MINIMAL_GST */
-  TYPE_FIND_REGISTER (plugin, "video/x-matroska", GST_RANK_PRIMARY,
-      matroska_type_find, matroska_exts, MATROSKA_CAPS, NULL, NULL);
+  TYPE_FIND_REGISTER_SIGNATURE (plugin, "video/x-matroska", GST_RANK_PRIMARY,
+      matroska_type_find, matroska_exts, MATROSKA_CAPS, NULL, NULL, 0,
+      "\032\105\337\243", 4);
 #ifndef OPERA_MINIMAL_GST
   TYPE_FIND_REGISTER (plugin, "application/mxf", GST_RANK_PRIMARY,
       mxf_type_find, mxf_exts, MXF_CAPS, NULL, NULL);
@@ -3909,10 +3920,10 @@ plugin_init (GstPlugin * plugin)
   TYPE_FIND_REGISTER (plugin, "audio/x-flac", GST_RANK_PRIMARY,
       flac_type_find, flac_exts, FLAC_CAPS, NULL, NULL);
 #endif /* OPERA_MINIMAL_GST */
-  TYPE_FIND_REGISTER (plugin, "audio/x-vorbis", GST_RANK_PRIMARY,
-      vorbis_type_find, NULL, VORBIS_CAPS, NULL, NULL);
-  TYPE_FIND_REGISTER (plugin, "video/x-theora", GST_RANK_PRIMARY,
-      theora_type_find, NULL, THEORA_CAPS, NULL, NULL);
+  TYPE_FIND_REGISTER_SIGNATURE (plugin, "audio/x-vorbis", GST_RANK_PRIMARY,
+      vorbis_type_find, NULL, VORBIS_CAPS, NULL, NULL, 0, "\001vorbis", 7);
+  TYPE_FIND_REGISTER_SIGNATURE (plugin, "video/x-theora", GST_RANK_PRIMARY,
+      theora_type_find, NULL, THEORA_CAPS, NULL, NULL, 0, "\200theora", 7);
 #ifndef OPERA_MINIMAL_GST
   TYPE_FIND_REGISTER (plugin, "application/x-ogm-video", GST_RANK_PRIMARY,
       ogmvideo_type_find, NULL, OGMVIDEO_CAPS, NULL, NULL);
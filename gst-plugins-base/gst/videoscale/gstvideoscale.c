@@ -60,20 +60,53 @@
 #include "gstvideoscale.h"
 #include "vs_image.h"
 #include "vs_4tap.h"
+#include "vs_lanczos.h"
 
 
 /* debug variable definition */
 GST_DEBUG_CATEGORY (video_scale_debug);
 
 #define DEFAULT_PROP_METHOD	GST_VIDEO_SCALE_BILINEAR
+#define DEFAULT_PROP_N_THREADS	1
+
+#define MAX_THREADS		64
+
+/* number of lobes of the Lanczos filter */
+#define LANCZOS_LOBES		3
 
 enum
 {
   PROP_0,
-  PROP_METHOD
+  PROP_METHOD,
+  PROP_N_THREADS
       /* FILL ME */
 };
 
+typedef void (*GstVideoScaleFunc) (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end);
+typedef void (*GstVideoScaleFilterFunc) (const VSImage * dest,
+    const VSImage * src, uint8_t * tmpbuf, int y_start, int y_end,
+    const VSFilterSet * filters);
+
+/* one horizontal band of every plane of a frame */
+typedef struct
+{
+  GstVideoScale *videoscale;
+  GstVideoScaleFunc func;
+  /* used instead of func when set, with the filters of every plane */
+  GstVideoScaleFilterFunc filter_func;
+  const VSFilterSet *filters;
+  const VSImage *dest;
+  const VSImage *src;
+  gint n_planes;
+  guint8 *tmpbuf;
+  guint band;
+  guint n_bands;
+} GstVideoScaleBand;
+
+/* scales the bands of all videoscale instances */
+static GThreadPool *band_pool;
+
 #undef GST_VIDEO_SIZE_RANGE
 #define GST_VIDEO_SIZE_RANGE "(int) [ 1, 32767]"
 
@@ -147,6 +180,7 @@ gst_video_scale_method_get_type (void)
     {GST_VIDEO_SCALE_NEAREST, "Nearest Neighbour", "nearest-neighbour"},
     {GST_VIDEO_SCALE_BILINEAR, "Bilinear", "bilinear"},
     {GST_VIDEO_SCALE_4TAP, "4-tap", "4-tap"},
+    {GST_VIDEO_SCALE_LANCZOS, "Lanczos", "lanczos"},
     {0, NULL, NULL},
   };
 
@@ -198,6 +232,10 @@ static void gst_video_scale_init (GstVideoScale * videoscale);
 
 static void gst_video_scale_finalize (GstVideoScale * videoscale);
 
+static void gst_video_scale_scale_band (GstVideoScaleBand * band,
+    gpointer user_data);
+static void gst_video_scale_clear_filters (GstVideoScale * videoscale);
+
 static gboolean gst_video_scale_src_event (GstBaseTransform * trans,
     GstEvent * event);
 
@@ -278,6 +316,21 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
       g_param_spec_enum ("method", "method", "method",
           GST_TYPE_VIDEO_SCALE_METHOD, DEFAULT_PROP_METHOD,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstVideoScale:n-threads
+   *
+   * The number of threads that scale each frame. Every frame is cut into
+   * this many horizontal bands, which are scaled in parallel by a thread
+   * pool shared by all videoscale elements. The output does not depend on
+   * the number of threads.
+   *
+   * Since: 0.10.30
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Number of threads to scale each frame with (0 = number of CPUs)",
+          0, MAX_THREADS, DEFAULT_PROP_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   trans_class->transform_caps =
       GST_DEBUG_FUNCPTR (gst_video_scale_transform_caps);
@@ -291,6 +344,11 @@ gst_video_scale_class_init (GstVideoScaleClass * klass)
   trans_class->passthrough_on_same_caps = TRUE;
 
   parent_class = g_type_class_peek_parent (klass);
+
+  /* more threads than processors would only compete for them, the bands
+   * of all elements wait their turn in the queue instead */
+  band_pool = g_thread_pool_new ((GFunc) gst_video_scale_scale_band, NULL,
+      gst_util_get_num_cpus (), FALSE, NULL);
 }
 
 static void
@@ -299,6 +357,9 @@ gst_video_scale_init (GstVideoScale * videoscale)
   gst_base_transform_set_qos_enabled (GST_BASE_TRANSFORM (videoscale), TRUE);
   videoscale->tmp_buf = NULL;
   videoscale->method = DEFAULT_PROP_METHOD;
+  videoscale->n_threads = DEFAULT_PROP_N_THREADS;
+  videoscale->bands_lock = g_mutex_new ();
+  videoscale->bands_cond = g_cond_new ();
 }
 
 static void
@@ -306,6 +367,9 @@ gst_video_scale_finalize (GstVideoScale * videoscale)
 {
   if (videoscale->tmp_buf)
     g_free (videoscale->tmp_buf);
+  gst_video_scale_clear_filters (videoscale);
+  g_mutex_free (videoscale->bands_lock);
+  g_cond_free (videoscale->bands_cond);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (videoscale));
 }
@@ -322,6 +386,11 @@ gst_video_scale_set_property (GObject * object, guint prop_id,
       vscale->method = g_value_get_enum (value);
       GST_OBJECT_UNLOCK (vscale);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (vscale);
+      vscale->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (vscale);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -340,6 +409,11 @@ gst_video_scale_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_enum (value, vscale->method);
       GST_OBJECT_UNLOCK (vscale);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (vscale);
+      g_value_set_uint (value, vscale->n_threads);
+      GST_OBJECT_UNLOCK (vscale);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -533,11 +607,18 @@ gst_video_scale_set_caps (GstBaseTransform * trans, GstCaps * in, GstCaps * out)
     /* prepare size has posted an error when it returns FALSE */
     goto done;
 
+  /* every band gets its own tmp_buf, they are allocated when we know how
+   * many bands there are */
   if (videoscale->tmp_buf)
     g_free (videoscale->tmp_buf);
+  videoscale->tmp_buf = NULL;
+  videoscale->n_tmp_bufs = 0;
+
+  videoscale->tmp_size = MAX (videoscale->dest.stride * 4,
+      vs_image_scale_lanczos_get_tmp_size (&videoscale->src)) *
+      (videoscale->interlaced ? 2 : 1);
 
-  videoscale->tmp_buf =
-      g_malloc (videoscale->dest.stride * 4 * (videoscale->interlaced ? 2 : 1));
+  gst_video_scale_clear_filters (videoscale);
 
   /* FIXME: par */
   GST_DEBUG_OBJECT (videoscale, "from=%dx%d, size %d -> to=%dx%d, size %d",
@@ -730,219 +811,391 @@ gst_video_scale_prepare_image (gint format, GstBuffer * buf,
   return res;
 }
 
+static void
+gst_video_scale_clear_filters (GstVideoScale * videoscale)
+{
+  g_slist_foreach (videoscale->filters, (GFunc) vs_filter_free, NULL);
+  g_slist_free (videoscale->filters);
+  videoscale->filters = NULL;
+}
+
+/* Returns the Lanczos filter from @src_size to @dest_size samples. The
+ * filters only depend on the sizes, so they are made once and kept until the
+ * caps change. */
+static const VSFilter *
+gst_video_scale_get_filter (GstVideoScale * videoscale, gint src_size,
+    gint dest_size)
+{
+  VSFilter *filter;
+  GSList *l;
+
+  for (l = videoscale->filters; l; l = l->next) {
+    filter = l->data;
+    if (filter->src_size == src_size && filter->dest_size == dest_size)
+      return filter;
+  }
+
+  GST_DEBUG_OBJECT (videoscale, "making filter from %d to %d samples",
+      src_size, dest_size);
+  filter = vs_filter_new_lanczos (src_size, dest_size, LANCZOS_LOBES);
+  videoscale->filters = g_slist_prepend (videoscale->filters, filter);
+
+  return filter;
+}
+
+static void
+gst_video_scale_scale_band (GstVideoScaleBand * band, gpointer user_data)
+{
+  GstVideoScale *videoscale = band->videoscale;
+  gint i;
+
+  for (i = 0; i < band->n_planes; i++) {
+    gint height = band->dest[i].height;
+    gint y_start = height * band->band / band->n_bands;
+    gint y_end = height * (band->band + 1) / band->n_bands;
+
+    if (y_start >= y_end)
+      continue;
+
+    if (band->filter_func)
+      band->filter_func (&band->dest[i], &band->src[i], band->tmpbuf, y_start,
+          y_end, &band->filters[i]);
+    else
+      band->func (&band->dest[i], &band->src[i], band->tmpbuf, y_start, y_end);
+  }
+
+  /* the first band is scaled by the streaming thread, which waits for the
+   * others */
+  if (band->band > 0) {
+    g_mutex_lock (videoscale->bands_lock);
+    if (--videoscale->bands_pending == 0)
+      g_cond_signal (videoscale->bands_cond);
+    g_mutex_unlock (videoscale->bands_lock);
+  }
+}
+
+/* scales the @n_planes planes of @src into @dest with @func, or with
+ * @filter_func and @filters, in @n_bands bands that are scaled in parallel */
+static void
+gst_video_scale_scale (GstVideoScale * videoscale, GstVideoScaleFunc func,
+    GstVideoScaleFilterFunc filter_func, const VSFilterSet * filters,
+    const VSImage * dest, const VSImage * src, gint n_planes, guint n_bands)
+{
+  GstVideoScaleBand *bands;
+  guint i;
+
+  bands = g_newa (GstVideoScaleBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].videoscale = videoscale;
+    bands[i].func = func;
+    bands[i].filter_func = filter_func;
+    bands[i].filters = filters;
+    bands[i].dest = dest;
+    bands[i].src = src;
+    bands[i].n_planes = n_planes;
+    bands[i].tmpbuf = videoscale->tmp_buf + i * videoscale->tmp_size;
+    bands[i].band = i;
+    bands[i].n_bands = n_bands;
+  }
+
+  videoscale->bands_pending = n_bands - 1;
+  for (i = 1; i < n_bands; i++)
+    g_thread_pool_push (band_pool, &bands[i], NULL);
+
+  gst_video_scale_scale_band (&bands[0], NULL);
+
+  g_mutex_lock (videoscale->bands_lock);
+  while (videoscale->bands_pending > 0)
+    g_cond_wait (videoscale->bands_cond, videoscale->bands_lock);
+  g_mutex_unlock (videoscale->bands_lock);
+}
+
 static GstFlowReturn
 gst_video_scale_transform (GstBaseTransform * trans, GstBuffer * in,
     GstBuffer * out)
 {
   GstVideoScale *videoscale = GST_VIDEO_SCALE (trans);
   GstFlowReturn ret = GST_FLOW_OK;
-  VSImage dest = videoscale->dest;
-  VSImage src = videoscale->src;
-  VSImage dest_u = { NULL, };
-  VSImage dest_v = { NULL, };
-  VSImage src_u = { NULL, };
-  VSImage src_v = { NULL, };
+  VSImage dest[3] = { videoscale->dest, };
+  VSImage src[3] = { videoscale->src, };
+  VSFilterSet filters[3];
+  GstVideoScaleFunc func = NULL;
+  GstVideoScaleFilterFunc filter_func = NULL;
+  gint n_planes = 1;
   gint method;
+  gint i;
+  guint n_threads;
   gint step;
   gboolean interlaced = videoscale->interlaced;
 
   GST_OBJECT_LOCK (videoscale);
   method = videoscale->method;
+  n_threads = videoscale->n_threads;
   GST_OBJECT_UNLOCK (videoscale);
 
-  src.pixels = GST_BUFFER_DATA (in);
-  dest.pixels = GST_BUFFER_DATA (out);
+  if (n_threads == 0)
+    n_threads = MIN (gst_util_get_num_cpus (), MAX_THREADS);
+
+  if (n_threads != videoscale->n_tmp_bufs) {
+    g_free (videoscale->tmp_buf);
+    videoscale->tmp_buf = g_malloc (videoscale->tmp_size * n_threads);
+    videoscale->n_tmp_bufs = n_threads;
+  }
+
+  src[0].pixels = GST_BUFFER_DATA (in);
+  dest[0].pixels = GST_BUFFER_DATA (out);
 
   /* For interlaced content we have to run two times with half height
    * and doubled stride */
   if (interlaced) {
-    dest.height /= 2;
-    src.height /= 2;
-    dest.stride *= 2;
-    src.stride *= 2;
+    dest[0].height /= 2;
+    src[0].height /= 2;
+    dest[0].stride *= 2;
+    src[0].stride *= 2;
   }
 
-  if (src.height < 4 && method == GST_VIDEO_SCALE_4TAP)
+  /* the Lanczos filters work on 8 bit samples */
+  if (method == GST_VIDEO_SCALE_LANCZOS &&
+      (videoscale->format == GST_VIDEO_SCALE_GRAY16 ||
+          videoscale->format == GST_VIDEO_SCALE_RGB565 ||
+          videoscale->format == GST_VIDEO_SCALE_RGB555))
+    method = GST_VIDEO_SCALE_4TAP;
+
+  if (src[0].height < 4 && method == GST_VIDEO_SCALE_4TAP)
     method = GST_VIDEO_SCALE_BILINEAR;
 
+  switch (method) {
+    case GST_VIDEO_SCALE_NEAREST:
+      GST_LOG_OBJECT (videoscale, "doing nearest scaling");
+      switch (videoscale->format) {
+        case GST_VIDEO_SCALE_RGBx:
+        case GST_VIDEO_SCALE_xRGB:
+        case GST_VIDEO_SCALE_BGRx:
+        case GST_VIDEO_SCALE_xBGR:
+        case GST_VIDEO_SCALE_RGBA:
+        case GST_VIDEO_SCALE_ARGB:
+        case GST_VIDEO_SCALE_BGRA:
+        case GST_VIDEO_SCALE_ABGR:
+        case GST_VIDEO_SCALE_AYUV:
+          func = vs_image_scale_nearest_RGBA;
+          break;
+        case GST_VIDEO_SCALE_RGB:
+        case GST_VIDEO_SCALE_BGR:
+        case GST_VIDEO_SCALE_v308:
+          func = vs_image_scale_nearest_RGB;
+          break;
+        case GST_VIDEO_SCALE_YUY2:
+        case GST_VIDEO_SCALE_YVYU:
+          func = vs_image_scale_nearest_YUYV;
+          break;
+        case GST_VIDEO_SCALE_UYVY:
+          func = vs_image_scale_nearest_UYVY;
+          break;
+        case GST_VIDEO_SCALE_Y:
+        case GST_VIDEO_SCALE_GRAY8:
+          func = vs_image_scale_nearest_Y;
+          break;
+        case GST_VIDEO_SCALE_GRAY16:
+          func = vs_image_scale_nearest_Y16;
+          break;
+        case GST_VIDEO_SCALE_I420:
+        case GST_VIDEO_SCALE_YV12:
+          func = vs_image_scale_nearest_Y;
+          n_planes = 3;
+          break;
+        case GST_VIDEO_SCALE_RGB565:
+          func = vs_image_scale_nearest_RGB565;
+          break;
+        case GST_VIDEO_SCALE_RGB555:
+          func = vs_image_scale_nearest_RGB555;
+          break;
+        default:
+          goto unsupported;
+      }
+      break;
+    case GST_VIDEO_SCALE_BILINEAR:
+      GST_LOG_OBJECT (videoscale, "doing bilinear scaling");
+      switch (videoscale->format) {
+        case GST_VIDEO_SCALE_RGBx:
+        case GST_VIDEO_SCALE_xRGB:
+        case GST_VIDEO_SCALE_BGRx:
+        case GST_VIDEO_SCALE_xBGR:
+        case GST_VIDEO_SCALE_RGBA:
+        case GST_VIDEO_SCALE_ARGB:
+        case GST_VIDEO_SCALE_BGRA:
+        case GST_VIDEO_SCALE_ABGR:
+        case GST_VIDEO_SCALE_AYUV:
+          func = vs_image_scale_linear_RGBA;
+          break;
+        case GST_VIDEO_SCALE_RGB:
+        case GST_VIDEO_SCALE_BGR:
+        case GST_VIDEO_SCALE_v308:
+          func = vs_image_scale_linear_RGB;
+          break;
+        case GST_VIDEO_SCALE_YUY2:
+        case GST_VIDEO_SCALE_YVYU:
+          func = vs_image_scale_linear_YUYV;
+          break;
+        case GST_VIDEO_SCALE_UYVY:
+          func = vs_image_scale_linear_UYVY;
+          break;
+        case GST_VIDEO_SCALE_Y:
+        case GST_VIDEO_SCALE_GRAY8:
+          func = vs_image_scale_linear_Y;
+          break;
+        case GST_VIDEO_SCALE_GRAY16:
+          func = vs_image_scale_linear_Y16;
+          break;
+        case GST_VIDEO_SCALE_I420:
+        case GST_VIDEO_SCALE_YV12:
+          func = vs_image_scale_linear_Y;
+          n_planes = 3;
+          break;
+        case GST_VIDEO_SCALE_RGB565:
+          func = vs_image_scale_linear_RGB565;
+          break;
+        case GST_VIDEO_SCALE_RGB555:
+          func = vs_image_scale_linear_RGB555;
+          break;
+        default:
+          goto unsupported;
+      }
+      break;
+    case GST_VIDEO_SCALE_4TAP:
+      GST_LOG_OBJECT (videoscale, "doing 4tap scaling");
+      switch (videoscale->format) {
+        case GST_VIDEO_SCALE_RGBx:
+        case GST_VIDEO_SCALE_xRGB:
+        case GST_VIDEO_SCALE_BGRx:
+        case GST_VIDEO_SCALE_xBGR:
+        case GST_VIDEO_SCALE_RGBA:
+        case GST_VIDEO_SCALE_ARGB:
+        case GST_VIDEO_SCALE_BGRA:
+        case GST_VIDEO_SCALE_ABGR:
+        case GST_VIDEO_SCALE_AYUV:
+          func = vs_image_scale_4tap_RGBA;
+          break;
+        case GST_VIDEO_SCALE_RGB:
+        case GST_VIDEO_SCALE_BGR:
+        case GST_VIDEO_SCALE_v308:
+          func = vs_image_scale_4tap_RGB;
+          break;
+        case GST_VIDEO_SCALE_YUY2:
+        case GST_VIDEO_SCALE_YVYU:
+          func = vs_image_scale_4tap_YUYV;
+          break;
+        case GST_VIDEO_SCALE_UYVY:
+          func = vs_image_scale_4tap_UYVY;
+          break;
+        case GST_VIDEO_SCALE_Y:
+        case GST_VIDEO_SCALE_GRAY8:
+          func = vs_image_scale_4tap_Y;
+          break;
+        case GST_VIDEO_SCALE_GRAY16:
+          func = vs_image_scale_4tap_Y16;
+          break;
+        case GST_VIDEO_SCALE_I420:
+        case GST_VIDEO_SCALE_YV12:
+          func = vs_image_scale_4tap_Y;
+          n_planes = 3;
+          break;
+        case GST_VIDEO_SCALE_RGB565:
+          func = vs_image_scale_4tap_RGB565;
+          break;
+        case GST_VIDEO_SCALE_RGB555:
+          func = vs_image_scale_4tap_RGB555;
+          break;
+        default:
+          goto unsupported;
+      }
+      break;
+    case GST_VIDEO_SCALE_LANCZOS:
+      GST_LOG_OBJECT (videoscale, "doing lanczos scaling");
+      switch (videoscale->format) {
+        case GST_VIDEO_SCALE_RGBx:
+        case GST_VIDEO_SCALE_xRGB:
+        case GST_VIDEO_SCALE_BGRx:
+        case GST_VIDEO_SCALE_xBGR:
+        case GST_VIDEO_SCALE_RGBA:
+        case GST_VIDEO_SCALE_ARGB:
+        case GST_VIDEO_SCALE_BGRA:
+        case GST_VIDEO_SCALE_ABGR:
+        case GST_VIDEO_SCALE_AYUV:
+          filter_func = vs_image_scale_lanczos_RGBA;
+          break;
+        case GST_VIDEO_SCALE_RGB:
+        case GST_VIDEO_SCALE_BGR:
+        case GST_VIDEO_SCALE_v308:
+          filter_func = vs_image_scale_lanczos_RGB;
+          break;
+        case GST_VIDEO_SCALE_YUY2:
+        case GST_VIDEO_SCALE_YVYU:
+          filter_func = vs_image_scale_lanczos_YUYV;
+          break;
+        case GST_VIDEO_SCALE_UYVY:
+          filter_func = vs_image_scale_lanczos_UYVY;
+          break;
+        case GST_VIDEO_SCALE_Y:
+        case GST_VIDEO_SCALE_GRAY8:
+          filter_func = vs_image_scale_lanczos_Y;
+          break;
+        case GST_VIDEO_SCALE_I420:
+        case GST_VIDEO_SCALE_YV12:
+          filter_func = vs_image_scale_lanczos_Y;
+          n_planes = 3;
+          break;
+        default:
+          goto unsupported;
+      }
+      break;
+    default:
+      goto unknown_mode;
+  }
+
   for (step = 0; step < (interlaced ? 2 : 1); step++) {
     gst_video_scale_prepare_image (videoscale->format, in, &videoscale->src,
-        &src_u, &src_v, step, interlaced);
+        &src[1], &src[2], step, interlaced);
     gst_video_scale_prepare_image (videoscale->format, out, &videoscale->dest,
-        &dest_u, &dest_v, step, interlaced);
+        &dest[1], &dest[2], step, interlaced);
 
     if (step == 0 && interlaced) {
       if (videoscale->from_height % 2 == 1) {
-        src.height += 1;
+        src[0].height += 1;
       }
 
       if (videoscale->to_height % 2 == 1) {
-        dest.height += 1;
+        dest[0].height += 1;
       }
     } else if (step == 1 && interlaced) {
       if (videoscale->from_height % 2 == 1) {
-        src.height -= 1;
+        src[0].height -= 1;
       }
 
       if (videoscale->to_height % 2 == 1) {
-        dest.height -= 1;
+        dest[0].height -= 1;
       }
-      src.pixels += (src.stride / 2);
-      dest.pixels += (dest.stride / 2);
+      src[0].pixels += (src[0].stride / 2);
+      dest[0].pixels += (dest[0].stride / 2);
     }
 
-    switch (method) {
-      case GST_VIDEO_SCALE_NEAREST:
-        GST_LOG_OBJECT (videoscale, "doing nearest scaling");
-        switch (videoscale->format) {
-          case GST_VIDEO_SCALE_RGBx:
-          case GST_VIDEO_SCALE_xRGB:
-          case GST_VIDEO_SCALE_BGRx:
-          case GST_VIDEO_SCALE_xBGR:
-          case GST_VIDEO_SCALE_RGBA:
-          case GST_VIDEO_SCALE_ARGB:
-          case GST_VIDEO_SCALE_BGRA:
-          case GST_VIDEO_SCALE_ABGR:
-          case GST_VIDEO_SCALE_AYUV:
-            vs_image_scale_nearest_RGBA (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB:
-          case GST_VIDEO_SCALE_BGR:
-          case GST_VIDEO_SCALE_v308:
-            vs_image_scale_nearest_RGB (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_YUY2:
-          case GST_VIDEO_SCALE_YVYU:
-            vs_image_scale_nearest_YUYV (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_UYVY:
-            vs_image_scale_nearest_UYVY (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_Y:
-          case GST_VIDEO_SCALE_GRAY8:
-            vs_image_scale_nearest_Y (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_GRAY16:
-            vs_image_scale_nearest_Y16 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_I420:
-          case GST_VIDEO_SCALE_YV12:
-            vs_image_scale_nearest_Y (&dest, &src, videoscale->tmp_buf);
-            vs_image_scale_nearest_Y (&dest_u, &src_u, videoscale->tmp_buf);
-            vs_image_scale_nearest_Y (&dest_v, &src_v, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB565:
-            vs_image_scale_nearest_RGB565 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB555:
-            vs_image_scale_nearest_RGB555 (&dest, &src, videoscale->tmp_buf);
-            break;
-          default:
-            goto unsupported;
-        }
-        break;
-      case GST_VIDEO_SCALE_BILINEAR:
-        GST_LOG_OBJECT (videoscale, "doing bilinear scaling");
-        switch (videoscale->format) {
-          case GST_VIDEO_SCALE_RGBx:
-          case GST_VIDEO_SCALE_xRGB:
-          case GST_VIDEO_SCALE_BGRx:
-          case GST_VIDEO_SCALE_xBGR:
-          case GST_VIDEO_SCALE_RGBA:
-          case GST_VIDEO_SCALE_ARGB:
-          case GST_VIDEO_SCALE_BGRA:
-          case GST_VIDEO_SCALE_ABGR:
-          case GST_VIDEO_SCALE_AYUV:
-            vs_image_scale_linear_RGBA (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB:
-          case GST_VIDEO_SCALE_BGR:
-          case GST_VIDEO_SCALE_v308:
-            vs_image_scale_linear_RGB (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_YUY2:
-          case GST_VIDEO_SCALE_YVYU:
-            vs_image_scale_linear_YUYV (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_UYVY:
-            vs_image_scale_linear_UYVY (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_Y:
-          case GST_VIDEO_SCALE_GRAY8:
-            vs_image_scale_linear_Y (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_GRAY16:
-            vs_image_scale_linear_Y16 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_I420:
-          case GST_VIDEO_SCALE_YV12:
-            vs_image_scale_linear_Y (&dest, &src, videoscale->tmp_buf);
-            vs_image_scale_linear_Y (&dest_u, &src_u, videoscale->tmp_buf);
-            vs_image_scale_linear_Y (&dest_v, &src_v, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB565:
-            vs_image_scale_linear_RGB565 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB555:
-            vs_image_scale_linear_RGB555 (&dest, &src, videoscale->tmp_buf);
-            break;
-          default:
-            goto unsupported;
-        }
-        break;
-      case GST_VIDEO_SCALE_4TAP:
-        GST_LOG_OBJECT (videoscale, "doing 4tap scaling");
-        switch (videoscale->format) {
-          case GST_VIDEO_SCALE_RGBx:
-          case GST_VIDEO_SCALE_xRGB:
-          case GST_VIDEO_SCALE_BGRx:
-          case GST_VIDEO_SCALE_xBGR:
-          case GST_VIDEO_SCALE_RGBA:
-          case GST_VIDEO_SCALE_ARGB:
-          case GST_VIDEO_SCALE_BGRA:
-          case GST_VIDEO_SCALE_ABGR:
-          case GST_VIDEO_SCALE_AYUV:
-            vs_image_scale_4tap_RGBA (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB:
-          case GST_VIDEO_SCALE_BGR:
-          case GST_VIDEO_SCALE_v308:
-            vs_image_scale_4tap_RGB (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_YUY2:
-          case GST_VIDEO_SCALE_YVYU:
-            vs_image_scale_4tap_YUYV (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_UYVY:
-            vs_image_scale_4tap_UYVY (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_Y:
-          case GST_VIDEO_SCALE_GRAY8:
-            vs_image_scale_4tap_Y (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_GRAY16:
-            vs_image_scale_4tap_Y16 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_I420:
-          case GST_VIDEO_SCALE_YV12:
-            vs_image_scale_4tap_Y (&dest, &src, videoscale->tmp_buf);
-            vs_image_scale_4tap_Y (&dest_u, &src_u, videoscale->tmp_buf);
-            vs_image_scale_4tap_Y (&dest_v, &src_v, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB565:
-            vs_image_scale_4tap_RGB565 (&dest, &src, videoscale->tmp_buf);
-            break;
-          case GST_VIDEO_SCALE_RGB555:
-            vs_image_scale_4tap_RGB555 (&dest, &src, videoscale->tmp_buf);
-            break;
-          default:
-            goto unsupported;
-        }
-        break;
-      default:
-        goto unknown_mode;
+    if (filter_func) {
+      for (i = 0; i < n_planes; i++) {
+        filters[i].x = gst_video_scale_get_filter (videoscale, src[i].width,
+            dest[i].width);
+        filters[i].y = gst_video_scale_get_filter (videoscale, src[i].height,
+            dest[i].height);
+        /* the packed 4:2:2 formats have a chroma sample for two pixels */
+        if (filter_func == vs_image_scale_lanczos_YUYV ||
+            filter_func == vs_image_scale_lanczos_UYVY)
+          filters[i].x_chroma = gst_video_scale_get_filter (videoscale,
+              (src[i].width + 1) / 2, (dest[i].width + 1) / 2);
+        else
+          filters[i].x_chroma = NULL;
+      }
     }
 
+    gst_video_scale_scale (videoscale, func, filter_func, filters, dest, src,
+        n_planes, n_threads);
   }
 
   GST_LOG_OBJECT (videoscale, "pushing buffer of %d bytes",
@@ -1018,6 +1271,7 @@ plugin_init (GstPlugin * plugin)
       "videoscale element");
 
   vs_4tap_init ();
+  vs_lanczos_init ();
 
   return TRUE;
 }
@@ -46,13 +46,16 @@ GST_DEBUG_CATEGORY_EXTERN (video_scale_debug);
  * @GST_VIDEO_SCALE_NEAREST: use nearest neighbour scaling (fast and ugly)
  * @GST_VIDEO_SCALE_BILINEAR: use bilinear scaling (slower but prettier).
  * @GST_VIDEO_SCALE_4TAP: use a 4-tap filter for scaling (slow).
+ * @GST_VIDEO_SCALE_LANCZOS: use a Lanczos filter with 3 lobes for scaling,
+ *   which gets more taps when downscaling (slow, best quality). Since: 0.10.30
  *
  * The videoscale method to use.
  */
 typedef enum {
   GST_VIDEO_SCALE_NEAREST,
   GST_VIDEO_SCALE_BILINEAR,
-  GST_VIDEO_SCALE_4TAP
+  GST_VIDEO_SCALE_4TAP,
+  GST_VIDEO_SCALE_LANCZOS
 } GstVideoScaleMethod;
 
 typedef struct _GstVideoScale GstVideoScale;
@@ -67,6 +70,7 @@ struct _GstVideoScale {
   GstBaseTransform element;
 
   GstVideoScaleMethod method;
+  guint n_threads;
 
   /* negotiated stuff */
   int format;
@@ -82,6 +86,16 @@ struct _GstVideoScale {
   
   /*< private >*/
   guint8 *tmp_buf;
+  guint tmp_size;               /* size of the tmp_buf of one band */
+  guint n_tmp_bufs;
+
+  /* the VSFilters of the Lanczos method for the current caps */
+  GSList *filters;
+
+  /* bands of the current frame that are still being scaled */
+  GMutex *bands_lock;
+  GCond *bands_cond;
+  guint bands_pending;
 };
 
 struct _GstVideoScaleClass {
@@ -154,7 +154,7 @@ vs_scanline_merge_4tap_Y (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_Y (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -163,6 +163,7 @@ vs_image_scale_4tap_Y (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -174,16 +175,21 @@ vs_image_scale_4tap_Y (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_Y (tmpbuf + i * dest->width,
+    vs_scanline_resample_4tap_Y (tmpbuf + (i & 3) * dest->width,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -271,7 +277,7 @@ vs_scanline_merge_4tap_Y16 (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_Y16 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -280,6 +286,7 @@ vs_image_scale_4tap_Y16 (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -291,16 +298,21 @@ vs_image_scale_4tap_Y16 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_Y16 (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_Y16 (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -394,7 +406,7 @@ vs_scanline_merge_4tap_RGBA (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_RGBA (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -403,6 +415,7 @@ vs_image_scale_4tap_RGBA (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -414,16 +427,21 @@ vs_image_scale_4tap_RGBA (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_RGBA (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_RGBA (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -517,7 +535,7 @@ vs_scanline_merge_4tap_RGB (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_RGB (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -526,6 +544,7 @@ vs_image_scale_4tap_RGB (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -537,16 +556,21 @@ vs_image_scale_4tap_RGB (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_RGB (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_RGB (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -715,7 +739,7 @@ vs_scanline_merge_4tap_YUYV (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_YUYV (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -724,6 +748,7 @@ vs_image_scale_4tap_YUYV (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -735,16 +760,21 @@ vs_image_scale_4tap_YUYV (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_YUYV (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_YUYV (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -913,7 +943,7 @@ vs_scanline_merge_4tap_UYVY (uint8_t * dest, uint8_t * src1, uint8_t * src2,
 
 void
 vs_image_scale_4tap_UYVY (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -922,6 +952,7 @@ vs_image_scale_4tap_UYVY (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -933,16 +964,21 @@ vs_image_scale_4tap_UYVY (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_UYVY (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_UYVY (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -1098,7 +1134,7 @@ vs_scanline_merge_4tap_RGB565 (uint8_t * dest_u8, uint8_t * src1_u8,
 
 void
 vs_image_scale_4tap_RGB565 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -1107,6 +1143,7 @@ vs_image_scale_4tap_RGB565 (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -1118,16 +1155,21 @@ vs_image_scale_4tap_RGB565 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_RGB565 (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_RGB565 (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
@@ -1283,7 +1325,7 @@ vs_scanline_merge_4tap_RGB555 (uint8_t * dest_u8, uint8_t * src1_u8,
 
 void
 vs_image_scale_4tap_RGB555 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int yacc;
   int y_increment;
@@ -1292,6 +1334,7 @@ vs_image_scale_4tap_RGB555 (const VSImage * dest, const VSImage * src,
   int j;
   int xacc;
   int k;
+  int last;
 
   if (dest->height == 1)
     y_increment = 0;
@@ -1303,16 +1346,21 @@ vs_image_scale_4tap_RGB555 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  k = 0;
-  for (i = 0; i < 4; i++) {
+  yacc = y_start * y_increment;
+  k = yacc >> 16;
+
+  /* fill the ring the way scaling from the top would have left it, with the
+   * last four lines up to line k + 3, so a band starting at y_start gives the
+   * same output */
+  last = MIN (k + 3, src->height - 1);
+  for (i = last - 3; i <= last; i++) {
     xacc = 0;
-    vs_scanline_resample_4tap_RGB555 (tmpbuf + i * dest->stride,
+    vs_scanline_resample_4tap_RGB555 (tmpbuf + (i & 3) * dest->stride,
         src->pixels + i * src->stride, dest->width, src->width,
         &xacc, x_increment);
   }
 
-  yacc = 0;
-  for (i = 0; i < dest->height; i++) {
+  for (i = y_start; i < y_end; i++) {
     uint8_t *t0, *t1, *t2, *t3;
 
     j = yacc >> 16;
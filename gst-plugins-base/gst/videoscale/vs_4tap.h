@@ -38,56 +38,56 @@ void vs_scanline_resample_4tap_Y (uint8_t *dest, uint8_t *src,
 void vs_scanline_merge_4tap_Y (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_Y (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_RGBA (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_RGBA (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_RGBA (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_RGB (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_RGB (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_RGB (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_YUYV (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_YUYV (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_YUYV (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_UYVY (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_UYVY (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_UYVY (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_RGB565 (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_RGB565 (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_RGB565 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_RGB555 (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_RGB555 (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_RGB555 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 void vs_scanline_resample_4tap_Y16 (uint8_t *dest, uint8_t *src,
     int n, int src_width, int *xacc, int increment);
 void vs_scanline_merge_4tap_Y16 (uint8_t *dest, uint8_t *src1, uint8_t *src2,
     uint8_t *src3, uint8_t *src4, int n, int acc);
 void vs_image_scale_4tap_Y16 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf);
+    uint8_t * tmpbuf, int y_start, int y_end);
 
 #endif
 
@@ -36,7 +36,7 @@
 
 void
 vs_image_scale_nearest_RGBA (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -56,8 +56,8 @@ vs_image_scale_nearest_RGBA (const VSImage * dest, const VSImage * src,
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -71,7 +71,7 @@ vs_image_scale_nearest_RGBA (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_RGBA (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -101,13 +101,14 @@ vs_image_scale_linear_RGBA (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_RGBA (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_RGBA (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -166,7 +167,7 @@ vs_image_scale_linear_RGBA (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_RGB (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -185,8 +186,8 @@ vs_image_scale_nearest_RGB (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -200,7 +201,7 @@ vs_image_scale_nearest_RGB (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_RGB (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -230,13 +231,14 @@ vs_image_scale_linear_RGB (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_RGB (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_RGB (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -296,7 +298,7 @@ vs_image_scale_linear_RGB (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_YUYV (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -315,8 +317,8 @@ vs_image_scale_nearest_YUYV (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -330,7 +332,7 @@ vs_image_scale_nearest_YUYV (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_YUYV (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -360,13 +362,14 @@ vs_image_scale_linear_YUYV (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_YUYV (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_YUYV (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -426,7 +429,7 @@ vs_image_scale_linear_YUYV (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_UYVY (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -445,8 +448,8 @@ vs_image_scale_nearest_UYVY (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -460,7 +463,7 @@ vs_image_scale_nearest_UYVY (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_UYVY (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -490,13 +493,14 @@ vs_image_scale_linear_UYVY (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_UYVY (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_UYVY (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -556,7 +560,7 @@ vs_image_scale_linear_UYVY (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_Y (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -575,8 +579,8 @@ vs_image_scale_nearest_Y (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -590,7 +594,7 @@ vs_image_scale_nearest_Y (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_Y (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -620,13 +624,14 @@ vs_image_scale_linear_Y (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_Y (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_Y (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -684,7 +689,7 @@ vs_image_scale_linear_Y (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_Y16 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -703,8 +708,8 @@ vs_image_scale_nearest_Y16 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -718,7 +723,7 @@ vs_image_scale_nearest_Y16 (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_Y16 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -748,13 +753,14 @@ vs_image_scale_linear_Y16 (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_Y16 (tmp1, src->pixels, src->width, dest->width,
+  vs_scanline_resample_linear_Y16 (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
       &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -814,7 +820,7 @@ vs_image_scale_linear_Y16 (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_RGB565 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -833,8 +839,8 @@ vs_image_scale_nearest_RGB565 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -848,7 +854,7 @@ vs_image_scale_nearest_RGB565 (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_RGB565 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -878,13 +884,14 @@ vs_image_scale_linear_RGB565 (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_RGB565 (tmp1, src->pixels, src->width,
-      dest->width, &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  vs_scanline_resample_linear_RGB565 (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
+      &xacc, x_increment);
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -944,7 +951,7 @@ vs_image_scale_linear_RGB565 (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_nearest_RGB555 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -963,8 +970,8 @@ vs_image_scale_nearest_RGB555 (const VSImage * dest, const VSImage * src,
   else
     x_increment = ((src->width - 1) << 16) / (dest->width - 1);
 
-  acc = 0;
-  for (i = 0; i < dest->height; i++) {
+  acc = y_start * y_increment;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
 
     xacc = 0;
@@ -978,7 +985,7 @@ vs_image_scale_nearest_RGB555 (const VSImage * dest, const VSImage * src,
 
 void
 vs_image_scale_linear_RGB555 (const VSImage * dest, const VSImage * src,
-    uint8_t * tmpbuf)
+    uint8_t * tmpbuf, int y_start, int y_end)
 {
   int acc;
   int y_increment;
@@ -1008,13 +1015,14 @@ vs_image_scale_linear_RGB555 (const VSImage * dest, const VSImage * src,
   tmp1 = tmpbuf;
   tmp2 = tmpbuf + dest_size;
 
-  acc = 0;
+  acc = y_start * y_increment;
   xacc = 0;
   y2 = -1;
-  vs_scanline_resample_linear_RGB555 (tmp1, src->pixels, src->width,
-      dest->width, &xacc, x_increment);
-  y1 = 0;
-  for (i = 0; i < dest->height; i++) {
+  vs_scanline_resample_linear_RGB555 (tmp1,
+      src->pixels + (acc >> 16) * src->stride, src->width, dest->width,
+      &xacc, x_increment);
+  y1 = acc >> 16;
+  for (i = y_start; i < y_end; i++) {
     j = acc >> 16;
     x = acc & 0xffff;
 
@@ -39,45 +39,50 @@ struct _VSImage {
   int stride;
 };
 
+/* The scaling functions only write the lines from y_start up to, but not
+ * including, y_end of dest. The lines are the same as when the whole image
+ * is scaled at once, so bands of one image can be scaled concurrently, each
+ * with its own tmpbuf. */
+
 void vs_image_scale_nearest_RGBA (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_RGBA (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_RGB (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_RGB (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_YUYV (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_YUYV (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_UYVY (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_UYVY (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_Y (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_Y (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_RGB565 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_RGB565 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_RGB555 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_RGB555 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 void vs_image_scale_nearest_Y16 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 void vs_image_scale_linear_Y16 (const VSImage *dest, const VSImage *src,
-    uint8_t *tmpbuf);
+    uint8_t *tmpbuf, int y_start, int y_end);
 
 #endif
 
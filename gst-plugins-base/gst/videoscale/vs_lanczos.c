@@ -0,0 +1,439 @@
+/*
+ * Image Scaling Functions (Lanczos)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Separable polyphase scaling. Every output line is made by filtering the
+ * source lines vertically into a line of 16 bit samples with 6 fractional
+ * bits, which is then filtered horizontally. All coefficients of a geometry
+ * are computed once, by vs_filter_new_lanczos(). The SSE2 routines give
+ * exactly the same output as the C routines. */
+
+#include "vs_image.h"
+
+#include "vs_lanczos.h"
+
+#include <liboil/liboil.h>
+#include <liboil/liboilcpu.h>
+#include <liboil/liboilfunction.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* MSVC does not define __SSE2__, it is always there on x64 and with
+ * /arch:SSE2 on x86 */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_VS_LANCZOS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define MAX(a,b) (((a) > (b)) ? (a) : (b))
+#define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#define CLAMP(x,a,b) MAX(MIN((x),(b)),(a))
+
+#ifndef M_PI
+#define M_PI  3.14159265358979323846
+#endif
+
+/* fractional bits of the vertically filtered samples */
+#define LINE_BITS 6
+#define LINE_SHIFT (VS_FILTER_BITS - LINE_BITS)
+#define ROW_SHIFT (VS_FILTER_BITS + LINE_BITS)
+
+/* samples after the end of a filtered line that the SSE2 routines may read,
+ * the padding of the taps of 7 pixels of 4 components */
+#define LINE_PAD 32
+
+typedef void (*VSFilterLinesFunc) (int16_t * dest, const uint8_t * src,
+    int stride, const int16_t * taps, int n_taps, int n);
+typedef void (*VSFilterRowFunc) (uint8_t * dest, const int16_t * src,
+    const VSFilter * filter);
+
+static VSFilterLinesFunc vs_lanczos_filter_lines;
+static VSFilterRowFunc vs_lanczos_filter_row_Y;
+static VSFilterRowFunc vs_lanczos_filter_row_RGBA;
+
+static double
+vs_lanczos_func (double x, int a)
+{
+  if (x == 0)
+    return 1;
+  if (x <= -a || x >= a)
+    return 0;
+  return a * sin (M_PI * x) * sin (M_PI * x / a) / (M_PI * M_PI * x * x);
+}
+
+VSFilter *
+vs_filter_new_lanczos (int src_size, int dest_size, int a)
+{
+  VSFilter *filter;
+  double scale = (double) src_size / dest_size;
+  double fscale = MAX (scale, 1.0);
+  double *weights;
+  int n_taps;
+  int i;
+  int j;
+
+  /* when downscaling the kernel is stretched to filter out what can not be
+   * represented in the output */
+  n_taps = 2 * (int) ceil (a * fscale);
+
+  filter = malloc (sizeof (VSFilter));
+  filter->src_size = src_size;
+  filter->dest_size = dest_size;
+  filter->n_taps = MIN (n_taps, src_size);
+  filter->stride = (filter->n_taps + 7) & ~7;
+  filter->offsets = malloc (dest_size * sizeof (int));
+  filter->taps = calloc (dest_size * filter->stride, sizeof (int16_t));
+
+  weights = malloc (filter->n_taps * sizeof (double));
+
+  for (i = 0; i < dest_size; i++) {
+    int16_t *taps = filter->taps + i * filter->stride;
+    double center = (i + 0.5) * scale - 0.5;
+    double sum = 0;
+    int start = (int) floor (center) - n_taps / 2 + 1;
+    int offset = CLAMP (start, 0, src_size - filter->n_taps);
+    int isum = 0;
+    int max = 0;
+
+    /* the taps outside of the input are added to the edge sample */
+    memset (weights, 0, filter->n_taps * sizeof (double));
+    for (j = 0; j < n_taps; j++) {
+      double w = vs_lanczos_func ((start + j - center) / fscale, a);
+
+      weights[CLAMP (start + j, 0, src_size - 1) - offset] += w;
+      sum += w;
+    }
+
+    for (j = 0; j < filter->n_taps; j++) {
+      taps[j] = (int) floor (weights[j] / sum * (1 << VS_FILTER_BITS) + 0.5);
+      isum += taps[j];
+      if (taps[j] > taps[max])
+        max = j;
+    }
+    /* make the taps add up to exactly 1 */
+    taps[max] += (1 << VS_FILTER_BITS) - isum;
+
+    filter->offsets[i] = offset;
+  }
+
+  free (weights);
+
+  return filter;
+}
+
+void
+vs_filter_free (VSFilter * filter)
+{
+  free (filter->offsets);
+  free (filter->taps);
+  free (filter);
+}
+
+int
+vs_image_scale_lanczos_get_tmp_size (const VSImage * src)
+{
+  return (src->stride + LINE_PAD) * sizeof (int16_t);
+}
+
+static void
+vs_lanczos_filter_lines_c (int16_t * dest, const uint8_t * src, int stride,
+    const int16_t * taps, int n_taps, int n)
+{
+  int i;
+  int j;
+  int sum;
+
+  for (i = 0; i < n; i++) {
+    sum = 1 << (LINE_SHIFT - 1);
+    for (j = 0; j < n_taps; j++)
+      sum += taps[j] * src[j * stride + i];
+    dest[i] = CLAMP (sum >> LINE_SHIFT, -32768, 32767);
+  }
+}
+
+static void
+vs_lanczos_filter_row_c (uint8_t * dest, int dest_step, const int16_t * src,
+    int src_step, const VSFilter * filter)
+{
+  const int16_t *s;
+  const int16_t *taps;
+  int i;
+  int j;
+  int sum;
+
+  for (i = 0; i < filter->dest_size; i++) {
+    s = src + filter->offsets[i] * src_step;
+    taps = filter->taps + i * filter->stride;
+    sum = 1 << (ROW_SHIFT - 1);
+    for (j = 0; j < filter->n_taps; j++)
+      sum += taps[j] * s[j * src_step];
+    dest[i * dest_step] = CLAMP (sum >> ROW_SHIFT, 0, 255);
+  }
+}
+
+static void
+vs_lanczos_filter_row_Y_c (uint8_t * dest, const int16_t * src,
+    const VSFilter * filter)
+{
+  vs_lanczos_filter_row_c (dest, 1, src, 1, filter);
+}
+
+static void
+vs_lanczos_filter_row_RGBA_c (uint8_t * dest, const int16_t * src,
+    const VSFilter * filter)
+{
+  int k;
+
+  for (k = 0; k < 4; k++)
+    vs_lanczos_filter_row_c (dest + k, 4, src + k, 4, filter);
+}
+
+#ifdef HAVE_VS_LANCZOS_SSE2
+/* two 16 bit taps for _mm_madd_epi16() */
+#define TAP_PAIR(t0, t1) \
+  _mm_set1_epi32 ((int) (((unsigned int) (t1) << 16) | ((t0) & 0xffff)))
+
+static void
+vs_lanczos_filter_lines_sse2 (int16_t * dest, const uint8_t * src,
+    int stride, const int16_t * taps, int n_taps, int n)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i round = _mm_set1_epi32 (1 << (LINE_SHIFT - 1));
+  __m128i a0, a1, a2, a3, p0, p1, lo, hi, t;
+  const uint8_t *s0;
+  const uint8_t *s1;
+  int i;
+  int j;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    a0 = a1 = a2 = a3 = round;
+    /* two lines at a time, an odd last line is paired with itself and a
+     * tap of 0 */
+    for (j = 0; j < n_taps; j += 2) {
+      s0 = src + j * stride + i;
+      if (j + 1 < n_taps) {
+        s1 = s0 + stride;
+        t = TAP_PAIR (taps[j], taps[j + 1]);
+      } else {
+        s1 = s0;
+        t = TAP_PAIR (taps[j], 0);
+      }
+      p0 = _mm_loadu_si128 ((const __m128i *) s0);
+      p1 = _mm_loadu_si128 ((const __m128i *) s1);
+      lo = _mm_unpacklo_epi8 (p0, p1);
+      hi = _mm_unpackhi_epi8 (p0, p1);
+      a0 = _mm_add_epi32 (a0, _mm_madd_epi16 (_mm_unpacklo_epi8 (lo, zero),
+              t));
+      a1 = _mm_add_epi32 (a1, _mm_madd_epi16 (_mm_unpackhi_epi8 (lo, zero),
+              t));
+      a2 = _mm_add_epi32 (a2, _mm_madd_epi16 (_mm_unpacklo_epi8 (hi, zero),
+              t));
+      a3 = _mm_add_epi32 (a3, _mm_madd_epi16 (_mm_unpackhi_epi8 (hi, zero),
+              t));
+    }
+    _mm_storeu_si128 ((__m128i *) (dest + i),
+        _mm_packs_epi32 (_mm_srai_epi32 (a0, LINE_SHIFT),
+            _mm_srai_epi32 (a1, LINE_SHIFT)));
+    _mm_storeu_si128 ((__m128i *) (dest + i + 8),
+        _mm_packs_epi32 (_mm_srai_epi32 (a2, LINE_SHIFT),
+            _mm_srai_epi32 (a3, LINE_SHIFT)));
+  }
+
+  if (i < n)
+    vs_lanczos_filter_lines_c (dest + i, src + i, stride, taps, n_taps, n - i);
+}
+
+static void
+vs_lanczos_filter_row_Y_sse2 (uint8_t * dest, const int16_t * src,
+    const VSFilter * filter)
+{
+  const int16_t *s;
+  const int16_t *taps;
+  __m128i acc;
+  int i;
+  int j;
+  int sum;
+
+  for (i = 0; i < filter->dest_size; i++) {
+    s = src + filter->offsets[i];
+    taps = filter->taps + i * filter->stride;
+    acc = _mm_setzero_si128 ();
+    for (j = 0; j < filter->stride; j += 8)
+      acc = _mm_add_epi32 (acc,
+          _mm_madd_epi16 (_mm_loadu_si128 ((const __m128i *) (s + j)),
+              _mm_loadu_si128 ((const __m128i *) (taps + j))));
+    acc = _mm_add_epi32 (acc, _mm_srli_si128 (acc, 8));
+    acc = _mm_add_epi32 (acc, _mm_srli_si128 (acc, 4));
+    sum = _mm_cvtsi128_si32 (acc) + (1 << (ROW_SHIFT - 1));
+    dest[i] = CLAMP (sum >> ROW_SHIFT, 0, 255);
+  }
+}
+
+static void
+vs_lanczos_filter_row_RGBA_sse2 (uint8_t * dest, const int16_t * src,
+    const VSFilter * filter)
+{
+  const __m128i round = _mm_set1_epi32 (1 << (ROW_SHIFT - 1));
+  const int16_t *s;
+  const int16_t *taps;
+  __m128i acc, p;
+  int i;
+  int j;
+  int v;
+
+  for (i = 0; i < filter->dest_size; i++) {
+    s = src + filter->offsets[i] * 4;
+    taps = filter->taps + i * filter->stride;
+    acc = round;
+    for (j = 0; j < filter->stride; j += 2) {
+      /* the components of two pixels, interleaved into pairs */
+      p = _mm_loadu_si128 ((const __m128i *) (s + j * 4));
+      p = _mm_unpacklo_epi16 (p, _mm_srli_si128 (p, 8));
+      acc = _mm_add_epi32 (acc, _mm_madd_epi16 (p, TAP_PAIR (taps[j],
+                  taps[j + 1])));
+    }
+    acc = _mm_srai_epi32 (acc, ROW_SHIFT);
+    acc = _mm_packs_epi32 (acc, acc);
+    v = _mm_cvtsi128_si32 (_mm_packus_epi16 (acc, acc));
+    memcpy (dest + i * 4, &v, 4);
+  }
+}
+#endif
+
+void
+vs_lanczos_init (void)
+{
+  vs_lanczos_filter_lines = vs_lanczos_filter_lines_c;
+  vs_lanczos_filter_row_Y = vs_lanczos_filter_row_Y_c;
+  vs_lanczos_filter_row_RGBA = vs_lanczos_filter_row_RGBA_c;
+
+#ifdef HAVE_VS_LANCZOS_SSE2
+  if (oil_cpu_get_flags () & OIL_IMPL_FLAG_SSE2) {
+    vs_lanczos_filter_lines = vs_lanczos_filter_lines_sse2;
+    vs_lanczos_filter_row_Y = vs_lanczos_filter_row_Y_sse2;
+    vs_lanczos_filter_row_RGBA = vs_lanczos_filter_row_RGBA_sse2;
+  }
+#endif
+}
+
+/* filters the source lines of line i vertically, n is the number of bytes
+ * of a line */
+static int16_t *
+vs_lanczos_filter_line (const VSImage * src, uint8_t * tmpbuf, int i, int n,
+    const VSFilter * filter)
+{
+  int16_t *tmp = (int16_t *) tmpbuf;
+
+  vs_lanczos_filter_lines (tmp, src->pixels + filter->offsets[i] * src->stride,
+      src->stride, filter->taps + i * filter->stride, filter->n_taps, n);
+  /* the horizontal filters read past the end, with taps of 0 */
+  memset (tmp + n, 0, LINE_PAD * sizeof (int16_t));
+
+  return tmp;
+}
+
+void
+vs_image_scale_lanczos_Y (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters)
+{
+  int16_t *tmp;
+  int i;
+
+  for (i = y_start; i < y_end; i++) {
+    tmp = vs_lanczos_filter_line (src, tmpbuf, i, src->width, filters->y);
+    vs_lanczos_filter_row_Y (dest->pixels + i * dest->stride, tmp, filters->x);
+  }
+}
+
+void
+vs_image_scale_lanczos_RGBA (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters)
+{
+  int16_t *tmp;
+  int i;
+
+  for (i = y_start; i < y_end; i++) {
+    tmp = vs_lanczos_filter_line (src, tmpbuf, i, src->width * 4, filters->y);
+    vs_lanczos_filter_row_RGBA (dest->pixels + i * dest->stride, tmp,
+        filters->x);
+  }
+}
+
+void
+vs_image_scale_lanczos_RGB (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters)
+{
+  uint8_t *d;
+  int16_t *tmp;
+  int i;
+  int k;
+
+  for (i = y_start; i < y_end; i++) {
+    tmp = vs_lanczos_filter_line (src, tmpbuf, i, src->width * 3, filters->y);
+    d = dest->pixels + i * dest->stride;
+    for (k = 0; k < 3; k++)
+      vs_lanczos_filter_row_c (d + k, 3, tmp + k, 3, filters->x);
+  }
+}
+
+/* y is the offset of the first luma sample and u that of the U sample in a
+ * macropixel */
+static void
+vs_lanczos_scale_422 (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters,
+    int y, int u)
+{
+  uint8_t *d;
+  int16_t *tmp;
+  int i;
+
+  for (i = y_start; i < y_end; i++) {
+    tmp = vs_lanczos_filter_line (src, tmpbuf, i,
+        ((src->width + 1) & ~1) * 2, filters->y);
+    d = dest->pixels + i * dest->stride;
+    vs_lanczos_filter_row_c (d + y, 2, tmp + y, 2, filters->x);
+    vs_lanczos_filter_row_c (d + u, 4, tmp + u, 4, filters->x_chroma);
+    vs_lanczos_filter_row_c (d + u + 2, 4, tmp + u + 2, 4, filters->x_chroma);
+    /* the last macropixel of an odd width has only one luma sample */
+    if (dest->width & 1)
+      d[dest->width * 2 + y] = d[(dest->width - 1) * 2 + y];
+  }
+}
+
+void
+vs_image_scale_lanczos_YUYV (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters)
+{
+  vs_lanczos_scale_422 (dest, src, tmpbuf, y_start, y_end, filters, 0, 1);
+}
+
+void
+vs_image_scale_lanczos_UYVY (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters)
+{
+  vs_lanczos_scale_422 (dest, src, tmpbuf, y_start, y_end, filters, 1, 0);
+}
@@ -0,0 +1,82 @@
+/*
+ * Image Scaling Functions (Lanczos)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _VS_LANCZOS_H_
+#define _VS_LANCZOS_H_
+
+#include "vs_image.h"
+
+#include <liboil/liboil-stdint.h>
+
+/* the taps of a filter add up to 1 << VS_FILTER_BITS */
+#define VS_FILTER_BITS 14
+
+typedef struct _VSFilter VSFilter;
+typedef struct _VSFilterSet VSFilterSet;
+
+/* The filter bank that resamples src_size samples to dest_size samples.
+ * Output sample i is the sum of taps[i * stride + j] times input sample
+ * offsets[i] + j, for j from 0 to n_taps - 1. The taps are padded with
+ * zeros up to stride, which is a multiple of 8. */
+struct _VSFilter {
+  int src_size;
+  int dest_size;
+  int n_taps;
+  int stride;
+  int *offsets;
+  int16_t *taps;
+};
+
+/* the filters to scale one plane with, x_chroma is only used for the
+ * chroma samples of packed 4:2:2 formats */
+struct _VSFilterSet {
+  const VSFilter *x;
+  const VSFilter *x_chroma;
+  const VSFilter *y;
+};
+
+void vs_lanczos_init (void);
+
+VSFilter * vs_filter_new_lanczos (int src_size, int dest_size, int a);
+void vs_filter_free (VSFilter *filter);
+
+int vs_image_scale_lanczos_get_tmp_size (const VSImage * src);
+
+/* Like the other scaling functions these only write lines y_start up to
+ * y_end of dest, tmpbuf must be vs_image_scale_lanczos_get_tmp_size()
+ * bytes large */
+void vs_image_scale_lanczos_Y (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters);
+void vs_image_scale_lanczos_RGBA (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters);
+void vs_image_scale_lanczos_RGB (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters);
+void vs_image_scale_lanczos_YUYV (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters);
+void vs_image_scale_lanczos_UYVY (const VSImage * dest, const VSImage * src,
+    uint8_t * tmpbuf, int y_start, int y_end, const VSFilterSet * filters);
+
+#endif
@@ -430,7 +430,7 @@ get_int_mc_caps (guint channels, const gchar * endianness, guint width,
 static void
 verify_convert (const gchar * which, void *in, int inlength,
     GstCaps * incaps, void *out, int outlength, GstCaps * outcaps,
-    GstFlowReturn expected_flow)
+    GstFlowReturn expected_flow, gboolean in_readonly)
 {
   GstBuffer *inbuffer, *outbuffer;
   GstElement *audioconvert;
@@ -454,11 +454,21 @@ verify_convert (const gchar * which, void *in, int inlength,
   ASSERT_CAPS_REFCOUNT (incaps, "incaps", 2);
   ASSERT_BUFFER_REFCOUNT (inbuffer, "inbuffer", 1);
 
+  /* keep a ref, so the input is not writable and must be left alone */
+  if (in_readonly)
+    gst_buffer_ref (inbuffer);
+
   /* pushing gives away my reference ... */
   GST_DEBUG ("push it");
   fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), expected_flow);
   GST_DEBUG ("pushed it");
 
+  if (in_readonly) {
+    fail_unless (memcmp (GST_BUFFER_DATA (inbuffer), in, inlength) == 0,
+        "input modified converting %s", which);
+    gst_buffer_unref (inbuffer);
+  }
+
   if (expected_flow != GST_FLOW_OK)
     goto done;
 
@@ -515,11 +525,19 @@ done:
 
 #define RUN_CONVERSION(which, inarray, in_get_caps, outarray, out_get_caps)    \
   verify_convert (which, inarray, sizeof (inarray),                            \
-        in_get_caps, outarray, sizeof (outarray), out_get_caps, GST_FLOW_OK)
+        in_get_caps, outarray, sizeof (outarray), out_get_caps, GST_FLOW_OK,   \
+        FALSE)
+
+#define RUN_CONVERSION_READONLY(which, inarray, in_get_caps, outarray,         \
+    out_get_caps)                                                              \
+  verify_convert (which, inarray, sizeof (inarray),                            \
+        in_get_caps, outarray, sizeof (outarray), out_get_caps, GST_FLOW_OK,   \
+        TRUE)
 
 #define RUN_CONVERSION_TO_FAIL(which, inarray, in_caps, outarray, out_caps)    \
   verify_convert (which, inarray, sizeof (inarray),                            \
-        in_caps, outarray, sizeof (outarray), out_caps, GST_FLOW_NOT_NEGOTIATED)
+        in_caps, outarray, sizeof (outarray), out_caps, GST_FLOW_NOT_NEGOTIATED, \
+        FALSE)
 
 
 GST_START_TEST (test_int16)
@@ -881,6 +899,52 @@ GST_START_TEST (test_float_conversion)
 GST_END_TEST;
 
 
+/* buffers long enough for the vectorised direct conversions plus a few
+ * samples that are converted one by one */
+GST_START_TEST (test_direct_conversion)
+{
+  /* 32 signed stereo to mono */
+  {
+    gint32 in[] = { G_MAXINT32, G_MAXINT32, G_MININT32, G_MININT32,
+      100, 200, -100, -300, 3, 3, -3, -3, 0, 0, 1000000, -1000000,
+      65536, 131072
+    };
+    gint32 out[] = { G_MAXINT32, G_MININT32, 150, -200, 2, -2, 0, 0,
+      98304
+    };
+
+    RUN_CONVERSION ("int32 stereo to mono",
+        in, get_int_caps (2, "BYTE_ORDER", 32, 32, TRUE),
+        out, get_int_caps (1, "BYTE_ORDER", 32, 32, TRUE));
+  }
+  /* 32 float to 16 signed */
+  {
+    gfloat in[] = { 0.0, 1.0, -1.0, 2.0, -2.0, 0.5, -0.5, 1.0 / 65536,
+      -0.25
+    };
+    gint16 out[] = { 0, 32767, -32768, 32767, -32768, 16384, -16384, 1,
+      -8192
+    };
+
+    RUN_CONVERSION ("float32 to int16",
+        in, get_float_caps (1, "BYTE_ORDER", 32),
+        out, get_int_caps (1, "BYTE_ORDER", 16, 16, TRUE));
+  }
+  /* 32 signed to 16 signed, from a buffer that can't be written to */
+  {
+    gint32 in[] = { G_MAXINT32, G_MININT32, 65536, 98304, -65536, 0,
+      32767, 32768, -32769, -98305
+    };
+    gint16 out[] = { 32767, -32768, 1, 2, -1, 0, 0, 1, -1, -2 };
+
+    RUN_CONVERSION_READONLY ("int32 to int16 read-only",
+        in, get_int_caps (1, "BYTE_ORDER", 32, 32, TRUE),
+        out, get_int_caps (1, "BYTE_ORDER", 16, 16, TRUE));
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_multichannel_conversion)
 {
   {
@@ -1731,6 +1795,7 @@ audioconvert_suite (void)
   tcase_add_test (tc_chain, test_float32);
   tcase_add_test (tc_chain, test_int_conversion);
   tcase_add_test (tc_chain, test_float_conversion);
+  tcase_add_test (tc_chain, test_direct_conversion);
   tcase_add_test (tc_chain, test_multichannel_conversion);
   tcase_add_test (tc_chain, test_channel_remapping);
   tcase_add_test (tc_chain, test_caps_negotiation);
@@ -31,6 +31,7 @@
 #include <unistd.h>
 
 #include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
 
 typedef struct _RGBFormat
 {
@@ -412,6 +413,203 @@ GST_START_TEST (test_rgb_to_rgb)
 
 GST_END_TEST;
 
+/* odd, so that the last chroma sample of a line and the last line of a
+ * 4:2:0 frame belong to a single pixel, and not a multiple of the 16 pixels
+ * handled per iteration by the SIMD routines */
+#define TEST_WIDTH 37
+#define TEST_HEIGHT 11
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static guint8
+yuv_pattern (gint comp, gint x, gint y)
+{
+  return (comp * 61 + x * 37 + y * 91 + x * y) & 0xff;
+}
+
+static guint8 *
+component_pixel (GstBuffer * buf, GstVideoFormat format, gint comp, gint x,
+    gint y)
+{
+  return GST_BUFFER_DATA (buf) + gst_video_format_get_component_offset (format,
+      comp, TEST_WIDTH, TEST_HEIGHT) +
+      y * gst_video_format_get_row_stride (format, comp, TEST_WIDTH) +
+      x * gst_video_format_get_pixel_stride (format, comp);
+}
+
+/* every sample of every component gets its yuv_pattern() value */
+static GstBuffer *
+create_yuv_frame (GstVideoFormat format)
+{
+  GstBuffer *buf;
+  GstCaps *caps;
+  gint comp, x, y;
+
+  buf = gst_buffer_new_and_alloc (gst_video_format_get_size (format,
+          TEST_WIDTH, TEST_HEIGHT));
+  memset (GST_BUFFER_DATA (buf), 0, GST_BUFFER_SIZE (buf));
+  for (comp = 0; comp < 3; comp++) {
+    for (y = 0; y < gst_video_format_get_component_height (format, comp,
+            TEST_HEIGHT); y++) {
+      for (x = 0; x < gst_video_format_get_component_width (format, comp,
+              TEST_WIDTH); x++)
+        *component_pixel (buf, format, comp, x, y) = yuv_pattern (comp, x, y);
+    }
+  }
+
+  caps = gst_video_format_new_caps (format, TEST_WIDTH, TEST_HEIGHT, 25, 1,
+      1, 1);
+  gst_buffer_set_caps (buf, caps);
+  gst_caps_unref (caps);
+
+  return buf;
+}
+
+/* pushes @inbuf through ffmpegcolorspace and returns the frame in @format */
+static GstBuffer *
+convert_frame (GstBuffer * inbuf, GstVideoFormat format)
+{
+  GstElement *csp;
+  GstBuffer *outbuf;
+  GstCaps *caps;
+
+  csp = gst_check_setup_element ("ffmpegcolorspace");
+  mysrcpad = gst_check_setup_src_pad (csp, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (csp, &sinktemplate, NULL);
+  gst_pad_use_fixed_caps (mysinkpad);
+  caps = gst_video_format_new_caps (format, TEST_WIDTH, TEST_HEIGHT, 25, 1,
+      1, 1);
+  gst_pad_set_caps (mysinkpad, caps);
+  gst_caps_unref (caps);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (csp,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_pad_push (mysrcpad, inbuf) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  outbuf = GST_BUFFER (buffers->data);
+  g_list_free (buffers);
+  buffers = NULL;
+  fail_unless_equals_int (GST_BUFFER_SIZE (outbuf),
+      gst_video_format_get_size (format, TEST_WIDTH, TEST_HEIGHT));
+
+  gst_element_set_state (csp, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (csp);
+  gst_check_teardown_sink_pad (csp);
+  gst_check_teardown_element (csp);
+
+  return outbuf;
+}
+
+/* the fixed point BT.601 conversion of ffmpegcolorspace */
+#define SCALEBITS 10
+#define ONE_HALF (1 << (SCALEBITS - 1))
+#define FIX(x) ((gint) ((x) * (1 << SCALEBITS) + 0.5))
+
+static void
+yuv_to_rgb (gint y, gint u, gint v, guint8 * r, guint8 * g, guint8 * b)
+{
+  y = (y - 16) * FIX (255.0 / 219.0);
+  u -= 128;
+  v -= 128;
+  *r = CLAMP ((y + FIX (1.40200 * 255.0 / 224.0) * v + ONE_HALF) >> SCALEBITS,
+      0, 255);
+  *g = CLAMP ((y - FIX (0.34414 * 255.0 / 224.0) * u -
+          FIX (0.71414 * 255.0 / 224.0) * v + ONE_HALF) >> SCALEBITS, 0, 255);
+  *b = CLAMP ((y + FIX (1.77200 * 255.0 / 224.0) * u + ONE_HALF) >> SCALEBITS,
+      0, 255);
+}
+
+GST_START_TEST (test_yuv_to_rgb)
+{
+  static const GstVideoFormat yuv_formats[] = {
+    GST_VIDEO_FORMAT_I420, GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV12,
+    GST_VIDEO_FORMAT_YUY2, GST_VIDEO_FORMAT_UYVY
+  };
+  static const GstVideoFormat rgb_formats[] = {
+    GST_VIDEO_FORMAT_BGRx, GST_VIDEO_FORMAT_RGBx, GST_VIDEO_FORMAT_xRGB,
+    GST_VIDEO_FORMAT_xBGR, GST_VIDEO_FORMAT_BGRA, GST_VIDEO_FORMAT_ARGB
+  };
+  gint i, j, x, y;
+
+  for (i = 0; i < G_N_ELEMENTS (yuv_formats); i++) {
+    GstVideoFormat from = yuv_formats[i];
+    gint xshift = TEST_WIDTH >
+        gst_video_format_get_component_width (from, 1, TEST_WIDTH) ? 1 : 0;
+    gint yshift = TEST_HEIGHT >
+        gst_video_format_get_component_height (from, 1, TEST_HEIGHT) ? 1 : 0;
+
+    for (j = 0; j < G_N_ELEMENTS (rgb_formats); j++) {
+      GstVideoFormat to = rgb_formats[j];
+      GstBuffer *outbuf;
+
+      GST_DEBUG ("converting %" GST_FOURCC_FORMAT " to format %d",
+          GST_FOURCC_ARGS (gst_video_format_to_fourcc (from)), to);
+      outbuf = convert_frame (create_yuv_frame (from), to);
+
+      for (y = 0; y < TEST_HEIGHT; y++) {
+        for (x = 0; x < TEST_WIDTH; x++) {
+          guint8 r, g, b;
+
+          yuv_to_rgb (yuv_pattern (0, x, y),
+              yuv_pattern (1, x >> xshift, y >> yshift),
+              yuv_pattern (2, x >> xshift, y >> yshift), &r, &g, &b);
+          fail_unless_equals_int (*component_pixel (outbuf, to, 0, x, y), r);
+          fail_unless_equals_int (*component_pixel (outbuf, to, 1, x, y), g);
+          fail_unless_equals_int (*component_pixel (outbuf, to, 2, x, y), b);
+        }
+      }
+      gst_buffer_unref (outbuf);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_yuv_round_trip)
+{
+  static const GstVideoFormat formats[] = {
+    GST_VIDEO_FORMAT_YV12, GST_VIDEO_FORMAT_NV12, GST_VIDEO_FORMAT_YUY2,
+    GST_VIDEO_FORMAT_UYVY, GST_VIDEO_FORMAT_AYUV
+  };
+  gint i, comp, x, y;
+
+  /* these keep all the samples of I420 */
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    GstBuffer *buf;
+
+    buf = convert_frame (create_yuv_frame (GST_VIDEO_FORMAT_I420), formats[i]);
+    buf = convert_frame (buf, GST_VIDEO_FORMAT_I420);
+
+    for (comp = 0; comp < 3; comp++) {
+      for (y = 0; y < gst_video_format_get_component_height
+          (GST_VIDEO_FORMAT_I420, comp, TEST_HEIGHT); y++) {
+        for (x = 0; x < gst_video_format_get_component_width
+            (GST_VIDEO_FORMAT_I420, comp, TEST_WIDTH); x++) {
+          fail_unless_equals_int (*component_pixel (buf,
+                  GST_VIDEO_FORMAT_I420, comp, x, y), yuv_pattern (comp, x,
+                  y));
+        }
+      }
+    }
+    gst_buffer_unref (buf);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 ffmpegcolorspace_suite (void)
 {
@@ -430,8 +628,9 @@ ffmpegcolorspace_suite (void)
   }
 #endif
 
-  /* FIXME: add tests for YUV <=> YUV and YUV <=> RGB */
   tcase_add_test (tc_chain, test_rgb_to_rgb);
+  tcase_add_test (tc_chain, test_yuv_to_rgb);
+  tcase_add_test (tc_chain, test_yuv_round_trip);
 
   return s;
 }
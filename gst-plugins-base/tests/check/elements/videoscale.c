@@ -89,7 +89,7 @@ on_sink_handoff (GstElement * element, GstBuffer * buffer, GstPad * pad,
 
 static void
 run_test (const GstCaps * caps, gint src_width, gint src_height,
-    gint dest_width, gint dest_height, gint method,
+    gint dest_width, gint dest_height, gint method, guint n_threads,
     GCallback src_handoff, gpointer src_handoff_user_data,
     GCallback sink_handoff, gpointer sink_handoff_user_data)
 {
@@ -126,7 +126,8 @@ run_test (const GstCaps * caps, gint src_width, gint src_height,
 
   scale = gst_element_factory_make ("videoscale", "scale");
   fail_unless (scale != NULL);
-  g_object_set (G_OBJECT (scale), "method", method, NULL);
+  g_object_set (G_OBJECT (scale), "method", method, "n-threads", n_threads,
+      NULL);
 
   capsfilter2 = gst_element_factory_make ("capsfilter", "filter2");
   fail_unless (capsfilter2 != NULL);
@@ -209,12 +210,12 @@ GST_START_TEST (test_passthrough)
   while (*p) {
     GstCaps *caps = *p;
 
-    for (method = 0; method < 3; method++) {
+    for (method = 0; method < 4; method++) {
       GST_DEBUG ("Running test for caps '%" GST_PTR_FORMAT "'"
           " from %dx%u to %dx%d with method %d", caps, src_width, src_height,
           dest_width, dest_height, method);
       run_test (caps, src_width, src_height,
-          dest_width, dest_height, method,
+          dest_width, dest_height, method, 1,
           G_CALLBACK (on_src_handoff_passthrough), &src_buffers,
           G_CALLBACK (on_sink_handoff_passthrough), &sink_buffers);
 
@@ -247,6 +248,61 @@ GST_START_TEST (test_passthrough)
 
 GST_END_TEST;
 
+GST_START_TEST (test_n_threads)
+{
+  GList *l1, *l2, *serial_buffers = NULL, *threaded_buffers = NULL;
+  GstCaps **allowed_caps = NULL, **p;
+  gint method;
+  static const gint src_width = 640, src_height = 480;
+  static const gint dest_width = 321, dest_height = 241;
+
+  p = allowed_caps = videoscale_get_allowed_caps ();
+
+  while (*p) {
+    GstCaps *caps = *p;
+
+    for (method = 0; method < 4; method++) {
+      GST_DEBUG ("Running test for caps '%" GST_PTR_FORMAT "'"
+          " from %dx%u to %dx%d with method %d", caps, src_width, src_height,
+          dest_width, dest_height, method);
+      run_test (caps, src_width, src_height,
+          dest_width, dest_height, method, 1, NULL, NULL,
+          G_CALLBACK (on_sink_handoff_passthrough), &serial_buffers);
+      run_test (caps, src_width, src_height,
+          dest_width, dest_height, method, 4, NULL, NULL,
+          G_CALLBACK (on_sink_handoff_passthrough), &threaded_buffers);
+
+      fail_unless (serial_buffers && threaded_buffers);
+      fail_unless_equals_int (g_list_length (serial_buffers),
+          g_list_length (threaded_buffers));
+
+      /* scaling in bands must give exactly the same output */
+      for (l1 = serial_buffers, l2 = threaded_buffers; l1 && l2;
+          l1 = l1->next, l2 = l2->next) {
+        GstBuffer *a = l1->data;
+        GstBuffer *b = l2->data;
+
+        fail_unless_equals_int (GST_BUFFER_SIZE (a), GST_BUFFER_SIZE (b));
+        fail_unless (memcmp (GST_BUFFER_DATA (a), GST_BUFFER_DATA (b),
+                GST_BUFFER_SIZE (a)) == 0);
+
+        gst_buffer_unref (a);
+        gst_buffer_unref (b);
+      }
+      g_list_free (serial_buffers);
+      serial_buffers = NULL;
+      g_list_free (threaded_buffers);
+      threaded_buffers = NULL;
+    }
+
+    gst_caps_unref (caps);
+    p++;
+  }
+  g_free (allowed_caps);
+}
+
+GST_END_TEST;
+
 #define CREATE_TEST(name,method,src_width,src_height,dest_width,dest_height) \
 GST_START_TEST (name) \
 { \
@@ -261,7 +317,7 @@ GST_START_TEST (name) \
         " from %dx%u to %dx%d with method %d", caps, src_width, src_height, \
         dest_width, dest_height, method); \
     run_test (caps, src_width, src_height, \
-        dest_width, dest_height, method, \
+        dest_width, dest_height, method, 1, \
         NULL, NULL, NULL, NULL); \
     \
     gst_caps_unref (caps); \
@@ -275,39 +331,51 @@ GST_END_TEST;
 CREATE_TEST (test_downscale_640x480_320x240_method_0, 0, 640, 480, 320, 240);
 CREATE_TEST (test_downscale_640x480_320x240_method_1, 1, 640, 480, 320, 240);
 CREATE_TEST (test_downscale_640x480_320x240_method_2, 2, 640, 480, 320, 240);
+CREATE_TEST (test_downscale_640x480_320x240_method_3, 3, 640, 480, 320, 240);
 CREATE_TEST (test_upscale_320x240_640x480_method_0, 0, 320, 240, 640, 480);
 CREATE_TEST (test_upscale_320x240_640x480_method_1, 1, 320, 240, 640, 480);
 CREATE_TEST (test_upscale_320x240_640x480_method_2, 2, 320, 240, 640, 480);
+CREATE_TEST (test_upscale_320x240_640x480_method_3, 3, 320, 240, 640, 480);
 CREATE_TEST (test_downscale_640x480_1x1_method_0, 0, 640, 480, 1, 1);
 CREATE_TEST (test_downscale_640x480_1x1_method_1, 1, 640, 480, 1, 1);
 CREATE_TEST (test_downscale_640x480_1x1_method_2, 2, 640, 480, 1, 1);
+CREATE_TEST (test_downscale_640x480_1x1_method_3, 3, 640, 480, 1, 1);
 CREATE_TEST (test_upscale_1x1_640x480_method_0, 0, 1, 1, 640, 480);
 CREATE_TEST (test_upscale_1x1_640x480_method_1, 1, 1, 1, 640, 480);
 CREATE_TEST (test_upscale_1x1_640x480_method_2, 2, 1, 1, 640, 480);
+CREATE_TEST (test_upscale_1x1_640x480_method_3, 3, 1, 1, 640, 480);
 CREATE_TEST (test_downscale_641x481_111x30_method_0, 0, 641, 481, 111, 30);
 CREATE_TEST (test_downscale_641x481_111x30_method_1, 1, 641, 481, 111, 30);
 CREATE_TEST (test_downscale_641x481_111x30_method_2, 2, 641, 481, 111, 30);
+CREATE_TEST (test_downscale_641x481_111x30_method_3, 3, 641, 481, 111, 30);
 CREATE_TEST (test_upscale_111x30_641x481_method_0, 0, 111, 30, 641, 481);
 CREATE_TEST (test_upscale_111x30_641x481_method_1, 1, 111, 30, 641, 481);
 CREATE_TEST (test_upscale_111x30_641x481_method_2, 2, 111, 30, 641, 481);
+CREATE_TEST (test_upscale_111x30_641x481_method_3, 3, 111, 30, 641, 481);
 CREATE_TEST (test_downscale_641x481_30x111_method_0, 0, 641, 481, 30, 111);
 CREATE_TEST (test_downscale_641x481_30x111_method_1, 1, 641, 481, 30, 111);
 CREATE_TEST (test_downscale_641x481_30x111_method_2, 2, 641, 481, 30, 111);
+CREATE_TEST (test_downscale_641x481_30x111_method_3, 3, 641, 481, 30, 111);
 CREATE_TEST (test_upscale_30x111_641x481_method_0, 0, 30, 111, 641, 481);
 CREATE_TEST (test_upscale_30x111_641x481_method_1, 1, 30, 111, 641, 481);
 CREATE_TEST (test_upscale_30x111_641x481_method_2, 2, 30, 111, 641, 481);
+CREATE_TEST (test_upscale_30x111_641x481_method_3, 3, 30, 111, 641, 481);
 CREATE_TEST (test_downscale_640x480_320x1_method_0, 0, 640, 480, 320, 1);
 CREATE_TEST (test_downscale_640x480_320x1_method_1, 1, 640, 480, 320, 1);
 CREATE_TEST (test_downscale_640x480_320x1_method_2, 2, 640, 480, 320, 1);
+CREATE_TEST (test_downscale_640x480_320x1_method_3, 3, 640, 480, 320, 1);
 CREATE_TEST (test_upscale_320x1_640x480_method_0, 0, 320, 1, 640, 480);
 CREATE_TEST (test_upscale_320x1_640x480_method_1, 1, 320, 1, 640, 480);
 CREATE_TEST (test_upscale_320x1_640x480_method_2, 2, 320, 1, 640, 480);
+CREATE_TEST (test_upscale_320x1_640x480_method_3, 3, 320, 1, 640, 480);
 CREATE_TEST (test_downscale_640x480_1x240_method_0, 0, 640, 480, 1, 240);
 CREATE_TEST (test_downscale_640x480_1x240_method_1, 1, 640, 480, 1, 240);
 CREATE_TEST (test_downscale_640x480_1x240_method_2, 2, 640, 480, 1, 240);
+CREATE_TEST (test_downscale_640x480_1x240_method_3, 3, 640, 480, 1, 240);
 CREATE_TEST (test_upscale_1x240_640x480_method_0, 0, 1, 240, 640, 480);
 CREATE_TEST (test_upscale_1x240_640x480_method_1, 1, 1, 240, 640, 480);
 CREATE_TEST (test_upscale_1x240_640x480_method_2, 2, 1, 240, 640, 480);
+CREATE_TEST (test_upscale_1x240_640x480_method_3, 3, 1, 240, 640, 480);
 
 static Suite *
 videoscale_suite (void)
@@ -318,42 +386,55 @@ videoscale_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_passthrough);
+  tcase_add_test (tc_chain, test_n_threads);
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_0);
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_1);
   tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_2);
+  tcase_add_test (tc_chain, test_downscale_640x480_320x240_method_3);
   tcase_add_test (tc_chain, test_upscale_320x240_640x480_method_0);
   tcase_add_test (tc_chain, test_upscale_320x240_640x480_method_1);
   tcase_add_test (tc_chain, test_upscale_320x240_640x480_method_2);
+  tcase_add_test (tc_chain, test_upscale_320x240_640x480_method_3);
   tcase_add_test (tc_chain, test_downscale_640x480_1x1_method_0);
   tcase_add_test (tc_chain, test_downscale_640x480_1x1_method_1);
   tcase_add_test (tc_chain, test_downscale_640x480_1x1_method_2);
+  tcase_add_test (tc_chain, test_downscale_640x480_1x1_method_3);
   tcase_add_test (tc_chain, test_upscale_1x1_640x480_method_0);
   tcase_add_test (tc_chain, test_upscale_1x1_640x480_method_1);
   tcase_add_test (tc_chain, test_upscale_1x1_640x480_method_2);
+  tcase_add_test (tc_chain, test_upscale_1x1_640x480_method_3);
   tcase_add_test (tc_chain, test_downscale_641x481_111x30_method_0);
   tcase_add_test (tc_chain, test_downscale_641x481_111x30_method_1);
   tcase_add_test (tc_chain, test_downscale_641x481_111x30_method_2);
+  tcase_add_test (tc_chain, test_downscale_641x481_111x30_method_3);
   tcase_add_test (tc_chain, test_upscale_111x30_641x481_method_0);
   tcase_add_test (tc_chain, test_upscale_111x30_641x481_method_1);
   tcase_add_test (tc_chain, test_upscale_111x30_641x481_method_2);
+  tcase_add_test (tc_chain, test_upscale_111x30_641x481_method_3);
   tcase_add_test (tc_chain, test_downscale_641x481_30x111_method_0);
   tcase_add_test (tc_chain, test_downscale_641x481_30x111_method_1);
   tcase_add_test (tc_chain, test_downscale_641x481_30x111_method_2);
+  tcase_add_test (tc_chain, test_downscale_641x481_30x111_method_3);
   tcase_add_test (tc_chain, test_upscale_30x111_641x481_method_0);
   tcase_add_test (tc_chain, test_upscale_30x111_641x481_method_1);
   tcase_add_test (tc_chain, test_upscale_30x111_641x481_method_2);
+  tcase_add_test (tc_chain, test_upscale_30x111_641x481_method_3);
   tcase_add_test (tc_chain, test_downscale_640x480_320x1_method_0);
   tcase_add_test (tc_chain, test_downscale_640x480_320x1_method_1);
   tcase_add_test (tc_chain, test_downscale_640x480_320x1_method_2);
+  tcase_add_test (tc_chain, test_downscale_640x480_320x1_method_3);
   tcase_add_test (tc_chain, test_upscale_320x1_640x480_method_0);
   tcase_add_test (tc_chain, test_upscale_320x1_640x480_method_1);
   tcase_add_test (tc_chain, test_upscale_320x1_640x480_method_2);
+  tcase_add_test (tc_chain, test_upscale_320x1_640x480_method_3);
   tcase_add_test (tc_chain, test_downscale_640x480_1x240_method_0);
   tcase_add_test (tc_chain, test_downscale_640x480_1x240_method_1);
   tcase_add_test (tc_chain, test_downscale_640x480_1x240_method_2);
+  tcase_add_test (tc_chain, test_downscale_640x480_1x240_method_3);
   tcase_add_test (tc_chain, test_upscale_1x240_640x480_method_0);
   tcase_add_test (tc_chain, test_upscale_1x240_640x480_method_1);
   tcase_add_test (tc_chain, test_upscale_1x240_640x480_method_2);
+  tcase_add_test (tc_chain, test_upscale_1x240_640x480_method_3);
 
   return s;
 }
@@ -0,0 +1,201 @@
+/* GStreamer
+ *
+ * audioconvert-bench.c: time audioconvert for pairs of formats
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes the same buffer through audioconvert many times for every pair of
+ * the formats below and prints the time per buffer as a matrix, with the
+ * source formats as rows. Dithering and noise shaping are disabled so that
+ * the conversions between S16, S32 and F32 and between mono and stereo of
+ * the same format take the direct path. The other formats go through the
+ * generic path for comparison. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+
+#define BUFFER_COUNT 500
+#define BUFFER_SAMPLES 44100
+#define RATE 44100
+
+static const struct
+{
+  gboolean is_int;
+  gint width;
+  gint channels;
+  const gchar *name;
+} formats[] = {
+  {TRUE, 8, 1, "U8/1"},
+  {TRUE, 8, 2, "U8/2"},
+  {TRUE, 16, 1, "S16/1"},
+  {TRUE, 16, 2, "S16/2"},
+  {TRUE, 24, 1, "S24/1"},
+  {TRUE, 24, 2, "S24/2"},
+  {TRUE, 32, 1, "S32/1"},
+  {TRUE, 32, 2, "S32/2"},
+  {FALSE, 32, 1, "F32/1"},
+  {FALSE, 32, 2, "F32/2"},
+  {FALSE, 64, 1, "F64/1"},
+  {FALSE, 64, 2, "F64/2"}
+};
+
+static GstClockTime
+gst_get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return GST_TIMEVAL_TO_TIME (tv);
+}
+
+static GstCaps *
+get_caps (guint format)
+{
+  if (formats[format].is_int)
+    return gst_caps_new_simple ("audio/x-raw-int",
+        "rate", G_TYPE_INT, RATE,
+        "channels", G_TYPE_INT, formats[format].channels,
+        "endianness", G_TYPE_INT, G_BYTE_ORDER,
+        "width", G_TYPE_INT, formats[format].width,
+        "depth", G_TYPE_INT, formats[format].width,
+        "signed", G_TYPE_BOOLEAN, formats[format].width != 8, NULL);
+  else
+    return gst_caps_new_simple ("audio/x-raw-float",
+        "rate", G_TYPE_INT, RATE,
+        "channels", G_TYPE_INT, formats[format].channels,
+        "endianness", G_TYPE_INT, G_BYTE_ORDER,
+        "width", G_TYPE_INT, formats[format].width, NULL);
+}
+
+static GstFlowReturn
+chain_func (GstPad * pad, GstBuffer * buf)
+{
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+/* returns the time per buffer, or GST_CLOCK_TIME_NONE if audioconvert does
+ * not do the conversion */
+static GstClockTime
+run (guint from, guint to, guint samples, guint buffers)
+{
+  GstElement *convert;
+  GstPad *srcpad, *sinkpad, *convert_sink, *convert_src;
+  GstCaps *from_caps, *to_caps;
+  GstBuffer *buf;
+  GstClockTime start, end;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  convert = gst_element_factory_make ("audioconvert", NULL);
+  g_assert (convert != NULL);
+  g_object_set (convert, "dithering", 0, "noise-shaping", 0, NULL);
+
+  from_caps = get_caps (from);
+  to_caps = get_caps (to);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain_func);
+  /* make audioconvert pick the destination format */
+  gst_pad_use_fixed_caps (sinkpad);
+  gst_pad_set_caps (sinkpad, to_caps);
+
+  convert_sink = gst_element_get_static_pad (convert, "sink");
+  convert_src = gst_element_get_static_pad (convert, "src");
+  if (gst_pad_link (srcpad, convert_sink) != GST_PAD_LINK_OK ||
+      gst_pad_link (convert_src, sinkpad) != GST_PAD_LINK_OK)
+    g_assert_not_reached ();
+  gst_object_unref (convert_sink);
+  gst_object_unref (convert_src);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  if (gst_element_set_state (convert,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    g_assert_not_reached ();
+
+  buf = gst_buffer_new_and_alloc (samples * formats[from].channels *
+      formats[from].width / 8);
+  memset (GST_BUFFER_DATA (buf), 0x10, GST_BUFFER_SIZE (buf));
+  gst_buffer_set_caps (buf, from_caps);
+
+  start = gst_get_current_time ();
+  for (i = 0; i < buffers && ret == GST_FLOW_OK; i++)
+    ret = gst_pad_push (srcpad, gst_buffer_ref (buf));
+  end = gst_get_current_time ();
+
+  gst_buffer_unref (buf);
+  gst_element_set_state (convert, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (convert);
+  gst_caps_unref (from_caps);
+  gst_caps_unref (to_caps);
+
+  if (ret != GST_FLOW_OK || buffers == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return (end - start) / buffers;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint buffers = BUFFER_COUNT, samples = BUFFER_SAMPLES;
+  guint from, to;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    buffers = atoi (argv[1]);
+  if (argc > 2)
+    samples = atoi (argv[2]);
+
+  g_print ("*** audioconvert, %u samples per buffer, microseconds per buffer "
+      "over %u buffers\n\n", samples, buffers);
+
+  g_print ("from\\to");
+  for (to = 0; to < G_N_ELEMENTS (formats); to++)
+    g_print (" %6s", formats[to].name);
+  g_print ("\n");
+
+  for (from = 0; from < G_N_ELEMENTS (formats); from++) {
+    g_print ("%-7s", formats[from].name);
+    for (to = 0; to < G_N_ELEMENTS (formats); to++) {
+      GstClockTime t;
+
+      if (from == to) {
+        g_print (" %6s", "-");
+        continue;
+      }
+      t = run (from, to, samples, buffers);
+      if (GST_CLOCK_TIME_IS_VALID (t))
+        g_print (" %6" G_GUINT64_FORMAT, t / GST_USECOND);
+      else
+        g_print (" %6s", "n/a");
+    }
+    g_print ("\n");
+  }
+
+  return 0;
+}
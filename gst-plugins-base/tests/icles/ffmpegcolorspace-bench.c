@@ -0,0 +1,183 @@
+/* GStreamer
+ *
+ * ffmpegcolorspace-bench.c: time ffmpegcolorspace for pairs of formats
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Pushes the same frame through ffmpegcolorspace many times for every pair
+ * of the formats below and prints the time per frame as a matrix, with the
+ * source formats as rows. Only the conversion and the allocation of the
+ * output buffers is measured. Run it with OIL_CPU_FLAGS=0 in the
+ * environment to time the C routines on a CPU with SIMD routines. */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+#define FRAME_COUNT 200
+#define FRAME_WIDTH 1280
+#define FRAME_HEIGHT 720
+
+static const struct
+{
+  GstVideoFormat format;
+  const gchar *name;
+} formats[] = {
+  {GST_VIDEO_FORMAT_I420, "I420"},
+  {GST_VIDEO_FORMAT_YV12, "YV12"},
+  {GST_VIDEO_FORMAT_NV12, "NV12"},
+  {GST_VIDEO_FORMAT_YUY2, "YUY2"},
+  {GST_VIDEO_FORMAT_UYVY, "UYVY"},
+  {GST_VIDEO_FORMAT_AYUV, "AYUV"},
+  {GST_VIDEO_FORMAT_BGRx, "BGRx"},
+  {GST_VIDEO_FORMAT_RGBx, "RGBx"},
+  {GST_VIDEO_FORMAT_xRGB, "xRGB"},
+  {GST_VIDEO_FORMAT_xBGR, "xBGR"},
+  {GST_VIDEO_FORMAT_BGRA, "BGRA"},
+  {GST_VIDEO_FORMAT_ARGB, "ARGB"}
+};
+
+static GstClockTime
+gst_get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return GST_TIMEVAL_TO_TIME (tv);
+}
+
+static GstFlowReturn
+chain_func (GstPad * pad, GstBuffer * buf)
+{
+  gst_buffer_unref (buf);
+
+  return GST_FLOW_OK;
+}
+
+/* returns the time per frame, or GST_CLOCK_TIME_NONE if ffmpegcolorspace
+ * does not do the conversion */
+static GstClockTime
+run (GstVideoFormat from, GstVideoFormat to, gint width, gint height,
+    guint frames)
+{
+  GstElement *csp;
+  GstPad *srcpad, *sinkpad, *csp_sink, *csp_src;
+  GstCaps *from_caps, *to_caps;
+  GstBuffer *buf;
+  GstClockTime start, end;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  csp = gst_element_factory_make ("ffmpegcolorspace", NULL);
+  g_assert (csp != NULL);
+
+  from_caps = gst_video_format_new_caps (from, width, height, 25, 1, 1, 1);
+  to_caps = gst_video_format_new_caps (to, width, height, 25, 1, 1, 1);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, chain_func);
+  /* make ffmpegcolorspace pick the destination format */
+  gst_pad_use_fixed_caps (sinkpad);
+  gst_pad_set_caps (sinkpad, to_caps);
+
+  csp_sink = gst_element_get_static_pad (csp, "sink");
+  csp_src = gst_element_get_static_pad (csp, "src");
+  if (gst_pad_link (srcpad, csp_sink) != GST_PAD_LINK_OK ||
+      gst_pad_link (csp_src, sinkpad) != GST_PAD_LINK_OK)
+    g_assert_not_reached ();
+  gst_object_unref (csp_sink);
+  gst_object_unref (csp_src);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  if (gst_element_set_state (csp,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    g_assert_not_reached ();
+
+  buf = gst_buffer_new_and_alloc (gst_video_format_get_size (from, width,
+          height));
+  memset (GST_BUFFER_DATA (buf), 0x80, GST_BUFFER_SIZE (buf));
+  gst_buffer_set_caps (buf, from_caps);
+
+  start = gst_get_current_time ();
+  for (i = 0; i < frames && ret == GST_FLOW_OK; i++)
+    ret = gst_pad_push (srcpad, gst_buffer_ref (buf));
+  end = gst_get_current_time ();
+
+  gst_buffer_unref (buf);
+  gst_element_set_state (csp, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (csp);
+  gst_caps_unref (from_caps);
+  gst_caps_unref (to_caps);
+
+  if (ret != GST_FLOW_OK || frames == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return (end - start) / frames;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint frames = FRAME_COUNT, width = FRAME_WIDTH, height = FRAME_HEIGHT;
+  guint from, to;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    frames = atoi (argv[1]);
+  if (argc > 3) {
+    width = atoi (argv[2]);
+    height = atoi (argv[3]);
+  }
+
+  g_print ("*** ffmpegcolorspace, %ux%u, microseconds per frame over %u "
+      "frames\n\n", width, height, frames);
+
+  g_print ("from\\to");
+  for (to = 0; to < G_N_ELEMENTS (formats); to++)
+    g_print (" %6s", formats[to].name);
+  g_print ("\n");
+
+  for (from = 0; from < G_N_ELEMENTS (formats); from++) {
+    g_print ("%-7s", formats[from].name);
+    for (to = 0; to < G_N_ELEMENTS (formats); to++) {
+      GstClockTime t;
+
+      if (from == to) {
+        g_print (" %6s", "-");
+        continue;
+      }
+      t = run (formats[from].format, formats[to].format, width, height,
+          frames);
+      if (GST_CLOCK_TIME_IS_VALID (t))
+        g_print (" %6" G_GUINT64_FORMAT, t / GST_USECOND);
+      else
+        g_print (" %6s", "n/a");
+    }
+    g_print ("\n");
+  }
+
+  return 0;
+}
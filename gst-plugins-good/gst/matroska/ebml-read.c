@@ -100,10 +100,25 @@ GDOUBLE_SWAP_LE_BE(gdouble in)
 GST_DEBUG_CATEGORY_STATIC (ebmlread_debug);
 #define GST_CAT_DEFAULT ebmlread_debug
 
+/* in pull mode, upstream is read in chunks of at least this many bytes, to
+ * avoid pulling buffers of a few bytes all the time */
+#define DEFAULT_READ_AHEAD (64 * 1024)
+
+enum
+{
+  PROP_0,
+  PROP_READ_AHEAD
+};
+
 static void gst_ebml_read_class_init (GstEbmlReadClass * klass);
 
 static void gst_ebml_read_init (GstEbmlRead * ebml);
 
+static void gst_ebml_read_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_ebml_read_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+
 static GstStateChangeReturn gst_ebml_read_change_state (GstElement * element,
     GstStateChange transition);
 
@@ -176,6 +191,14 @@ gst_ebml_read_class_init (GstEbmlReadClass * klass)
       0, "EBML stream helper class");
 
   gobject_class->finalize = gst_ebml_finalize;
+  gobject_class->set_property = gst_ebml_read_set_property;
+  gobject_class->get_property = gst_ebml_read_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD,
+      g_param_spec_uint ("read-ahead", "Read ahead",
+          "Minimum number of bytes to pull at once in pull mode",
+          1, G_MAXINT, DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_ebml_read_change_state);
@@ -186,6 +209,43 @@ gst_ebml_read_init (GstEbmlRead * ebml)
 {
   ebml->sinkpad = NULL;
   ebml->level = NULL;
+  ebml->read_ahead = DEFAULT_READ_AHEAD;
+}
+
+static void
+gst_ebml_read_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstEbmlRead *ebml = GST_EBML_READ (object);
+
+  switch (prop_id) {
+    case PROP_READ_AHEAD:
+      GST_OBJECT_LOCK (ebml);
+      ebml->read_ahead = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (ebml);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_ebml_read_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstEbmlRead *ebml = GST_EBML_READ (object);
+
+  switch (prop_id) {
+    case PROP_READ_AHEAD:
+      GST_OBJECT_LOCK (ebml);
+      g_value_set_uint (value, ebml->read_ahead);
+      GST_OBJECT_UNLOCK (ebml);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static GstStateChangeReturn
@@ -285,6 +345,7 @@ gst_ebml_read_peek_bytes (GstEbmlRead * ebml, guint size, GstBuffer ** p_buf,
     guint8 ** bytes)
 {
   GstFlowReturn ret;
+  guint read_ahead;
 
   /* Caching here actually makes much less difference than one would expect.
    * We do it mainly to avoid pulling buffers of 1 byte all the time */
@@ -315,7 +376,11 @@ gst_ebml_read_peek_bytes (GstEbmlRead * ebml, guint size, GstBuffer ** p_buf,
   }
 
   /* refill the cache */
-  ret = gst_pad_pull_range (ebml->sinkpad, ebml->offset, MAX (size, 64 * 1024),
+  GST_OBJECT_LOCK (ebml);
+  read_ahead = ebml->read_ahead;
+  GST_OBJECT_UNLOCK (ebml);
+
+  ret = gst_pad_pull_range (ebml->sinkpad, ebml->offset, MAX (size, read_ahead),
       &ebml->cached_buffer);
   if (ret != GST_FLOW_OK) {
     ebml->cached_buffer = NULL;
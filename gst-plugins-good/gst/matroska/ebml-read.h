@@ -61,6 +61,9 @@ typedef struct _GstEbmlRead {
   guint64 offset;
 
   GList *level;
+
+  /* minimum size of the pulls in pull mode, protected by the object lock */
+  guint read_ahead;
 } GstEbmlRead;
 
 typedef struct _GstEbmlReadClass {
@@ -320,6 +320,10 @@ static GstCaps
 
 /* stream methods */
 static void gst_matroska_demux_reset (GstElement * element);
+static gboolean gst_matroska_demux_seek_push_to_offset (GstMatroskaDemux *
+    demux, GstEvent * event, guint64 offset);
+static void gst_matroska_demux_commit_seek_push (GstMatroskaDemux * demux,
+    GstEvent * event, GstClockTime time);
 static gboolean perform_seek_to_offset (GstMatroskaDemux * demux,
     guint64 offset);
 
@@ -363,6 +367,11 @@ gst_matroska_demux_finalize (GObject * object)
   }
 #endif /* OPERA_MINIMAL_GST */
 
+  if (demux->cluster_index) {
+    g_array_free (demux->cluster_index, TRUE);
+    demux->cluster_index = NULL;
+  }
+
   g_object_unref (demux->adapter);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -538,6 +547,11 @@ gst_matroska_demux_reset (GstElement * element)
     g_array_free (demux->index, TRUE);
     demux->index = NULL;
   }
+  if (demux->cluster_index) {
+    g_array_free (demux->cluster_index, TRUE);
+    demux->cluster_index = NULL;
+  }
+  demux->cluster_entry = -1;
 
   /* reset timers */
   demux->clock = NULL;
@@ -2058,6 +2072,10 @@ gst_matroska_demux_add_stream (GstMatroskaDemux * demux)
   gst_pad_set_element_private (context->pad, context);
 
   gst_pad_use_fixed_caps (context->pad);
+#ifdef GST_PAD_ALLOC_POOLED
+  /* for the buffers we allocate ourselves (headers, reassembled frames) */
+  GST_OBJECT_FLAG_SET (context->pad, GST_PAD_ALLOC_POOLED);
+#endif
   gst_pad_set_caps (context->pad, context->caps);
   gst_pad_set_active (context->pad, TRUE);
   gst_element_add_pad (GST_ELEMENT (demux), context->pad);
@@ -2241,6 +2259,128 @@ gst_matroskademux_do_index_seek (GstMatroskaDemux * demux,
   return entry;
 }
 
+static gint
+gst_matroska_cluster_entry_pos_find (GstMatroskaClusterEntry * e,
+    guint64 * pos, gpointer user_data)
+{
+  if (e->pos < *pos)
+    return -1;
+  else if (e->pos > *pos)
+    return 1;
+  else
+    return 0;
+}
+
+static gint
+gst_matroska_cluster_entry_time_find (GstMatroskaClusterEntry * e,
+    GstClockTime * time, gpointer user_data)
+{
+  if (e->time < *time)
+    return -1;
+  else if (e->time > *time)
+    return 1;
+  else
+    return 0;
+}
+
+/* Remembers the cluster at @pos (relative to the segment start) starting at
+ * @time, in push mode. Clusters are kept sorted, and each entry knows whether
+ * the following one is the next cluster in the file, so that the index can
+ * tell which time ranges it covers completely, even when it was built from
+ * several pieces of the file with seeks in between. The entries also go to
+ * the element index, if there is one. */
+static void
+gst_matroska_demux_index_cluster (GstMatroskaDemux * demux, guint64 pos,
+    GstClockTime time)
+{
+  GstMatroskaClusterEntry *entry;
+  GstMatroskaClusterEntry new_entry;
+  gboolean added = FALSE;
+  guint idx;
+
+  GST_OBJECT_LOCK (demux);
+  if (G_UNLIKELY (demux->cluster_index == NULL))
+    demux->cluster_index =
+        g_array_sized_new (FALSE, FALSE, sizeof (GstMatroskaClusterEntry),
+        256);
+
+  /* usually the cluster goes at the end */
+  entry = NULL;
+  if (demux->cluster_index->len > 0) {
+    entry = &g_array_index (demux->cluster_index, GstMatroskaClusterEntry,
+        demux->cluster_index->len - 1);
+    if (entry->pos < pos) {
+      entry = NULL;
+    } else {
+      entry = gst_util_array_binary_search (demux->cluster_index->data,
+          demux->cluster_index->len, sizeof (GstMatroskaClusterEntry),
+          (GCompareDataFunc) gst_matroska_cluster_entry_pos_find,
+          GST_SEARCH_MODE_AFTER, &pos, NULL);
+    }
+  }
+
+  if (entry && entry->pos == pos) {
+    idx = entry - (GstMatroskaClusterEntry *) demux->cluster_index->data;
+  } else {
+    idx = entry ? entry - (GstMatroskaClusterEntry *) demux->cluster_index->data
+        : demux->cluster_index->len;
+    new_entry.pos = pos;
+    new_entry.time = time;
+    new_entry.contiguous = FALSE;
+    g_array_insert_val (demux->cluster_index, idx, new_entry);
+    if (demux->cluster_entry >= (gint) idx)
+      demux->cluster_entry++;
+    added = TRUE;
+  }
+
+  /* we came here straight from the previous entry */
+  if (demux->cluster_entry >= 0 && (guint) demux->cluster_entry + 1 == idx)
+    g_array_index (demux->cluster_index, GstMatroskaClusterEntry,
+        demux->cluster_entry).contiguous = TRUE;
+  demux->cluster_entry = idx;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (!added)
+    return;
+
+  GST_LOG_OBJECT (demux, "indexed cluster at %" G_GUINT64_FORMAT " time %"
+      GST_TIME_FORMAT ", %u clusters known", pos, GST_TIME_ARGS (time),
+      demux->cluster_index->len);
+
+  if (demux->element_index) {
+    if (demux->element_index_writer_id == -1)
+      gst_index_get_writer_id (demux->element_index,
+          GST_OBJECT (demux), &demux->element_index_writer_id);
+
+    gst_index_add_association (demux->element_index,
+        demux->element_index_writer_id, GST_ASSOCIATION_FLAG_KEY_UNIT,
+        GST_FORMAT_TIME, time, GST_FORMAT_BYTES,
+        pos + demux->ebml_segment_start, NULL);
+  }
+}
+
+/* Looks for the cluster containing @time among the clusters passed so far.
+ * Only succeeds if the cluster following it was seen as well, otherwise the
+ * cluster might end before @time. Must be called with the object lock. */
+static GstMatroskaClusterEntry *
+gst_matroska_demux_find_cluster (GstMatroskaDemux * demux, GstClockTime time)
+{
+  GstMatroskaClusterEntry *entry;
+
+  if (!demux->cluster_index || !demux->cluster_index->len)
+    return NULL;
+
+  entry = gst_util_array_binary_search (demux->cluster_index->data,
+      demux->cluster_index->len, sizeof (GstMatroskaClusterEntry),
+      (GCompareDataFunc) gst_matroska_cluster_entry_time_find,
+      GST_SEARCH_MODE_BEFORE, &time, NULL);
+
+  if (entry == NULL || (!entry->contiguous && entry->time != time))
+    return NULL;
+
+  return entry;
+}
+
 #ifndef OPERA_MINIMAL_GST
 /* takes ownership of taglist */
 static void
@@ -2478,7 +2618,7 @@ gst_matroska_demux_handle_seek_event (GstMatroskaDemux * demux,
     /* need to seek to cluster start to pick up cluster time */
     /* upstream takes care of flushing and all that
      * ... and newsegment event handling takes care of the rest */
-    return perform_seek_to_offset (demux,
+    return gst_matroska_demux_seek_push_to_offset (demux, event,
         entry->pos + demux->ebml_segment_start);
   }
 
@@ -2613,6 +2753,23 @@ gst_matroska_demux_handle_seek_push (GstMatroskaDemux * demux, GstPad * pad,
     return FALSE;
   }
 
+  /* go straight to clusters we have passed already */
+  if (!demux->index_parsed && cur_type == GST_SEEK_TYPE_SET && cur >= 0) {
+    GstMatroskaClusterEntry *entry;
+    guint64 offset = 0;
+
+    GST_OBJECT_LOCK (demux);
+    if ((entry = gst_matroska_demux_find_cluster (demux, cur)))
+      offset = entry->pos + demux->ebml_segment_start;
+    GST_OBJECT_UNLOCK (demux);
+
+    if (entry) {
+      GST_INFO_OBJECT (demux, "Seeking to known cluster at %" G_GUINT64_FORMAT,
+          offset);
+      return gst_matroska_demux_seek_push_to_offset (demux, event, offset);
+    }
+  }
+
   /* check for having parsed index already */
   if (!demux->index_parsed) {
     gboolean building_index;
@@ -4818,17 +4975,32 @@ gst_matroska_demux_parse_blockgroup_or_simpleblock (GstMatroskaDemux * demux,
 
     /* need to refresh segment info ASAP */
     if (GST_CLOCK_TIME_IS_VALID (lace_time) && demux->need_newsegment) {
-      GST_DEBUG_OBJECT (demux,
-          "generating segment starting at %" GST_TIME_FORMAT,
-          GST_TIME_ARGS (lace_time));
-      /* pretend we seeked here */
-      gst_segment_set_seek (&demux->segment, demux->segment.rate,
-          GST_FORMAT_TIME, 0, GST_SEEK_TYPE_SET, lace_time,
-          GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE, NULL);
-      /* now convey our segment notion downstream */
-      gst_matroska_demux_send_event (demux, gst_event_new_new_segment (FALSE,
-              demux->segment.rate, demux->segment.format, demux->segment.start,
-              demux->segment.stop, demux->segment.start));
+      GstEvent *seek_event = NULL;
+
+      /* a seek of ours brought us here, unless we are still after Cues */
+      GST_OBJECT_LOCK (demux);
+      if (demux->state == GST_MATROSKA_DEMUX_STATE_DATA) {
+        seek_event = demux->seek_event;
+        demux->seek_event = NULL;
+      }
+      GST_OBJECT_UNLOCK (demux);
+
+      if (seek_event) {
+        gst_matroska_demux_commit_seek_push (demux, seek_event, lace_time);
+      } else {
+        GST_DEBUG_OBJECT (demux,
+            "generating segment starting at %" GST_TIME_FORMAT,
+            GST_TIME_ARGS (lace_time));
+        /* pretend we seeked here */
+        gst_segment_set_seek (&demux->segment, demux->segment.rate,
+            GST_FORMAT_TIME, 0, GST_SEEK_TYPE_SET, lace_time,
+            GST_SEEK_TYPE_SET, GST_CLOCK_TIME_NONE, NULL);
+        /* now convey our segment notion downstream */
+        gst_matroska_demux_send_event (demux, gst_event_new_new_segment (FALSE,
+                demux->segment.rate, demux->segment.format,
+                demux->segment.start, demux->segment.stop,
+                demux->segment.start));
+      }
       demux->need_newsegment = FALSE;
     }
 
@@ -5864,6 +6036,76 @@ perform_seek_to_offset (GstMatroskaDemux * demux, guint64 offset)
   return res;
 }
 
+/*
+ * Seek upstream to @offset for the time seek @event in push mode. The segment
+ * of @event is configured when the first block after the seek is parsed, see
+ * gst_matroska_demux_commit_seek_push().
+ */
+static gboolean
+gst_matroska_demux_seek_push_to_offset (GstMatroskaDemux * demux,
+    GstEvent * event, guint64 offset)
+{
+  GST_OBJECT_LOCK (demux);
+  if (demux->seek_event)
+    gst_event_unref (demux->seek_event);
+  demux->seek_event = gst_event_ref (event);
+  GST_OBJECT_UNLOCK (demux);
+
+  if (perform_seek_to_offset (demux, offset))
+    return TRUE;
+
+  GST_OBJECT_LOCK (demux);
+  if (demux->seek_event == event) {
+    gst_event_unref (demux->seek_event);
+    demux->seek_event = NULL;
+  }
+  GST_OBJECT_UNLOCK (demux);
+
+  return FALSE;
+}
+
+/*
+ * Configures the segment of the seek @event that led to a byte seek in push
+ * mode, now that the first block after it starts at @time, and sends it
+ * downstream. Takes ownership of @event.
+ */
+static void
+gst_matroska_demux_commit_seek_push (GstMatroskaDemux * demux,
+    GstEvent * event, GstClockTime time)
+{
+  GstSeekFlags flags;
+  GstSeekType cur_type, stop_type;
+  GstFormat format;
+  gdouble rate;
+  gint64 cur, stop;
+  gboolean update;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &cur_type, &cur,
+      &stop_type, &stop);
+
+  gst_segment_set_seek (&demux->segment, rate, format, flags, cur_type, cur,
+      stop_type, stop, &update);
+
+  /* data starts at the cluster we went to */
+  if ((flags & GST_SEEK_FLAG_KEY_UNIT) || demux->segment.start < time) {
+    GST_DEBUG_OBJECT (demux, "adjusting segment start to %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (time));
+    demux->segment.start = time;
+    demux->segment.last_stop = time;
+    demux->segment.time = time;
+  }
+
+  GST_DEBUG_OBJECT (demux, "Committing seek segment %" GST_SEGMENT_FORMAT,
+      &demux->segment);
+
+  gst_matroska_demux_send_event (demux,
+      gst_event_new_new_segment_full (FALSE, demux->segment.rate,
+          demux->segment.applied_rate, demux->segment.format,
+          demux->segment.start, demux->segment.stop, demux->segment.time));
+
+  gst_event_unref (event);
+}
+
 static void
 gst_matroska_demux_check_seekability (GstMatroskaDemux * demux)
 {
@@ -5927,6 +6169,10 @@ gst_matroska_demux_peek_id_length (GstMatroskaDemux * demux, guint32 * _id,
 {
   guint avail, needed;
   const guint8 *buf;
+#ifdef GST_ADAPTER_HAS_SPANS
+  GstAdapterSpan span;
+  guint8 header[12];
+#endif
   gint len_mask = 0x80, read = 1, n = 1, num_ffs = 0;
   guint64 total;
   guint8 b;
@@ -5945,7 +6191,21 @@ gst_matroska_demux_peek_id_length (GstMatroskaDemux * demux, guint32 * _id,
   if (avail < needed)
     goto exit;
 
+  /* an id and a length take at most 12 bytes. Look at them where they are
+   * if possible, peeking would merge the buffers in the adapter if they
+   * straddle a buffer boundary */
+#ifdef GST_ADAPTER_HAS_SPANS
+  if (gst_adapter_peek_spans (demux->adapter, 0, MIN (avail, 12), &span,
+          1) == 1) {
+    buf = span.data;
+  } else {
+    gst_adapter_copy (demux->adapter, header, 0, MIN (avail, 12));
+    buf = header;
+  }
+#else
   buf = gst_adapter_peek (demux->adapter, 1);
+#endif
+
   b = GST_READ_UINT8 (buf);
 
   total = (guint64) b;
@@ -5959,7 +6219,9 @@ gst_matroska_demux_peek_id_length (GstMatroskaDemux * demux, guint32 * _id,
   if ((needed = read + 1) > avail)
     goto exit;
 
+#ifndef GST_ADAPTER_HAS_SPANS
   buf = gst_adapter_peek (demux->adapter, needed);
+#endif
   while (n < read) {
     b = GST_READ_UINT8 (buf + n);
     total = (total << 8) | b;
@@ -5983,7 +6245,9 @@ gst_matroska_demux_peek_id_length (GstMatroskaDemux * demux, guint32 * _id,
   if ((total &= (len_mask - 1)) == len_mask - 1)
     num_ffs++;
 
+#ifndef GST_ADAPTER_HAS_SPANS
   buf = gst_adapter_peek (demux->adapter, needed);
+#endif
   buf += (needed - read);
   n = 1;
   while (n < read) {
@@ -6041,6 +6305,7 @@ gst_matroska_demux_chain (GstPad * pad, GstBuffer * buffer)
     gst_adapter_clear (demux->adapter);
     GST_OBJECT_LOCK (demux);
     gst_matroska_demux_reset_streams (demux, GST_CLOCK_TIME_NONE, FALSE);
+    demux->cluster_entry = -1;
     GST_OBJECT_UNLOCK (demux);
   }
 
@@ -6135,7 +6400,7 @@ next:
                         0) ? demux->segment.duration : -1, 0));
           }
           demux->cluster_time = GST_CLOCK_TIME_NONE;
-          demux->cluster_offset = demux->parent.offset;
+          demux->cluster_offset = demux->offset;
           /* eat cluster prefix */
           gst_matroska_demux_flush (demux, needed);
           break;
@@ -6148,6 +6413,12 @@ next:
             goto parse_failed;
           GST_DEBUG_OBJECT (demux, "ClusterTimeCode: %" G_GUINT64_FORMAT, num);
           demux->cluster_time = num;
+          if (demux->cluster_offset >= demux->ebml_segment_start &&
+              demux->cluster_offset > 0) {
+            gst_matroska_demux_index_cluster (demux,
+                demux->cluster_offset - demux->ebml_segment_start,
+                num * demux->time_scale);
+          }
           break;
         }
         case GST_MATROSKA_ID_BLOCKGROUP:
@@ -6212,8 +6483,11 @@ next:
 
             g_assert (event);
             /* unlikely to fail, since we managed to seek to this point */
-            if (!gst_matroska_demux_handle_seek_event (demux, NULL, event))
+            if (!gst_matroska_demux_handle_seek_event (demux, NULL, event)) {
+              gst_event_unref (event);
               goto seek_failed;
+            }
+            gst_event_unref (event);
             /* resume data handling, main thread clear to seek again */
             GST_OBJECT_LOCK (demux);
             demux->state = GST_MATROSKA_DEMUX_STATE_DATA;
@@ -6312,6 +6586,7 @@ gst_matroska_demux_handle_sink_event (GstPad * pad, GstEvent * event)
       demux->segment.last_stop = GST_CLOCK_TIME_NONE;
       demux->cluster_time = GST_CLOCK_TIME_NONE;
       demux->cluster_offset = 0;
+      demux->cluster_entry = -1;
       demux->need_newsegment = TRUE;
       /* but keep some of the upstream segment */
       demux->segment.rate = rate;
@@ -6346,6 +6621,7 @@ gst_matroska_demux_handle_sink_event (GstPad * pad, GstEvent * event)
       demux->segment.last_stop = GST_CLOCK_TIME_NONE;
       demux->cluster_time = GST_CLOCK_TIME_NONE;
       demux->cluster_offset = 0;
+      demux->cluster_entry = -1;
       /* fall-through */
     }
     default:
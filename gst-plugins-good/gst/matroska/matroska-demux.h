@@ -52,6 +52,13 @@ typedef enum {
   GST_MATROSKA_DEMUX_STATE_SEEK
 } GstMatroskaDemuxState;
 
+/* a cluster passed in push mode, see gst_matroska_demux_index_cluster() */
+typedef struct {
+  guint64                  pos;         /* relative to the segment start */
+  GstClockTime             time;
+  gboolean                 contiguous;  /* the next entry is the next cluster */
+} GstMatroskaClusterEntry;
+
 typedef struct _GstMatroskaDemux {
   GstEbmlRead              parent;
 
@@ -121,6 +128,9 @@ typedef struct _GstMatroskaDemux {
   guint64                  index_offset;
   GstEvent                *seek_event;
   gboolean                 need_newsegment;
+  /* clusters passed in push mode, sorted, and the one we are in */
+  GArray                  *cluster_index;
+  gint                     cluster_entry;
 
   /* reverse playback */
   GArray                  *seek_index;
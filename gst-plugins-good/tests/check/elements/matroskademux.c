@@ -0,0 +1,578 @@
+/* GStreamer unit tests for matroskademux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gst/check/gstcheck.h>
+
+#define N_CLUSTERS 4
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/webm"));
+
+/* a small WebM file with one VP8 track and a one frame cluster per second */
+static GByteArray *file;
+static guint64 cluster_offsets[N_CLUSTERS];
+
+/* byte seeks the demuxer sent upstream */
+static GList *upstream_seeks;
+/* time newsegment events the demuxer sent downstream */
+static GList *newsegments;
+
+/* associations the demuxer added to its element index */
+typedef struct
+{
+  gint id;
+  GstAssocFlags flags;
+  gint64 time;
+  gint64 bytes;
+} IndexAssociation;
+
+static GArray *associations;
+
+/* protected by check_mutex */
+static gboolean have_eos;
+
+/* pull mode: pulls in progress, most of them at the same time, and the
+ * threads they came from */
+static gint pulls_active;
+static gint pulls_max_active;
+static GList *pull_threads;
+static guint pull_min_length;
+
+static void
+put_id (GByteArray * a, guint32 id)
+{
+  guint8 b[4];
+  gint i, n;
+
+  for (n = 1; n < 4 && (id >> (8 * n)); n++);
+  for (i = 0; i < n; i++)
+    b[i] = id >> (8 * (n - 1 - i));
+  g_byte_array_append (a, b, n);
+}
+
+static void
+put_size (GByteArray * a, guint64 size)
+{
+  guint8 b[8];
+  gint i;
+
+  /* always use the eight byte form */
+  b[0] = 0x01;
+  for (i = 1; i < 8; i++)
+    b[i] = size >> (8 * (7 - i));
+  g_byte_array_append (a, b, 8);
+}
+
+static void
+put_master (GByteArray * a, guint32 id, GByteArray * children)
+{
+  put_id (a, id);
+  put_size (a, children->len);
+  g_byte_array_append (a, children->data, children->len);
+  g_byte_array_free (children, TRUE);
+}
+
+static void
+put_uint (GByteArray * a, guint32 id, guint64 val)
+{
+  guint8 b[8];
+  gint i;
+
+  put_id (a, id);
+  put_size (a, 8);
+  for (i = 0; i < 8; i++)
+    b[i] = val >> (8 * (7 - i));
+  g_byte_array_append (a, b, 8);
+}
+
+static void
+put_string (GByteArray * a, guint32 id, const gchar * str)
+{
+  put_id (a, id);
+  put_size (a, strlen (str));
+  g_byte_array_append (a, (const guint8 *) str, strlen (str));
+}
+
+static void
+make_file (void)
+{
+  GByteArray *header, *info, *tracks, *entry, *video, *cluster;
+  guint64 segment_start;
+  gint i;
+
+  file = g_byte_array_new ();
+
+  header = g_byte_array_new ();
+  put_uint (header, 0x4286, 1);         /* EBMLVersion */
+  put_uint (header, 0x42F7, 1);         /* EBMLReadVersion */
+  put_uint (header, 0x42F2, 4);         /* EBMLMaxIDLength */
+  put_uint (header, 0x42F3, 8);         /* EBMLMaxSizeLength */
+  put_string (header, 0x4282, "webm");  /* DocType */
+  put_uint (header, 0x4287, 2);         /* DocTypeVersion */
+  put_uint (header, 0x4285, 2);         /* DocTypeReadVersion */
+  put_master (file, 0x1A45DFA3, header);
+
+  /* Segment of unknown size */
+  put_id (file, 0x18538067);
+  g_byte_array_append (file,
+      (const guint8 *) "\001\377\377\377\377\377\377\377", 8);
+  segment_start = file->len;
+
+  info = g_byte_array_new ();
+  put_uint (info, 0x2AD7B1, GST_MSECOND);       /* TimecodeScale */
+  put_master (file, 0x1549A966, info);
+
+  video = g_byte_array_new ();
+  put_uint (video, 0xB0, 16);   /* PixelWidth */
+  put_uint (video, 0xBA, 16);   /* PixelHeight */
+  entry = g_byte_array_new ();
+  put_uint (entry, 0xD7, 1);    /* TrackNumber */
+  put_uint (entry, 0x73C5, 1);  /* TrackUID */
+  put_uint (entry, 0x83, 1);    /* TrackType: video */
+  put_string (entry, 0x86, "V_VP8");    /* CodecID */
+  put_master (entry, 0xE0, video);
+  tracks = g_byte_array_new ();
+  put_master (tracks, 0xAE, entry);
+  put_master (file, 0x1654AE6B, tracks);
+
+  for (i = 0; i < N_CLUSTERS; i++) {
+    /* track 1, relative timecode 0, keyframe, four bytes of payload */
+    static const guint8 block[] = { 0x81, 0x00, 0x00, 0x80, 1, 2, 3, 4 };
+
+    cluster = g_byte_array_new ();
+    put_uint (cluster, 0xE7, i * 1000); /* Timecode */
+    put_id (cluster, 0xA3);     /* SimpleBlock */
+    put_size (cluster, sizeof (block));
+    g_byte_array_append (cluster, block, sizeof (block));
+
+    cluster_offsets[i] = file->len;
+    put_master (file, 0x1F43B675, cluster);
+  }
+
+  fail_unless (cluster_offsets[0] > segment_start);
+}
+
+static gboolean
+srcpad_event (GstPad * pad, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    GstFormat format;
+    GstSeekType cur_type;
+    gint64 cur;
+
+    gst_event_parse_seek (event, NULL, &format, NULL, &cur_type, &cur, NULL,
+        NULL);
+    fail_unless_equals_int (format, GST_FORMAT_BYTES);
+    fail_unless_equals_int (cur_type, GST_SEEK_TYPE_SET);
+    upstream_seeks = g_list_append (upstream_seeks, GINT_TO_POINTER (cur));
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+srcpad_getrange (GstPad * pad, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstBuffer *buf;
+  gint active;
+
+  active = g_atomic_int_exchange_and_add (&pulls_active, 1) + 1;
+
+  g_mutex_lock (check_mutex);
+  pulls_max_active = MAX (pulls_max_active, active);
+  if (!g_list_find (pull_threads, g_thread_self ()))
+    pull_threads = g_list_append (pull_threads, g_thread_self ());
+  pull_min_length = MIN (pull_min_length, length);
+  g_mutex_unlock (check_mutex);
+
+  /* give a concurrent pull a chance to overlap */
+  g_usleep (1000);
+
+  if (offset >= file->len) {
+    g_atomic_int_add (&pulls_active, -1);
+    return GST_FLOW_UNEXPECTED;
+  }
+
+  length = MIN (length, file->len - offset);
+  buf = gst_buffer_new_and_alloc (length);
+  memcpy (GST_BUFFER_DATA (buf), file->data + offset, length);
+  GST_BUFFER_OFFSET (buf) = offset;
+  *buffer = buf;
+
+  g_atomic_int_add (&pulls_active, -1);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+srcpad_query (GstPad * pad, GstQuery * query)
+{
+  GstFormat format;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_DURATION)
+    return FALSE;
+
+  gst_query_parse_duration (query, &format, NULL);
+  if (format != GST_FORMAT_BYTES)
+    return FALSE;
+
+  gst_query_set_duration (query, GST_FORMAT_BYTES, file->len);
+  return TRUE;
+}
+
+static gboolean
+sinkpad_event (GstPad * pad, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    g_mutex_lock (check_mutex);
+    have_eos = TRUE;
+    g_cond_signal (check_cond);
+    g_mutex_unlock (check_mutex);
+  }
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_NEWSEGMENT) {
+    GstFormat format;
+
+    gst_event_parse_new_segment (event, NULL, NULL, &format, NULL, NULL, NULL);
+    fail_unless_equals_int (format, GST_FORMAT_TIME);
+    newsegments = g_list_append (newsegments, event);
+    return TRUE;
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+pad_added_cb (GstElement * demux, GstPad * pad, gpointer user_data)
+{
+  fail_unless (mysinkpad == NULL);
+
+  mysinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (mysinkpad, gst_check_chain_func);
+  gst_pad_set_event_function (mysinkpad, sinkpad_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+  fail_unless (gst_pad_link (pad, mysinkpad) == GST_PAD_LINK_OK);
+}
+
+static GstElement *
+setup_matroskademux (void)
+{
+  GstElement *demux;
+  GstPad *sinkpad;
+
+  GST_DEBUG ("setup_matroskademux");
+  demux = gst_check_setup_element ("matroskademux");
+  g_signal_connect (demux, "pad-added", G_CALLBACK (pad_added_cb), NULL);
+
+  mysrcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_pad_set_event_function (mysrcpad, srcpad_event);
+  sinkpad = gst_element_get_static_pad (demux, "sink");
+  fail_unless (gst_pad_link (mysrcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (mysrcpad, TRUE);
+
+  make_file ();
+
+  return demux;
+}
+
+static void
+cleanup_matroskademux (GstElement * demux)
+{
+  GST_DEBUG ("cleanup_matroskademux");
+  gst_element_set_state (demux, GST_STATE_NULL);
+
+  gst_check_drop_buffers ();
+  g_list_foreach (newsegments, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (newsegments);
+  newsegments = NULL;
+  g_list_free (upstream_seeks);
+  upstream_seeks = NULL;
+  g_list_free (pull_threads);
+  pull_threads = NULL;
+  have_eos = FALSE;
+  g_byte_array_free (file, TRUE);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_object_unref (mysrcpad);
+  if (mysinkpad) {
+    gst_pad_set_active (mysinkpad, FALSE);
+    gst_object_unref (mysinkpad);
+    mysinkpad = NULL;
+  }
+  gst_check_teardown_element (demux);
+}
+
+/* pushes the file from @offset on, the way a source does after a seek */
+static void
+push_file_from (guint64 offset, gboolean after_seek)
+{
+  GstBuffer *buf;
+
+  if (after_seek) {
+    fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_start ()));
+    fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_flush_stop ()));
+    fail_unless (gst_pad_push_event (mysrcpad,
+            gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_BYTES, offset,
+                -1, offset)));
+  }
+
+  buf = gst_buffer_new_and_alloc (file->len - offset);
+  memcpy (GST_BUFFER_DATA (buf), file->data + offset, file->len - offset);
+  GST_BUFFER_OFFSET (buf) = offset;
+  fail_unless_equals_int (gst_pad_push (mysrcpad, buf), GST_FLOW_OK);
+}
+
+/* checks that a time seek on a file without Cues goes to the cluster the
+ * demuxer has seen before, and that the segment of the seek is used */
+static void
+check_seek_to_known_cluster (GstSeekFlags flags, GstClockTime position,
+    gint cluster, GstClockTime segment_start)
+{
+  GstElement *demux;
+  GstEvent *event;
+  GstFormat format;
+  gint64 start, time;
+  gdouble rate;
+
+  demux = setup_matroskademux ();
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  push_file_from (0, FALSE);
+  fail_unless (mysinkpad != NULL);
+  fail_unless_equals_int (g_list_length (buffers), N_CLUSTERS);
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_pad_push_event (mysinkpad,
+          gst_event_new_seek (1.0, GST_FORMAT_TIME,
+              GST_SEEK_FLAG_FLUSH | flags, GST_SEEK_TYPE_SET, position,
+              GST_SEEK_TYPE_NONE, -1)));
+  fail_unless_equals_int (g_list_length (upstream_seeks), 1);
+  fail_unless_equals_uint64 (GPOINTER_TO_INT (upstream_seeks->data),
+      cluster_offsets[cluster]);
+
+  g_list_foreach (newsegments, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (newsegments);
+  newsegments = NULL;
+
+  push_file_from (cluster_offsets[cluster], TRUE);
+
+  fail_unless_equals_int (g_list_length (buffers), N_CLUSTERS - cluster);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffers->data),
+      cluster * GST_SECOND);
+
+  fail_unless_equals_int (g_list_length (newsegments), 1);
+  event = newsegments->data;
+  gst_event_parse_new_segment (event, NULL, &rate, &format, &start, NULL,
+      &time);
+  fail_unless_equals_float (rate, 1.0);
+  fail_unless_equals_uint64 (start, segment_start);
+  fail_unless_equals_uint64 (time, segment_start);
+
+  cleanup_matroskademux (demux);
+}
+
+GST_START_TEST (test_push_seek_known_cluster)
+{
+  check_seek_to_known_cluster (GST_SEEK_FLAG_ACCURATE, 1500 * GST_MSECOND, 1,
+      1500 * GST_MSECOND);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_push_seek_known_cluster_key_unit)
+{
+  check_seek_to_known_cluster (GST_SEEK_FLAG_KEY_UNIT, 2500 * GST_MSECOND, 2,
+      2 * GST_SECOND);
+}
+
+GST_END_TEST;
+
+static void
+index_entry_added_cb (GstIndex * index, GstIndexEntry * entry,
+    gpointer user_data)
+{
+  IndexAssociation assoc;
+
+  if (entry->type != GST_INDEX_ENTRY_ASSOCIATION)
+    return;
+
+  assoc.id = entry->id;
+  assoc.flags = GST_INDEX_ASSOC_FLAGS (entry);
+  fail_unless (gst_index_entry_assoc_map (entry, GST_FORMAT_TIME,
+          &assoc.time));
+  fail_unless (gst_index_entry_assoc_map (entry, GST_FORMAT_BYTES,
+          &assoc.bytes));
+  g_array_append_val (associations, assoc);
+}
+
+/* checks that the clusters indexed in push mode end up in the element index,
+ * once each, as key unit associations between time and byte offset */
+GST_START_TEST (test_push_element_index)
+{
+  GstElement *demux;
+  GstIndex *index;
+  gint writer_id, j, found;
+  guint i;
+
+  demux = setup_matroskademux ();
+
+  associations = g_array_new (FALSE, FALSE, sizeof (IndexAssociation));
+  index = gst_index_new ();
+  g_signal_connect (index, "entry-added", G_CALLBACK (index_entry_added_cb),
+      NULL);
+  gst_element_set_index (demux, index);
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  push_file_from (0, FALSE);
+  fail_unless (mysinkpad != NULL);
+  fail_unless_equals_int (g_list_length (buffers), N_CLUSTERS);
+
+  /* going over known clusters again adds nothing */
+  fail_unless (gst_pad_push_event (mysinkpad,
+          gst_event_new_seek (1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH,
+              GST_SEEK_TYPE_SET, GST_SECOND, GST_SEEK_TYPE_NONE, -1)));
+  push_file_from (cluster_offsets[1], TRUE);
+
+  /* the demuxer itself writes the cluster entries, its pads the blocks */
+  fail_unless (gst_index_get_writer_id (index, GST_OBJECT (demux),
+          &writer_id));
+
+  found = 0;
+  for (i = 0; i < associations->len; i++) {
+    IndexAssociation *assoc =
+        &g_array_index (associations, IndexAssociation, i);
+
+    if (assoc->id != writer_id)
+      continue;
+
+    fail_unless (assoc->flags & GST_ASSOCIATION_FLAG_KEY_UNIT);
+    for (j = 0; j < N_CLUSTERS; j++) {
+      if (assoc->time == j * GST_SECOND)
+        break;
+    }
+    fail_unless (j < N_CLUSTERS, "unexpected time %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (assoc->time));
+    fail_unless_equals_uint64 (assoc->bytes, cluster_offsets[j]);
+    found++;
+  }
+  fail_unless_equals_int (found, N_CLUSTERS);
+
+  cleanup_matroskademux (demux);
+  gst_object_unref (index);
+  g_array_free (associations, TRUE);
+  associations = NULL;
+}
+
+GST_END_TEST;
+
+/* in pull mode all reading happens in the streaming thread, one pull at a
+ * time, in chunks of at least read-ahead bytes */
+static void
+check_pull (guint read_ahead)
+{
+  GstElement *demux;
+  GList *l;
+  gint i;
+
+  demux = setup_matroskademux ();
+  gst_pad_set_getrange_function (mysrcpad, srcpad_getrange);
+  gst_pad_set_query_function (mysrcpad, srcpad_query);
+  g_object_set (demux, "read-ahead", read_ahead, NULL);
+
+  pulls_active = 0;
+  pulls_max_active = 0;
+  pull_min_length = G_MAXUINT;
+
+  fail_unless (gst_element_set_state (demux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  g_mutex_lock (check_mutex);
+  while (!have_eos)
+    g_cond_wait (check_cond, check_mutex);
+  g_mutex_unlock (check_mutex);
+
+  fail_unless (mysinkpad != NULL);
+  fail_unless_equals_int (g_list_length (buffers), N_CLUSTERS);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf), i * GST_SECOND);
+    fail_unless_equals_int (GST_BUFFER_SIZE (buf), 4);
+  }
+
+  fail_unless_equals_int (pulls_max_active, 1);
+  fail_unless_equals_int (g_list_length (pull_threads), 1);
+  fail_unless (pull_min_length >= read_ahead);
+
+  cleanup_matroskademux (demux);
+}
+
+GST_START_TEST (test_pull)
+{
+  check_pull (64 * 1024);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_small_read_ahead)
+{
+  /* much smaller than the file, so it takes many pulls */
+  check_pull (16);
+}
+
+GST_END_TEST;
+
+static Suite *
+matroskademux_suite (void)
+{
+  Suite *s = suite_create ("matroskademux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_push_seek_known_cluster);
+  tcase_add_test (tc_chain, test_push_seek_known_cluster_key_unit);
+  tcase_add_test (tc_chain, test_push_element_index);
+  tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_small_read_ahead);
+
+  return s;
+}
+
+GST_CHECK_MAIN (matroskademux)
@@ -607,6 +607,10 @@ init_pre (GOptionContext * context, GOptionGroup * group, gpointer data,
 
   priv_gst_dump_dot_dir = g_getenv ("GST_DEBUG_DUMP_DOT_DIR");
 #endif
+
+  if (g_getenv ("GST_PAD_STATS") != NULL)
+    gst_pad_stats_set_enabled (TRUE);
+
   /* This is the earliest we can make stuff show up in the logs.
    * So give some useful info about GStreamer here */
   GST_INFO ("Initializing GStreamer Core Library version %s", VERSION);
@@ -1035,6 +1039,7 @@ gst_deinit (void)
   gst_object_unref (clock);
 
   _priv_gst_registry_cleanup ();
+  _priv_gst_caps_cache_clear ();
 
   g_type_class_unref (g_type_class_peek (gst_object_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_pad_get_type ()));
@@ -96,6 +96,10 @@ void  _gst_query_initialize (void);
 void  _gst_tag_initialize (void);
 void  _gst_value_initialize (void);
 
+/* Recycling of freed mini-object instances, see gstminiobject.c */
+void  _priv_gst_mini_object_register_recycling (GType type,
+                                                GInstanceInitFunc init);
+
 /* Private registry functions */
 gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
 void _priv_gst_registry_cleanup (void);
@@ -106,6 +110,16 @@ gboolean _gst_plugin_loader_client_run (void);
 
 gboolean  priv_gst_structure_append_to_gstring (const GstStructure * structure,
                                                 GString            * s);
+
+/* content hash and comparison of structures, for gstcaps.c */
+guint     _priv_gst_structure_hash (const GstStructure * structure,
+                                    gboolean           * hashable);
+gboolean  _priv_gst_structure_is_identical (const GstStructure * struct1,
+                                            const GstStructure * struct2);
+
+/* drops the memo of caps operations, see gstcaps.c */
+void      _priv_gst_caps_cache_clear (void);
+
 /* registry cache backends */
 /* FIXME 0.11: use priv_ prefix */
 gboolean 		gst_registry_binary_read_cache 	(GstRegistry * registry, const char *location);
@@ -128,6 +128,7 @@
 #include "gstminiobject.h"
 #include "gstversion.h"
 
+static void gst_buffer_init (GstBuffer * buffer);
 static void gst_buffer_finalize (GstBuffer * buffer);
 static GstBuffer *_gst_buffer_copy (GstBuffer * buffer);
 
@@ -158,6 +159,264 @@ aligned_malloc (gpointer * memptr, guint size)
 
 #endif /* HAVE_POSIX_MEMALIGN */
 
+/* Pooled buffer memory, see gst_buffer_new_and_alloc_pooled().
+ *
+ * Memory is recycled by size class, with four classes per power of two
+ * between POOL_MIN_SIZE and POOL_MAX_SIZE, so that no more than a fifth of a
+ * block goes unused. Every block starts with a PoolBlock header, padded to
+ * keep the buffer alignment, that records the class of the block.
+ *
+ * Freed blocks of the smaller classes first go to a cache in the freeing
+ * thread, so that a thread that allocates and frees the same sizes never
+ * takes a lock. When the thread cache of a class overflows, half of it moves
+ * to the shared free list of the class, and an empty thread cache is refilled
+ * from there. The shared lists are what carry memory from the threads that
+ * free buffers (usually the sinks) back to the ones that allocate them, and
+ * the large classes only use those. They hold at most POOL_MAX_CACHED bytes,
+ * anything beyond that is given back to the system.
+ */
+#define POOL_MIN_SHIFT      8
+#define POOL_MIN_SIZE       (1 << POOL_MIN_SHIFT)
+#define POOL_MAX_SHIFT      25
+#define POOL_MAX_SIZE       (1 << POOL_MAX_SHIFT)
+#define POOL_N_CLASSES      (1 + 4 * (POOL_MAX_SHIFT - POOL_MIN_SHIFT))
+/* per class and thread */
+#define POOL_THREAD_BYTES   (1024 * 1024)
+#define POOL_THREAD_DEPTH   16
+#define POOL_MAX_CACHED     (64 * 1024 * 1024)
+
+typedef struct _PoolBlock PoolBlock;
+
+struct _PoolBlock
+{
+  PoolBlock *next;
+  guint klass;
+};
+
+typedef struct
+{
+  PoolBlock *head;
+  guint n;
+} PoolList;
+
+typedef struct
+{
+  PoolList lists[POOL_N_CLASSES];
+} PoolThreadCache;
+
+static gsize pool_header_size;
+static gsize pool_class_size[POOL_N_CLASSES];
+static guint pool_thread_depth[POOL_N_CLASSES];
+
+static GStaticPrivate pool_thread_cache = G_STATIC_PRIVATE_INIT;
+static GStaticMutex pool_lock = G_STATIC_MUTEX_INIT;
+static PoolList pool_shared[POOL_N_CLASSES];
+static gsize pool_shared_bytes;
+
+static volatile gint pool_hits;
+static volatile gint pool_misses;
+static volatile gint pool_frees;
+
+static void
+pool_initialize (void)
+{
+  gsize align;
+  guint i;
+
+#ifdef HAVE_POSIX_MEMALIGN
+  align = MAX (_gst_buffer_data_alignment, sizeof (gpointer));
+#else
+  align = 2 * sizeof (gpointer);
+#endif
+  pool_header_size = (sizeof (PoolBlock) + align - 1) / align * align;
+
+  /* class 0 takes everything up to POOL_MIN_SIZE, after that the classes
+   * step by an eighth of the next power of two: 5/4, 6/4, 7/4 and 8/4 */
+  pool_class_size[0] = POOL_MIN_SIZE;
+  for (i = 1; i < POOL_N_CLASSES; i++) {
+    pool_class_size[i] =
+        (gsize) (5 + (i - 1) % 4) << (POOL_MIN_SHIFT - 2 + (i - 1) / 4);
+    pool_thread_depth[i] = MIN (POOL_THREAD_BYTES / pool_class_size[i],
+        POOL_THREAD_DEPTH);
+    /* a cache of one block would just bounce between the thread and the
+     * shared list */
+    if (pool_thread_depth[i] < 2)
+      pool_thread_depth[i] = 0;
+  }
+  pool_thread_depth[0] = POOL_THREAD_DEPTH;
+}
+
+static inline guint
+pool_size_class (guint size)
+{
+  guint shift;
+
+  if (size <= POOL_MIN_SIZE)
+    return 0;
+
+  /* size - 1 is in [4 << shift, 8 << shift) */
+  shift = g_bit_storage (size - 1) - 3;
+  return 1 + 4 * (shift - (POOL_MIN_SHIFT - 2)) + ((size - 1) >> shift) - 4;
+}
+
+static void
+pool_block_free (PoolBlock * block)
+{
+  g_atomic_int_inc (&pool_frees);
+#ifdef HAVE_POSIX_MEMALIGN
+  free (block);
+#else
+  g_free (block);
+#endif
+}
+
+/* moves all but @keep blocks of @list to the shared list of @klass */
+static void
+pool_spill (PoolList * list, guint klass, guint keep)
+{
+  PoolBlock *drop = NULL;
+
+  g_static_mutex_lock (&pool_lock);
+  while (list->n > keep) {
+    PoolBlock *block = list->head;
+
+    list->head = block->next;
+    list->n--;
+    if (pool_shared_bytes + pool_class_size[klass] <= POOL_MAX_CACHED) {
+      block->next = pool_shared[klass].head;
+      pool_shared[klass].head = block;
+      pool_shared[klass].n++;
+      pool_shared_bytes += pool_class_size[klass];
+    } else {
+      block->next = drop;
+      drop = block;
+    }
+  }
+  g_static_mutex_unlock (&pool_lock);
+
+  while (drop) {
+    PoolBlock *next = drop->next;
+
+    pool_block_free (drop);
+    drop = next;
+  }
+}
+
+/* moves up to @n blocks from the shared list of @klass to @list */
+static void
+pool_refill (PoolList * list, guint klass, guint n)
+{
+  g_static_mutex_lock (&pool_lock);
+  while (n-- && pool_shared[klass].head) {
+    PoolBlock *block = pool_shared[klass].head;
+
+    pool_shared[klass].head = block->next;
+    pool_shared[klass].n--;
+    pool_shared_bytes -= pool_class_size[klass];
+    block->next = list->head;
+    list->head = block;
+    list->n++;
+  }
+  g_static_mutex_unlock (&pool_lock);
+}
+
+static void
+pool_thread_cache_free (PoolThreadCache * cache)
+{
+  guint i;
+
+  for (i = 0; i < POOL_N_CLASSES; i++)
+    pool_spill (&cache->lists[i], i, 0);
+  g_free (cache);
+}
+
+static inline PoolThreadCache *
+pool_get_thread_cache (void)
+{
+  PoolThreadCache *cache = g_static_private_get (&pool_thread_cache);
+
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (PoolThreadCache, 1);
+    g_static_private_set (&pool_thread_cache, cache,
+        (GDestroyNotify) pool_thread_cache_free);
+  }
+  return cache;
+}
+
+static void
+pool_free (gpointer data)
+{
+  PoolBlock *block = (PoolBlock *) ((guint8 *) data - pool_header_size);
+  guint klass = block->klass;
+  guint depth = pool_thread_depth[klass];
+  PoolList *list;
+
+  if (depth) {
+    list = &pool_get_thread_cache ()->lists[klass];
+    block->next = list->head;
+    list->head = block;
+    if (++list->n > depth)
+      pool_spill (list, klass, depth / 2);
+  } else {
+    PoolList single = { block, 1 };
+
+    block->next = NULL;
+    pool_spill (&single, klass, 0);
+  }
+}
+
+static guint8 *
+pool_alloc (guint size, gboolean try_alloc)
+{
+  guint klass = pool_size_class (size);
+  guint depth = pool_thread_depth[klass];
+  PoolBlock *block = NULL;
+  PoolList single = { NULL, 0 };
+  PoolList *list;
+  gsize alloc_size;
+
+  if (depth) {
+    list = &pool_get_thread_cache ()->lists[klass];
+    if (list->head == NULL)
+      pool_refill (list, klass, depth / 2);
+  } else {
+    list = &single;
+    pool_refill (list, klass, 1);
+  }
+  if (G_LIKELY ((block = list->head))) {
+    list->head = block->next;
+    list->n--;
+    g_atomic_int_inc (&pool_hits);
+    return (guint8 *) block + pool_header_size;
+  }
+
+  g_atomic_int_inc (&pool_misses);
+  alloc_size = pool_header_size + pool_class_size[klass];
+#ifdef HAVE_POSIX_MEMALIGN
+  {
+    gpointer memptr = NULL;
+
+    if (G_UNLIKELY (!aligned_malloc (&memptr, alloc_size))) {
+      if (!try_alloc)
+        g_error ("%s: failed to allocate %" G_GSIZE_FORMAT " bytes", G_STRLOC,
+            alloc_size);
+      return NULL;
+    }
+    block = memptr;
+  }
+#else
+  if (try_alloc)
+    block = g_try_malloc (alloc_size);
+  else
+    block = g_malloc (alloc_size);
+  if (G_UNLIKELY (block == NULL))
+    return NULL;
+#endif
+  block->klass = klass;
+
+  return (guint8 *) block + pool_header_size;
+}
+
 void
 _gst_buffer_initialize (void)
 {
@@ -170,6 +429,9 @@ _gst_buffer_initialize (void)
   _gst_buffer_data_alignment = getpagesize ();
 #endif
 #endif
+  pool_initialize ();
+  _priv_gst_mini_object_register_recycling (_gst_buffer_type,
+      (GInstanceInitFunc) gst_buffer_init);
 }
 
 #define _do_init \
@@ -441,6 +703,162 @@ gst_buffer_try_new_and_alloc (guint size)
   return newbuf;
 }
 
+/**
+ * gst_buffer_new_and_alloc_pooled:
+ * @size: the size of the new buffer's data.
+ *
+ * Creates a newly allocated buffer with data of the given size, like
+ * gst_buffer_new_and_alloc(), but takes the memory from a pool that recycles
+ * the memory of freed buffers by size. This avoids the cost of going to the
+ * system allocator, and the heap fragmentation that comes with it, for
+ * elements that produce many buffers of the same few sizes, such as video
+ * decoders.
+ *
+ * The memory is given back to the pool by the buffer's free function, so
+ * GST_BUFFER_MALLOCDATA() and GST_BUFFER_FREE_FUNC() of the buffer must not be
+ * changed or reallocated. Buffers too large for the pool, or of size 0, are
+ * allocated like gst_buffer_new_and_alloc() does.
+ *
+ * See also gst_buffer_pool_get_stats() and gst_buffer_pool_trim().
+ *
+ * MT safe.
+ * Returns: the new #GstBuffer.
+ *
+ * Since: 0.10.30
+ */
+GstBuffer *
+gst_buffer_new_and_alloc_pooled (guint size)
+{
+  GstBuffer *newbuf;
+
+  if (G_UNLIKELY (size == 0 || size > POOL_MAX_SIZE))
+    return gst_buffer_new_and_alloc (size);
+
+  newbuf = gst_buffer_new ();
+
+  newbuf->malloc_data = pool_alloc (size, FALSE);
+  GST_BUFFER_FREE_FUNC (newbuf) = pool_free;
+  GST_BUFFER_DATA (newbuf) = newbuf->malloc_data;
+  GST_BUFFER_SIZE (newbuf) = size;
+
+  GST_CAT_LOG (GST_CAT_BUFFER, "new %p of size %d from pool", newbuf, size);
+
+  return newbuf;
+}
+
+/**
+ * gst_buffer_try_new_and_alloc_pooled:
+ * @size: the size of the new buffer's data.
+ *
+ * Like gst_buffer_new_and_alloc_pooled(), but returns NULL instead of
+ * aborting when the memory can't be allocated.
+ *
+ * MT safe.
+ *
+ * Returns: a new #GstBuffer, or NULL if the memory couldn't be allocated.
+ *
+ * Since: 0.10.30
+ */
+GstBuffer *
+gst_buffer_try_new_and_alloc_pooled (guint size)
+{
+  GstBuffer *newbuf;
+  guint8 *malloc_data;
+
+  if (G_UNLIKELY (size == 0 || size > POOL_MAX_SIZE))
+    return gst_buffer_try_new_and_alloc (size);
+
+  malloc_data = pool_alloc (size, TRUE);
+  if (G_UNLIKELY (malloc_data == NULL)) {
+    GST_CAT_WARNING (GST_CAT_BUFFER, "failed to allocate %d bytes", size);
+    return NULL;
+  }
+
+  newbuf = gst_buffer_new ();
+
+  GST_BUFFER_MALLOCDATA (newbuf) = malloc_data;
+  GST_BUFFER_FREE_FUNC (newbuf) = pool_free;
+  GST_BUFFER_DATA (newbuf) = malloc_data;
+  GST_BUFFER_SIZE (newbuf) = size;
+
+  GST_CAT_LOG (GST_CAT_BUFFER, "new %p of size %d from pool", newbuf, size);
+
+  return newbuf;
+}
+
+/**
+ * gst_buffer_pool_get_stats:
+ * @stats: a #GstBufferPoolStats to fill in
+ *
+ * Retrieves the statistics of the pool that gst_buffer_new_and_alloc_pooled()
+ * allocates from, for the whole process. The counters wrap around when they
+ * overflow.
+ *
+ * MT safe.
+ *
+ * Since: 0.10.30
+ */
+void
+gst_buffer_pool_get_stats (GstBufferPoolStats * stats)
+{
+  g_return_if_fail (stats != NULL);
+
+  stats->hits = g_atomic_int_get (&pool_hits);
+  stats->misses = g_atomic_int_get (&pool_misses);
+  stats->frees = g_atomic_int_get (&pool_frees);
+  g_static_mutex_lock (&pool_lock);
+  stats->cached = pool_shared_bytes;
+  g_static_mutex_unlock (&pool_lock);
+}
+
+/**
+ * gst_buffer_pool_trim:
+ *
+ * Gives the memory kept in the buffer pool back to the system. Only the memory
+ * cached by the calling thread and the memory shared between threads is
+ * released; other threads keep their (small) caches.
+ *
+ * Applications can call this when they stop playback, to reduce their memory
+ * usage while idle.
+ *
+ * MT safe.
+ *
+ * Since: 0.10.30
+ */
+void
+gst_buffer_pool_trim (void)
+{
+  PoolThreadCache *cache;
+  PoolBlock *drop = NULL;
+  guint i;
+
+  if ((cache = g_static_private_get (&pool_thread_cache))) {
+    for (i = 0; i < POOL_N_CLASSES; i++)
+      pool_spill (&cache->lists[i], i, 0);
+  }
+
+  g_static_mutex_lock (&pool_lock);
+  for (i = 0; i < POOL_N_CLASSES; i++) {
+    while (pool_shared[i].head) {
+      PoolBlock *block = pool_shared[i].head;
+
+      pool_shared[i].head = block->next;
+      block->next = drop;
+      drop = block;
+    }
+    pool_shared[i].n = 0;
+  }
+  pool_shared_bytes = 0;
+  g_static_mutex_unlock (&pool_lock);
+
+  while (drop) {
+    PoolBlock *next = drop->next;
+
+    pool_block_free (drop);
+    drop = next;
+  }
+}
+
 /**
  * gst_buffer_get_caps:
  * @buffer: a #GstBuffer.
@@ -300,6 +300,34 @@ GstBuffer * gst_buffer_new               (void);
 GstBuffer * gst_buffer_new_and_alloc     (guint size);
 GstBuffer * gst_buffer_try_new_and_alloc (guint size);
 
+/**
+ * GstBufferPoolStats:
+ * @hits: number of allocations served with recycled memory
+ * @misses: number of allocations that needed new memory from the system
+ * @frees: number of blocks given back to the system, because the pool was
+ *     full or trimmed
+ * @cached: bytes currently kept in the pool for all threads to use
+ *
+ * Statistics of the pool used by gst_buffer_new_and_alloc_pooled(), as
+ * returned by gst_buffer_pool_get_stats().
+ *
+ * Since: 0.10.30
+ */
+typedef struct {
+  guint hits;
+  guint misses;
+  guint frees;
+  gsize cached;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+} GstBufferPoolStats;
+
+GstBuffer * gst_buffer_new_and_alloc_pooled      (guint size);
+GstBuffer * gst_buffer_try_new_and_alloc_pooled  (guint size);
+void        gst_buffer_pool_get_stats            (GstBufferPoolStats *stats);
+void        gst_buffer_pool_trim                 (void);
+
 /**
  * gst_buffer_set_data:
  * @buf: a #GstBuffer
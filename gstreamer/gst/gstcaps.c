@@ -1056,6 +1056,215 @@ gst_caps_is_fixed (const GstCaps * caps)
   return gst_structure_foreach (structure, gst_caps_is_fixed_foreach, NULL);
 }
 
+/* Memo of the results of intersecting caps and of testing them for subsets,
+ * which are done over and over with the same (template) caps while
+ * negotiating. Caps can still be changed after they have been handed to
+ * us, so the entries keep their own copies of the operands and the key is a
+ * hash of their contents, computed on each lookup. That is linear in the
+ * size of the caps while the operations are quadratic, so the memo is only
+ * used for caps with several structures. */
+#define CAPS_CACHE_SIZE       128
+#define CAPS_CACHE_MIN_PAIRS  4
+
+typedef enum
+{
+  GST_CAPS_OP_INTERSECT,
+  GST_CAPS_OP_CAN_INTERSECT,
+  GST_CAPS_OP_IS_SUBSET
+} GstCapsOp;
+
+typedef struct
+{
+  GList link;                   /* in caps_cache_lru, data is the entry */
+  GstCapsOp op;
+  guint hash;
+  GstCaps *caps1;
+  GstCaps *caps2;
+  GstCaps *result;              /* for GST_CAPS_OP_INTERSECT */
+  gboolean ret;
+} GstCapsCacheEntry;
+
+static GStaticMutex caps_cache_lock = G_STATIC_MUTEX_INIT;
+static GHashTable *caps_cache = NULL;
+/* most recently used first */
+static GQueue caps_cache_lru = { NULL, NULL, 0 };
+
+static gboolean
+gst_caps_hash (const GstCaps * caps, guint * hash)
+{
+  gboolean hashable = TRUE;
+  guint i;
+
+  *hash = caps->flags;
+  for (i = 0; i < caps->structs->len; i++)
+    *hash = *hash * 31 +
+        _priv_gst_structure_hash (gst_caps_get_structure_unchecked (caps, i),
+        &hashable);
+
+  return hashable;
+}
+
+static gboolean
+gst_caps_is_identical (const GstCaps * caps1, const GstCaps * caps2)
+{
+  guint i;
+
+  if (caps1->flags != caps2->flags ||
+      caps1->structs->len != caps2->structs->len)
+    return FALSE;
+
+  for (i = 0; i < caps1->structs->len; i++) {
+    if (!_priv_gst_structure_is_identical (gst_caps_get_structure_unchecked
+            (caps1, i), gst_caps_get_structure_unchecked (caps2, i)))
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/* both caps are fixed and have the same contents */
+static gboolean
+gst_caps_is_identical_fixed (const GstCaps * caps1, const GstCaps * caps2)
+{
+  if (caps1->structs->len != 1 || caps2->structs->len != 1)
+    return FALSE;
+
+  if (!_priv_gst_structure_is_identical (gst_caps_get_structure_unchecked
+          (caps1, 0), gst_caps_get_structure_unchecked (caps2, 0)))
+    return FALSE;
+
+  return gst_caps_is_fixed (caps1);
+}
+
+static guint
+gst_caps_cache_entry_hash (gconstpointer key)
+{
+  return ((const GstCapsCacheEntry *) key)->hash;
+}
+
+static gboolean
+gst_caps_cache_entry_equal (gconstpointer a, gconstpointer b)
+{
+  const GstCapsCacheEntry *entry1 = a, *entry2 = b;
+
+  return entry1->op == entry2->op &&
+      gst_caps_is_identical (entry1->caps1, entry2->caps1) &&
+      gst_caps_is_identical (entry1->caps2, entry2->caps2);
+}
+
+static void
+gst_caps_cache_entry_free (GstCapsCacheEntry * entry)
+{
+  gst_caps_unref (entry->caps1);
+  gst_caps_unref (entry->caps2);
+  if (entry->result)
+    gst_caps_unref (entry->result);
+  g_slice_free (GstCapsCacheEntry, entry);
+}
+
+/* fills in @key for @op on @caps1 and @caps2, returns FALSE when the result
+ * should not be memoized */
+static gboolean
+gst_caps_cache_key (GstCapsCacheEntry * key, GstCapsOp op,
+    const GstCaps * caps1, const GstCaps * caps2)
+{
+  guint hash1, hash2;
+
+  if (caps1->structs->len * caps2->structs->len < CAPS_CACHE_MIN_PAIRS)
+    return FALSE;
+
+  if (!gst_caps_hash (caps1, &hash1) || !gst_caps_hash (caps2, &hash2))
+    return FALSE;
+
+  key->op = op;
+  key->hash = (hash1 * 31 + hash2) * 31 + op;
+  key->caps1 = (GstCaps *) caps1;
+  key->caps2 = (GstCaps *) caps2;
+  key->result = NULL;
+  key->ret = FALSE;
+
+  return TRUE;
+}
+
+/* looks up @key, on a hit @key is filled in with a new ref to the result */
+static gboolean
+gst_caps_cache_lookup (GstCapsCacheEntry * key)
+{
+  GstCapsCacheEntry *entry;
+
+  g_static_mutex_lock (&caps_cache_lock);
+  if (caps_cache == NULL ||
+      (entry = g_hash_table_lookup (caps_cache, key)) == NULL) {
+    g_static_mutex_unlock (&caps_cache_lock);
+    return FALSE;
+  }
+
+  g_queue_unlink (&caps_cache_lru, &entry->link);
+  g_queue_push_head_link (&caps_cache_lru, &entry->link);
+
+  if (entry->result)
+    key->result = gst_caps_ref (entry->result);
+  key->ret = entry->ret;
+  g_static_mutex_unlock (&caps_cache_lock);
+
+  GST_CAT_LOG (GST_CAT_CAPS, "cache hit for operation %d", key->op);
+
+  return TRUE;
+}
+
+static void
+gst_caps_cache_store (const GstCapsCacheEntry * key, const GstCaps * result,
+    gboolean ret)
+{
+  GstCapsCacheEntry *entry;
+
+  entry = g_slice_new0 (GstCapsCacheEntry);
+  entry->link.data = entry;
+  entry->op = key->op;
+  entry->hash = key->hash;
+  entry->caps1 = gst_caps_copy (key->caps1);
+  entry->caps2 = gst_caps_copy (key->caps2);
+  if (result)
+    entry->result = gst_caps_copy (result);
+  entry->ret = ret;
+
+  g_static_mutex_lock (&caps_cache_lock);
+  if (caps_cache == NULL)
+    caps_cache = g_hash_table_new (gst_caps_cache_entry_hash,
+        gst_caps_cache_entry_equal);
+
+  /* another thread got there first */
+  if (g_hash_table_lookup (caps_cache, entry)) {
+    g_static_mutex_unlock (&caps_cache_lock);
+    gst_caps_cache_entry_free (entry);
+    return;
+  }
+
+  if (caps_cache_lru.length >= CAPS_CACHE_SIZE) {
+    GList *last = g_queue_pop_tail_link (&caps_cache_lru);
+
+    g_hash_table_remove (caps_cache, last->data);
+    gst_caps_cache_entry_free (last->data);
+  }
+  g_hash_table_insert (caps_cache, entry, entry);
+  g_queue_push_head_link (&caps_cache_lru, &entry->link);
+  g_static_mutex_unlock (&caps_cache_lock);
+}
+
+void
+_priv_gst_caps_cache_clear (void)
+{
+  GList *link;
+
+  g_static_mutex_lock (&caps_cache_lock);
+  while ((link = g_queue_pop_head_link (&caps_cache_lru)))
+    gst_caps_cache_entry_free (link->data);
+  if (caps_cache) {
+    g_hash_table_destroy (caps_cache);
+    caps_cache = NULL;
+  }
+  g_static_mutex_unlock (&caps_cache_lock);
+}
+
 /**
  * gst_caps_is_equal_fixed:
  * @caps1: the #GstCaps to test
@@ -1077,6 +1286,8 @@ gst_caps_is_equal_fixed (const GstCaps * caps1, const GstCaps * caps2)
   struct1 = gst_caps_get_structure_unchecked (caps1, 0);
   struct2 = gst_caps_get_structure_unchecked (caps2, 0);
 
+  if (struct1 == struct2)
+    return TRUE;
   if (struct1->name != struct2->name) {
     return FALSE;
   }
@@ -1122,6 +1333,8 @@ gst_caps_is_always_compatible (const GstCaps * caps1, const GstCaps * caps2)
 gboolean
 gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
 {
+  GstCapsCacheEntry key;
+  gboolean use_cache;
   GstCaps *caps;
   gboolean ret;
 
@@ -1133,9 +1346,21 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  if (subset == superset || gst_caps_is_identical_fixed (subset, superset))
+    return TRUE;
+
+  use_cache = gst_caps_cache_key (&key, GST_CAPS_OP_IS_SUBSET, subset,
+      superset);
+  if (use_cache && gst_caps_cache_lookup (&key))
+    return key.ret;
+
   caps = gst_caps_subtract (subset, superset);
   ret = CAPS_IS_EMPTY_SIMPLE (caps);
   gst_caps_unref (caps);
+
+  if (use_cache)
+    gst_caps_cache_store (&key, NULL, ret);
+
   return ret;
 }
 
@@ -1313,6 +1538,9 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   guint j, k, len1, len2;
   GstStructure *struct1;
   GstStructure *struct2;
+  GstCapsCacheEntry key;
+  gboolean use_cache;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
   g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
@@ -1329,6 +1557,15 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
     return TRUE;
 
+  /* fixed caps with the same contents, the common case when negotiating */
+  if (gst_caps_is_identical_fixed (caps1, caps2))
+    return TRUE;
+
+  use_cache = gst_caps_cache_key (&key, GST_CAPS_OP_CAN_INTERSECT, caps1,
+      caps2);
+  if (use_cache && gst_caps_cache_lookup (&key))
+    return key.ret;
+
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1361,7 +1598,8 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
       struct2 = gst_caps_get_structure_unchecked (caps2, k);
 
       if (gst_caps_structure_can_intersect (struct1, struct2)) {
-        return TRUE;
+        ret = TRUE;
+        goto done;
       }
       /* move down left */
       k++;
@@ -1370,7 +1608,12 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
       j--;
     }
   }
-  return FALSE;
+
+done:
+  if (use_cache)
+    gst_caps_cache_store (&key, NULL, ret);
+
+  return ret;
 }
 
 #if 0
@@ -1435,6 +1678,8 @@ gst_caps_intersect (const GstCaps * caps1, const GstCaps * caps2)
   GstStructure *struct2;
   GstCaps *dest;
   GstStructure *istruct;
+  GstCapsCacheEntry key;
+  gboolean use_cache;
 
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
@@ -1453,6 +1698,17 @@ gst_caps_intersect (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (CAPS_IS_ANY (caps2)))
     return gst_caps_copy (caps1);
 
+  /* fixed caps with the same contents, the common case when negotiating */
+  if (gst_caps_is_identical_fixed (caps1, caps2))
+    return gst_caps_copy (caps1);
+
+  use_cache = gst_caps_cache_key (&key, GST_CAPS_OP_INTERSECT, caps1, caps2);
+  if (use_cache && gst_caps_cache_lookup (&key)) {
+    dest = gst_caps_copy (key.result);
+    gst_caps_unref (key.result);
+    return dest;
+  }
+
   dest = gst_caps_new_empty ();
 
   /* run zigzag on top line then right line, this preserves the caps order
@@ -1496,6 +1752,10 @@ gst_caps_intersect (const GstCaps * caps1, const GstCaps * caps2)
       j--;
     }
   }
+
+  if (use_cache)
+    gst_caps_cache_store (&key, dest, FALSE);
+
   return dest;
 }
 
@@ -87,6 +87,7 @@
 
 #define GST_EVENT_SEQNUM(e) ((GstEvent*)e)->abidata.seqnum
 
+static void gst_event_init (GstEvent * event);
 static void gst_event_finalize (GstEvent * event);
 static GstEvent *_gst_event_copy (GstEvent * event);
 
@@ -98,6 +99,8 @@ _gst_event_initialize (void)
   g_type_class_ref (gst_event_get_type ());
   g_type_class_ref (gst_seek_flags_get_type ());
   g_type_class_ref (gst_seek_type_get_type ());
+  _priv_gst_mini_object_register_recycling (GST_TYPE_EVENT,
+      (GInstanceInitFunc) gst_event_init);
 }
 
 typedef struct
@@ -37,6 +37,7 @@
 #include "gst/gstminiobject.h"
 #include "gst/gstinfo.h"
 #include <gobject/gvaluecollector.h>
+#include <string.h>
 
 #ifndef GST_DISABLE_TRACE
 #include "gsttrace.h"
@@ -169,6 +170,250 @@ gst_mini_object_finalize (GstMiniObject * obj)
    */
 }
 
+/* Recycling of mini-object instances.
+ *
+ * Instances of the types registered with
+ * _priv_gst_mini_object_register_recycling() are not given back to the GType
+ * allocator when their last reference goes away but kept for the next
+ * gst_mini_object_new() of the same type. Only instances of exactly that
+ * type are recycled, never those of subclasses.
+ *
+ * Freed instances go to a list in the freeing thread first, so that a thread
+ * that creates and frees objects never synchronizes with anything. When that
+ * list is full, half of it is pushed onto a shared stack, and a thread whose
+ * own list is empty steals the complete shared stack at once. Both are a
+ * single compare-and-exchange, and since nobody ever pops a single entry off
+ * the shared stack there is no ABA problem. The shared stack holds about
+ * RECYCLE_MAX_SHARED instances per type, anything beyond that is freed.
+ *
+ * While an instance sits in a list, its _gst_reserved field links it to the
+ * next one.
+ */
+#define RECYCLE_MAX_TYPES   4
+#define RECYCLE_THREAD_DEPTH 64
+#define RECYCLE_MAX_SHARED  1024
+
+#define RECYCLE_NEXT(obj) (*(GstMiniObject **) &(obj)->_gst_reserved)
+
+typedef struct
+{
+  GType type;
+  gsize instance_size;
+  GInstanceInitFunc init;
+
+  /* the shared stack and its approximate length */
+  volatile gpointer shared;
+  volatile gint n_shared;
+} RecycleType;
+
+typedef struct
+{
+  GstMiniObject *head;
+  guint n;
+} RecycleList;
+
+typedef struct
+{
+  RecycleList lists[RECYCLE_MAX_TYPES];
+} RecycleThreadCache;
+
+static RecycleType recycle_types[RECYCLE_MAX_TYPES];
+static guint recycle_n_types;
+static GStaticPrivate recycle_thread_cache = G_STATIC_PRIVATE_INIT;
+
+/* Makes gst_mini_object_new() reuse freed instances of @type. A recycled
+ * instance is cleared to zero, like a new one, and then set up with the
+ * #GstMiniObject defaults and @init, so @type must not have any instance init
+ * function between #GstMiniObject and itself. Must be called during
+ * initialization, before other threads can create mini-objects. */
+void
+_priv_gst_mini_object_register_recycling (GType type, GInstanceInitFunc init)
+{
+  GTypeQuery query;
+  RecycleType *rt;
+
+  g_return_if_fail (g_type_is_a (type, GST_TYPE_MINI_OBJECT));
+  g_return_if_fail (recycle_n_types < RECYCLE_MAX_TYPES);
+
+  /* keep the real allocations visible to valgrind */
+  if (_priv_gst_in_valgrind ())
+    return;
+
+  g_type_query (type, &query);
+  g_return_if_fail (query.instance_size >= sizeof (GstMiniObject));
+
+  rt = &recycle_types[recycle_n_types];
+  rt->type = type;
+  rt->instance_size = query.instance_size;
+  rt->init = init;
+  recycle_n_types++;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "recycling %s instances",
+      g_type_name (type));
+}
+
+static inline gint
+recycle_lookup (GType type)
+{
+  guint i;
+
+  for (i = 0; i < recycle_n_types; i++)
+    if (recycle_types[i].type == type)
+      return i;
+
+  return -1;
+}
+
+static void
+recycle_free_chain (GstMiniObject * obj)
+{
+  while (obj) {
+    GstMiniObject *next = RECYCLE_NEXT (obj);
+
+    g_type_free_instance ((GTypeInstance *) obj);
+    obj = next;
+  }
+}
+
+/* pushes the @n instances from @head to @tail onto the shared stack, or frees
+ * them if it is full */
+static void
+recycle_push_shared (RecycleType * rt, GstMiniObject * head,
+    GstMiniObject * tail, guint n)
+{
+  gpointer top;
+
+  if (g_atomic_int_get (&rt->n_shared) >= RECYCLE_MAX_SHARED) {
+    RECYCLE_NEXT (tail) = NULL;
+    recycle_free_chain (head);
+    return;
+  }
+
+  g_atomic_int_add (&rt->n_shared, n);
+  do {
+    top = g_atomic_pointer_get (&rt->shared);
+    RECYCLE_NEXT (tail) = top;
+  } while (!g_atomic_pointer_compare_and_exchange (&rt->shared, top, head));
+}
+
+/* takes the complete shared stack of @rt into @list */
+static void
+recycle_steal_shared (RecycleType * rt, RecycleList * list)
+{
+  GstMiniObject *head, *obj;
+  guint n = 0;
+
+  do {
+    head = g_atomic_pointer_get (&rt->shared);
+    if (head == NULL)
+      return;
+  } while (!g_atomic_pointer_compare_and_exchange (&rt->shared, head, NULL));
+
+  for (obj = head; RECYCLE_NEXT (obj); obj = RECYCLE_NEXT (obj))
+    n++;
+  n++;
+  g_atomic_int_add (&rt->n_shared, -(gint) n);
+
+  RECYCLE_NEXT (obj) = list->head;
+  list->head = head;
+  list->n += n;
+}
+
+static void
+recycle_thread_cache_free (RecycleThreadCache * cache)
+{
+  guint i;
+
+  for (i = 0; i < recycle_n_types; i++) {
+    RecycleList *list = &cache->lists[i];
+    GstMiniObject *tail;
+
+    if (list->head == NULL)
+      continue;
+    for (tail = list->head; RECYCLE_NEXT (tail); tail = RECYCLE_NEXT (tail));
+    recycle_push_shared (&recycle_types[i], list->head, tail, list->n);
+  }
+  g_free (cache);
+}
+
+static inline RecycleThreadCache *
+recycle_get_thread_cache (void)
+{
+  RecycleThreadCache *cache;
+
+  cache = g_static_private_get (&recycle_thread_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (RecycleThreadCache, 1);
+    g_static_private_set (&recycle_thread_cache, cache,
+        (GDestroyNotify) recycle_thread_cache_free);
+  }
+  return cache;
+}
+
+static GstMiniObject *
+recycle_pop (GType type)
+{
+  RecycleList *list;
+  RecycleType *rt;
+  GstMiniObject *obj;
+  gint idx;
+
+  if ((idx = recycle_lookup (type)) < 0)
+    return NULL;
+
+  rt = &recycle_types[idx];
+  list = &recycle_get_thread_cache ()->lists[idx];
+  if (list->head == NULL) {
+    recycle_steal_shared (rt, list);
+    if (list->head == NULL)
+      return NULL;
+  }
+
+  obj = list->head;
+  list->head = RECYCLE_NEXT (obj);
+  list->n--;
+
+  /* make it look like a new instance again */
+  memset ((guint8 *) obj + sizeof (GTypeInstance), 0,
+      rt->instance_size - sizeof (GTypeInstance));
+  obj->refcount = 1;
+  if (rt->init)
+    rt->init ((GTypeInstance *) obj, obj->instance.g_class);
+
+  return obj;
+}
+
+static gboolean
+recycle_push (GstMiniObject * obj)
+{
+  RecycleList *list;
+  gint idx;
+
+  if ((idx = recycle_lookup (G_TYPE_FROM_INSTANCE (obj))) < 0)
+    return FALSE;
+
+  list = &recycle_get_thread_cache ()->lists[idx];
+  if (G_UNLIKELY (list->n >= RECYCLE_THREAD_DEPTH)) {
+    GstMiniObject *head, *tail;
+    guint i, n;
+
+    /* the first half goes to the shared stack */
+    n = list->n / 2;
+    head = tail = list->head;
+    for (i = 1; i < n; i++)
+      tail = RECYCLE_NEXT (tail);
+    list->head = RECYCLE_NEXT (tail);
+    list->n -= n;
+    recycle_push_shared (&recycle_types[idx], head, tail, n);
+  }
+
+  RECYCLE_NEXT (obj) = list->head;
+  list->head = obj;
+  list->n++;
+
+  return TRUE;
+}
+
 /**
  * gst_mini_object_new:
  * @type: the #GType of the mini-object to create
@@ -186,7 +431,9 @@ gst_mini_object_new (GType type)
 
   /* we don't support dynamic types because they really aren't useful,
    * and could cause refcount problems */
-  mini_object = (GstMiniObject *) g_type_create_instance (type);
+  mini_object = recycle_pop (type);
+  if (mini_object == NULL)
+    mini_object = (GstMiniObject *) g_type_create_instance (type);
 
 #ifndef GST_DISABLE_TRACE
   gst_alloc_trace_new (_gst_mini_object_trace, mini_object);
@@ -341,7 +588,8 @@ gst_mini_object_free (GstMiniObject * mini_object)
 #ifndef GST_DISABLE_TRACE
     gst_alloc_trace_free (_gst_mini_object_trace, mini_object);
 #endif
-    g_type_free_instance ((GTypeInstance *) mini_object);
+    if (!recycle_push (mini_object))
+      g_type_free_instance ((GTypeInstance *) mini_object);
   }
 }
 
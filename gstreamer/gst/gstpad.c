@@ -103,6 +103,9 @@ enum
 struct _GstPadPrivate
 {
   GstPadChainListFunction chainlistfunc;
+
+  /* allocated when statistics are first collected */
+  volatile gpointer stats_mem;
 };
 
 static void gst_pad_dispose (GObject * object);
@@ -138,6 +141,11 @@ static guint gst_pad_signals[LAST_SIGNAL] = { 0 };
 static GQuark buffer_quark;
 static GQuark event_quark;
 
+/* set while a source pad with GST_PAD_ALLOC_POOLED allocates a buffer, so that
+ * the fallback allocation, wherever it ends up after the request has been
+ * proxied downstream, comes from the buffer pool */
+static GStaticPrivate alloc_pooled = G_STATIC_PRIVATE_INIT;
+
 typedef struct
 {
   const gint ret;
@@ -380,6 +388,8 @@ gst_pad_init (GstPad * pad)
   g_static_rec_mutex_init (pad->stream_rec_lock);
 
   pad->block_cond = g_cond_new ();
+
+  pad->abidata.ABI.priv->stats_mem = NULL;
 }
 
 static void
@@ -445,6 +455,9 @@ gst_pad_finalize (GObject * object)
     pad->block_cond = NULL;
   }
 
+  g_free (pad->abidata.ABI.priv->stats_mem);
+  pad->abidata.ABI.priv->stats_mem = NULL;
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -2932,7 +2945,12 @@ fallback:
     /* fallback case, allocate a buffer of our own, add pad caps. */
     GST_CAT_DEBUG_OBJECT (GST_CAT_PADS, pad, "fallback buffer alloc");
 
-    if ((*buf = gst_buffer_try_new_and_alloc (size))) {
+    if (g_static_private_get (&alloc_pooled))
+      *buf = gst_buffer_try_new_and_alloc_pooled (size);
+    else
+      *buf = gst_buffer_try_new_and_alloc (size);
+
+    if (*buf) {
       GST_BUFFER_OFFSET (*buf) = offset;
       gst_buffer_set_caps (*buf, caps);
       return GST_FLOW_OK;
@@ -2953,6 +2971,7 @@ gst_pad_alloc_buffer_full (GstPad * pad, guint64 offset, gint size,
   GstFlowReturn ret;
   GstCaps *newcaps;
   gboolean caps_changed;
+  gboolean pooled;
 
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
@@ -2971,9 +2990,16 @@ gst_pad_alloc_buffer_full (GstPad * pad, guint64 offset, gint size,
     goto no_peer;
 
   gst_object_ref (peer);
+  /* only the outermost request needs to set and clear alloc_pooled */
+  pooled = GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_ALLOC_POOLED) &&
+      g_static_private_get (&alloc_pooled) == NULL;
   GST_OBJECT_UNLOCK (pad);
 
+  if (pooled)
+    g_static_private_set (&alloc_pooled, GINT_TO_POINTER (TRUE), NULL);
   ret = gst_pad_buffer_alloc_unchecked (peer, offset, size, caps, buf);
+  if (pooled)
+    g_static_private_set (&alloc_pooled, NULL, NULL);
   gst_object_unref (peer);
 
   if (G_UNLIKELY (ret != GST_FLOW_OK))
@@ -3041,7 +3067,12 @@ wrong_size_fallback:
 
     gst_buffer_unref (*buf);
 
-    if ((*buf = gst_buffer_try_new_and_alloc (size))) {
+    if (GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_ALLOC_POOLED))
+      *buf = gst_buffer_try_new_and_alloc_pooled (size);
+    else
+      *buf = gst_buffer_try_new_and_alloc (size);
+
+    if (*buf) {
       GST_BUFFER_OFFSET (*buf) = offset;
       gst_buffer_set_caps (*buf, caps);
       return GST_FLOW_OK;
@@ -3875,6 +3906,157 @@ gst_ghost_pad_save_thyself (GstPad * pad, xmlNodePtr parent)
 #endif /* 0 */
 #endif /* GST_DISABLE_LOADSAVE */
 
+/* data flow statistics, kept in a block of whole cache lines per pad so that
+ * streaming threads updating the counters of different pads don't share a
+ * cache line. The counters are only written by the streaming thread of the
+ * pad, without locking. */
+static gboolean _gst_pad_stats_enabled = FALSE;
+
+#define GST_PAD_STATS_ALIGN 64
+#define GST_PAD_STATS_SIZE \
+    ((sizeof (GstPadStats) + GST_PAD_STATS_ALIGN - 1) & ~(GST_PAD_STATS_ALIGN - 1))
+#define GST_PAD_STATS_CAST(mem) ((GstPadStats *) GSIZE_TO_POINTER ( \
+    (GPOINTER_TO_SIZE (mem) + GST_PAD_STATS_ALIGN - 1) & \
+    ~(gsize) (GST_PAD_STATS_ALIGN - 1)))
+
+static GstPadStats *
+gst_pad_stats_get (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->abidata.ABI.priv;
+  gpointer mem;
+
+  mem = g_atomic_pointer_get (&priv->stats_mem);
+  if (G_UNLIKELY (mem == NULL)) {
+    mem = g_malloc0 (GST_PAD_STATS_SIZE + GST_PAD_STATS_ALIGN - 1);
+    if (!g_atomic_pointer_compare_and_exchange (&priv->stats_mem, NULL, mem)) {
+      /* another thread was faster */
+      g_free (mem);
+      mem = g_atomic_pointer_get (&priv->stats_mem);
+    }
+  }
+  return GST_PAD_STATS_CAST (mem);
+}
+
+static GstBufferListItem
+gst_pad_stats_add_buffer (GstBuffer ** buffer, guint group, guint idx,
+    GstPadStats * stats)
+{
+  stats->buffers++;
+  stats->bytes += GST_BUFFER_SIZE (*buffer);
+
+  return GST_BUFFER_LIST_CONTINUE;
+}
+
+/* count the data before it is handed on and lost to us */
+static void
+gst_pad_stats_add_data (GstPadStats * stats, gboolean is_buffer, void *data)
+{
+  if (G_LIKELY (is_buffer))
+    gst_pad_stats_add_buffer ((GstBuffer **) & data, 0, 0, stats);
+  else
+    gst_buffer_list_foreach (GST_BUFFER_LIST_CAST (data),
+        (GstBufferListFunc) gst_pad_stats_add_buffer, stats);
+}
+
+static void
+gst_pad_stats_add_time (GstPadStats * stats, GstClockTime elapsed)
+{
+  guint64 usecs;
+  guint bucket;
+
+  stats->processing += elapsed;
+
+  usecs = elapsed / GST_USECOND;
+  bucket = usecs ? g_bit_storage (usecs) : 0;
+  stats->histogram[MIN (bucket, GST_PAD_STATS_HISTOGRAM_SIZE - 1)]++;
+}
+
+/**
+ * gst_pad_stats_set_enabled:
+ * @enabled: whether to collect statistics
+ *
+ * Enables or disables collecting data flow statistics on all pads, see
+ * gst_pad_get_stats(). Statistics are also enabled at startup when the
+ * GST_PAD_STATS environment variable is set.
+ *
+ * While disabled, pushing data costs one check of a global flag.
+ *
+ * Since: 0.10.30
+ */
+void
+gst_pad_stats_set_enabled (gboolean enabled)
+{
+  _gst_pad_stats_enabled = enabled;
+}
+
+/**
+ * gst_pad_stats_get_enabled:
+ *
+ * Checks whether data flow statistics are collected.
+ *
+ * Returns: %TRUE when statistics are collected on all pads.
+ *
+ * Since: 0.10.30
+ */
+gboolean
+gst_pad_stats_get_enabled (void)
+{
+  return _gst_pad_stats_enabled;
+}
+
+/**
+ * gst_pad_get_stats:
+ * @pad: a #GstPad
+ * @stats: the #GstPadStats to fill in
+ *
+ * Gets the data flow statistics of @pad. Source pads count the buffers
+ * pushed with gst_pad_push() and gst_pad_push_list(), sink pads the buffers
+ * handed to their chain function.
+ *
+ * The counters are updated without locking by the streaming thread, so
+ * values read while data flows are a snapshot that can be slightly off.
+ *
+ * Returns: %TRUE if @stats was filled in, %FALSE if no data went through
+ * @pad while statistics were enabled.
+ *
+ * Since: 0.10.30
+ */
+gboolean
+gst_pad_get_stats (GstPad * pad, GstPadStats * stats)
+{
+  gpointer mem;
+
+  g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
+  g_return_val_if_fail (stats != NULL, FALSE);
+
+  mem = g_atomic_pointer_get (&pad->abidata.ABI.priv->stats_mem);
+  if (mem == NULL)
+    return FALSE;
+
+  memcpy (stats, GST_PAD_STATS_CAST (mem), sizeof (GstPadStats));
+  return TRUE;
+}
+
+/**
+ * gst_pad_reset_stats:
+ * @pad: a #GstPad
+ *
+ * Sets the data flow statistics of @pad back to zero.
+ *
+ * Since: 0.10.30
+ */
+void
+gst_pad_reset_stats (GstPad * pad)
+{
+  gpointer mem;
+
+  g_return_if_fail (GST_IS_PAD (pad));
+
+  mem = g_atomic_pointer_get (&pad->abidata.ABI.priv->stats_mem);
+  if (mem)
+    memset (GST_PAD_STATS_CAST (mem), 0, sizeof (GstPadStats));
+}
+
 /*
  * should be called with pad OBJECT_LOCK and STREAM_LOCK held.
  * GST_PAD_IS_BLOCKED (pad) == TRUE when this function is
@@ -4081,9 +4263,23 @@ gst_pad_chain_data_unchecked (GstPad * pad, gboolean is_buffer, void *data)
   gboolean caps_changed;
   GstFlowReturn ret;
   gboolean emit_signal;
+  GstPadStats *stats = NULL;
+  GstClockTime start = 0;
+
+  if (G_UNLIKELY (_gst_pad_stats_enabled)) {
+    stats = gst_pad_stats_get (pad);
+    start = gst_util_get_timestamp ();
+  }
 
   GST_PAD_STREAM_LOCK (pad);
 
+  if (G_UNLIKELY (stats)) {
+    GstClockTime now = gst_util_get_timestamp ();
+
+    stats->blocked += now - start;
+    start = now;
+  }
+
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
@@ -4128,8 +4324,14 @@ gst_pad_chain_data_unchecked (GstPad * pad, gboolean is_buffer, void *data)
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "calling chainfunction &%s", GST_DEBUG_FUNCPTR_NAME (chainfunc));
 
+    if (G_UNLIKELY (stats))
+      gst_pad_stats_add_data (stats, TRUE, data);
+
     ret = chainfunc (pad, GST_BUFFER_CAST (data));
 
+    if (G_UNLIKELY (stats))
+      gst_pad_stats_add_time (stats, gst_util_get_timestamp () - start);
+
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainfunction &%s, returned %s",
         GST_DEBUG_FUNCPTR_NAME (chainfunc), gst_flow_get_name (ret));
@@ -4143,8 +4345,14 @@ gst_pad_chain_data_unchecked (GstPad * pad, gboolean is_buffer, void *data)
         "calling chainlistfunction &%s",
         GST_DEBUG_FUNCPTR_NAME (chainlistfunc));
 
+    if (G_UNLIKELY (stats))
+      gst_pad_stats_add_data (stats, FALSE, data);
+
     ret = chainlistfunc (pad, GST_BUFFER_LIST_CAST (data));
 
+    if (G_UNLIKELY (stats))
+      gst_pad_stats_add_time (stats, gst_util_get_timestamp () - start);
+
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainlistfunction &%s, returned %s",
         GST_DEBUG_FUNCPTR_NAME (chainlistfunc), gst_flow_get_name (ret));
@@ -4313,9 +4521,22 @@ gst_pad_push_data (GstPad * pad, gboolean is_buffer, void *data)
 
   /* FIXME: this check can go away; pad_set_blocked could be implemented with
    * probes completely or probes with an extended pad block. */
-  while (G_UNLIKELY (GST_PAD_IS_BLOCKED (pad)))
-    if ((ret = handle_pad_block (pad)) != GST_FLOW_OK)
+  if (G_UNLIKELY (GST_PAD_IS_BLOCKED (pad))) {
+    GstClockTime start = GST_CLOCK_TIME_NONE;
+
+    if (G_UNLIKELY (_gst_pad_stats_enabled))
+      start = gst_util_get_timestamp ();
+
+    ret = GST_FLOW_OK;
+    while (ret == GST_FLOW_OK && GST_PAD_IS_BLOCKED (pad))
+      ret = handle_pad_block (pad);
+
+    if (G_UNLIKELY (GST_CLOCK_TIME_IS_VALID (start)))
+      gst_pad_stats_get (pad)->blocked += gst_util_get_timestamp () - start;
+
+    if (ret != GST_FLOW_OK)
       goto flushed;
+  }
 
   /* we emit signals on the pad arg, the peer will have a chance to
    * emit in the _chain() function */
@@ -4428,6 +4649,25 @@ not_negotiated:
   }
 }
 
+/* gst_pad_push_data() with statistics, kept out of the way of the normal
+ * path */
+static GstFlowReturn
+gst_pad_push_data_stats (GstPad * pad, gboolean is_buffer, void *data)
+{
+  GstPadStats *stats;
+  GstClockTime start;
+  GstFlowReturn ret;
+
+  stats = gst_pad_stats_get (pad);
+  gst_pad_stats_add_data (stats, is_buffer, data);
+
+  start = gst_util_get_timestamp ();
+  ret = gst_pad_push_data (pad, is_buffer, data);
+  gst_pad_stats_add_time (stats, gst_util_get_timestamp () - start);
+
+  return ret;
+}
+
 /**
  * gst_pad_push:
  * @pad: a source #GstPad, returns #GST_FLOW_ERROR if not.
@@ -4461,6 +4701,9 @@ gst_pad_push (GstPad * pad, GstBuffer * buffer)
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
+  if (G_UNLIKELY (_gst_pad_stats_enabled))
+    return gst_pad_push_data_stats (pad, TRUE, buffer);
+
   return gst_pad_push_data (pad, TRUE, buffer);
 }
 
@@ -4506,6 +4749,9 @@ gst_pad_push_list (GstPad * pad, GstBufferList * list)
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
+  if (G_UNLIKELY (_gst_pad_stats_enabled))
+    return gst_pad_push_data_stats (pad, FALSE, list);
+
   return gst_pad_push_data (pad, FALSE, list);
 }
 
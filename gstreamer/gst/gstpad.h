@@ -539,6 +539,9 @@ typedef enum {
  * @GST_PAD_IN_GETCAPS: GstPadGetCapsFunction() is running now
  * @GST_PAD_IN_SETCAPS: GstPadSetCapsFunction() is running now
  * @GST_PAD_BLOCKING: is pad currently blocking on a buffer or event
+ * @GST_PAD_ALLOC_POOLED: when no element downstream provides buffers for
+ *   gst_pad_alloc_buffer() on this source pad, allocate them with
+ *   gst_buffer_try_new_and_alloc_pooled(). Since: 0.10.30
  * @GST_PAD_FLAG_LAST: offset to define more flags
  *
  * Pad state flags
@@ -549,10 +552,54 @@ typedef enum {
   GST_PAD_IN_GETCAPS    = (GST_OBJECT_FLAG_LAST << 2),
   GST_PAD_IN_SETCAPS    = (GST_OBJECT_FLAG_LAST << 3),
   GST_PAD_BLOCKING	= (GST_OBJECT_FLAG_LAST << 4),
+  GST_PAD_ALLOC_POOLED  = (GST_OBJECT_FLAG_LAST << 5),
   /* padding */
   GST_PAD_FLAG_LAST     = (GST_OBJECT_FLAG_LAST << 8)
 } GstPadFlags;
 
+/* so that code which also builds against older releases can check for it */
+#define GST_PAD_ALLOC_POOLED GST_PAD_ALLOC_POOLED
+
+/**
+ * GST_PAD_STATS_HISTOGRAM_SIZE:
+ *
+ * The number of buckets in the histogram of #GstPadStats.
+ *
+ * Since: 0.10.30
+ */
+#define GST_PAD_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * GstPadStats:
+ * @buffers: number of buffers that went through the pad
+ * @bytes: number of bytes in those buffers
+ * @processing: total time spent in pushing the buffers to the peer (source
+ *   pads) or in the chain function (sink pads)
+ * @blocked: total time the streaming thread waited for a pad block to be
+ *   released (source pads) or for the stream lock (sink pads)
+ * @histogram: the number of pushes or chain function calls by the time they
+ *   took. The first bucket counts the calls that took less than a
+ *   microsecond, bucket n those that took from 2^(n-1) up to 2^n
+ *   microseconds and the last bucket all longer calls.
+ *
+ * Data flow statistics of a pad, see gst_pad_get_stats(). Buffer lists count
+ * as one call with all their buffers.
+ *
+ * Since: 0.10.30
+ */
+typedef struct _GstPadStats GstPadStats;
+
+struct _GstPadStats {
+  guint64      buffers;
+  guint64      bytes;
+  GstClockTime processing;
+  GstClockTime blocked;
+  guint64      histogram[GST_PAD_STATS_HISTOGRAM_SIZE];
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
 /* FIXME: this awful circular dependency need to be resolved properly (see padtemplate.h) */
 typedef struct _GstPadTemplate GstPadTemplate;
 
@@ -965,6 +1012,12 @@ gboolean		gst_pad_peer_query			(GstPad *pad, GstQuery *query);
 void			gst_pad_set_query_function		(GstPad *pad, GstPadQueryFunction query);
 gboolean		gst_pad_query_default			(GstPad *pad, GstQuery *query);
 
+/* data flow statistics */
+void			gst_pad_stats_set_enabled		(gboolean enabled);
+gboolean		gst_pad_stats_get_enabled		(void);
+gboolean		gst_pad_get_stats			(GstPad *pad, GstPadStats *stats);
+void			gst_pad_reset_stats			(GstPad *pad);
+
 /* misc helper functions */
 gboolean		gst_pad_dispatcher			(GstPad *pad, GstPadDispatcherFunction dispatch,
 								 gpointer data);
@@ -61,18 +61,54 @@ static gboolean plugin_loader_free (GstPluginLoader * loader);
 static gboolean plugin_loader_load (GstPluginLoader * loader,
     const gchar * filename, off_t file_size, time_t file_mtime);
 
+static GstPluginLoaderPool *plugin_loader_pool_new (GstRegistry * registry,
+    guint max_scanners);
+static gboolean plugin_loader_pool_free (GstPluginLoaderPool * pool);
+static gboolean plugin_loader_pool_load (GstPluginLoaderPool * pool,
+    const gchar * filename, off_t file_size, time_t file_mtime);
+
 const GstPluginLoaderFuncs _priv_gst_plugin_loader_funcs = {
-  plugin_loader_new, plugin_loader_free, plugin_loader_load
+  plugin_loader_pool_new, plugin_loader_pool_free, plugin_loader_pool_load
 };
 
 typedef struct _PendingPluginEntry
 {
   guint32 tag;
+  /* position in the pool's request order */
+  guint32 seq;
   gchar *filename;
   off_t file_size;
   time_t file_mtime;
 } PendingPluginEntry;
 
+typedef struct _PluginLoaderResult
+{
+  gboolean done;
+  /* the plugin in the staging registry, or NULL */
+  GstPlugin *plugin;
+} PluginLoaderResult;
+
+struct _GstPluginLoaderPool
+{
+  GstRegistry *registry;
+  /* the scanners load plugins into this one, they are moved to @registry
+   * in the order they were asked for */
+  GstRegistry *staging;
+
+  GstPluginLoader **loaders;
+  guint n_loaders;
+  guint max_loaders;
+  /* the read fds of all scanners */
+  GstPoll *fdset;
+
+  guint32 next_seq;
+  /* results from commit_seq on, in request order */
+  guint32 commit_seq;
+  GArray *results;
+
+  gboolean got_plugin_details;
+};
+
 struct _GstPluginLoader
 {
   GstRegistry *registry;
@@ -103,6 +139,10 @@ struct _GstPluginLoader
      PendingPluginEntry structs */
   GList *pending_plugins;
   GList *pending_plugins_tail;
+
+  /* in the parent, the pool this scanner belongs to */
+  GstPluginLoaderPool *pool;
+  GstPollFD pool_fd_r;
 };
 
 #define PACKET_EXIT 1
@@ -127,8 +167,10 @@ static gboolean exchange_packets (GstPluginLoader * l);
 static gboolean plugin_loader_replay_pending (GstPluginLoader * l);
 static gboolean plugin_loader_load_and_sync (GstPluginLoader * l,
     PendingPluginEntry * entry);
-static void plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
+static GstPlugin *plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
     PendingPluginEntry * entry);
+static void plugin_loader_finished (GstPluginLoader * l,
+    PendingPluginEntry * entry, GstPlugin * plugin);
 static void plugin_loader_cleanup_child (GstPluginLoader * loader);
 static gboolean plugin_loader_sync_with_child (GstPluginLoader * l);
 
@@ -142,6 +184,7 @@ plugin_loader_new (GstRegistry * registry)
   l->fdset = gst_poll_new (FALSE);
   gst_poll_fd_init (&l->fd_w);
   gst_poll_fd_init (&l->fd_r);
+  gst_poll_fd_init (&l->pool_fd_r);
 
   l->tx_buf_size = BUF_INIT_SIZE;
   l->tx_buf = g_malloc (BUF_INIT_SIZE);
@@ -195,6 +238,7 @@ plugin_loader_free (GstPluginLoader * loader)
   cur = loader->pending_plugins;
   while (cur) {
     PendingPluginEntry *entry = (PendingPluginEntry *) (cur->data);
+    plugin_loader_finished (loader, entry, NULL);
     g_free (entry->filename);
     g_slice_free (PendingPluginEntry, entry);
 
@@ -222,6 +266,13 @@ plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
 
   entry = g_slice_new (PendingPluginEntry);
   entry->tag = loader->next_tag++;
+  entry->seq = 0;
+  if (loader->pool) {
+    PluginLoaderResult res = { FALSE, NULL };
+
+    entry->seq = loader->pool->next_seq++;
+    g_array_append_val (loader->pool->results, res);
+  }
   entry->filename = g_strdup (filename);
   entry->file_size = file_size;
   entry->file_mtime = file_mtime;
@@ -263,9 +314,12 @@ restart:
       /* Create dummy plugin entry to block re-scanning this file */
       GST_ERROR ("Plugin file %s failed to load. Blacklisting",
           entry->filename);
-      plugin_loader_create_blacklist_plugin (l, entry);
+      plugin_loader_finished (l, entry,
+          plugin_loader_create_blacklist_plugin (l, entry));
       l->got_plugin_details = TRUE;
       /* Now remove this crashy plugin from the head of the list */
+      g_free (entry->filename);
+      g_slice_free (PendingPluginEntry, entry);
       l->pending_plugins = g_list_delete_link (cur, cur);
       if (l->pending_plugins == NULL)
         l->pending_plugins_tail = NULL;
@@ -321,7 +375,7 @@ plugin_loader_load_and_sync (GstPluginLoader * l, PendingPluginEntry * entry)
   return plugin_loader_sync_with_child (l);
 }
 
-static void
+static GstPlugin *
 plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
     PendingPluginEntry * entry)
 {
@@ -343,6 +397,8 @@ plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
 
   GST_DEBUG ("Adding blacklist plugin '%s'", plugin->desc.name);
   gst_registry_add_plugin (l->registry, plugin);
+
+  return plugin;
 }
 
 static gboolean
@@ -370,6 +426,12 @@ gst_plugin_loader_try_helper (GstPluginLoader * loader, gchar * location)
 
   loader->child_running = TRUE;
 
+  if (loader->pool) {
+    loader->pool_fd_r.fd = loader->fd_r.fd;
+    gst_poll_add_fd (loader->pool->fdset, &loader->pool_fd_r);
+    gst_poll_fd_ctl_read (loader->pool->fdset, &loader->pool_fd_r, TRUE);
+  }
+
   return TRUE;
 }
 
@@ -416,6 +478,10 @@ plugin_loader_cleanup_child (GstPluginLoader * l)
 
   gst_poll_remove_fd (l->fdset, &l->fd_w);
   gst_poll_remove_fd (l->fdset, &l->fd_r);
+  if (l->pool) {
+    gst_poll_remove_fd (l->pool->fdset, &l->pool_fd_r);
+    gst_poll_fd_init (&l->pool_fd_r);
+  }
 
   close (l->fd_w.fd);
   close (l->fd_r.fd);
@@ -431,6 +497,229 @@ plugin_loader_cleanup_child (GstPluginLoader * l)
   l->child_running = FALSE;
 }
 
+/* A pool of scanners. Files are handed to the scanner with the least work
+ * queued, and a new one is started while all of them are busy, up to
+ * max_loaders. Every scanner still replays its own work when its child
+ * crashes, so a crashing plugin only gets blacklisted by itself. */
+
+static GstPluginLoaderPool *
+plugin_loader_pool_new (GstRegistry * registry, guint max_scanners)
+{
+  GstPluginLoaderPool *pool = g_slice_new0 (GstPluginLoaderPool);
+
+  pool->registry = gst_object_ref (registry);
+  pool->staging = g_object_newv (GST_TYPE_REGISTRY, 0, NULL);
+  gst_object_ref_sink (pool->staging);
+
+  pool->max_loaders = MAX (max_scanners, 1);
+  pool->loaders = g_new0 (GstPluginLoader *, pool->max_loaders);
+  pool->fdset = gst_poll_new (FALSE);
+  pool->results = g_array_new (FALSE, FALSE, sizeof (PluginLoaderResult));
+
+  GST_DEBUG_OBJECT (registry, "plugin scanner pool of up to %u scanners",
+      pool->max_loaders);
+
+  return pool;
+}
+
+/* moves @plugin and its features from the staging registry to the real one */
+static void
+plugin_loader_pool_move_plugin (GstPluginLoaderPool * pool, GstPlugin * plugin)
+{
+  GList *features = NULL, *walk;
+
+  gst_object_ref (plugin);
+  /* unless a later plugin with the same basename replaced it already */
+  if (g_list_find (pool->staging->plugins, plugin)) {
+    features = gst_registry_get_feature_list_by_plugin (pool->staging,
+        plugin->desc.name);
+    gst_registry_remove_plugin (pool->staging, plugin);
+  }
+
+  GST_LOG_OBJECT (pool->registry, "adding plugin %s with %u features",
+      plugin->desc.name, g_list_length (features));
+  gst_registry_add_plugin (pool->registry, plugin);
+  for (walk = features; walk; walk = walk->next)
+    gst_registry_add_feature (pool->registry, walk->data);
+
+  gst_plugin_feature_list_free (features);
+  gst_object_unref (plugin);
+}
+
+/* adds the finished results to the registry, in request order */
+static void
+plugin_loader_pool_commit (GstPluginLoaderPool * pool)
+{
+  while (pool->results->len > 0) {
+    PluginLoaderResult *res =
+        &g_array_index (pool->results, PluginLoaderResult, 0);
+    GstPlugin *plugin = res->plugin;
+
+    if (!res->done)
+      break;
+
+    g_array_remove_index (pool->results, 0);
+    pool->commit_seq++;
+
+    if (plugin) {
+      plugin_loader_pool_move_plugin (pool, plugin);
+      gst_object_unref (plugin);
+    }
+  }
+}
+
+static void
+plugin_loader_finished (GstPluginLoader * l, PendingPluginEntry * entry,
+    GstPlugin * plugin)
+{
+  GstPluginLoaderPool *pool = l->pool;
+  PluginLoaderResult *res;
+
+  if (pool == NULL)
+    return;
+
+  g_return_if_fail (entry->seq - pool->commit_seq < pool->results->len);
+  res = &g_array_index (pool->results, PluginLoaderResult,
+      entry->seq - pool->commit_seq);
+  res->done = TRUE;
+  /* the staging registry could replace it with a plugin of the same
+   * basename before it is committed */
+  res->plugin = plugin ? gst_object_ref (plugin) : NULL;
+}
+
+/* gives up on everything @l still has to do */
+static void
+plugin_loader_drop_pending (GstPluginLoader * l)
+{
+  GList *cur;
+
+  for (cur = l->pending_plugins; cur; cur = g_list_delete_link (cur, cur)) {
+    PendingPluginEntry *entry = (PendingPluginEntry *) (cur->data);
+
+    GST_WARNING ("Giving up on plugin file %s", entry->filename);
+    plugin_loader_finished (l, entry, NULL);
+    g_free (entry->filename);
+    g_slice_free (PendingPluginEntry, entry);
+  }
+  l->pending_plugins = l->pending_plugins_tail = NULL;
+}
+
+/* handles what the scanners sent, waiting up to @timeout for it */
+static void
+plugin_loader_pool_poll (GstPluginLoaderPool * pool, GstClockTime timeout)
+{
+  gint res;
+  guint i;
+
+  do {
+    res = gst_poll_wait (pool->fdset, timeout);
+  } while (res == -1 && (errno == EINTR || errno == EAGAIN));
+
+  for (i = 0; res > 0 && i < pool->n_loaders; i++) {
+    GstPluginLoader *l = pool->loaders[i];
+
+    if (!l->child_running)
+      continue;
+    if (!gst_poll_fd_can_read (pool->fdset, &l->pool_fd_r) &&
+        !gst_poll_fd_has_closed (pool->fdset, &l->pool_fd_r) &&
+        !gst_poll_fd_has_error (pool->fdset, &l->pool_fd_r))
+      continue;
+
+    if (!exchange_packets (l) && !plugin_loader_replay_pending (l))
+      plugin_loader_drop_pending (l);
+  }
+
+  plugin_loader_pool_commit (pool);
+}
+
+static gboolean
+plugin_loader_pool_load (GstPluginLoaderPool * pool, const gchar * filename,
+    off_t file_size, time_t file_mtime)
+{
+  GstPluginLoader *l = NULL;
+  guint i, queued = G_MAXUINT;
+  gboolean res;
+
+  for (i = 0; i < pool->n_loaders; i++) {
+    guint n = g_list_length (pool->loaders[i]->pending_plugins);
+
+    if (n < queued) {
+      l = pool->loaders[i];
+      queued = n;
+    }
+  }
+
+  if (queued > 0 && pool->n_loaders < pool->max_loaders) {
+    GstPluginLoader *new_loader = plugin_loader_new (pool->staging);
+
+    new_loader->pool = pool;
+    if (gst_plugin_loader_spawn (new_loader)) {
+      GST_DEBUG_OBJECT (pool->registry, "started plugin scanner %u",
+          pool->n_loaders);
+      pool->loaders[pool->n_loaders++] = new_loader;
+      l = new_loader;
+    } else {
+      plugin_loader_free (new_loader);
+    }
+  }
+
+  if (l == NULL)
+    return FALSE;
+
+  res = plugin_loader_load (l, filename, file_size, file_mtime);
+
+  /* pick up whatever is ready already */
+  plugin_loader_pool_poll (pool, 0);
+
+  return res;
+}
+
+static gboolean
+plugin_loader_pool_free (GstPluginLoaderPool * pool)
+{
+  gboolean changed;
+  guint i;
+
+  /* wait for all answers, the scanners keep working in parallel */
+  while (pool->results->len > 0) {
+    gboolean running = FALSE;
+
+    for (i = 0; i < pool->n_loaders; i++) {
+      GstPluginLoader *l = pool->loaders[i];
+
+      if (l->pending_plugins == NULL)
+        continue;
+      if (!l->child_running && !plugin_loader_replay_pending (l)) {
+        plugin_loader_drop_pending (l);
+        continue;
+      }
+      running = TRUE;
+    }
+    if (!running)
+      break;
+
+    plugin_loader_pool_poll (pool, GST_SECOND);
+  }
+
+  for (i = 0; i < pool->n_loaders; i++)
+    pool->got_plugin_details |= plugin_loader_free (pool->loaders[i]);
+  /* anything still missing was lost with its scanner */
+  for (i = 0; i < pool->results->len; i++)
+    g_array_index (pool->results, PluginLoaderResult, i).done = TRUE;
+  plugin_loader_pool_commit (pool);
+
+  changed = pool->got_plugin_details;
+
+  g_free (pool->loaders);
+  gst_poll_free (pool->fdset);
+  g_array_free (pool->results, TRUE);
+  gst_object_unref (pool->staging);
+  gst_object_unref (pool->registry);
+  g_slice_free (GstPluginLoaderPool, pool);
+
+  return changed;
+}
+
 gboolean
 _gst_plugin_loader_client_run (void)
 {
@@ -759,6 +1048,7 @@ handle_rx_packet (GstPluginLoader * l,
           break;
         } else {
           cur = g_list_delete_link (cur, cur);
+          plugin_loader_finished (l, e, NULL);
           g_free (e->filename);
           g_slice_free (PendingPluginEntry, e);
         }
@@ -786,9 +1076,12 @@ handle_rx_packet (GstPluginLoader * l,
 
         /* We got a set of plugin details - remember it for later */
         l->got_plugin_details = TRUE;
+        if (entry != NULL)
+          plugin_loader_finished (l, entry, newplugin);
       } else if (entry != NULL) {
         /* Create a blacklist entry for this file to prevent scanning every time */
-        plugin_loader_create_blacklist_plugin (l, entry);
+        plugin_loader_finished (l, entry,
+            plugin_loader_create_blacklist_plugin (l, entry));
         l->got_plugin_details = TRUE;
       }
 
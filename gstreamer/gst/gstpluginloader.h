@@ -24,11 +24,16 @@
 G_BEGIN_DECLS
 
 typedef struct _GstPluginLoader GstPluginLoader;
+typedef struct _GstPluginLoaderPool GstPluginLoaderPool;
 
+/* create() makes a pool of up to @max_scanners plugin scanner processes that
+ * load plugins in parallel. Whatever order they finish in, the plugins are
+ * added to @registry in the order load() was called for them. destroy()
+ * waits for all of them and returns TRUE if the registry changed. */
 typedef struct _GstPluginLoaderFuncs {
-  GstPluginLoader * (*create)(GstRegistry *registry);
-  gboolean (*destroy)(GstPluginLoader *loader);
-  gboolean (*load)(GstPluginLoader *loader, const gchar *filename,
+  GstPluginLoaderPool * (*create)(GstRegistry *registry, guint max_scanners);
+  gboolean (*destroy)(GstPluginLoaderPool *pool);
+  gboolean (*load)(GstPluginLoaderPool *pool, const gchar *filename,
       off_t file_size, time_t file_mtime);
 } GstPluginLoaderFuncs;
 
@@ -99,6 +99,7 @@
 #endif
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* For g_stat () */
@@ -111,6 +112,7 @@
 #include "gstfilter.h"
 
 #include "gstpluginloader.h"
+#include "gstregistrychunks.h"
 
 #include "gst-i18n-lib.h"
 
@@ -132,6 +134,8 @@ struct _GstRegistryPrivate
   guint32 efl_cookie;
   GList *typefind_factory_list;
   guint32 tfl_cookie;
+  /* features of the registry cache that weren't created yet */
+  GstRegistryIndex *index;
 };
 
 /* the one instance of the default registry and the mutex protecting the
@@ -141,6 +145,8 @@ static GstRegistry *_gst_registry_default = NULL;
 
 /* defaults */
 #define DEFAULT_FORK TRUE
+/* upper limit for the default number of plugin scanners */
+#define DEFAULT_MAX_SCAN_JOBS 8
 
 /* control the behaviour of registry rebuild */
 static gboolean _gst_enable_registry_fork = DEFAULT_FORK;
@@ -168,6 +174,8 @@ static void gst_registry_finalize (GObject * object);
 
 static guint gst_registry_signals[LAST_SIGNAL] = { 0 };
 
+static GList *gst_registry_load_features_locked (GstRegistry * registry,
+    GType type);
 static GstPluginFeature *gst_registry_lookup_feature_locked (GstRegistry *
     registry, const char *name);
 static GstPlugin *gst_registry_lookup_bn_locked (GstRegistry * registry,
@@ -265,6 +273,11 @@ gst_registry_finalize (GObject * object)
   }
   g_list_free (features);
 
+  if (registry->priv->index) {
+    _priv_gst_registry_index_free (registry->priv->index);
+    registry->priv->index = NULL;
+  }
+
   g_hash_table_destroy (registry->feature_hash);
   registry->feature_hash = NULL;
   g_hash_table_destroy (registry->basename_hash);
@@ -457,6 +470,8 @@ gst_registry_remove_features_for_plugin_unlocked (GstRegistry * registry,
     }
     f = next;
   }
+  if (registry->priv->index)
+    _priv_gst_registry_index_drop_plugin (registry->priv->index, name);
   registry->priv->cookie++;
 }
 
@@ -510,8 +525,12 @@ gst_registry_add_feature (GstRegistry * registry, GstPluginFeature * feature)
   g_return_val_if_fail (feature->plugin_name != NULL, FALSE);
 
   GST_OBJECT_LOCK (registry);
-  existing_feature = gst_registry_lookup_feature_locked (registry,
+  /* the feature replaces a cached one, no need to create that */
+  existing_feature = g_hash_table_lookup (registry->feature_hash,
       feature->name);
+  if (registry->priv->index)
+    _priv_gst_registry_index_drop_feature (registry->priv->index,
+        feature->name);
   if (G_UNLIKELY (existing_feature)) {
     GST_DEBUG_OBJECT (registry, "replacing existing feature %p (%s)",
         existing_feature, feature->name);
@@ -619,6 +638,8 @@ gst_registry_get_feature_list_or_create (GstRegistry * registry,
   if (G_UNLIKELY (!*previous || priv->cookie != *cookie)) {
     GstTypeNameData data;
 
+    g_list_free (gst_registry_load_features_locked (registry, type));
+
     if (*previous)
       gst_plugin_feature_list_free (*previous);
 
@@ -715,6 +736,8 @@ gst_registry_feature_filter (GstRegistry * registry,
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
 
   GST_OBJECT_LOCK (registry);
+  g_list_free (gst_registry_load_features_locked (registry,
+          GST_TYPE_PLUGIN_FEATURE));
   list = gst_filter_run (registry->features, (GstFilterFunc) filter, first,
       user_data);
   for (g = list; g; g = g->next) {
@@ -807,6 +830,7 @@ GList *
 gst_registry_get_feature_list (GstRegistry * registry, GType type)
 {
   GstTypeNameData data;
+  GList *list, *g;
 
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
   g_return_val_if_fail (g_type_is_a (type, GST_TYPE_PLUGIN_FEATURE), NULL);
@@ -820,9 +844,17 @@ gst_registry_get_feature_list (GstRegistry * registry, GType type)
   data.type = type;
   data.name = NULL;
 
-  return gst_registry_feature_filter (registry,
-      (GstPluginFeatureFilter) gst_plugin_feature_type_name_filter,
-      FALSE, &data);
+  /* only create the cached features of @type */
+  GST_OBJECT_LOCK (registry);
+  g_list_free (gst_registry_load_features_locked (registry, type));
+  list = gst_filter_run (registry->features,
+      (GstFilterFunc) gst_plugin_feature_type_name_filter, FALSE, &data);
+  for (g = list; g; g = g->next) {
+    gst_object_ref (GST_PLUGIN_FEATURE_CAST (g->data));
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  return list;
 }
 
 /**
@@ -854,10 +886,93 @@ gst_registry_get_plugin_list (GstRegistry * registry)
   return list;
 }
 
+/* adds a feature that was created from the registry cache. Unlike
+ * gst_registry_add_feature() this doesn't change the feature list cookie and
+ * doesn't emit feature-added, as far as the outside is concerned the feature
+ * was there all the time.
+ *
+ * Must be called with the object lock taken */
+static void
+gst_registry_insert_cached_feature_locked (GstRegistry * registry,
+    GstPluginFeature * feature)
+{
+  if (G_UNLIKELY (g_hash_table_lookup (registry->feature_hash,
+              feature->name))) {
+    /* added by hand in the meantime, that one wins */
+    gst_object_unref (feature);
+    return;
+  }
+
+  registry->features = g_list_prepend (registry->features, feature);
+  g_hash_table_insert (registry->feature_hash, feature->name, feature);
+  gst_object_ref_sink (feature);
+}
+
+/* creates the features of @type that are still in the registry cache and
+ * returns them, they are owned by the registry.
+ *
+ * Must be called with the object lock taken */
+static GList *
+gst_registry_load_features_locked (GstRegistry * registry, GType type)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GList *list, *walk;
+
+  if (G_LIKELY (priv->index == NULL))
+    return NULL;
+
+  list = _priv_gst_registry_index_load_features (priv->index, type);
+  for (walk = list; walk; walk = walk->next)
+    gst_registry_insert_cached_feature_locked (registry, walk->data);
+
+  if (_priv_gst_registry_index_is_empty (priv->index)) {
+    GST_DEBUG_OBJECT (registry, "all cached features were created");
+    _priv_gst_registry_index_free (priv->index);
+    priv->index = NULL;
+  }
+
+  return list;
+}
+
 static GstPluginFeature *
 gst_registry_lookup_feature_locked (GstRegistry * registry, const char *name)
 {
-  return g_hash_table_lookup (registry->feature_hash, name);
+  GstPluginFeature *feature;
+
+  feature = g_hash_table_lookup (registry->feature_hash, name);
+  if (feature == NULL && registry->priv->index) {
+    feature = _priv_gst_registry_index_load_feature (registry->priv->index,
+        name);
+    if (feature) {
+      gst_registry_insert_cached_feature_locked (registry, feature);
+      feature = g_hash_table_lookup (registry->feature_hash, name);
+    }
+  }
+
+  return feature;
+}
+
+/*
+ * _priv_gst_registry_set_index:
+ * @registry: a #GstRegistry
+ * @index: the features of the registry cache, or %NULL
+ *
+ * Makes @registry create the features in @index when they are asked for.
+ * @registry takes ownership of @index.
+ */
+void
+_priv_gst_registry_set_index (GstRegistry * registry, GstRegistryIndex * index)
+{
+  GST_OBJECT_LOCK (registry);
+  /* an older cache can't be thrown away, it may have features that the new
+   * one doesn't */
+  g_list_free (gst_registry_load_features_locked (registry,
+          GST_TYPE_PLUGIN_FEATURE));
+  if (registry->priv->index)
+    _priv_gst_registry_index_free (registry->priv->index);
+  registry->priv->index = index;
+  registry->priv->cookie++;
+  GST_OBJECT_UNLOCK (registry);
 }
 
 /**
@@ -951,10 +1066,30 @@ typedef struct
 {
   GstRegistry *registry;
   GstRegistryScanHelperState helper_state;
-  GstPluginLoader *helper;
+  GstPluginLoaderPool *helper;
   gboolean changed;
 } GstRegistryScanContext;
 
+#ifndef OPERA_MINIMAL_GST
+/* How many plugin scanners may run at the same time. One per processor
+ * by default, GST_REGISTRY_SCAN_JOBS overrides that. */
+static guint
+gst_registry_get_scan_jobs (void)
+{
+  const gchar *env;
+
+  if ((env = g_getenv ("GST_REGISTRY_SCAN_JOBS"))) {
+    gint jobs = atoi (env);
+
+    if (jobs > 0)
+      return jobs;
+    GST_WARNING ("Invalid GST_REGISTRY_SCAN_JOBS: %s", env);
+  }
+
+  return MIN (gst_util_get_num_cpus (), DEFAULT_MAX_SCAN_JOBS);
+}
+#endif /* OPERA_MINIMAL_GST */
+
 static void
 init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
 {
@@ -1014,7 +1149,8 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
   /* Have a plugin to load - see if the scan-helper needs starting */
   if (context->helper_state == REGISTRY_SCAN_HELPER_NOT_STARTED) {
     GST_DEBUG ("Starting plugin scanner for file %s", filename);
-    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry);
+    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry,
+        gst_registry_get_scan_jobs ());
     if (context->helper != NULL)
       context->helper_state = REGISTRY_SCAN_HELPER_RUNNING;
     else {
@@ -1262,6 +1398,63 @@ gst_registry_get_feature_list_by_plugin (GstRegistry * registry,
       _gst_plugin_feature_filter_plugin_name, FALSE, (gpointer) name);
 }
 
+/**
+ * gst_registry_get_feature_list_by_media_type:
+ * @registry: a #GstRegistry.
+ * @media_type: a media type, like "audio/x-raw-int"
+ *
+ * Retrieves a #GList of the element factories whose pad templates and of the
+ * typefind factories whose caps have a structure named @media_type.
+ *
+ * Unlike filtering the list of all features, this only creates the features
+ * of the registry cache that match.
+ *
+ * Returns: a #GList of #GstPluginFeature. Use gst_plugin_feature_list_free()
+ * after usage.
+ *
+ * MT safe.
+ *
+ * Since: 0.10.30
+ */
+GList *
+gst_registry_get_feature_list_by_media_type (GstRegistry * registry,
+    const gchar * media_type)
+{
+  GstRegistryIndex *index;
+  GList *list = NULL, *names, *walk;
+
+  g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
+  g_return_val_if_fail (media_type != NULL, NULL);
+
+  GST_OBJECT_LOCK (registry);
+  index = registry->priv->index;
+  names = index ? _priv_gst_registry_index_get_media_type (index,
+      media_type) : NULL;
+  for (walk = names; walk; walk = walk->next) {
+    GstPluginFeature *feature;
+
+    feature = gst_registry_lookup_feature_locked (registry, walk->data);
+    if (feature)
+      list = g_list_prepend (list, gst_object_ref (feature));
+    g_free (walk->data);
+  }
+  g_list_free (names);
+
+  /* the features that were never in the cache, the cached ones were all
+   * handled above */
+  for (walk = registry->features; walk; walk = walk->next) {
+    GstPluginFeature *feature = walk->data;
+
+    if (index && _priv_gst_registry_index_has_feature (index, feature->name))
+      continue;
+    if (_priv_gst_registry_chunks_has_media_type (feature, media_type))
+      list = g_list_prepend (list, gst_object_ref (feature));
+  }
+  GST_OBJECT_UNLOCK (registry);
+
+  return list;
+}
+
 /* Unref and delete the default registry */
 void
 _priv_gst_registry_cleanup (void)
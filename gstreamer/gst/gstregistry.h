@@ -107,6 +107,8 @@ GList*			gst_registry_feature_filter	(GstRegistry *registry,
 GList *                 gst_registry_get_feature_list   (GstRegistry *registry,
                                                          GType type);
 GList *                 gst_registry_get_feature_list_by_plugin (GstRegistry *registry, const gchar *name);
+GList *                 gst_registry_get_feature_list_by_media_type (GstRegistry *registry,
+                                                                     const gchar *media_type);
 guint32                 gst_registry_get_feature_list_cookie (GstRegistry *registry);
 
 GstPlugin*		gst_registry_find_plugin	(GstRegistry *registry, const gchar *name);
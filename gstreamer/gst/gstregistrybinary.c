@@ -23,9 +23,8 @@
  */
 
 /* FIXME:
- * - keep registry binary blob and reference strings
- *   - don't free/unmmap contents when leaving gst_registry_binary_read_cache()
- *     - free at gst_deinit() / _priv_gst_registry_cleanup() ?
+ * - reference strings of the registry binary blob instead of copying them,
+ *   it's kept alive by the registry index now
  *   - GstPlugin:
  *     - GST_PLUGIN_FLAG_CONST
  *   - GstPluginFeature, GstIndexFactory, GstElementFactory
@@ -346,7 +345,9 @@ gst_registry_binary_write_cache (GstRegistry * registry, const char *location)
   GstBinaryRegistryMagic magic;
   GList *to_write = NULL;
   unsigned long file_position = 0;
-  BinaryRegistryCache *cache;
+  BinaryRegistryCache *cache = NULL;
+  GArray *positions = NULL;
+  GstRegistryChunk *index;
 
   GST_INFO ("Building binary registry cache image");
 
@@ -392,19 +393,42 @@ gst_registry_binary_write_cache (GstRegistry * registry, const char *location)
   }
   file_position += sizeof (GstBinaryRegistryMagic);
 
-  /* write out data chunks */
+  /* write out data chunks, remembering where the plugins and features are */
+  positions = g_array_new (FALSE, FALSE, sizeof (GstRegistryChunkPosition));
   for (walk = to_write; walk; walk = g_list_next (walk)) {
     GstRegistryChunk *cur = walk->data;
     gboolean res;
 
     res = gst_registry_binary_write_chunk (cache, cur, &file_position);
 
+    if (res && (cur->flags & (GST_REGISTRY_CHUNK_FLAG_PLUGIN |
+                GST_REGISTRY_CHUNK_FLAG_FEATURE))) {
+      GstRegistryChunkPosition pos;
+
+      pos.object = cur->object;
+      pos.offset = file_position - cur->size;
+      g_array_append_val (positions, pos);
+    }
+
     _priv_gst_registry_chunk_free (cur);
     walk->data = NULL;
     if (!res)
       goto fail_free_list;
   }
   g_list_free (to_write);
+  to_write = NULL;
+
+  /* and the index of those at the end */
+  index = _priv_gst_registry_chunks_save_index (positions, file_position);
+  g_array_free (positions, TRUE);
+  positions = NULL;
+  if (!index)
+    goto fail_free_list;
+  if (!gst_registry_binary_write_chunk (cache, index, &file_position)) {
+    _priv_gst_registry_chunk_free (index);
+    goto fail_free_list;
+  }
+  _priv_gst_registry_chunk_free (index);
 
   if (!gst_registry_binary_cache_finish (cache, TRUE))
     return FALSE;
@@ -421,6 +445,8 @@ fail_free_list:
         _priv_gst_registry_chunk_free (cur);
     }
     g_list_free (to_write);
+    if (positions)
+      g_array_free (positions, TRUE);
 
     if (cache)
       (void) gst_registry_binary_cache_finish (cache, FALSE);
@@ -477,6 +503,16 @@ fail:
   return -1;
 }
 
+static void
+gst_registry_binary_unmap (GMappedFile * mapped)
+{
+#if GLIB_CHECK_VERSION(2,22,0)
+  g_mapped_file_unref (mapped);
+#else
+  g_mapped_file_free (mapped);
+#endif
+}
+
 /**
  * gst_registry_binary_read_cache:
  * @registry: a #GstRegistry
@@ -496,6 +532,7 @@ gst_registry_binary_read_cache (GstRegistry * registry, const char *location)
   GError *err = NULL;
   gboolean res = FALSE;
   gint check_magic_result;
+  GstRegistryIndex *index;
 #ifndef GST_DISABLE_GST_DEBUG
   GTimer *timer = NULL;
   gdouble seconds;
@@ -554,26 +591,18 @@ gst_registry_binary_read_cache (GstRegistry * registry, const char *location)
     goto Error;
   }
 
-  /* check if there are plugins in the file */
-  if (G_UNLIKELY (!(((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
-              (gsize) contents + size))) {
-    GST_INFO ("No binary plugins structure to read");
-    /* empty file, this is not an error */
-  } else {
-    gchar *end = contents + size;
-    /* read as long as we still have space for a GstRegistryChunkPluginElement */
-    for (;
-        ((gsize) in + sizeof (GstRegistryChunkPluginElement)) <
-        (gsize) contents + size;) {
-      GST_DEBUG ("reading binary registry %" G_GSIZE_FORMAT "(%x)/%"
-          G_GSIZE_FORMAT, (gsize) in - (gsize) contents,
-          (guint) ((gsize) in - (gsize) contents), size);
-      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, NULL)) {
-        GST_ERROR ("Problem while reading binary registry %s", location);
-        goto Error;
-      }
-    }
+  /* add the plugins, the features are created from the index when they are
+   * needed, so the index keeps the file contents */
+  index = _priv_gst_registry_index_new (registry, contents, size,
+      mapped ? (gpointer) mapped : (gpointer) contents,
+      mapped ? (GDestroyNotify) gst_registry_binary_unmap : g_free);
+  if (G_UNLIKELY (index == NULL)) {
+    GST_ERROR ("Problem while reading binary registry %s", location);
+    goto Error;
   }
+  _priv_gst_registry_set_index (registry, index);
+  mapped = NULL;
+  contents = NULL;
 
 #ifndef GST_DISABLE_GST_DEBUG
   g_timer_stop (timer);
@@ -583,7 +612,6 @@ gst_registry_binary_read_cache (GstRegistry * registry, const char *location)
   GST_INFO ("loaded %s in %lf seconds", location, seconds);
 
   res = TRUE;
-  /* TODO: once we re-use the pointers to registry contents, return here */
 
 Error:
   if (err)
@@ -593,11 +621,7 @@ Error:
   g_timer_destroy (timer);
 #endif
   if (mapped) {
-#if GLIB_CHECK_VERSION(2,22,0)
-    g_mapped_file_unref (mapped);
-#else
-    g_mapped_file_free (mapped);
-#endif
+    gst_registry_binary_unmap (mapped);
   } else {
     g_free (contents);
   }
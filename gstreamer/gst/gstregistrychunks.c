@@ -28,6 +28,8 @@
 #  include "config.h"
 #endif
 
+#include <stdlib.h>
+
 #include <gst/gst_private.h>
 #include <gst/gstconfig.h>
 #include <gst/gstelement.h>
@@ -130,6 +132,7 @@ gst_registry_chunks_save_const_string (GList ** list, const gchar * str)
   chunk->size = strlen ((gchar *) chunk->data) + 1;
   chunk->flags = GST_REGISTRY_CHUNK_FLAG_CONST;
   chunk->align = FALSE;
+  chunk->object = NULL;
   *list = g_list_prepend (*list, chunk);
   return TRUE;
 }
@@ -151,6 +154,7 @@ gst_registry_chunks_save_string (GList ** list, gchar * str)
   chunk->size = strlen ((gchar *) chunk->data) + 1;
   chunk->flags = GST_REGISTRY_CHUNK_FLAG_MALLOC;
   chunk->align = FALSE;
+  chunk->object = NULL;
   *list = g_list_prepend (*list, chunk);
   return TRUE;
 }
@@ -172,6 +176,7 @@ gst_registry_chunks_make_data (gpointer data, gulong size)
   chunk->size = size;
   chunk->flags = GST_REGISTRY_CHUNK_FLAG_NONE;
   chunk->align = TRUE;
+  chunk->object = NULL;
   return chunk;
 }
 
@@ -304,6 +309,18 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     tff->nextensions = 0;
     pf = (GstRegistryChunkPluginFeature *) tff;
 
+    /* save signature */
+    if (factory->abidata.ABI.signature) {
+      GstRegistryChunk *sig_chk;
+
+      tff->signature_offset = factory->abidata.ABI.signature_offset;
+      tff->signature_size = factory->abidata.ABI.signature_size;
+      sig_chk = gst_registry_chunks_make_data (g_memdup (factory->abidata.
+              ABI.signature, tff->signature_size), tff->signature_size);
+      sig_chk->flags = GST_REGISTRY_CHUNK_FLAG_MALLOC;
+      sig_chk->align = FALSE;
+      *list = g_list_prepend (*list, sig_chk);
+    }
     /* save extensions */
     if (factory->extensions) {
       while (factory->extensions[tff->nextensions]) {
@@ -346,6 +363,10 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
     gst_registry_chunks_save_const_string (list, feature->name);
     gst_registry_chunks_save_const_string (list, (gchar *) type_name);
 
+    chk = (*list)->data;
+    chk->flags |= GST_REGISTRY_CHUNK_FLAG_FEATURE;
+    chk->object = feature;
+
     return TRUE;
   }
 
@@ -415,16 +436,8 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
   pe->nfeatures = 0;
   pe->n_deps = 0;
 
-  /* pack external deps */
-  for (walk = plugin->priv->deps; walk != NULL; walk = walk->next) {
-    if (!gst_registry_chunks_save_plugin_dep (list, walk->data)) {
-      GST_ERROR ("Could not save external plugin dependency, aborting.");
-      goto fail;
-    }
-    ++pe->n_deps;
-  }
-
-  /* pack plugin features */
+  /* pack plugin features, they go last so that the plugin can be loaded
+   * without them */
   plugin_features =
       gst_registry_get_feature_list_by_plugin (registry, plugin->desc.name);
   for (walk = plugin_features; walk; walk = g_list_next (walk), pe->nfeatures++) {
@@ -437,6 +450,16 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
   }
 
   gst_plugin_feature_list_free (plugin_features);
+  plugin_features = NULL;
+
+  /* pack external deps */
+  for (walk = plugin->priv->deps; walk != NULL; walk = walk->next) {
+    if (!gst_registry_chunks_save_plugin_dep (list, walk->data)) {
+      GST_ERROR ("Could not save external plugin dependency, aborting.");
+      goto fail;
+    }
+    ++pe->n_deps;
+  }
 
   /* pack cache data */
   if (plugin->priv->cache_data) {
@@ -456,6 +479,8 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
   gst_registry_chunks_save_const_string (list, plugin->desc.description);
   gst_registry_chunks_save_const_string (list, plugin->desc.name);
 
+  chk->flags |= GST_REGISTRY_CHUNK_FLAG_PLUGIN;
+  chk->object = plugin;
   *list = g_list_prepend (*list, chk);
 
   GST_DEBUG ("Found %d features in plugin \"%s\"", pe->nfeatures,
@@ -515,11 +540,11 @@ fail:
  *
  * Make a new GstPluginFeature from current binary plugin feature structure
  *
- * Returns: new GstPluginFeature
+ * Returns: new GstPluginFeature, or %NULL
  */
-static gboolean
-gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
-    gchar * end, const gchar * plugin_name)
+static GstPluginFeature *
+gst_registry_chunks_load_feature (gchar ** in, gchar * end,
+    const gchar * plugin_name)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
@@ -533,7 +558,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
   if (G_UNLIKELY (!type_name)) {
     GST_ERROR ("No feature type name");
-    return FALSE;
+    return NULL;
   }
 
   /* unpack more plugin feature strings */
@@ -546,12 +571,12 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     GST_ERROR ("Unknown type from typename '%s' for plugin '%s'", type_name,
         plugin_name);
     g_free (feature_name);
-    return FALSE;
+    return NULL;
   }
   if (G_UNLIKELY ((feature = g_object_newv (type, 0, NULL)) == NULL)) {
     GST_ERROR ("Can't create feature from type");
     g_free (feature_name);
-    return FALSE;
+    return NULL;
   }
 
   feature->name = feature_name;
@@ -641,6 +666,16 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
         factory->extensions[i] = str;
       }
     }
+
+    /* load signature */
+    if (tff->signature_size) {
+      if (*in + tff->signature_size > end)
+        goto fail;
+      factory->abidata.ABI.signature = g_memdup (*in, tff->signature_size);
+      factory->abidata.ABI.signature_offset = tff->signature_offset;
+      factory->abidata.ABI.signature_size = tff->signature_size;
+      *in += tff->signature_size;
+    }
   } else if (GST_IS_INDEX_FACTORY (feature)) {
     GstIndexFactory *factory = GST_INDEX_FACTORY (feature);
 
@@ -661,10 +696,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
   feature->plugin_name = plugin_name;
 
-  gst_registry_add_feature (registry, feature);
-  GST_DEBUG ("Added feature %s", feature->name);
-
-  return TRUE;
+  return feature;
 
   /* Errors */
 fail:
@@ -675,7 +707,7 @@ fail:
     else
       g_object_unref (feature);
   }
-  return FALSE;
+  return NULL;
 }
 
 static gchar **
@@ -740,15 +772,17 @@ fail:
 
 
 /*
- * _priv_gst_registry_chunks_load_plugin:
+ * gst_registry_chunks_load_plugin_info:
  *
- * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
- * and add it to the GstRegistry. Return an offset to the next
- * GstRegistryChunkPluginElement structure.
+ * Make a new GstPlugin from current GstRegistryChunkPluginElement structure,
+ * with its external dependencies, and add it to the GstRegistry. Leaves @in
+ * at the features of the plugin, and their number in @n_features.
+ *
+ * Returns: the plugin, or %NULL
  */
-gboolean
-_priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+static GstPlugin *
+gst_registry_chunks_load_plugin_info (GstRegistry * registry, gchar ** in,
+    gchar * end, guint * n_features)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -756,7 +790,7 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
   GstRegistryChunkPluginElement *pe;
   const gchar *cache_str = NULL;
   GstPlugin *plugin = NULL;
-  guint i, n;
+  guint i;
 
   align (*in);
   GST_LOG ("Reading/casting for GstRegistryChunkPluginElement at address %p",
@@ -802,20 +836,8 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
 
   /* Takes ownership of plugin */
   gst_registry_add_plugin (registry, plugin);
-  n = pe->nfeatures;
   GST_DEBUG ("Added plugin '%s' plugin with %d features from binary registry",
-      plugin->desc.name, n);
-
-  /* Load plugin features */
-  for (i = 0; i < n; i++) {
-    if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin->desc.name))) {
-      GST_ERROR ("Error while loading binary feature for plugin '%s'",
-          GST_STR_NULL (plugin->desc.name));
-      gst_registry_remove_plugin (registry, plugin);
-      goto fail;
-    }
-  }
+      plugin->desc.name, pe->nfeatures);
 
   /* Load external plugin dependencies */
   for (i = 0; i < pe->n_deps; ++i) {
@@ -827,13 +849,877 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
     }
   }
 
+  *n_features = pe->nfeatures;
+
+  return plugin;
+
+  /* Errors */
+fail:
+  GST_INFO ("Reading plugin failed after %u bytes", (guint) (end - start));
+  return NULL;
+}
+
+/*
+ * _priv_gst_registry_chunks_load_plugin:
+ *
+ * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
+ * and add it to the GstRegistry, with its features. Return an offset to the
+ * next GstRegistryChunkPluginElement structure.
+ */
+gboolean
+_priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
+    gchar * end, GstPlugin ** out_plugin)
+{
+  GstPlugin *plugin;
+  guint i, n;
+
+  plugin = gst_registry_chunks_load_plugin_info (registry, in, end, &n);
+  if (G_UNLIKELY (plugin == NULL))
+    return FALSE;
+
+  /* Load plugin features */
+  for (i = 0; i < n; i++) {
+    GstPluginFeature *feature;
+
+    feature = gst_registry_chunks_load_feature (in, end, plugin->desc.name);
+    if (G_UNLIKELY (feature == NULL)) {
+      GST_ERROR ("Error while loading binary feature for plugin '%s'",
+          GST_STR_NULL (plugin->desc.name));
+      gst_registry_remove_plugin (registry, plugin);
+      return FALSE;
+    }
+    gst_registry_add_feature (registry, feature);
+    GST_DEBUG ("Added feature %s", feature->name);
+  }
+
   if (out_plugin)
     *out_plugin = plugin;
 
   return TRUE;
+}
+
+/* Registry index */
+
+/* tries per bucket before the table is made bigger */
+#define PHASH_MAX_SEED 4096
+
+/* FNV-1a, with a final mix so that different seeds give unrelated hashes */
+static guint32
+gst_registry_chunks_hash (const gchar * key, guint32 seed)
+{
+  guint32 h = 2166136261U ^ (seed * 0x9e3779b9U);
+
+  while (*key) {
+    h ^= (guint8) * key++;
+    h *= 16777619U;
+  }
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+
+  return h;
+}
+
+/*
+ * gst_registry_chunks_phash:
+ *
+ * The slot of @key in a table built by gst_registry_chunks_phash_build().
+ * Keys that are not in the table get some slot too, the caller has to check
+ * the name in it.
+ */
+static guint32
+gst_registry_chunks_phash (const guint32 * seeds, guint32 n_buckets,
+    guint32 n_slots, const gchar * key)
+{
+  guint32 bucket = gst_registry_chunks_hash (key, 0) % n_buckets;
+
+  return gst_registry_chunks_hash (key, seeds[bucket]) % n_slots;
+}
+
+typedef struct
+{
+  guint32 bucket;
+  guint32 size;
+  guint key;
+} GstRegistryChunkHashKey;
+
+static int
+gst_registry_chunks_hash_key_cmp (const void *p1, const void *p2)
+{
+  const GstRegistryChunkHashKey *a = p1, *b = p2;
+
+  /* biggest buckets first, and the keys of a bucket together */
+  if (a->size != b->size)
+    return (a->size > b->size) ? -1 : 1;
+  if (a->bucket != b->bucket)
+    return (a->bucket < b->bucket) ? -1 : 1;
+  return 0;
+}
+
+/*
+ * gst_registry_chunks_phash_build:
+ *
+ * Hash and displace: the keys are spread over buckets, then for each bucket,
+ * biggest first, a seed is searched that puts all of its keys into free
+ * slots. The keys must be distinct.
+ *
+ * Returns: the seeds of the buckets, and the slot of each key in @slots, or
+ * %NULL if no table could be built
+ */
+static guint32 *
+gst_registry_chunks_phash_build (const gchar ** keys, guint n_keys,
+    guint32 * n_buckets, guint32 * n_slots, guint32 * slots)
+{
+  GstRegistryChunkHashKey *order;
+  guint32 *seeds = NULL, *sizes;
+  guint8 *taken;
+  guint i, j, k;
+
+  *n_buckets = MAX (n_keys / 4, 1);
+  *n_slots = MAX (n_keys + n_keys / 4, 1);
+
+  order = g_new (GstRegistryChunkHashKey, MAX (n_keys, 1));
+  sizes = g_new0 (guint32, *n_buckets);
+  for (i = 0; i < n_keys; i++) {
+    order[i].bucket = gst_registry_chunks_hash (keys[i], 0) % *n_buckets;
+    order[i].key = i;
+    sizes[order[i].bucket]++;
+  }
+  for (i = 0; i < n_keys; i++)
+    order[i].size = sizes[order[i].bucket];
+  g_free (sizes);
+  qsort (order, n_keys, sizeof (GstRegistryChunkHashKey),
+      gst_registry_chunks_hash_key_cmp);
+
+  while (*n_slots <= 16 * (n_keys + 1)) {
+    seeds = g_new0 (guint32, *n_buckets);
+    taken = g_new0 (guint8, *n_slots);
+
+    for (i = 0; i < n_keys; i = j) {
+      guint32 seed;
+
+      for (j = i; j < n_keys && order[j].bucket == order[i].bucket; j++);
+
+      for (seed = 1; seed <= PHASH_MAX_SEED; seed++) {
+        for (k = i; k < j; k++) {
+          guint32 slot =
+              gst_registry_chunks_hash (keys[order[k].key], seed) % *n_slots;
+
+          if (taken[slot])
+            break;
+          taken[slot] = 1;
+          slots[order[k].key] = slot;
+        }
+        if (k == j)
+          break;
+        /* give back what this seed took */
+        while (k > i) {
+          k--;
+          taken[slots[order[k].key]] = 0;
+        }
+      }
+      if (seed > PHASH_MAX_SEED)
+        break;
+      seeds[order[i].bucket] = seed;
+    }
+    g_free (taken);
+
+    if (i >= n_keys)
+      break;
+
+    /* too crowded, try again with more room */
+    g_free (seeds);
+    seeds = NULL;
+    *n_slots *= 2;
+  }
+  g_free (order);
+
+  if (!seeds)
+    GST_ERROR ("Could not build a perfect hash of %u keys", n_keys);
+
+  return seeds;
+}
+
+typedef void (*GstRegistryChunkMediaTypeFunc) (const gchar * media_type,
+    gpointer user_data);
+
+static void
+gst_registry_chunks_foreach_caps_media_type (const GstCaps * caps,
+    GstRegistryChunkMediaTypeFunc func, gpointer user_data)
+{
+  guint i;
+
+  if (gst_caps_is_any (caps))
+    return;
+
+  for (i = 0; i < gst_caps_get_size (caps); i++)
+    func (gst_structure_get_name (gst_caps_get_structure (caps, i)), user_data);
+}
+
+/*
+ * gst_registry_chunks_foreach_media_type:
+ *
+ * Calls @func with the name of each structure in the pad template caps of an
+ * element factory or in the caps of a typefind factory. ANY caps don't have
+ * any. Pad templates whose caps don't contain @hint are skipped, if it's
+ * given.
+ */
+static void
+gst_registry_chunks_foreach_media_type (GstPluginFeature * feature,
+    const gchar * hint, GstRegistryChunkMediaTypeFunc func, gpointer user_data)
+{
+  if (GST_IS_ELEMENT_FACTORY (feature)) {
+    GList *walk;
+
+    for (walk = GST_ELEMENT_FACTORY (feature)->staticpadtemplates; walk;
+        walk = walk->next) {
+      GstStaticPadTemplate *templ = walk->data;
+      const gchar *str = templ->static_caps.string;
+      GstCaps *caps;
+
+      if (str == NULL || (hint && strstr (str, hint) == NULL))
+        continue;
+
+      if ((caps = gst_caps_from_string (str))) {
+        gst_registry_chunks_foreach_caps_media_type (caps, func, user_data);
+        gst_caps_unref (caps);
+      }
+    }
+  } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
+    GstCaps *caps = GST_TYPE_FIND_FACTORY (feature)->caps;
+
+    if (caps)
+      gst_registry_chunks_foreach_caps_media_type (caps, func, user_data);
+  }
+}
+
+typedef struct
+{
+  const gchar *media_type;
+  gboolean found;
+} GstRegistryChunkMediaTypeSearch;
+
+static void
+gst_registry_chunks_match_media_type (const gchar * media_type,
+    GstRegistryChunkMediaTypeSearch * search)
+{
+  if (strcmp (media_type, search->media_type) == 0)
+    search->found = TRUE;
+}
+
+/*
+ * _priv_gst_registry_chunks_has_media_type:
+ *
+ * Returns: %TRUE if @media_type is in the pad template caps of element
+ * factory @feature, or in the caps of typefind factory @feature.
+ */
+gboolean
+_priv_gst_registry_chunks_has_media_type (GstPluginFeature * feature,
+    const gchar * media_type)
+{
+  GstRegistryChunkMediaTypeSearch search;
+
+  search.media_type = media_type;
+  search.found = FALSE;
+  gst_registry_chunks_foreach_media_type (feature, media_type,
+      (GstRegistryChunkMediaTypeFunc) gst_registry_chunks_match_media_type,
+      &search);
+
+  return search.found;
+}
+
+static void
+gst_registry_chunks_array_free (GArray * array)
+{
+  g_array_free (array, TRUE);
+}
+
+typedef struct
+{
+  /* media type -> GArray of feature numbers */
+  GHashTable *features;
+  GPtrArray *names;
+  guint32 feature;
+} GstRegistryChunkMediaTypes;
+
+static void
+gst_registry_chunks_add_media_type (const gchar * media_type,
+    GstRegistryChunkMediaTypes * types)
+{
+  GArray *features;
+
+  media_type = g_intern_string (media_type);
+  features = g_hash_table_lookup (types->features, media_type);
+  if (!features) {
+    features = g_array_new (FALSE, FALSE, sizeof (guint32));
+    g_hash_table_insert (types->features, (gpointer) media_type, features);
+    g_ptr_array_add (types->names, (gpointer) media_type);
+  }
+
+  /* features are added one after the other, this skips duplicates */
+  if (features->len == 0 ||
+      g_array_index (features, guint32, features->len - 1) != types->feature)
+    g_array_append_val (features, types->feature);
+}
+
+static guint32
+gst_registry_chunks_feature_kind (GstPluginFeature * feature)
+{
+  if (GST_IS_ELEMENT_FACTORY (feature))
+    return GST_REGISTRY_CHUNK_FEATURE_ELEMENT;
+  else if (GST_IS_TYPE_FIND_FACTORY (feature))
+    return GST_REGISTRY_CHUNK_FEATURE_TYPE_FIND;
+  else
+    return GST_REGISTRY_CHUNK_FEATURE_INDEX;
+}
+
+/*
+ * _priv_gst_registry_chunks_save_index:
+ * @positions: where the plugins and features were written, in order
+ * @file_position: where the index will be written
+ *
+ * Build the lookup tables for the plugins and features at @positions.
+ *
+ * Returns: a chunk with the #GstRegistryChunkIndex and its tables, or %NULL
+ */
+GstRegistryChunk *
+_priv_gst_registry_chunks_save_index (GArray * positions, gulong file_position)
+{
+  GstRegistryChunkIndex idx;
+  GstRegistryChunkMediaTypes types;
+  GArray *plugins, *features;
+  GPtrArray *names;
+  guint32 *feature_seeds = NULL, *feature_slots = NULL;
+  guint32 *media_seeds = NULL, *media_slots = NULL;
+  guint32 n_media_features = 0, strings_size = 0;
+  gulong base, size;
+  guint8 *data = NULL;
+  guint i;
+
+  memset (&idx, 0, sizeof (idx));
+  plugins = g_array_new (FALSE, FALSE, sizeof (guint32));
+  features = g_array_new (FALSE, FALSE, sizeof (GstRegistryChunkIndexFeature));
+  names = g_ptr_array_new ();
+  types.features = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) gst_registry_chunks_array_free);
+  types.names = g_ptr_array_new ();
+
+  for (i = 0; i < positions->len; i++) {
+    GstRegistryChunkPosition *pos =
+        &g_array_index (positions, GstRegistryChunkPosition, i);
+
+    if (GST_IS_PLUGIN (pos->object)) {
+      g_array_append_val (plugins, pos->offset);
+    } else {
+      GstPluginFeature *feature = pos->object;
+      GstRegistryChunkIndexFeature entry;
+
+      if (G_UNLIKELY (plugins->len == 0))
+        goto no_plugin;
+
+      /* the name comes right after the type name */
+      entry.name = pos->offset +
+          strlen (g_type_name (G_OBJECT_TYPE (feature))) + 1;
+      entry.offset = pos->offset;
+      entry.plugin = plugins->len - 1;
+      entry.kind = gst_registry_chunks_feature_kind (feature);
+      g_array_append_val (features, entry);
+      g_ptr_array_add (names, feature->name);
+
+      types.feature = features->len - 1;
+      gst_registry_chunks_foreach_media_type (feature, NULL,
+          (GstRegistryChunkMediaTypeFunc) gst_registry_chunks_add_media_type,
+          &types);
+    }
+  }
+
+  /* the perfect hashes */
+  feature_slots = g_new (guint32, MAX (features->len, 1));
+  feature_seeds = gst_registry_chunks_phash_build ((const gchar **) names->pdata,
+      features->len, &idx.n_feature_buckets, &idx.n_feature_slots,
+      feature_slots);
+  media_slots = g_new (guint32, MAX (types.names->len, 1));
+  media_seeds =
+      gst_registry_chunks_phash_build ((const gchar **) types.names->pdata,
+      types.names->len, &idx.n_media_buckets, &idx.n_media_slots, media_slots);
+  if (!feature_seeds || !media_seeds)
+    goto done;
+
+  for (i = 0; i < types.names->len; i++) {
+    const gchar *name = g_ptr_array_index (types.names, i);
+    GArray *list = g_hash_table_lookup (types.features, name);
+
+    n_media_features += list->len;
+    strings_size += strlen (name) + 1;
+  }
+
+  /* lay out the tables, the writer aligns the chunk like this */
+  base = file_position;
+  align (base);
+  size = 0;
+  idx.n_plugins = plugins->len;
+  idx.plugins = base + size;
+  size += idx.n_plugins * sizeof (guint32);
+  idx.feature_buckets = base + size;
+  size += idx.n_feature_buckets * sizeof (guint32);
+  idx.feature_slots = base + size;
+  size += idx.n_feature_slots * sizeof (GstRegistryChunkIndexFeature);
+  idx.media_buckets = base + size;
+  size += idx.n_media_buckets * sizeof (guint32);
+  idx.media_slots = base + size;
+  size += idx.n_media_slots * sizeof (GstRegistryChunkIndexMediaType);
+  idx.media_features = base + size;
+  size += n_media_features * sizeof (guint32);
+  size += strings_size;
+  size = (size + 3) & ~3;
+  size += sizeof (GstRegistryChunkIndex);
+
+  data = g_malloc0 (size);
+  memcpy (data + idx.plugins - base, plugins->data,
+      idx.n_plugins * sizeof (guint32));
+  memcpy (data + idx.feature_buckets - base, feature_seeds,
+      idx.n_feature_buckets * sizeof (guint32));
+  for (i = 0; i < features->len; i++) {
+    GstRegistryChunkIndexFeature *slots =
+        (GstRegistryChunkIndexFeature *) (data + idx.feature_slots - base);
+
+    slots[feature_slots[i]] =
+        g_array_index (features, GstRegistryChunkIndexFeature, i);
+  }
+  memcpy (data + idx.media_buckets - base, media_seeds,
+      idx.n_media_buckets * sizeof (guint32));
+  {
+    GstRegistryChunkIndexMediaType *slots =
+        (GstRegistryChunkIndexMediaType *) (data + idx.media_slots - base);
+    guint32 *media_features = (guint32 *) (data + idx.media_features - base);
+    guint32 first = 0, string = idx.media_features + n_media_features * 4;
+    guint j;
+
+    for (i = 0; i < types.names->len; i++) {
+      const gchar *name = g_ptr_array_index (types.names, i);
+      GArray *list = g_hash_table_lookup (types.features, name);
+      GstRegistryChunkIndexMediaType *slot = &slots[media_slots[i]];
+
+      slot->name = string;
+      slot->first = first;
+      slot->n_features = list->len;
+      for (j = 0; j < list->len; j++)
+        media_features[first++] = feature_slots[g_array_index (list, guint32,
+                j)];
+      strcpy ((gchar *) data + string - base, name);
+      string += strlen (name) + 1;
+    }
+  }
+  memcpy (data + size - sizeof (GstRegistryChunkIndex), &idx,
+      sizeof (GstRegistryChunkIndex));
+
+  GST_DEBUG ("Index of %u plugins, %u features in %u slots, %u media types "
+      "in %u slots, %lu bytes", idx.n_plugins, features->len,
+      idx.n_feature_slots, types.names->len, idx.n_media_slots, size);
+
+done:
+  g_free (feature_seeds);
+  g_free (feature_slots);
+  g_free (media_seeds);
+  g_free (media_slots);
+  g_array_free (plugins, TRUE);
+  g_array_free (features, TRUE);
+  g_ptr_array_free (names, TRUE);
+  g_hash_table_destroy (types.features);
+  g_ptr_array_free (types.names, TRUE);
+
+  if (data) {
+    GstRegistryChunk *chunk = gst_registry_chunks_make_data (data, size);
+
+    chunk->flags = GST_REGISTRY_CHUNK_FLAG_MALLOC;
+    return chunk;
+  }
+  return NULL;
 
   /* Errors */
-fail:
-  GST_INFO ("Reading plugin failed after %u bytes", (guint) (end - start));
-  return FALSE;
+no_plugin:
+  {
+    GST_ERROR ("Feature written before any plugin");
+    goto done;
+  }
+}
+
+/* Features of a registry cache that are created on demand */
+
+enum
+{
+  GST_REGISTRY_INDEX_SLOT_NONE = 0,     /* empty, or the feature was dropped */
+  GST_REGISTRY_INDEX_SLOT_PENDING,
+  GST_REGISTRY_INDEX_SLOT_LOADED
+};
+
+struct _GstRegistryIndex
+{
+  gchar *contents;
+  gsize size;
+  gpointer data;
+  GDestroyNotify notify;
+
+  const GstRegistryChunkIndex *header;
+  const guint32 *feature_buckets;
+  const GstRegistryChunkIndexFeature *feature_slots;
+  const guint32 *media_buckets;
+  const GstRegistryChunkIndexMediaType *media_slots;
+  const guint32 *media_features;
+  /* media_features ends where the header starts */
+  guint32 n_media_features;
+
+  /* interned plugin names, by number */
+  const gchar **plugin_names;
+  /* state of each feature slot */
+  guint8 *state;
+  guint n_pending;
+};
+
+/* returns a table of @n elements of @elem_size at @offset, if there is room
+ * for it before the header */
+static gconstpointer
+gst_registry_index_table (GstRegistryIndex * index, guint32 offset, guint32 n,
+    gsize elem_size)
+{
+  gsize end = (gchar *) index->header - index->contents;
+
+  if (offset % 4 != 0 || offset > end ||
+      (guint64) n * elem_size > (guint64) (end - offset))
+    return NULL;
+
+  return index->contents + offset;
+}
+
+/* returns the string at @offset, or NULL */
+static const gchar *
+gst_registry_index_string (GstRegistryIndex * index, guint32 offset)
+{
+  if (offset == 0 || offset >= index->size ||
+      _strnlen (index->contents + offset, index->size - offset) == -1)
+    return NULL;
+
+  return index->contents + offset;
+}
+
+/*
+ * _priv_gst_registry_index_new:
+ * @registry: the registry to add the plugins to
+ * @contents: the registry cache
+ * @size: the size of @contents
+ * @data: what has to stay alive for @contents to be valid
+ * @notify: frees @data when the index is freed
+ *
+ * Adds the plugins in @contents to @registry, but not their features, they
+ * are made when they are needed.
+ *
+ * Returns: the index of @contents, %NULL if it's invalid
+ */
+GstRegistryIndex *
+_priv_gst_registry_index_new (GstRegistry * registry, gchar * contents,
+    gsize size, gpointer data, GDestroyNotify notify)
+{
+  GstRegistryIndex *index;
+  const guint32 *plugins;
+  guint i;
+
+  index = g_slice_new0 (GstRegistryIndex);
+  index->contents = contents;
+  index->size = size;
+
+  if (size < sizeof (GstRegistryChunkIndex) ||
+      (size - sizeof (GstRegistryChunkIndex)) % 4 != 0)
+    goto invalid;
+
+  index->header = (GstRegistryChunkIndex *) (contents + size -
+      sizeof (GstRegistryChunkIndex));
+  plugins = gst_registry_index_table (index, index->header->plugins,
+      index->header->n_plugins, sizeof (guint32));
+  index->feature_buckets = gst_registry_index_table (index,
+      index->header->feature_buckets, index->header->n_feature_buckets,
+      sizeof (guint32));
+  index->feature_slots = gst_registry_index_table (index,
+      index->header->feature_slots, index->header->n_feature_slots,
+      sizeof (GstRegistryChunkIndexFeature));
+  index->media_buckets = gst_registry_index_table (index,
+      index->header->media_buckets, index->header->n_media_buckets,
+      sizeof (guint32));
+  index->media_slots = gst_registry_index_table (index,
+      index->header->media_slots, index->header->n_media_slots,
+      sizeof (GstRegistryChunkIndexMediaType));
+  index->media_features = gst_registry_index_table (index,
+      index->header->media_features, 0, sizeof (guint32));
+  if (!plugins || !index->feature_buckets || !index->feature_slots ||
+      !index->media_buckets || !index->media_slots || !index->media_features ||
+      index->header->n_feature_buckets == 0 ||
+      index->header->n_feature_slots == 0 ||
+      index->header->n_media_buckets == 0 || index->header->n_media_slots == 0)
+    goto invalid;
+  index->n_media_features = ((gchar *) index->header -
+      (gchar *) index->media_features) / sizeof (guint32);
+
+  index->plugin_names = g_new0 (const gchar *, index->header->n_plugins);
+  for (i = 0; i < index->header->n_plugins; i++) {
+    GstPlugin *plugin;
+    gchar *in;
+    guint n_features;
+
+    if (plugins[i] >= size)
+      goto invalid;
+
+    in = contents + plugins[i];
+    plugin = gst_registry_chunks_load_plugin_info (registry, &in,
+        contents + size, &n_features);
+    if (!plugin)
+      goto invalid;
+    index->plugin_names[i] = plugin->desc.name;
+  }
+
+  index->state = g_new0 (guint8, index->header->n_feature_slots);
+  for (i = 0; i < index->header->n_feature_slots; i++) {
+    if (index->feature_slots[i].name != 0) {
+      index->state[i] = GST_REGISTRY_INDEX_SLOT_PENDING;
+      index->n_pending++;
+    }
+  }
+  GST_DEBUG ("%u plugins with %u features in the registry cache",
+      index->header->n_plugins, index->n_pending);
+
+  index->data = data;
+  index->notify = notify;
+
+  return index;
+
+  /* Errors */
+invalid:
+  {
+    GST_ERROR ("Invalid registry cache index");
+    _priv_gst_registry_index_free (index);
+    return NULL;
+  }
+}
+
+void
+_priv_gst_registry_index_free (GstRegistryIndex * index)
+{
+  if (index->notify)
+    index->notify (index->data);
+  g_free (index->plugin_names);
+  g_free (index->state);
+  g_slice_free (GstRegistryIndex, index);
+}
+
+/*
+ * _priv_gst_registry_index_is_empty:
+ *
+ * Returns: %TRUE if all features of @index were made or dropped.
+ */
+gboolean
+_priv_gst_registry_index_is_empty (GstRegistryIndex * index)
+{
+  return index->n_pending == 0;
+}
+
+/* returns the slot of feature @name, or -1 */
+static gint
+gst_registry_index_find_feature (GstRegistryIndex * index, const gchar * name)
+{
+  const gchar *slot_name;
+  guint32 slot;
+
+  slot = gst_registry_chunks_phash (index->feature_buckets,
+      index->header->n_feature_buckets, index->header->n_feature_slots, name);
+  slot_name = gst_registry_index_string (index,
+      index->feature_slots[slot].name);
+  if (slot_name == NULL || strcmp (slot_name, name) != 0)
+    return -1;
+
+  return slot;
+}
+
+static void
+gst_registry_index_drop_slot (GstRegistryIndex * index, guint slot)
+{
+  if (index->state[slot] == GST_REGISTRY_INDEX_SLOT_PENDING)
+    index->n_pending--;
+  index->state[slot] = GST_REGISTRY_INDEX_SLOT_NONE;
+}
+
+static GstPluginFeature *
+gst_registry_index_load_slot (GstRegistryIndex * index, guint slot)
+{
+  const GstRegistryChunkIndexFeature *entry = &index->feature_slots[slot];
+  GstPluginFeature *feature = NULL;
+
+  index->state[slot] = GST_REGISTRY_INDEX_SLOT_LOADED;
+  index->n_pending--;
+
+  if (entry->offset < index->size && entry->plugin < index->header->n_plugins) {
+    gchar *in = index->contents + entry->offset;
+
+    feature = gst_registry_chunks_load_feature (&in,
+        index->contents + index->size, index->plugin_names[entry->plugin]);
+  }
+
+  if (G_UNLIKELY (feature == NULL)) {
+    GST_ERROR ("Could not load the feature at %u of the registry cache",
+        entry->offset);
+    index->state[slot] = GST_REGISTRY_INDEX_SLOT_NONE;
+  } else {
+    GST_LOG ("Loaded feature %s", feature->name);
+  }
+
+  return feature;
+}
+
+/*
+ * _priv_gst_registry_index_has_feature:
+ *
+ * Returns: %TRUE if @index has feature @name and it wasn't dropped
+ */
+gboolean
+_priv_gst_registry_index_has_feature (GstRegistryIndex * index,
+    const gchar * name)
+{
+  gint slot = gst_registry_index_find_feature (index, name);
+
+  return slot >= 0 && index->state[slot] != GST_REGISTRY_INDEX_SLOT_NONE;
+}
+
+/*
+ * _priv_gst_registry_index_load_feature:
+ *
+ * Returns: a new feature @name, or %NULL if @index doesn't have it or it was
+ * made or dropped before
+ */
+GstPluginFeature *
+_priv_gst_registry_index_load_feature (GstRegistryIndex * index,
+    const gchar * name)
+{
+  gint slot = gst_registry_index_find_feature (index, name);
+
+  if (slot < 0 || index->state[slot] != GST_REGISTRY_INDEX_SLOT_PENDING)
+    return NULL;
+
+  return gst_registry_index_load_slot (index, slot);
+}
+
+/*
+ * _priv_gst_registry_index_load_features:
+ *
+ * Returns: a list of new features of @type, for those that weren't made or
+ * dropped before
+ */
+GList *
+_priv_gst_registry_index_load_features (GstRegistryIndex * index, GType type)
+{
+  GList *list = NULL;
+  guint i;
+
+  for (i = 0; i < index->header->n_feature_slots && index->n_pending; i++) {
+    GstPluginFeature *feature;
+    GType kind_type;
+
+    if (index->state[i] != GST_REGISTRY_INDEX_SLOT_PENDING)
+      continue;
+
+    switch (index->feature_slots[i].kind) {
+      case GST_REGISTRY_CHUNK_FEATURE_ELEMENT:
+        kind_type = GST_TYPE_ELEMENT_FACTORY;
+        break;
+      case GST_REGISTRY_CHUNK_FEATURE_TYPE_FIND:
+        kind_type = GST_TYPE_TYPE_FIND_FACTORY;
+        break;
+      case GST_REGISTRY_CHUNK_FEATURE_INDEX:
+        kind_type = GST_TYPE_INDEX_FACTORY;
+        break;
+      default:
+        kind_type = type;
+        break;
+    }
+    if (!g_type_is_a (kind_type, type))
+      continue;
+
+    if ((feature = gst_registry_index_load_slot (index, i)))
+      list = g_list_prepend (list, feature);
+  }
+
+  return list;
+}
+
+/*
+ * _priv_gst_registry_index_drop_feature:
+ *
+ * Makes @index forget about feature @name.
+ */
+void
+_priv_gst_registry_index_drop_feature (GstRegistryIndex * index,
+    const gchar * name)
+{
+  gint slot = gst_registry_index_find_feature (index, name);
+
+  if (slot >= 0)
+    gst_registry_index_drop_slot (index, slot);
+}
+
+/*
+ * _priv_gst_registry_index_drop_plugin:
+ *
+ * Makes @index forget about the features of plugin @plugin_name.
+ */
+void
+_priv_gst_registry_index_drop_plugin (GstRegistryIndex * index,
+    const gchar * plugin_name)
+{
+  guint i;
+
+  for (i = 0; i < index->header->n_feature_slots; i++) {
+    guint32 plugin = index->feature_slots[i].plugin;
+
+    if (index->state[i] != GST_REGISTRY_INDEX_SLOT_NONE &&
+        plugin < index->header->n_plugins &&
+        strcmp (index->plugin_names[plugin], plugin_name) == 0)
+      gst_registry_index_drop_slot (index, i);
+  }
+}
+
+/*
+ * _priv_gst_registry_index_get_media_type:
+ *
+ * Returns: the names of the features in @index that weren't dropped and
+ * have @media_type in their caps, free with g_free()
+ */
+GList *
+_priv_gst_registry_index_get_media_type (GstRegistryIndex * index,
+    const gchar * media_type)
+{
+  const GstRegistryChunkIndexMediaType *entry;
+  const gchar *name;
+  GList *list = NULL;
+  guint32 i;
+
+  entry = &index->media_slots[gst_registry_chunks_phash (index->media_buckets,
+          index->header->n_media_buckets, index->header->n_media_slots,
+          media_type)];
+  name = gst_registry_index_string (index, entry->name);
+  if (name == NULL || strcmp (name, media_type) != 0 ||
+      entry->first > index->n_media_features ||
+      entry->n_features > index->n_media_features - entry->first)
+    return NULL;
+
+  for (i = entry->first; i < entry->first + entry->n_features; i++) {
+    guint32 slot = index->media_features[i];
+
+    if (slot >= index->header->n_feature_slots ||
+        index->state[slot] == GST_REGISTRY_INDEX_SLOT_NONE)
+      continue;
+
+    name = gst_registry_index_string (index, index->feature_slots[slot].name);
+    if (name)
+      list = g_list_prepend (list, g_strdup (name));
+  }
+
+  return list;
 }
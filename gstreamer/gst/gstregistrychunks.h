@@ -30,15 +30,20 @@
  * we reference strings directly from the plugins and in this case set CONST to
  * avoid freeing them. If g_free() should be used, the MALLOC flag is set,
  * otherwise g_slice_free1() will be used!
+ * The first chunk of a plugin or a feature is marked with the PLUGIN or
+ * FEATURE flag, so that the index can be built when writing the chunks.
  */
 enum {
   GST_REGISTRY_CHUNK_FLAG_NONE = 0,
   GST_REGISTRY_CHUNK_FLAG_CONST = 1,
   GST_REGISTRY_CHUNK_FLAG_MALLOC = 2,
+  GST_REGISTRY_CHUNK_FLAG_PLUGIN = 4,
+  GST_REGISTRY_CHUNK_FLAG_FEATURE = 8
 };
 
 /*
  * GstRegistryChunk:
+ * @object: the #GstPlugin or #GstPluginFeature starting with this chunk
  *
  * Header for binary blobs
  */
@@ -48,6 +53,7 @@ typedef struct _GstRegistryChunk
   guint size;
   guint flags;
   gboolean align;
+  gpointer object;
 } GstRegistryChunk;
 
 /*
@@ -116,6 +122,8 @@ typedef struct _GstRegistryChunkElementFactory
 /*
  * GstRegistryChunkTypeFindFactory:
  * @nextensions: stores the number of typefind extensions
+ * @signature_offset: offset of the signature in the stream
+ * @signature_size: size of the signature, 0 if there is none
  *
  * A structure containing the element factory fields
  */
@@ -124,6 +132,8 @@ typedef struct _GstRegistryChunkTypeFindFactory
   GstRegistryChunkPluginFeature plugin_feature;
 
   guint nextensions;
+  guint signature_offset;
+  guint signature_size;
 } GstRegistryChunkTypeFindFactory;
 
 /*
@@ -137,6 +147,99 @@ typedef struct _GstRegistryChunkPadTemplate
   GstPadPresence presence;
 } GstRegistryChunkPadTemplate;
 
+/*
+ * GstRegistryChunkIndex:
+ * @n_plugins: number of plugins
+ * @plugins: offset of the offsets of the plugins
+ * @n_feature_buckets: number of seeds for the feature table
+ * @feature_buckets: offset of the seeds for the feature table
+ * @n_feature_slots: number of entries in the feature table
+ * @feature_slots: offset of the #GstRegistryChunkIndexFeature table
+ * @n_media_buckets: number of seeds for the media type table
+ * @media_buckets: offset of the seeds for the media type table
+ * @n_media_slots: number of entries in the media type table
+ * @media_slots: offset of the #GstRegistryChunkIndexMediaType table
+ * @media_features: offset of the feature slot numbers the media type table
+ * refers to
+ *
+ * Lookup tables written after the plugins. The feature table is indexed by
+ * feature name and the media type table by the media types in the caps of
+ * the features, both with a perfect hash (see gst_registry_chunks_phash()).
+ * This structure is the last thing in the file, all offsets are from the
+ * start of the file.
+ */
+typedef struct _GstRegistryChunkIndex
+{
+  guint32 n_plugins;
+  guint32 plugins;
+
+  guint32 n_feature_buckets;
+  guint32 feature_buckets;
+  guint32 n_feature_slots;
+  guint32 feature_slots;
+
+  guint32 n_media_buckets;
+  guint32 media_buckets;
+  guint32 n_media_slots;
+  guint32 media_slots;
+  guint32 media_features;
+} GstRegistryChunkIndex;
+
+/*
+ * GstRegistryChunkIndexFeature:
+ * @name: offset of the name of the feature, 0 for an empty slot
+ * @offset: offset of the feature
+ * @plugin: number of the plugin of the feature
+ * @kind: a #GstRegistryChunkFeatureKind
+ */
+typedef struct _GstRegistryChunkIndexFeature
+{
+  guint32 name;
+  guint32 offset;
+  guint32 plugin;
+  guint32 kind;
+} GstRegistryChunkIndexFeature;
+
+typedef enum {
+  GST_REGISTRY_CHUNK_FEATURE_ELEMENT = 1,
+  GST_REGISTRY_CHUNK_FEATURE_TYPE_FIND = 2,
+  GST_REGISTRY_CHUNK_FEATURE_INDEX = 3
+} GstRegistryChunkFeatureKind;
+
+/*
+ * GstRegistryChunkIndexMediaType:
+ * @name: offset of the media type, 0 for an empty slot
+ * @first: first of the feature slot numbers for this media type
+ * @n_features: number of feature slot numbers for this media type
+ */
+typedef struct _GstRegistryChunkIndexMediaType
+{
+  guint32 name;
+  guint32 first;
+  guint32 n_features;
+} GstRegistryChunkIndexMediaType;
+
+/*
+ * GstRegistryChunkPosition:
+ * @object: a #GstPlugin or #GstPluginFeature
+ * @offset: where its first chunk was written
+ *
+ * Tells _priv_gst_registry_chunks_save_index() where things are.
+ */
+typedef struct _GstRegistryChunkPosition
+{
+  gpointer object;
+  guint32 offset;
+} GstRegistryChunkPosition;
+
+/*
+ * GstRegistryIndex:
+ *
+ * Opaque state of a registry cache whose features are only created on
+ * demand.
+ */
+typedef struct _GstRegistryIndex GstRegistryIndex;
+
 G_BEGIN_DECLS
 
 gboolean
@@ -150,6 +253,52 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
 void
 _priv_gst_registry_chunk_free (GstRegistryChunk *chunk);
 
+GstRegistryChunk *
+_priv_gst_registry_chunks_save_index (GArray * positions,
+    gulong file_position);
+
+gboolean
+_priv_gst_registry_chunks_has_media_type (GstPluginFeature * feature,
+    const gchar * media_type);
+
+GstRegistryIndex *
+_priv_gst_registry_index_new (GstRegistry * registry, gchar * contents,
+    gsize size, gpointer data, GDestroyNotify notify);
+
+void
+_priv_gst_registry_index_free (GstRegistryIndex * index);
+
+gboolean
+_priv_gst_registry_index_is_empty (GstRegistryIndex * index);
+
+gboolean
+_priv_gst_registry_index_has_feature (GstRegistryIndex * index,
+    const gchar * name);
+
+GstPluginFeature *
+_priv_gst_registry_index_load_feature (GstRegistryIndex * index,
+    const gchar * name);
+
+GList *
+_priv_gst_registry_index_load_features (GstRegistryIndex * index, GType type);
+
+void
+_priv_gst_registry_index_drop_feature (GstRegistryIndex * index,
+    const gchar * name);
+
+void
+_priv_gst_registry_index_drop_plugin (GstRegistryIndex * index,
+    const gchar * plugin_name);
+
+GList *
+_priv_gst_registry_index_get_media_type (GstRegistryIndex * index,
+    const gchar * media_type);
+
+/* in gstregistry.c */
+void
+_priv_gst_registry_set_index (GstRegistry * registry,
+    GstRegistryIndex * index);
+
 G_END_DECLS
 
 #endif /* __GST_REGISTRYCHUNKS_H__ */
@@ -1667,6 +1667,156 @@ priv_gst_structure_append_to_gstring (const GstStructure * structure,
   return TRUE;
 }
 
+static guint
+gst_structure_value_hash (const GValue * value, gboolean * hashable)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint hash = (guint) type;
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_INT:
+      return hash * 31 + g_value_get_int (value);
+    case G_TYPE_UINT:
+      return hash * 31 + g_value_get_uint (value);
+    case G_TYPE_BOOLEAN:
+      return hash * 31 + g_value_get_boolean (value);
+    case G_TYPE_ENUM:
+      return hash * 31 + g_value_get_enum (value);
+    case G_TYPE_FLAGS:
+      return hash * 31 + g_value_get_flags (value);
+    case G_TYPE_INT64:
+      return hash * 31 + (guint) g_value_get_int64 (value);
+    case G_TYPE_UINT64:
+      return hash * 31 + (guint) g_value_get_uint64 (value);
+    case G_TYPE_STRING:{
+      const gchar *str = g_value_get_string (value);
+
+      return hash * 31 + (str ? g_str_hash (str) : 0);
+    }
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      /* 0.0 and -0.0 are equal, just use the type */
+      return hash;
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_INT_RANGE) {
+    hash = hash * 31 + gst_value_get_int_range_min (value);
+    hash = hash * 31 + gst_value_get_int_range_max (value);
+  } else if (type == GST_TYPE_FRACTION) {
+    hash = hash * 31 + gst_value_get_fraction_numerator (value);
+    hash = hash * 31 + gst_value_get_fraction_denominator (value);
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    hash = hash * 31 +
+        gst_structure_value_hash (gst_value_get_fraction_range_min (value),
+        hashable);
+    hash = hash * 31 +
+        gst_structure_value_hash (gst_value_get_fraction_range_max (value),
+        hashable);
+  } else if (type == GST_TYPE_FOURCC) {
+    hash = hash * 31 + gst_value_get_fourcc (value);
+  } else if (type == GST_TYPE_LIST) {
+    guint i, len = gst_value_list_get_size (value);
+
+    for (i = 0; i < len; i++)
+      hash = hash * 31 +
+          gst_structure_value_hash (gst_value_list_get_value (value, i),
+          hashable);
+  } else if (type == GST_TYPE_ARRAY) {
+    guint i, len = gst_value_array_get_size (value);
+
+    for (i = 0; i < len; i++)
+      hash = hash * 31 +
+          gst_structure_value_hash (gst_value_array_get_value (value, i),
+          hashable);
+  } else if (type != GST_TYPE_DOUBLE_RANGE &&
+      !gst_value_can_compare (value, value)) {
+    *hashable = FALSE;
+  }
+
+  return hash;
+}
+
+static gboolean
+gst_structure_value_is_identical (const GValue * value1, const GValue * value2)
+{
+  guint i, len;
+
+  if (G_VALUE_TYPE (value1) != G_VALUE_TYPE (value2))
+    return FALSE;
+
+  /* lists compare equal in any order, but the order matters here */
+  if (G_VALUE_TYPE (value1) == GST_TYPE_LIST) {
+    len = gst_value_list_get_size (value1);
+    if (len != gst_value_list_get_size (value2))
+      return FALSE;
+    for (i = 0; i < len; i++) {
+      if (!gst_structure_value_is_identical (gst_value_list_get_value (value1,
+                  i), gst_value_list_get_value (value2, i)))
+        return FALSE;
+    }
+    return TRUE;
+  }
+
+  return gst_value_compare (value1, value2) == GST_VALUE_EQUAL;
+}
+
+/*
+ * _priv_gst_structure_hash:
+ * @structure: a #GstStructure
+ * @hashable: set to %FALSE if @structure has values that can't be compared
+ *
+ * Returns: a hash of the name and the fields of @structure, in order, that
+ * is the same for structures that are _priv_gst_structure_is_identical()
+ */
+guint
+_priv_gst_structure_hash (const GstStructure * structure, gboolean * hashable)
+{
+  guint i, hash = structure->name;
+
+  for (i = 0; i < structure->fields->len; i++) {
+    GstStructureField *field = GST_STRUCTURE_FIELD (structure, i);
+
+    hash = hash * 31 + field->name;
+    hash = hash * 31 + gst_structure_value_hash (&field->value, hashable);
+  }
+
+  return hash;
+}
+
+/*
+ * _priv_gst_structure_is_identical:
+ * @struct1: a #GstStructure
+ * @struct2: a #GstStructure
+ *
+ * Returns: %TRUE if @struct1 and @struct2 have the same name and the same
+ * fields with equal values, in the same order
+ */
+gboolean
+_priv_gst_structure_is_identical (const GstStructure * struct1,
+    const GstStructure * struct2)
+{
+  guint i;
+
+  if (struct1 == struct2)
+    return TRUE;
+  if (struct1->name != struct2->name ||
+      struct1->fields->len != struct2->fields->len)
+    return FALSE;
+
+  for (i = 0; i < struct1->fields->len; i++) {
+    GstStructureField *field1 = GST_STRUCTURE_FIELD (struct1, i);
+    GstStructureField *field2 = GST_STRUCTURE_FIELD (struct2, i);
+
+    if (field1->name != field2->name ||
+        !gst_structure_value_is_identical (&field1->value, &field2->value))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
 /**
  * gst_structure_to_string:
  * @structure: a #GstStructure
@@ -49,6 +49,40 @@ gst_type_find_get_type (void)
   return typefind_type;
 }
 
+static GstTypeFindFactory *
+gst_type_find_factory_create (GstPlugin * plugin, const gchar * name,
+    guint rank, GstTypeFindFunction func, gchar ** extensions,
+    const GstCaps * possible_caps, gpointer data, GDestroyNotify data_notify)
+{
+  GstTypeFindFactory *factory;
+
+  GST_INFO ("registering typefind function for %s", name);
+
+  factory = g_object_newv (GST_TYPE_TYPE_FIND_FACTORY, 0, NULL);
+  GST_DEBUG_OBJECT (factory, "using new typefind factory for %s", name);
+  g_assert (GST_IS_TYPE_FIND_FACTORY (factory));
+
+  gst_plugin_feature_set_name (GST_PLUGIN_FEATURE_CAST (factory), name);
+  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE_CAST (factory), rank);
+
+  if (factory->extensions)
+    g_strfreev (factory->extensions);
+  factory->extensions = g_strdupv (extensions);
+
+  gst_caps_replace (&factory->caps, (GstCaps *) possible_caps);
+  factory->function = func;
+  factory->user_data = data;
+  factory->user_data_notify = data_notify;
+  if (plugin && plugin->desc.name) {
+    GST_PLUGIN_FEATURE_CAST (factory)->plugin_name = plugin->desc.name; /* interned string */
+  } else {
+    GST_PLUGIN_FEATURE_CAST (factory)->plugin_name = "NULL";
+  }
+  GST_PLUGIN_FEATURE_CAST (factory)->loaded = TRUE;
+
+  return factory;
+}
+
 /**
  * gst_type_find_register:
  * @plugin: A #GstPlugin, or NULL for a static typefind function (note that
@@ -79,29 +113,60 @@ gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
 
   g_return_val_if_fail (name != NULL, FALSE);
 
-  GST_INFO ("registering typefind function for %s", name);
+  factory = gst_type_find_factory_create (plugin, name, rank, func,
+      extensions, possible_caps, data, data_notify);
 
-  factory = g_object_newv (GST_TYPE_TYPE_FIND_FACTORY, 0, NULL);
-  GST_DEBUG_OBJECT (factory, "using new typefind factory for %s", name);
-  g_assert (GST_IS_TYPE_FIND_FACTORY (factory));
+  gst_registry_add_feature (gst_registry_get_default (),
+      GST_PLUGIN_FEATURE_CAST (factory));
 
-  gst_plugin_feature_set_name (GST_PLUGIN_FEATURE_CAST (factory), name);
-  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE_CAST (factory), rank);
+  return TRUE;
+}
 
-  if (factory->extensions)
-    g_strfreev (factory->extensions);
-  factory->extensions = g_strdupv (extensions);
+/**
+ * gst_type_find_register_with_signature:
+ * @plugin: A #GstPlugin, or NULL for a static typefind function
+ * @name: The name for registering
+ * @rank: The rank (or importance) of this typefind function
+ * @func: The #GstTypeFindFunction to use
+ * @extensions: Optional extensions that could belong to this type
+ * @possible_caps: Optionally the caps that could be returned when typefinding
+ *                 succeeds
+ * @data: Optional user data. This user data must be available until the plugin
+ *        is unloaded.
+ * @data_notify: a #GDestroyNotify that will be called on @data when the plugin
+ *        is unloaded.
+ * @offset: The offset of @signature in the stream
+ * @signature: The bytes the stream has at @offset for any type @func suggests
+ * @size: The size of @signature
+ *
+ * Like gst_type_find_register(), for typefind functions that only suggest a
+ * type when the stream contains @signature at @offset, such as magic bytes at
+ * the start of a file. The signature is saved in the registry, so that
+ * typefinders can skip the function, without loading its plugin, for streams
+ * that don't match. @func must not suggest anything for such streams.
+ *
+ * Returns: TRUE on success, FALSE otherwise
+ *
+ * Since: 0.10.30
+ */
+gboolean
+gst_type_find_register_with_signature (GstPlugin * plugin, const gchar * name,
+    guint rank, GstTypeFindFunction func, gchar ** extensions,
+    const GstCaps * possible_caps, gpointer data, GDestroyNotify data_notify,
+    guint offset, const guint8 * signature, guint size)
+{
+  GstTypeFindFactory *factory;
 
-  gst_caps_replace (&factory->caps, (GstCaps *) possible_caps);
-  factory->function = func;
-  factory->user_data = data;
-  factory->user_data_notify = data_notify;
-  if (plugin && plugin->desc.name) {
-    GST_PLUGIN_FEATURE_CAST (factory)->plugin_name = plugin->desc.name; /* interned string */
-  } else {
-    GST_PLUGIN_FEATURE_CAST (factory)->plugin_name = "NULL";
-  }
-  GST_PLUGIN_FEATURE_CAST (factory)->loaded = TRUE;
+  g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (signature != NULL, FALSE);
+  g_return_val_if_fail (size > 0, FALSE);
+
+  factory = gst_type_find_factory_create (plugin, name, rank, func,
+      extensions, possible_caps, data, data_notify);
+
+  factory->abidata.ABI.signature = g_memdup (signature, size);
+  factory->abidata.ABI.signature_offset = offset;
+  factory->abidata.ABI.signature_size = size;
 
   gst_registry_add_feature (gst_registry_get_default (),
       GST_PLUGIN_FEATURE_CAST (factory));
@@ -117,6 +117,18 @@ gboolean  gst_type_find_register   (GstPlugin            * plugin,
                                     gpointer               data,
                                     GDestroyNotify         data_notify);
 
+gboolean  gst_type_find_register_with_signature (GstPlugin       * plugin,
+                                    const gchar          * name,
+                                    guint                  rank,
+                                    GstTypeFindFunction    func,
+                                    gchar               ** extensions,
+                                    const GstCaps        * possible_caps,
+                                    gpointer               data,
+                                    GDestroyNotify         data_notify,
+                                    guint                  offset,
+                                    const guint8         * signature,
+                                    guint                  size);
+
 G_END_DECLS
 
 #endif /* __GST_TYPE_FIND_H__ */
@@ -132,6 +132,10 @@ gst_type_find_factory_dispose (GObject * object)
     g_strfreev (factory->extensions);
     factory->extensions = NULL;
   }
+  if (factory->abidata.ABI.signature) {
+    g_free (factory->abidata.ABI.signature);
+    factory->abidata.ABI.signature = NULL;
+  }
   if (factory->user_data_notify && factory->user_data) {
     factory->user_data_notify (factory->user_data);
     factory->user_data = NULL;
@@ -174,6 +178,35 @@ gst_type_find_factory_get_caps (GstTypeFindFactory * factory)
   return factory->caps;
 }
 
+/**
+ * gst_type_find_factory_get_signature:
+ * @factory: A #GstTypeFindFactory
+ * @offset: location to store the offset of the signature in the stream
+ * @size: location to store the size of the signature
+ *
+ * Gets the bytes a stream must contain at @offset for the typefind function
+ * of @factory to suggest a type, see gst_type_find_register_with_signature().
+ * Typefinders can use this to skip the function for other streams.
+ *
+ * Returns: the signature of @factory, or %NULL if the function has to be
+ * called for any stream. The data belongs to @factory.
+ *
+ * Since: 0.10.30
+ */
+const guint8 *
+gst_type_find_factory_get_signature (GstTypeFindFactory * factory,
+    guint * offset, guint * size)
+{
+  g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
+
+  if (offset)
+    *offset = factory->abidata.ABI.signature_offset;
+  if (size)
+    *size = factory->abidata.ABI.signature_size;
+
+  return factory->abidata.ABI.signature;
+}
+
 /**
  * gst_type_find_factory_get_extensions:
  * @factory: A #GstTypeFindFactory
@@ -55,7 +55,17 @@ struct _GstTypeFindFactory {
   gpointer			user_data;
   GDestroyNotify		user_data_notify;
 
-  gpointer _gst_reserved[GST_PADDING];
+  union {
+    struct {
+      /* bytes the stream has at signature_offset when the function can
+       * suggest something, or NULL */
+      guint8 *			signature;
+      guint			signature_offset;
+      guint			signature_size;
+    } ABI;
+    /* adding + 0 to mark ABI change to be undone later */
+    gpointer _gst_reserved[GST_PADDING + 0];
+  } abidata;
 };
 
 struct _GstTypeFindFactoryClass {
@@ -73,6 +83,9 @@ GList *		gst_type_find_factory_get_list		(void);
 
 gchar **	gst_type_find_factory_get_extensions	(GstTypeFindFactory *factory);
 GstCaps *	gst_type_find_factory_get_caps	  	(GstTypeFindFactory *factory);
+const guint8 *	gst_type_find_factory_get_signature	(GstTypeFindFactory *factory,
+							 guint *offset,
+							 guint *size);
 void		gst_type_find_factory_call_function	(GstTypeFindFactory *factory,
 							 GstTypeFind *find);
 
@@ -41,6 +41,15 @@
 #include "gst-i18n-lib.h"
 #include <math.h>
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>             /* sysconf */
+#endif
+
+#ifdef G_OS_WIN32
+#  define WIN32_LEAN_AND_MEAN   /* prevents from including too many things */
+#  include <windows.h>          /* GetSystemInfo */
+#endif
+
 /**
  * gst_util_dump_mem:
  * @mem: a pointer to the memory to dump
@@ -3558,6 +3567,130 @@ gst_bin_find_unconnected_pad (GstBin * bin, GstPadDirection direction)
 }
 #endif
 
+static void
+stats_append_pad (GString * json, GstPad * pad)
+{
+  GstPadStats stats;
+  gchar *path;
+  const gchar *c;
+  guint i;
+
+  if (!gst_pad_get_stats (pad, &stats))
+    return;
+
+  if (json->str[json->len - 1] == '}')
+    g_string_append_c (json, ',');
+
+  path = gst_object_get_path_string (GST_OBJECT_CAST (pad));
+  g_string_append (json, "{\"pad\":\"");
+  for (c = path; *c; c++) {
+    if (*c == '"' || *c == '\\')
+      g_string_append_printf (json, "\\%c", *c);
+    else if ((guchar) * c < 0x20)
+      g_string_append_printf (json, "\\u%04x", (guchar) * c);
+    else
+      g_string_append_c (json, *c);
+  }
+  g_free (path);
+
+  g_string_append_printf (json, "\",\"direction\":\"%s\",\"buffers\":%"
+      G_GUINT64_FORMAT ",\"bytes\":%" G_GUINT64_FORMAT ",\"processing\":%"
+      G_GUINT64_FORMAT ",\"blocked\":%" G_GUINT64_FORMAT ",\"histogram\":[",
+      GST_PAD_IS_SRC (pad) ? "src" : "sink", stats.buffers, stats.bytes,
+      stats.processing, stats.blocked);
+  for (i = 0; i < GST_PAD_STATS_HISTOGRAM_SIZE; i++)
+    g_string_append_printf (json, "%s%" G_GUINT64_FORMAT, i ? "," : "",
+        stats.histogram[i]);
+  g_string_append (json, "]}");
+}
+
+static void
+stats_append_element (GString * json, GstElement * element)
+{
+  GstIterator *iter;
+  gsize len = json->len;
+  gboolean done;
+
+  iter = gst_element_iterate_pads (element);
+  done = FALSE;
+  while (!done) {
+    gpointer pad;
+
+    switch (gst_iterator_next (iter, &pad)) {
+      case GST_ITERATOR_OK:
+        stats_append_pad (json, GST_PAD_CAST (pad));
+        gst_object_unref (pad);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_string_truncate (json, len);
+        gst_iterator_resync (iter);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (iter);
+}
+
+/**
+ * gst_bin_stats_to_json:
+ * @bin: a #GstBin
+ *
+ * Dumps the data flow statistics of the pads of @bin and of all elements in
+ * it as a JSON object like this:
+ * <programlisting>
+ * {"pads":[{"pad":"/pipeline0/queue0.src","direction":"src","buffers":1000,
+ *   "bytes":4096000,"processing":2140000000,"blocked":0,
+ *   "histogram":[0,0,0,0,0,0,0,0,0,0,0,998,2,0,0,0]}, ...]}
+ * </programlisting>
+ * The fields are those of #GstPadStats, with times in nanoseconds. Pads
+ * without statistics are left out, see gst_pad_stats_set_enabled().
+ *
+ * Returns: a newly allocated string, free with g_free().
+ *
+ * Since: 0.10.30
+ */
+gchar *
+gst_bin_stats_to_json (GstBin * bin)
+{
+  GString *json;
+  GstIterator *iter;
+  gsize len;
+  gboolean done;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  json = g_string_new ("{\"pads\":[");
+  stats_append_element (json, GST_ELEMENT_CAST (bin));
+  len = json->len;
+
+  iter = gst_bin_iterate_recurse (bin);
+  done = FALSE;
+  while (!done) {
+    gpointer element;
+
+    switch (gst_iterator_next (iter, &element)) {
+      case GST_ITERATOR_OK:
+        stats_append_element (json, GST_ELEMENT_CAST (element));
+        gst_object_unref (element);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_string_truncate (json, len);
+        gst_iterator_resync (iter);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  gst_iterator_free (iter);
+
+  g_string_append (json, "]}");
+
+  return g_string_free (json, FALSE);
+}
+
 /**
  * gst_parse_bin_from_description:
  * @bin_description: command line describing the bin
@@ -3758,6 +3891,33 @@ gst_util_get_timestamp (void)
 #endif
 }
 
+/**
+ * gst_util_get_num_cpus:
+ *
+ * Get the number of processors that are currently online. Elements can use
+ * this to pick a default number of threads for their work.
+ *
+ * Returns: the number of online processors, at least 1
+ *
+ * Since: 0.10.30
+ */
+guint
+gst_util_get_num_cpus (void)
+{
+  glong n_cpus = 1;
+
+#ifdef G_OS_WIN32
+  SYSTEM_INFO info;
+
+  GetSystemInfo (&info);
+  n_cpus = info.dwNumberOfProcessors;
+#elif defined (_SC_NPROCESSORS_ONLN)
+  n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+
+  return MAX (n_cpus, 1);
+}
+
 /**
  * gst_util_array_binary_search:
  * @array: the sorted input array
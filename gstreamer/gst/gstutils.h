@@ -1076,6 +1076,7 @@ GstPad *                gst_bin_find_unlinked_pad       (GstBin *bin, GstPadDire
 #ifndef GST_DISABLE_DEPRECATED
 GstPad *                gst_bin_find_unconnected_pad    (GstBin *bin, GstPadDirection direction);
 #endif
+gchar *                 gst_bin_stats_to_json           (GstBin *bin);
 
 /* buffer functions */
 GstBuffer *		gst_buffer_merge		(GstBuffer * buf1, GstBuffer * buf2);
@@ -1142,6 +1143,9 @@ GstElement *            gst_parse_bin_from_description_full (const gchar     * b
                                                              GError         ** err);
 
 GstClockTime            gst_util_get_timestamp          (void);
+guint                   gst_util_get_num_cpus           (void);
+/* lets plugins that also build against 0.10.29 and older test with #ifdef */
+#define gst_util_get_num_cpus gst_util_get_num_cpus
 
 /**
  * GstSearchMode:
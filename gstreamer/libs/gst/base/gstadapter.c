@@ -93,7 +93,8 @@
  * this, some functions like gst_adapter_available_fast() are provided to help
  * speed up such cases should you want to. To avoid repeated memory allocations,
  * gst_adapter_copy() can be used to copy data into a (statically allocated)
- * user provided buffer.
+ * user provided buffer. Elements that can handle data in pieces can avoid the
+ * copies altogether with gst_adapter_peek_spans().
  *
  * GstAdapter is not MT safe. All operations on an adapter must be serialized by
  * the caller. This is not normally a problem, however, as the normal use case
@@ -453,6 +454,75 @@ gst_adapter_copy (GstAdapter * adapter, guint8 * dest, guint offset, guint size)
   copy_into_unchecked (adapter, dest, offset + adapter->skip, size);
 }
 
+/**
+ * gst_adapter_peek_spans:
+ * @adapter: a #GstAdapter
+ * @offset: the bytes offset in the adapter to start from
+ * @size: the number of bytes to look at
+ * @spans: array of at least @n_spans #GstAdapterSpan to fill in
+ * @n_spans: the number of elements in @spans
+ *
+ * Gets pointers to the @size bytes starting at @offset in @adapter, without
+ * copying or merging anything. The range is described by one #GstAdapterSpan
+ * for each buffer that it touches, in order. The pointers are valid until the
+ * next function that modifies the adapter is called.
+ *
+ * The return value is the number of spans that make up the whole range. If
+ * that is more than @n_spans, only the first @n_spans are filled in, and the
+ * call can be repeated with a larger array.
+ *
+ * Since: 0.10.30
+ *
+ * Returns: the number of spans needed for the range, or 0 if @adapter holds
+ * less than @offset + @size bytes.
+ */
+guint
+gst_adapter_peek_spans (GstAdapter * adapter, guint offset, guint size,
+    GstAdapterSpan * spans, guint n_spans)
+{
+  GSList *g;
+  GstBuffer *buf;
+  guint bsize, csize, n = 0;
+
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), 0);
+  g_return_val_if_fail (size > 0, 0);
+  g_return_val_if_fail (spans != NULL || n_spans == 0, 0);
+
+  if (G_UNLIKELY (offset + size > adapter->size || offset + size < size))
+    return 0;
+
+  /* skip to the buffer containing @offset */
+  offset += adapter->skip;
+  g = adapter->buflist;
+  buf = g->data;
+  bsize = GST_BUFFER_SIZE (buf);
+  while (offset >= bsize) {
+    offset -= bsize;
+    g = g_slist_next (g);
+    buf = g->data;
+    bsize = GST_BUFFER_SIZE (buf);
+  }
+
+  while (TRUE) {
+    csize = MIN (bsize - offset, size);
+    if (n < n_spans) {
+      spans[n].data = GST_BUFFER_DATA (buf) + offset;
+      spans[n].size = csize;
+    }
+    n++;
+    size -= csize;
+    if (size == 0)
+      break;
+
+    g = g_slist_next (g);
+    buf = g->data;
+    bsize = GST_BUFFER_SIZE (buf);
+    offset = 0;
+  }
+
+  return n;
+}
+
 /**
  * gst_adapter_flush:
  * @adapter: a #GstAdapter
@@ -71,6 +71,24 @@ struct _GstAdapter {
   gpointer _gst_reserved[GST_PADDING - 2];
 };
 
+/**
+ * GstAdapterSpan:
+ * @data: the first byte of the span
+ * @size: the number of bytes in the span
+ *
+ * A range of bytes that is contiguous in memory, as returned by
+ * gst_adapter_peek_spans().
+ *
+ * Since: 0.10.30
+ */
+typedef struct {
+  const guint8 *data;
+  guint         size;
+} GstAdapterSpan;
+
+/* for code that also builds against releases without gst_adapter_peek_spans() */
+#define GST_ADAPTER_HAS_SPANS 1
+
 struct _GstAdapterClass {
   GObjectClass  parent_class;
 
@@ -87,6 +105,9 @@ void                    gst_adapter_push                (GstAdapter *adapter, Gs
 const guint8 *          gst_adapter_peek                (GstAdapter *adapter, guint size);
 void                    gst_adapter_copy                (GstAdapter *adapter, guint8 *dest,
                                                          guint offset, guint size);
+guint                   gst_adapter_peek_spans          (GstAdapter *adapter, guint offset,
+                                                         guint size, GstAdapterSpan *spans,
+                                                         guint n_spans);
 void                    gst_adapter_flush               (GstAdapter *adapter, guint flush);
 guint8*                 gst_adapter_take                (GstAdapter *adapter, guint nbytes);
 GstBuffer*              gst_adapter_take_buffer         (GstAdapter *adapter, guint nbytes);
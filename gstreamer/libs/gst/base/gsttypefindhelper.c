@@ -40,6 +40,188 @@
 
 #include "gsttypefindhelper.h"
 
+/* *********************** typefinder dispatching ************************* */
+
+/* The typefind factories in order of rank, and for every value of the first
+ * byte of a stream a mask of the factories that can match it. Factories with
+ * a signature at offset 0 are only in the mask of the first byte of their
+ * signature, the others are in all masks and have their signature (if any)
+ * checked against the stream before their function is called. The extra
+ * mask at index 256 is for streams of which the first byte can't be read.
+ * Built from the registry and rebuilt when the list of features changes. */
+typedef struct
+{
+  gint refcount;
+  guint32 cookie;
+  GList *list;
+  GstTypeFindFactory **factories;
+  guint n_factories;
+  guint n_words;
+  guint32 *masks;
+} GstTypeFindDispatcher;
+
+#define DISPATCHER_MASK(d,byte) (&(d)->masks[(byte) * (d)->n_words])
+#define DISPATCHER_MASK_HAS(mask,i) (((mask)[(i) >> 5] >> ((i) & 31)) & 1)
+
+static GStaticMutex dispatcher_lock = G_STATIC_MUTEX_INIT;
+static GstTypeFindDispatcher *dispatcher = NULL;
+
+static void
+gst_type_find_dispatcher_unref (GstTypeFindDispatcher * d)
+{
+  if (!g_atomic_int_dec_and_test (&d->refcount))
+    return;
+
+  gst_plugin_feature_list_free (d->list);
+  g_free (d->factories);
+  g_free (d->masks);
+  g_slice_free (GstTypeFindDispatcher, d);
+}
+
+static GstTypeFindDispatcher *
+gst_type_find_dispatcher_new (void)
+{
+  GstTypeFindDispatcher *d;
+  GList *l;
+  guint i, b;
+
+  d = g_slice_new0 (GstTypeFindDispatcher);
+  d->refcount = 1;
+  /* take the cookie first, a change after it just causes another rebuild */
+  d->cookie = gst_default_registry_get_feature_list_cookie ();
+  d->list = gst_type_find_factory_get_list ();
+  d->n_factories = g_list_length (d->list);
+  d->factories = g_new (GstTypeFindFactory *, d->n_factories);
+  d->n_words = (d->n_factories + 31) / 32;
+  d->masks = g_new0 (guint32, 257 * d->n_words);
+
+  for (l = d->list, i = 0; l; l = l->next, i++) {
+    GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (l->data);
+    const guint8 *signature;
+    guint offset;
+
+    d->factories[i] = factory;
+    signature = gst_type_find_factory_get_signature (factory, &offset, NULL);
+    if (signature && offset == 0) {
+      DISPATCHER_MASK (d, signature[0])[i >> 5] |= 1 << (i & 31);
+    } else {
+      for (b = 0; b < 257; b++)
+        DISPATCHER_MASK (d, b)[i >> 5] |= 1 << (i & 31);
+    }
+  }
+
+  GST_DEBUG ("indexed %u typefind factories", d->n_factories);
+
+  return d;
+}
+
+static GstTypeFindDispatcher *
+gst_type_find_dispatcher_get (void)
+{
+  GstTypeFindDispatcher *d;
+
+  g_static_mutex_lock (&dispatcher_lock);
+  if (dispatcher == NULL || dispatcher->cookie !=
+      gst_default_registry_get_feature_list_cookie ()) {
+    if (dispatcher)
+      gst_type_find_dispatcher_unref (dispatcher);
+    dispatcher = gst_type_find_dispatcher_new ();
+  }
+  d = dispatcher;
+  g_atomic_int_inc (&d->refcount);
+  g_static_mutex_unlock (&dispatcher_lock);
+
+  return d;
+}
+
+static gboolean
+gst_type_find_factory_has_extension (GstTypeFindFactory * factory,
+    const gchar * extension)
+{
+  gchar **ext;
+  gint i;
+
+  ext = gst_type_find_factory_get_extensions (factory);
+  if (ext == NULL)
+    return FALSE;
+
+  for (i = 0; ext[i]; i++) {
+    if (strcmp (ext[i], extension) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/*
+ * gst_type_find_dispatcher_run:
+ * @d: a #GstTypeFindDispatcher
+ * @obj: object doing the typefinding (used for logging)
+ * @find: the #GstTypeFind to call the functions with
+ * @extension: extension of the media, or %NULL
+ * @factory: location the peek and suggest functions of @find take the
+ *     current factory from (used for logging)
+ * @best_probability: location the suggest function of @find stores the
+ *     best probability in
+ *
+ * Calls the typefind functions that can match the stream in order of rank,
+ * those for @extension first, until one of them suggests a type with
+ * maximum probability.
+ */
+static void
+gst_type_find_dispatcher_run (GstTypeFindDispatcher * d, GstObject * obj,
+    GstTypeFind * find, const gchar * extension,
+    GstTypeFindFactory ** factory, guint * best_probability)
+{
+  const guint32 *mask;
+  guint8 *head;
+  guint i, pass;
+
+  if (d->n_factories == 0)
+    return;
+
+  /* peek() wants a factory to log */
+  *factory = d->factories[0];
+  head = gst_type_find_peek (find, 0, 1);
+  if (*best_probability >= GST_TYPE_FIND_MAXIMUM)
+    return;
+  mask = DISPATCHER_MASK (d, head ? head[0] : 256);
+
+  for (pass = (extension ? 0 : 1); pass < 2; pass++) {
+    for (i = 0; i < d->n_factories; i++) {
+      const guint8 *signature;
+      guint offset, size;
+
+      if (!DISPATCHER_MASK_HAS (mask, i))
+        continue;
+
+      *factory = d->factories[i];
+
+      /* the extension ones go in the first pass, the rest in the second */
+      if (extension && gst_type_find_factory_has_extension (*factory,
+              extension) != (pass == 0))
+        continue;
+
+      signature = gst_type_find_factory_get_signature (*factory, &offset,
+          &size);
+      if (signature && (offset > 0 || size > 1)) {
+        guint8 *data = gst_type_find_peek (find, offset, size);
+
+        if (*best_probability >= GST_TYPE_FIND_MAXIMUM)
+          return;
+        if (data == NULL || memcmp (data, signature, size) != 0) {
+          GST_LOG_OBJECT (obj, "signature of '%s' does not match",
+              GST_PLUGIN_FEATURE_NAME (*factory));
+          continue;
+        }
+      }
+
+      gst_type_find_factory_call_function (*factory, find);
+      if (*best_probability >= GST_TYPE_FIND_MAXIMUM)
+        return;
+    }
+  }
+}
+
 /* ********************** typefinding in pull mode ************************ */
 
 static void
@@ -249,9 +431,8 @@ gst_type_find_helper_get_range_ext (GstObject * obj,
   GstTypeFindHelper helper;
   GstTypeFind find;
   GSList *walk;
-  GList *l, *type_list;
+  GstTypeFindDispatcher *d;
   GstCaps *result = NULL;
-  gint pos = 0;
 
   g_return_val_if_fail (GST_IS_OBJECT (obj), NULL);
   g_return_val_if_fail (func != NULL, NULL);
@@ -274,57 +455,16 @@ gst_type_find_helper_get_range_ext (GstObject * obj,
     find.get_length = helper_find_get_length;
   }
 
-  type_list = gst_type_find_factory_get_list ();
-
-  /* move the typefinders for the extension first in the list. The idea is that
-   * when one of them returns MAX we don't need to search further as there is a
-   * very high chance we got the right type. */
-  if (extension) {
-    GList *next;
-
-    GST_LOG_OBJECT (obj, "sorting typefind for extension %s to head",
-        extension);
-
-    for (l = type_list; l; l = next) {
-      GstTypeFindFactory *factory;
-      gint i;
-      gchar **ext;
+  if (extension)
+    GST_LOG_OBJECT (obj, "trying typefind for extension %s first", extension);
 
-      next = l->next;
-
-      factory = GST_TYPE_FIND_FACTORY (l->data);
-
-      ext = gst_type_find_factory_get_extensions (factory);
-      if (ext == NULL)
-        continue;
-
-      GST_LOG_OBJECT (obj, "testing factory %s for extension %s",
-          GST_PLUGIN_FEATURE_NAME (factory), extension);
-
-      for (i = 0; ext[i]; i++) {
-        if (strcmp (ext[i], extension) == 0) {
-          /* found extension, move in front */
-          GST_LOG_OBJECT (obj, "moving typefind for extension %s to head",
-              extension);
-          /* remove entry from list */
-          type_list = g_list_delete_link (type_list, l);
-          /* insert at the position */
-          type_list = g_list_insert (type_list, factory, pos);
-          /* next element will be inserted after this one */
-          pos++;
-          break;
-        }
-      }
-    }
-  }
-
-  for (l = type_list; l; l = l->next) {
-    helper.factory = GST_TYPE_FIND_FACTORY (l->data);
-    gst_type_find_factory_call_function (helper.factory, &find);
-    if (helper.best_probability >= GST_TYPE_FIND_MAXIMUM)
-      break;
-  }
-  gst_plugin_feature_list_free (type_list);
+  /* the typefinders for the extension go first. The idea is that when one of
+   * them returns MAX we don't need to search further as there is a very high
+   * chance we got the right type. */
+  d = gst_type_find_dispatcher_get ();
+  gst_type_find_dispatcher_run (d, obj, &find, extension,
+      &helper.factory, &helper.best_probability);
+  gst_type_find_dispatcher_unref (d);
 
   for (walk = helper.buffers; walk; walk = walk->next)
     gst_buffer_unref (GST_BUFFER_CAST (walk->data));
@@ -494,7 +634,7 @@ gst_type_find_helper_for_buffer (GstObject * obj, GstBuffer * buf,
 {
   GstTypeFindBufHelper helper;
   GstTypeFind find;
-  GList *l, *type_list;
+  GstTypeFindDispatcher *d;
   GstCaps *result = NULL;
 
   g_return_val_if_fail (buf != NULL, NULL);
@@ -516,15 +656,10 @@ gst_type_find_helper_for_buffer (GstObject * obj, GstBuffer * buf,
   find.suggest = buf_helper_find_suggest;
   find.get_length = NULL;
 
-  type_list = gst_type_find_factory_get_list ();
-
-  for (l = type_list; l; l = l->next) {
-    helper.factory = GST_TYPE_FIND_FACTORY (l->data);
-    gst_type_find_factory_call_function (helper.factory, &find);
-    if (helper.best_probability >= GST_TYPE_FIND_MAXIMUM)
-      break;
-  }
-  gst_plugin_feature_list_free (type_list);
+  d = gst_type_find_dispatcher_get ();
+  gst_type_find_dispatcher_run (d, obj, &find, NULL,
+      &helper.factory, &helper.best_probability);
+  gst_type_find_dispatcher_unref (d);
 
   if (helper.best_probability > 0)
     result = helper.caps;
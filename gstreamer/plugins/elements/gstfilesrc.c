@@ -60,6 +60,15 @@
 # include <sys/mman.h>
 #endif
 
+#if defined (HAVE_MMAP) && defined (HAVE_SIGACTION)
+# include <signal.h>
+# include <setjmp.h>
+# include <pthread.h>
+# ifdef SA_SIGINFO
+#  define GUARD_MMAP 1
+# endif
+#endif
+
 #include <errno.h>
 #include <string.h>
 
@@ -167,6 +176,11 @@ enum
 #define DEFAULT_TOUCH           TRUE
 #define DEFAULT_USEMMAP         FALSE
 #define DEFAULT_SEQUENTIAL      FALSE
+#define DEFAULT_READ_AHEAD      0
+
+/* most reads kept in flight, and threads doing them */
+#define MAX_READ_AHEAD_REQUESTS 16
+#define READ_AHEAD_THREADS      4
 
 enum
 {
@@ -176,7 +190,8 @@ enum
   ARG_MMAPSIZE,
   ARG_SEQUENTIAL,
   ARG_TOUCH,
-  ARG_USEMMAP
+  ARG_USEMMAP,
+  ARG_READ_AHEAD
 };
 
 static void gst_file_src_finalize (GObject * object);
@@ -280,6 +295,12 @@ gst_file_src_class_init (GstFileSrcClass * klass)
    * a CD/DVD medium cannot be be read because the medium is scratched or
    * otherwise damaged.
    *
+   * Where sigaction() is available, filesrc catches the SIGBUS raised while
+   * it touches the pages of a buffer since 0.10.30 (see #GstFileSrc:touch)
+   * and posts an error instead, so that a file getting truncated or a
+   * device going away before the data is read no longer kills the
+   * application. Faults on buffers that were already pushed are not caught.
+   *
    **/
   g_object_class_install_property (gobject_class, ARG_USEMMAP,
       g_param_spec_boolean ("use-mmap", "Use mmap to read data",
@@ -292,6 +313,23 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           "mmap pages will be sequential",
           DEFAULT_SEQUENTIAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_PLAYING));
+  /**
+   * GstFileSrc:read-ahead
+   *
+   * How many bytes to read ahead of the current position. When the file is
+   * read sequentially, filesrc keeps reads of the next blocks in flight in
+   * helper threads so that the disk latency overlaps with the processing
+   * downstream; random access is served directly. 0, the default, disables
+   * reading ahead. Not used in mmap mode or on platforms without pread().
+   *
+   * Since: 0.10.30
+   */
+  g_object_class_install_property (gobject_class, ARG_READ_AHEAD,
+      g_param_spec_uint ("read-ahead", "Read ahead",
+          "Bytes to read ahead of sequential reads (0 = disabled)",
+          0, G_MAXINT, DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
 
   gobject_class->finalize = gst_file_src_finalize;
 
@@ -327,6 +365,10 @@ gst_file_src_init (GstFileSrc * src, GstFileSrcClass * g_class)
   src->sequential = DEFAULT_SEQUENTIAL;
 
   src->is_regular = FALSE;
+
+  src->read_ahead = DEFAULT_READ_AHEAD;
+  src->ra_lock = g_mutex_new ();
+  src->ra_cond = g_cond_new ();
 }
 
 static void
@@ -339,6 +381,9 @@ gst_file_src_finalize (GObject * object)
   g_free (src->filename);
   g_free (src->uri);
 
+  g_mutex_free (src->ra_lock);
+  g_cond_free (src->ra_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -417,6 +462,9 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case ARG_USEMMAP:
       src->use_mmap = g_value_get_boolean (value);
       break;
+    case ARG_READ_AHEAD:
+      src->read_ahead = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -452,6 +500,9 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_USEMMAP:
       g_value_set_boolean (value, src->use_mmap);
       break;
+    case ARG_READ_AHEAD:
+      g_value_set_uint (value, src->read_ahead);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -491,6 +542,159 @@ struct _GstMmapBufferClass
   GstBufferClass buffer_class;
 };
 
+#ifdef GUARD_MMAP
+/* Accessing a page of a mapped file that is past its end, because the file
+ * got truncated after we mapped it, or that can't be read anymore, because
+ * the device went away, raises SIGBUS, which would kill the application.
+ * While filesrc touches the pages of a buffer before pushing it, it catches
+ * that signal and jumps back out of the touching loop to post an error.
+ * Faults anywhere else go to the previous handler. The handler can't take
+ * locks, hence the fixed table of probes with atomically claimed slots. */
+#define MAX_PROBES              64
+#define PROBE_CLAIMED           ((gpointer) 1)
+
+typedef struct
+{
+  gpointer start;               /* NULL if free */
+  gsize size;
+  pthread_t thread;
+  sigjmp_buf *env;
+} GstMmapProbe;
+
+static GstMmapProbe probes[MAX_PROBES];
+
+/* protected by guard_lock */
+static GStaticMutex guard_lock = G_STATIC_MUTEX_INIT;
+static guint guard_refcount = 0;
+static struct sigaction guard_oldaction;
+
+static void
+gst_file_src_sigbus_handler (int signum, siginfo_t * info, void *context)
+{
+  guint8 *addr = info->si_addr;
+  guint i;
+
+  for (i = 0; i < MAX_PROBES; i++) {
+    guint8 *start = g_atomic_pointer_get (&probes[i].start);
+
+    if (start == NULL || start == PROBE_CLAIMED)
+      continue;
+
+    if (addr >= start && addr < start + probes[i].size &&
+        pthread_equal (probes[i].thread, pthread_self ()))
+      siglongjmp (*probes[i].env, 1);
+  }
+
+  /* not ours */
+  if (guard_oldaction.sa_flags & SA_SIGINFO) {
+    guard_oldaction.sa_sigaction (signum, info, context);
+  } else if (guard_oldaction.sa_handler != SIG_DFL &&
+      guard_oldaction.sa_handler != SIG_IGN) {
+    guard_oldaction.sa_handler (signum);
+  } else {
+    /* the access faults again when we return, with the default action */
+    sigaction (SIGBUS, &guard_oldaction, NULL);
+  }
+}
+
+/* installs the handler for the first filesrc using mmap */
+static gboolean
+gst_file_src_guard_ref (void)
+{
+  gboolean ret = TRUE;
+
+  g_static_mutex_lock (&guard_lock);
+  if (guard_refcount == 0) {
+    struct sigaction action;
+
+    memset (&action, 0, sizeof (action));
+    sigemptyset (&action.sa_mask);
+    action.sa_sigaction = gst_file_src_sigbus_handler;
+    action.sa_flags = SA_SIGINFO;
+
+    ret = (sigaction (SIGBUS, &action, &guard_oldaction) == 0);
+    GST_DEBUG ("SIGBUS handler installed: %d", ret);
+  }
+  if (ret)
+    guard_refcount++;
+  g_static_mutex_unlock (&guard_lock);
+
+  return ret;
+}
+
+/* puts the previous handler back when the last one stops, unless somebody
+ * else installed their own meanwhile */
+static void
+gst_file_src_guard_unref (void)
+{
+  g_static_mutex_lock (&guard_lock);
+  if (--guard_refcount == 0) {
+    struct sigaction current;
+
+    if (sigaction (SIGBUS, NULL, &current) == 0 &&
+        (current.sa_flags & SA_SIGINFO) &&
+        current.sa_sigaction == gst_file_src_sigbus_handler) {
+      sigaction (SIGBUS, &guard_oldaction, NULL);
+      GST_DEBUG ("SIGBUS handler restored");
+    }
+  }
+  g_static_mutex_unlock (&guard_lock);
+}
+#endif /* GUARD_MMAP */
+
+/* read the first byte of each page, to bring it into memory */
+static void
+gst_file_src_touch_pages (GstFileSrc * src, const guint8 * data, gsize size)
+{
+  volatile const guint8 *p = data;
+  gsize i;
+
+  /* the read through a volatile pointer is not optimised away */
+  for (i = 0; i < size; i += src->pagesize)
+    (void) p[i];
+}
+
+#ifdef GUARD_MMAP
+/* Like gst_file_src_touch_pages(), but returns FALSE instead of crashing if
+ * a page can't be read. */
+static gboolean
+gst_file_src_probe_pages (GstFileSrc * src, const guint8 * data, gsize size)
+{
+  GstMmapProbe *probe = NULL;
+  sigjmp_buf env;
+  guint i;
+
+  for (i = 0; i < MAX_PROBES; i++) {
+    if (g_atomic_pointer_compare_and_exchange (&probes[i].start, NULL,
+            PROBE_CLAIMED)) {
+      probe = &probes[i];
+      break;
+    }
+  }
+
+  if (probe == NULL) {
+    GST_DEBUG_OBJECT (src, "too many probes, touching pages unguarded");
+    gst_file_src_touch_pages (src, data, size);
+    return TRUE;
+  }
+
+  probe->size = size;
+  probe->thread = pthread_self ();
+  probe->env = &env;
+
+  if (sigsetjmp (env, 1) != 0) {
+    g_atomic_pointer_set (&probe->start, NULL);
+    return FALSE;
+  }
+
+  g_atomic_pointer_set (&probe->start, (gpointer) data);
+  gst_file_src_touch_pages (src, data, size);
+  g_atomic_pointer_set (&probe->start, NULL);
+
+  return TRUE;
+}
+#endif
+
 static void gst_mmap_buffer_init (GTypeInstance * instance, gpointer g_class);
 static void gst_mmap_buffer_class_init (gpointer g_class, gpointer class_data);
 static void gst_mmap_buffer_finalize (GstMmapBuffer * mmap_buffer);
@@ -688,7 +892,6 @@ gst_file_src_create_mmap (GstFileSrc * src, guint64 offset, guint length,
   GstBuffer *buf = NULL;
   gsize readsize, mapsize;
   off_t readend, mapstart, mapend;
-  int i;
 
   /* calculate end pointers so we don't have to do so repeatedly later */
   readsize = length;
@@ -787,11 +990,15 @@ gst_file_src_create_mmap (GstFileSrc * src, guint64 offset, guint length,
 
   /* if we need to touch the buffer (to bring it into memory), do so */
   if (src->touch) {
-    volatile guchar *p = GST_BUFFER_DATA (buf), c;
-
-    /* read first byte of each page */
-    for (i = 0; i < GST_BUFFER_SIZE (buf); i += src->pagesize)
-      c = p[i];
+#ifdef GUARD_MMAP
+    if (src->guarded) {
+      if (!gst_file_src_probe_pages (src, GST_BUFFER_DATA (buf),
+              GST_BUFFER_SIZE (buf)))
+        goto read_failed;
+    } else
+#endif
+      gst_file_src_touch_pages (src, GST_BUFFER_DATA (buf),
+          GST_BUFFER_SIZE (buf));
   }
 
   /* we're done, return the buffer */
@@ -804,6 +1011,16 @@ could_not_mmap:
   {
     return GST_FLOW_ERROR;
   }
+#ifdef GUARD_MMAP
+read_failed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("could not read mapped data at offset %" G_GUINT64_FORMAT
+            ", the file was truncated or the device went away", offset));
+    gst_buffer_unref (buf);
+    return GST_FLOW_ERROR;
+  }
+#endif
 }
 #endif
 
@@ -818,6 +1035,208 @@ could_not_mmap:
  *
  */
 
+#ifdef HAVE_PREAD
+/* Asynchronous read-ahead: when a create() continues where the previous one
+ * ended, reads of the next few blocks of the same size are handed to a
+ * thread pool. They use pread(), which leaves the file position alone. A
+ * create() that hits one of them takes its data, waiting for it to complete
+ * if needed, instead of reading itself; one that misses cancels them. */
+
+typedef enum
+{
+  REQUEST_QUEUED,
+  REQUEST_BUSY,
+  REQUEST_DONE,
+  REQUEST_FAILED
+} GstFileSrcRequestState;
+
+typedef struct
+{
+  guint64 offset;
+  guint length;
+  GstFileSrcRequestState state;
+  gboolean cancelled;           /* not in ra_requests, the pool frees it */
+  GstBuffer *buf;
+} GstFileSrcRequest;
+
+static void
+gst_file_src_request_free (GstFileSrcRequest * req)
+{
+  if (req->buf)
+    gst_buffer_unref (req->buf);
+  g_slice_free (GstFileSrcRequest, req);
+}
+
+/* runs in the pool */
+static void
+gst_file_src_ra_read (GstFileSrcRequest * req, GstFileSrc * src)
+{
+  GstBuffer *buf;
+  gssize ret = -1;
+
+  g_mutex_lock (src->ra_lock);
+  if (req->cancelled) {
+    gst_file_src_request_free (req);
+    g_mutex_unlock (src->ra_lock);
+    return;
+  }
+  req->state = REQUEST_BUSY;
+  g_mutex_unlock (src->ra_lock);
+
+  buf = gst_buffer_try_new_and_alloc (req->length);
+  if (buf) {
+    do {
+      ret = pread (src->fd, GST_BUFFER_DATA (buf), req->length, req->offset);
+    } while (ret < 0 && errno == EINTR);
+  }
+
+  g_mutex_lock (src->ra_lock);
+  if (ret == req->length) {
+    GST_BUFFER_OFFSET (buf) = req->offset;
+    GST_BUFFER_OFFSET_END (buf) = req->offset + req->length;
+    req->buf = buf;
+    req->state = REQUEST_DONE;
+  } else {
+    /* the synchronous read will run into the same problem and report it */
+    GST_DEBUG_OBJECT (src, "read ahead of %u bytes at %" G_GUINT64_FORMAT
+        " returned %" G_GSSIZE_FORMAT, req->length, req->offset, ret);
+    if (buf)
+      gst_buffer_unref (buf);
+    req->state = REQUEST_FAILED;
+  }
+  if (req->cancelled)
+    gst_file_src_request_free (req);
+  else
+    g_cond_broadcast (src->ra_cond);
+  g_mutex_unlock (src->ra_lock);
+}
+
+/* with ra_lock */
+static void
+gst_file_src_ra_cancel (GstFileSrc * src, GList * link)
+{
+  GstFileSrcRequest *req = link->data;
+
+  src->ra_requests = g_list_delete_link (src->ra_requests, link);
+  if (req->state == REQUEST_QUEUED || req->state == REQUEST_BUSY)
+    req->cancelled = TRUE;
+  else
+    gst_file_src_request_free (req);
+}
+
+/* with ra_lock */
+static void
+gst_file_src_ra_schedule (GstFileSrc * src, guint64 offset, guint length)
+{
+  guint64 next = offset + length;
+  guint i, n;
+
+  n = CLAMP (src->read_ahead / length, 1, MAX_READ_AHEAD_REQUESTS);
+  for (i = 0; i < n && next < src->size; i++, next += length) {
+    GstFileSrcRequest *req;
+    GList *walk;
+
+    for (walk = src->ra_requests; walk; walk = walk->next) {
+      req = walk->data;
+      if (req->offset <= next && next < req->offset + req->length)
+        break;
+    }
+    if (walk)
+      continue;
+
+    req = g_slice_new0 (GstFileSrcRequest);
+    req->offset = next;
+    req->length = MIN (length, src->size - next);
+    req->state = REQUEST_QUEUED;
+    src->ra_requests = g_list_append (src->ra_requests, req);
+    g_thread_pool_push (src->ra_pool, req, NULL);
+  }
+}
+
+/* Returns the data of a read-ahead request holding (offset,length), if
+ * there is one, and schedules the next ones for sequential access. */
+static GstBuffer *
+gst_file_src_ra_take (GstFileSrc * src, guint64 offset, guint length)
+{
+  GstBuffer *buf = NULL;
+  GList *walk, *next;
+
+  g_mutex_lock (src->ra_lock);
+  src->ra_sequential = (offset == src->ra_last_end);
+  src->ra_last_end = offset + length;
+
+  for (walk = src->ra_requests; walk; walk = walk->next) {
+    GstFileSrcRequest *req = walk->data;
+
+    if (req->offset <= offset && offset + length <= req->offset + req->length) {
+      while (req->state == REQUEST_QUEUED || req->state == REQUEST_BUSY)
+        g_cond_wait (src->ra_cond, src->ra_lock);
+
+      if (req->state == REQUEST_DONE) {
+        if (req->offset == offset && req->length == length) {
+          buf = gst_buffer_ref (req->buf);
+        } else {
+          buf = gst_buffer_create_sub (req->buf, offset - req->offset, length);
+          GST_BUFFER_OFFSET (buf) = offset;
+          GST_BUFFER_OFFSET_END (buf) = offset + length;
+        }
+      }
+      break;
+    }
+  }
+
+  /* drop what we went past, or everything when jumping around */
+  for (walk = src->ra_requests; walk; walk = next) {
+    GstFileSrcRequest *req = walk->data;
+
+    next = walk->next;
+    if (!src->ra_sequential || req->offset + req->length <= offset + length)
+      gst_file_src_ra_cancel (src, walk);
+  }
+
+  if (src->ra_sequential)
+    gst_file_src_ra_schedule (src, offset, length);
+  g_mutex_unlock (src->ra_lock);
+
+  GST_LOG_OBJECT (src, "%s %u bytes at offset %" G_GUINT64_FORMAT,
+      buf ? "read ahead" : "no read ahead for", length, offset);
+
+  return buf;
+}
+
+static void
+gst_file_src_ra_start (GstFileSrc * src, guint64 size)
+{
+  GError *err = NULL;
+
+  src->size = size;
+  src->ra_last_end = G_MAXUINT64;
+  src->ra_sequential = FALSE;
+  src->ra_pool = g_thread_pool_new ((GFunc) gst_file_src_ra_read, src,
+      READ_AHEAD_THREADS, FALSE, &err);
+  if (!src->ra_pool) {
+    GST_WARNING_OBJECT (src, "no read ahead: %s", err->message);
+    g_error_free (err);
+  }
+}
+
+static void
+gst_file_src_ra_stop (GstFileSrc * src)
+{
+  if (!src->ra_pool)
+    return;
+
+  g_mutex_lock (src->ra_lock);
+  while (src->ra_requests)
+    gst_file_src_ra_cancel (src, src->ra_requests);
+  g_mutex_unlock (src->ra_lock);
+
+  /* let the pool run the cancelled requests, that frees them */
+  g_thread_pool_free (src->ra_pool, FALSE, TRUE);
+  src->ra_pool = NULL;
+}
+#endif /* HAVE_PREAD */
+
 static GstFlowReturn
 gst_file_src_create_read (GstFileSrc * src, guint64 offset, guint length,
     GstBuffer ** buffer)
@@ -825,6 +1244,16 @@ gst_file_src_create_read (GstFileSrc * src, guint64 offset, guint length,
   int ret;
   GstBuffer *buf;
 
+#ifdef HAVE_PREAD
+  if (src->ra_pool && length > 0) {
+    buf = gst_file_src_ra_take (src, offset, length);
+    if (buf) {
+      *buffer = buf;
+      return GST_FLOW_OK;
+    }
+  }
+#endif
+
   if (G_UNLIKELY (src->read_position != offset)) {
     off_t res;
 
@@ -1021,6 +1450,9 @@ gst_file_src_start (GstBaseSrc * basesrc)
       GST_DEBUG_OBJECT (src, "using mmap for file");
       src->using_mmap = TRUE;
       src->seekable = TRUE;
+#ifdef GUARD_MMAP
+      src->guarded = gst_file_src_guard_ref ();
+#endif
     }
   }
   if (src->mapbuf == NULL)
@@ -1044,6 +1476,11 @@ gst_file_src_start (GstBaseSrc * basesrc)
    * don't know their length, so seeking isn't useful/meaningful */
   src->seekable = src->seekable && src->is_regular;
 
+#ifdef HAVE_PREAD
+  if (src->read_ahead > 0 && src->seekable && !src->using_mmap)
+    gst_file_src_ra_start (src, stat_results.st_size);
+#endif
+
   return TRUE;
 
   /* ERROR */
@@ -1097,6 +1534,10 @@ gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
 
+#ifdef HAVE_PREAD
+  gst_file_src_ra_stop (src);
+#endif
+
   /* close the file */
   close (src->fd);
 
@@ -1109,6 +1550,13 @@ gst_file_src_stop (GstBaseSrc * basesrc)
     src->mapbuf = NULL;
   }
 
+#ifdef GUARD_MMAP
+  if (src->guarded) {
+    gst_file_src_guard_unref ();
+    src->guarded = FALSE;
+  }
+#endif
+
   return TRUE;
 }
 
@@ -72,6 +72,18 @@ struct _GstFileSrc {
   GstBuffer *mapbuf;
   size_t mapsize;
   gboolean use_mmap;
+  gboolean guarded;                     /* whether we hold a ref on the
+                                           SIGBUS handler */
+
+  /* asynchronous read-ahead */
+  guint read_ahead;                     /* bytes to keep requested ahead */
+  guint64 size;                         /* file size when started */
+  GThreadPool *ra_pool;
+  GMutex *ra_lock;
+  GCond *ra_cond;
+  GList *ra_requests;                   /* pending and completed reads */
+  guint64 ra_last_end;                  /* end of the previous create() */
+  gboolean ra_sequential;               /* whether it matched this one */
 };
 
 struct _GstFileSrcClass {
@@ -99,6 +99,13 @@
  *   queues is filled.
  *   Both signals are emitted from the context of the streaming thread.
  * </para>
+ * <para>
+ *   By default every stream has its own streaming thread pushing its data
+ *   downstream. When #GstMultiQueue:worker-threads is set, the streams are
+ *   instead serviced by a pool of at most that many threads, the stream that
+ *   is furthest behind in running time first, and
+ *   #GstMultiQueue:max-size-bytes limits the data in all queues together.
+ * </para>
  * </refsect2>
  *
  * Last reviewed on 2008-01-25 (0.10.17)
@@ -153,6 +160,15 @@ struct _GstSingleQueue
   guint32 nextid;               /* ID of the next object waiting to be pushed */
   guint32 oldid;                /* ID of the last object pushed (last in a series) */
   GCond *turn;                  /* SingleQueue turn waiting conditional */
+
+  /* worker pool, protected by global lock */
+  gboolean pooled;              /* serviced by the pool instead of a task */
+  gboolean scheduled;           /* in the pool or being serviced */
+  gboolean busy;                /* being serviced by worker */
+  GThread *worker;
+  GstMiniObject *pending;       /* object held back while not-linked */
+  GstClockTime sched_time;      /* running time of srcpad when scheduled */
+  guint32 sched_seq;
 };
 
 
@@ -168,6 +184,9 @@ struct _GstMultiQueueItem
 
   GDestroyNotify destroy;
   guint32 posid;
+
+  /* the byte budget this item is counted in, or NULL */
+  volatile gint *budget;
 };
 
 static GstSingleQueue *gst_single_queue_new (GstMultiQueue * mqueue);
@@ -221,6 +240,8 @@ enum
 #define DEFAULT_LOW_PERCENT   10
 #define DEFAULT_HIGH_PERCENT  99
 
+#define DEFAULT_WORKER_THREADS 0
+
 enum
 {
   PROP_0,
@@ -233,6 +254,7 @@ enum
   PROP_USE_BUFFERING,
   PROP_LOW_PERCENT,
   PROP_HIGH_PERCENT,
+  PROP_WORKER_THREADS,
   PROP_LAST
 };
 
@@ -255,6 +277,11 @@ static GstPad *gst_multi_queue_request_new_pad (GstElement * element,
 static void gst_multi_queue_release_pad (GstElement * element, GstPad * pad);
 
 static void gst_multi_queue_loop (GstPad * pad);
+static void gst_multi_queue_worker (GstSingleQueue * sq, GstMultiQueue * mq);
+static gint gst_single_queue_compare (GstSingleQueue * a, GstSingleQueue * b,
+    gpointer user_data);
+static void gst_single_queue_schedule (GstMultiQueue * mq, GstSingleQueue * sq);
+static void gst_multi_queue_grow_pool (GstMultiQueue * mq);
 
 #define _do_init(bla) \
   GST_DEBUG_CATEGORY_INIT (multi_queue_debug, "multiqueue", 0, "multiqueue element");
@@ -389,6 +416,27 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
       g_param_spec_int ("high-percent", "High percent",
           "High threshold for buffering to finish", 0, 100,
           DEFAULT_HIGH_PERCENT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstMultiQueue:worker-threads
+   *
+   * Number of threads pushing the data of all streams downstream, 0 for one
+   * streaming thread per stream. With a pool, the stream that is furthest
+   * behind in running time is serviced first and
+   * #GstMultiQueue:max-size-bytes is the limit for all queues together.
+   *
+   * A worker stays with a stream while its push blocks downstream, in a
+   * prerolling sink for example. When a stream fills up waiting for a worker,
+   * the pool grows by one thread, up to one thread per stream.
+   *
+   * The value is used when the source pads are activated.
+   *
+   * Since: 0.10.30
+   */
+  g_object_class_install_property (gobject_class, PROP_WORKER_THREADS,
+      g_param_spec_uint ("worker-threads", "Worker threads",
+          "Number of threads servicing all streams (0 = one per stream)",
+          0, G_MAXINT, DEFAULT_WORKER_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
 
   gobject_class->finalize = gst_multi_queue_finalize;
@@ -421,6 +469,11 @@ gst_multi_queue_init (GstMultiQueue * mqueue, GstMultiQueueClass * klass)
   mqueue->highid = -1;
   mqueue->nextnotlinked = -1;
 
+  mqueue->worker_threads = DEFAULT_WORKER_THREADS;
+  mqueue->pool = NULL;
+  mqueue->total_bytes = 0;
+  mqueue->budget_full = FALSE;
+
   mqueue->qlock = g_mutex_new ();
 }
 
@@ -435,6 +488,8 @@ gst_multi_queue_finalize (GObject * object)
   mqueue->queues_cookie++;
 
   /* free/unref instance data */
+  if (mqueue->pool)
+    g_thread_pool_free (mqueue->pool, TRUE, TRUE);
   g_mutex_free (mqueue->qlock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -492,6 +547,14 @@ gst_multi_queue_set_property (GObject * object, guint prop_id,
     case PROP_HIGH_PERCENT:
       mq->high_percent = g_value_get_int (value);
       break;
+    case PROP_WORKER_THREADS:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      mq->worker_threads = g_value_get_uint (value);
+      /* queues already in the pool keep using it until they are deactivated */
+      if (mq->pool && mq->worker_threads > 0)
+        g_thread_pool_set_max_threads (mq->pool, mq->worker_threads, NULL);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -534,6 +597,9 @@ gst_multi_queue_get_property (GObject * object, guint prop_id,
     case PROP_HIGH_PERCENT:
       g_value_set_int (value, mq->high_percent);
       break;
+    case PROP_WORKER_THREADS:
+      g_value_set_uint (value, mq->worker_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -660,15 +726,35 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush)
     sq->srcresult = GST_FLOW_WRONG_STATE;
     gst_data_queue_set_flushing (sq->queue, TRUE);
 
-    /* wake up non-linked task */
-    GST_LOG_OBJECT (mq, "SingleQueue %d : waking up eventually waiting task",
-        sq->id);
-    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
-    g_cond_signal (sq->turn);
-    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    if (sq->pooled) {
+      GST_LOG_OBJECT (mq, "SingleQueue %d : waiting for the worker", sq->id);
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      /* a worker flushing its own queue has nothing to wait for */
+      while (sq->scheduled && sq->worker != g_thread_self ()) {
+        /* make sure some worker gets to see that we are flushing */
+        if (!sq->busy)
+          gst_multi_queue_grow_pool (mq);
+        g_cond_wait (sq->turn, mq->qlock);
+      }
+      if (sq->pending) {
+        gst_mini_object_unref (sq->pending);
+        sq->pending = NULL;
+        sq->nextid = 0;
+        mq->numwaiting--;
+      }
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      result = TRUE;
+    } else {
+      /* wake up non-linked task */
+      GST_LOG_OBJECT (mq, "SingleQueue %d : waking up eventually waiting task",
+          sq->id);
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      g_cond_signal (sq->turn);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 
-    GST_LOG_OBJECT (mq, "SingleQueue %d : pausing task", sq->id);
-    result = gst_pad_pause_task (sq->srcpad);
+      GST_LOG_OBJECT (mq, "SingleQueue %d : pausing task", sq->id);
+      result = gst_pad_pause_task (sq->srcpad);
+    }
     sq->sink_tainted = sq->src_tainted = TRUE;
   } else {
     gst_data_queue_flush (sq->queue);
@@ -683,10 +769,15 @@ gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush)
     sq->oldid = 0;
     gst_data_queue_set_flushing (sq->queue, FALSE);
 
-    GST_LOG_OBJECT (mq, "SingleQueue %d : starting task", sq->id);
-    result =
-        gst_pad_start_task (sq->srcpad, (GstTaskFunction) gst_multi_queue_loop,
-        sq->srcpad);
+    if (sq->pooled) {
+      /* the queue is scheduled on the pool when data arrives */
+      result = TRUE;
+    } else {
+      GST_LOG_OBJECT (mq, "SingleQueue %d : starting task", sq->id);
+      result =
+          gst_pad_start_task (sq->srcpad,
+          (GstTaskFunction) gst_multi_queue_loop, sq->srcpad);
+    }
   }
   return result;
 }
@@ -885,13 +976,78 @@ apply_buffer (GstMultiQueue * mq, GstSingleQueue * sq, GstClockTime timestamp,
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 }
 
+/* the size of a buffer list and the timestamp and duration to give to
+ * apply_buffer() for it */
+typedef struct
+{
+  guint size;
+  GstClockTime timestamp;
+  GstClockTime duration;
+  GstClockTime total_duration;
+} BufferListInfo;
+
+static GstBufferListItem
+buffer_list_get_info (GstBuffer ** buf, guint group, guint idx, gpointer data)
+{
+  BufferListInfo *info = data;
+
+  info->size += GST_BUFFER_SIZE (*buf);
+
+  /* the last timestamp in the list and the durations from there on */
+  if (GST_BUFFER_TIMESTAMP_IS_VALID (*buf)) {
+    info->timestamp = GST_BUFFER_TIMESTAMP (*buf);
+    info->duration = 0;
+  }
+  if (GST_BUFFER_DURATION_IS_VALID (*buf)) {
+    info->duration += GST_BUFFER_DURATION (*buf);
+    info->total_duration += GST_BUFFER_DURATION (*buf);
+  }
+  return GST_BUFFER_LIST_CONTINUE;
+}
+
+static void
+buffer_list_get_info_all (GstBufferList * list, BufferListInfo * info)
+{
+  info->size = 0;
+  info->timestamp = GST_CLOCK_TIME_NONE;
+  info->duration = 0;
+  info->total_duration = 0;
+
+  gst_buffer_list_foreach (list, buffer_list_get_info, info);
+}
+
 static GstFlowReturn
 gst_single_queue_push_one (GstMultiQueue * mq, GstSingleQueue * sq,
     GstMiniObject * object)
 {
   GstFlowReturn result = GST_FLOW_OK;
 
-  if (GST_IS_BUFFER (object)) {
+  if (GST_IS_BUFFER_LIST (object)) {
+    GstBufferList *list;
+    BufferListInfo info;
+    GstBuffer *first;
+    GstCaps *caps = NULL;
+
+    list = GST_BUFFER_LIST_CAST (object);
+    buffer_list_get_info_all (list, &info);
+
+    apply_buffer (mq, sq, info.timestamp, info.duration, &sq->src_segment);
+
+    /* Applying the list may have made the queue non-full again */
+    gst_data_queue_limits_changed (sq->queue);
+
+    GST_DEBUG_OBJECT (mq,
+        "SingleQueue %d : Pushing buffer list %p ending at %" GST_TIME_FORMAT,
+        sq->id, list, GST_TIME_ARGS (info.timestamp));
+
+    /* Set the caps of the first buffer on the pad, see below */
+    if ((first = gst_buffer_list_get (list, 0, 0)))
+      caps = GST_BUFFER_CAPS (first);
+    if (caps && caps != GST_PAD_CAPS (sq->srcpad))
+      gst_pad_set_caps (sq->srcpad, caps);
+
+    result = gst_pad_push_list (sq->srcpad, list);
+  } else if (GST_IS_BUFFER (object)) {
     GstBuffer *buffer;
     GstClockTime timestamp, duration;
     GstCaps *caps;
@@ -963,6 +1119,8 @@ gst_multi_queue_item_steal_object (GstMultiQueueItem * item)
 static void
 gst_multi_queue_item_destroy (GstMultiQueueItem * item)
 {
+  if (item->budget)
+    g_atomic_int_add (item->budget, -(gint) item->size);
   if (item->object)
     gst_mini_object_unref (item->object);
   g_slice_free (GstMultiQueueItem, item);
@@ -970,7 +1128,8 @@ gst_multi_queue_item_destroy (GstMultiQueueItem * item)
 
 /* takes ownership of passed mini object! */
 static GstMultiQueueItem *
-gst_multi_queue_buffer_item_new (GstMiniObject * object, guint32 curid)
+gst_multi_queue_buffer_item_new (GstMiniObject * object, guint32 curid,
+    guint size, GstClockTime duration)
 {
   GstMultiQueueItem *item;
 
@@ -978,9 +1137,10 @@ gst_multi_queue_buffer_item_new (GstMiniObject * object, guint32 curid)
   item->object = object;
   item->destroy = (GDestroyNotify) gst_multi_queue_item_destroy;
   item->posid = curid;
+  item->budget = NULL;
 
-  item->size = GST_BUFFER_SIZE (object);
-  item->duration = GST_BUFFER_DURATION (object);
+  item->size = size;
+  item->duration = duration;
   if (item->duration == GST_CLOCK_TIME_NONE)
     item->duration = 0;
   item->visible = TRUE;
@@ -996,6 +1156,7 @@ gst_multi_queue_event_item_new (GstMiniObject * object, guint32 curid)
   item->object = object;
   item->destroy = (GDestroyNotify) gst_multi_queue_item_destroy;
   item->posid = curid;
+  item->budget = NULL;
 
   item->size = 0;
   item->duration = 0;
@@ -1136,15 +1297,240 @@ out_flushing:
   }
 }
 
+/*
+ * Worker pool functions
+ */
+
+/* The pool hands out the queue whose srcpad is furthest behind in running
+ * time first, queues that did not push anything yet before all others. */
+static gint
+gst_single_queue_compare (GstSingleQueue * a, GstSingleQueue * b,
+    gpointer user_data)
+{
+  GstClockTime ta, tb;
+
+  ta = GST_CLOCK_TIME_IS_VALID (a->sched_time) ? a->sched_time : 0;
+  tb = GST_CLOCK_TIME_IS_VALID (b->sched_time) ? b->sched_time : 0;
+
+  if (ta != tb)
+    return ta < tb ? -1 : 1;
+
+  /* first come, first served */
+  return (gint32) (a->sched_seq - b->sched_seq);
+}
+
+/* WITH LOCK TAKEN */
+static void
+gst_single_queue_schedule (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GST_LOG_OBJECT (mq, "SingleQueue %d : scheduling at %" GST_TIME_FORMAT,
+      sq->id, GST_TIME_ARGS (sq->srctime));
+
+  sq->scheduled = TRUE;
+  sq->sched_time = sq->srctime;
+  sq->sched_seq = mq->sched_counter++;
+  g_thread_pool_push (mq->pool, sq, NULL);
+}
+
+/* A queue waiting for a worker while all of them are blocked downstream
+ * would wait forever if the blocked pushes need data from this queue, as
+ * happens when several sinks preroll. Give the pool another thread then.
+ * WITH LOCK TAKEN */
+static void
+gst_multi_queue_grow_pool (GstMultiQueue * mq)
+{
+  gint max_threads;
+
+  max_threads = g_thread_pool_get_max_threads (mq->pool);
+  if (max_threads < 0 || max_threads >= (gint) mq->nbqueues)
+    return;
+
+  GST_DEBUG_OBJECT (mq, "workers are blocked, growing pool to %d threads",
+      max_threads + 1);
+  g_thread_pool_set_max_threads (mq->pool, max_threads + 1, NULL);
+}
+
+/* schedule a pooled queue after data was added to it */
+static void
+gst_single_queue_queued (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  /* a queue that is held back for not-linked is scheduled again when it is
+   * its turn */
+  if (!sq->scheduled && sq->pending == NULL)
+    gst_single_queue_schedule (mq, sq);
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+}
+
+/* unblock the queues that wait for the byte budget after data left */
+static void
+gst_multi_queue_budget_released (GstMultiQueue * mq)
+{
+  GList *tmp;
+
+  if (G_LIKELY (!g_atomic_int_get (&mq->budget_full)))
+    return;
+  if ((guint) g_atomic_int_get (&mq->total_bytes) >= mq->max_size.bytes)
+    return;
+
+  g_atomic_int_set (&mq->budget_full, FALSE);
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
+    GstSingleQueue *oq = (GstSingleQueue *) tmp->data;
+
+    if (oq->pooled)
+      gst_data_queue_limits_changed (oq->queue);
+  }
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+}
+
+/* Called from the pool with a scheduled queue. Pushes objects of the queue
+ * the same way as gst_multi_queue_loop() does, but instead of blocking it
+ * lets go of the queue when it is empty, when it has to wait for its turn
+ * because it is not-linked, or when other queues wait for a worker. In the
+ * last case the queue goes back into the pool, behind the queues that are
+ * further behind in running time. */
+static void
+gst_multi_queue_worker (GstSingleQueue * sq, GstMultiQueue * mq)
+{
+  GstMultiQueueItem *item;
+  GstDataQueueItem *sitem;
+  GstMiniObject *object;
+  guint32 newid;
+  GstFlowReturn result;
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  sq->busy = TRUE;
+  sq->worker = g_thread_self ();
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  GST_LOG_OBJECT (mq, "SingleQueue %d : servicing", sq->id);
+
+  do {
+    if (sq->srcresult == GST_FLOW_WRONG_STATE)
+      goto out_flushing;
+
+    if (sq->pending) {
+      /* it is our turn now */
+      object = sq->pending;
+      sq->pending = NULL;
+      newid = sq->nextid;
+    } else {
+      /* we are the only ones popping, so this does not block */
+      if (gst_data_queue_is_empty (sq->queue)) {
+        single_queue_underrun_cb (sq->queue, sq);
+
+        GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+        /* data that arrives after this will schedule us again */
+        if (gst_data_queue_is_empty (sq->queue))
+          goto idle;
+        GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      }
+
+      if (!(gst_data_queue_pop (sq->queue, &sitem)))
+        goto out_flushing;
+
+      item = (GstMultiQueueItem *) sitem;
+      newid = item->posid;
+
+      object = gst_multi_queue_item_steal_object (item);
+      gst_multi_queue_item_destroy (item);
+      gst_multi_queue_budget_released (mq);
+    }
+
+    GST_LOG_OBJECT (mq, "SingleQueue %d : newid:%d", sq->id, newid);
+
+    /* not-linked queues don't push beyond the linked ones, see
+     * gst_multi_queue_loop(). Instead of waiting we hold on to the object and
+     * wake_up_next_non_linked() schedules us again */
+    if (sq->srcresult == GST_FLOW_NOT_LINKED) {
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      sq->nextid = newid;
+      compute_high_id (mq);
+      if (newid > mq->highid) {
+        GST_DEBUG_OBJECT (mq, "queue %d waiting for not-linked wakeup with "
+            "newid %u and highid %u", sq->id, newid, mq->highid);
+        sq->pending = object;
+        mq->numwaiting++;
+        wake_up_next_non_linked (mq);
+        goto idle;
+      }
+      sq->nextid = 0;
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    }
+
+    result = gst_single_queue_push_one (mq, sq, object);
+    sq->srcresult = result;
+
+    if (result != GST_FLOW_OK && result != GST_FLOW_NOT_LINKED
+        && result != GST_FLOW_UNEXPECTED)
+      goto out_flushing;
+
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    sq->oldid = newid;
+    if (mq->numwaiting > 0) {
+      compute_high_id (mq);
+      wake_up_next_non_linked (mq);
+    }
+    /* stay with this queue unless others are waiting for a worker */
+    if (g_thread_pool_unprocessed (mq->pool) > 0 &&
+        !gst_data_queue_is_empty (sq->queue)) {
+      sq->busy = FALSE;
+      sq->worker = NULL;
+      gst_single_queue_schedule (mq, sq);
+      g_cond_signal (sq->turn);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      return;
+    }
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+  }
+  while (TRUE);
+
+idle:
+  {
+    GST_LOG_OBJECT (mq, "SingleQueue %d : idle", sq->id);
+    sq->busy = FALSE;
+    sq->worker = NULL;
+    sq->scheduled = FALSE;
+    g_cond_signal (sq->turn);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+    return;
+  }
+out_flushing:
+  {
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    compute_high_id (mq);
+    wake_up_next_non_linked (mq);
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+    if (GST_FLOW_IS_FATAL (sq->srcresult)) {
+      gst_data_queue_flush (sq->queue);
+      single_queue_underrun_cb (sq->queue, sq);
+    }
+    gst_data_queue_set_flushing (sq->queue, TRUE);
+    GST_CAT_LOG_OBJECT (multi_queue_debug, mq,
+        "SingleQueue[%d] stopped, reason:%s",
+        sq->id, gst_flow_get_name (sq->srcresult));
+
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    goto idle;
+  }
+}
+
 /**
- * gst_multi_queue_chain:
+ * gst_multi_queue_chain_buffer_or_list:
  *
  * This is similar to GstQueue's chain function, except:
  * _ we don't have leak behavioures,
  * _ we push with a unique id (curid)
+ *
+ * A buffer list is queued as one item with the size and duration of all its
+ * buffers, and pushed downstream as a whole.
  */
 static GstFlowReturn
-gst_multi_queue_chain (GstPad * pad, GstBuffer * buffer)
+gst_multi_queue_chain_buffer_or_list (GstPad * pad, GstMiniObject * object,
+    gboolean is_list)
 {
   GstSingleQueue *sq;
   GstMultiQueue *mq;
@@ -1158,13 +1544,35 @@ gst_multi_queue_chain (GstPad * pad, GstBuffer * buffer)
   /* Get a unique incrementing id */
   curid = mq->counter++;
 
-  GST_LOG_OBJECT (mq, "SingleQueue %d : about to enqueue buffer %p with id %d",
-      sq->id, buffer, curid);
+  /* we can't look at the object anymore once it is in the queue */
+  if (is_list) {
+    BufferListInfo info;
+
+    GST_LOG_OBJECT (mq, "SingleQueue %d : about to enqueue buffer list %p "
+        "with id %d", sq->id, object, curid);
+
+    buffer_list_get_info_all (GST_BUFFER_LIST_CAST (object), &info);
+    item = gst_multi_queue_buffer_item_new (object, curid, info.size,
+        info.total_duration);
+    timestamp = info.timestamp;
+    duration = info.duration;
+  } else {
+    GstBuffer *buffer = GST_BUFFER_CAST (object);
+
+    GST_LOG_OBJECT (mq, "SingleQueue %d : about to enqueue buffer %p "
+        "with id %d", sq->id, buffer, curid);
 
-  item = gst_multi_queue_buffer_item_new (GST_MINI_OBJECT_CAST (buffer), curid);
+    item = gst_multi_queue_buffer_item_new (object, curid,
+        GST_BUFFER_SIZE (buffer), GST_BUFFER_DURATION (buffer));
+    timestamp = GST_BUFFER_TIMESTAMP (buffer);
+    duration = GST_BUFFER_DURATION (buffer);
+  }
 
-  timestamp = GST_BUFFER_TIMESTAMP (buffer);
-  duration = GST_BUFFER_DURATION (buffer);
+  /* pooled queues share one byte budget, the item counts until it is gone */
+  if (sq->pooled) {
+    item->budget = &mq->total_bytes;
+    g_atomic_int_add (&mq->total_bytes, item->size);
+  }
 
   if (!(gst_data_queue_push (sq->queue, (GstDataQueueItem *) item)))
     goto flushing;
@@ -1173,6 +1581,9 @@ gst_multi_queue_chain (GstPad * pad, GstBuffer * buffer)
    * that we never end up filling the queue first. */
   apply_buffer (mq, sq, timestamp, duration, &sq->sink_segment);
 
+  if (sq->pooled)
+    gst_single_queue_queued (mq, sq);
+
 done:
   return sq->srcresult;
 
@@ -1186,6 +1597,20 @@ flushing:
   }
 }
 
+static GstFlowReturn
+gst_multi_queue_chain (GstPad * pad, GstBuffer * buffer)
+{
+  return gst_multi_queue_chain_buffer_or_list (pad,
+      GST_MINI_OBJECT_CAST (buffer), FALSE);
+}
+
+static GstFlowReturn
+gst_multi_queue_chain_list (GstPad * pad, GstBufferList * list)
+{
+  return gst_multi_queue_chain_buffer_or_list (pad,
+      GST_MINI_OBJECT_CAST (list), TRUE);
+}
+
 static gboolean
 gst_multi_queue_sink_activate_push (GstPad * pad, gboolean active)
 {
@@ -1264,6 +1689,9 @@ gst_multi_queue_sink_event (GstPad * pad, GstEvent * event)
   if (!(res = gst_data_queue_push (sq->queue, (GstDataQueueItem *) item)))
     goto flushing;
 
+  if (sq->pooled)
+    gst_single_queue_queued (mq, sq);
+
   /* mark EOS when we received one, we must do that after putting the
    * buffer in the queue because EOS marks the buffer as filled. No need to take
    * a lock, the _check_full happens from this thread only, right before pushing
@@ -1337,6 +1765,17 @@ gst_multi_queue_src_activate_push (GstPad * pad, gboolean active)
   GST_DEBUG_OBJECT (mq, "SingleQueue %d", sq->id);
 
   if (active) {
+    GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+    sq->pooled = (mq->worker_threads > 0);
+    if (sq->pooled && mq->pool == NULL) {
+      GST_DEBUG_OBJECT (mq, "creating pool of %u workers", mq->worker_threads);
+      mq->pool = g_thread_pool_new ((GFunc) gst_multi_queue_worker, mq,
+          mq->worker_threads, FALSE, NULL);
+      g_thread_pool_set_sort_function (mq->pool,
+          (GCompareDataFunc) gst_single_queue_compare, NULL);
+    }
+    GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
     result = gst_single_queue_flush (mq, sq, FALSE);
   } else {
     result = gst_single_queue_flush (mq, sq, TRUE);
@@ -1402,7 +1841,12 @@ wake_up_next_non_linked (GstMultiQueue * mq)
     if (sq->srcresult == GST_FLOW_NOT_LINKED) {
       if (sq->nextid != 0 && sq->nextid <= mq->highid) {
         GST_LOG_OBJECT (mq, "Waking up singlequeue %d", sq->id);
-        g_cond_signal (sq->turn);
+        if (!sq->pooled) {
+          g_cond_signal (sq->turn);
+        } else if (sq->pending && !sq->scheduled) {
+          mq->numwaiting--;
+          gst_single_queue_schedule (mq, sq);
+        }
       }
     }
   }
@@ -1470,6 +1914,10 @@ single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   GST_LOG_OBJECT (mq, "Single Queue %d is full", sq->id);
 
   GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  /* filled up while waiting for a worker, all of them are blocked */
+  if (sq->pooled && sq->scheduled && !sq->busy)
+    gst_multi_queue_grow_pool (mq);
+
   for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
     GstSingleQueue *oq = (GstSingleQueue *) tmp->data;
     GstDataQueueSize ssize;
@@ -1580,6 +2028,17 @@ single_queue_check_full (GstDataQueue * dataq, guint visible, guint bytes,
   if (!mq->use_buffering && IS_FILLED (sq, visible, visible))
     return TRUE;
 
+  /* pooled queues share the byte limit, an empty queue always takes data so
+   * that it can't be starved by the others */
+  if (sq->pooled) {
+    if (bytes > 0 && IS_FILLED (mq, bytes,
+            (guint) g_atomic_int_get (&mq->total_bytes))) {
+      g_atomic_int_set (&mq->budget_full, TRUE);
+      return TRUE;
+    }
+    return IS_FILLED (sq, time, sq->cur_time);
+  }
+
   /* check time or bytes */
   res = IS_FILLED (sq, time, sq->cur_time) || IS_FILLED (sq, bytes, bytes);
 
@@ -1635,6 +2094,12 @@ gst_single_queue_new (GstMultiQueue * mqueue)
   sq->oldid = 0;
   sq->turn = g_cond_new ();
 
+  sq->pooled = FALSE;
+  sq->scheduled = FALSE;
+  sq->busy = FALSE;
+  sq->worker = NULL;
+  sq->pending = NULL;
+
   sq->sinktime = GST_CLOCK_TIME_NONE;
   sq->srctime = GST_CLOCK_TIME_NONE;
   sq->sink_tainted = TRUE;
@@ -1646,6 +2111,8 @@ gst_single_queue_new (GstMultiQueue * mqueue)
 
   gst_pad_set_chain_function (sq->sinkpad,
       GST_DEBUG_FUNCPTR (gst_multi_queue_chain));
+  gst_pad_set_chain_list_function (sq->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_multi_queue_chain_list));
   gst_pad_set_activatepush_function (sq->sinkpad,
       GST_DEBUG_FUNCPTR (gst_multi_queue_sink_activate_push));
   gst_pad_set_event_function (sq->sinkpad,
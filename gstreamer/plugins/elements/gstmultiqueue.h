@@ -73,6 +73,12 @@ struct _GstMultiQueue {
   gint nextnotlinked;	/* ID of the next queue not linked (-1 : none) */
 
   gint numwaiting;	/* number of not-linked pads waiting */
+
+  guint worker_threads;	/* size of the worker pool, 0 : a task per queue */
+  GThreadPool *pool;	/* worker pool servicing the pooled queues */
+  volatile gint total_bytes;	/* bytes queued in all pooled queues */
+  volatile gint budget_full;	/* a pooled queue waits for total_bytes */
+  guint32 sched_counter;	/* order of the queues scheduled on the pool */
 };
 
 struct _GstMultiQueueClass {
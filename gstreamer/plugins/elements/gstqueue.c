@@ -53,6 +53,12 @@
  * the specified minimum thresholds require (by default: when the queue is
  * empty). The #GstQueue::overrun signal is emitted when the queue is filled
  * up. Both signals are emitted from the context of the streaming thread.
+ *
+ * With #GstQueue:lock-free set, buffers are handed from the upstream thread
+ * to the streaming thread without taking the queue lock whenever nothing else
+ * has to happen, which lowers the cost per buffer when many small buffers go
+ * through the queue. The streaming thread then polls the queue for a short
+ * while before it goes to sleep when the queue runs empty.
  */
 
 #include "gst/gst_private.h"
@@ -88,10 +94,10 @@ GST_DEBUG_CATEGORY_STATIC (queue_dataflow);
                       queue->cur_level.bytes, \
                       queue->min_threshold.bytes, \
                       queue->max_size.bytes, \
-                      queue->cur_level.time, \
+                      gst_queue_level_time (queue), \
                       queue->min_threshold.time, \
                       queue->max_size.time, \
-                      queue->queue->length)
+                      gst_queue_n_items (queue))
 
 /* Queue signals and args */
 enum
@@ -117,7 +123,8 @@ enum
   ARG_MIN_THRESHOLD_BUFFERS,
   ARG_MIN_THRESHOLD_BYTES,
   ARG_MIN_THRESHOLD_TIME,
-  ARG_LEAKY
+  ARG_LEAKY,
+  ARG_LOCK_FREE
       /* FILL ME */
 };
 
@@ -125,6 +132,22 @@ enum
 #define DEFAULT_MAX_SIZE_BUFFERS  200   /* 200 buffers */
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
+#define DEFAULT_LOCK_FREE         FALSE
+
+/* lock-free mode: bounds for the number of slots in the ring and for the
+ * number of polls before the waiting side goes to sleep */
+#define RING_MIN_SIZE   64
+#define RING_MAX_SIZE   4096
+#define RING_MIN_SPINS  16
+#define RING_MAX_SPINS  4096
+
+#define RING_CACHE_LINE 64
+
+#if defined (__GNUC__) && (defined (__i386__) || defined (__x86_64__))
+#define GST_QUEUE_CPU_RELAX() __asm__ __volatile__ ("pause")
+#else
+#define GST_QUEUE_CPU_RELAX() G_STMT_START { } G_STMT_END
+#endif
 
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (q->qlock);                                              \
@@ -142,7 +165,11 @@ enum
 
 #define GST_QUEUE_WAIT_DEL_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->sinkpad, "wait for DEL");                               \
-  g_cond_wait (q->item_del, q->qlock);                                  \
+  if (q->ring)                                                          \
+    gst_queue_ring_wait (q, q->item_del, NULL, &q->spin_del,            \
+        gst_queue_is_filled);                                           \
+  else                                                                  \
+    g_cond_wait (q->item_del, q->qlock);                                \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received DEL wakeup");                       \
     goto label;                                                         \
@@ -152,7 +179,11 @@ enum
 
 #define GST_QUEUE_WAIT_ADD_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->srcpad, "wait for ADD");                                \
-  g_cond_wait (q->item_add, q->qlock);                                  \
+  if (q->ring)                                                          \
+    gst_queue_ring_wait (q, q->item_add, &q->waiting_add, &q->spin_add, \
+        gst_queue_is_empty);                                            \
+  else                                                                  \
+    g_cond_wait (q->item_add, q->qlock);                                \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received ADD wakeup");                       \
     goto label;                                                         \
@@ -170,6 +201,22 @@ enum
   g_cond_signal (q->item_add);                                          \
 } G_STMT_END
 
+/* in lock-free mode upstream changes the levels without the queue lock */
+#define GST_QUEUE_LEVEL_ADD(q, field, val) G_STMT_START {               \
+  if (q->ring)                                                          \
+    g_atomic_int_add ((volatile gint *) &q->cur_level.field, (val));    \
+  else                                                                  \
+    q->cur_level.field += (val);                                        \
+} G_STMT_END
+
+#define GST_QUEUE_LEVEL_SUB(q, field, val) G_STMT_START {               \
+  if (q->ring)                                                          \
+    g_atomic_int_add ((volatile gint *) &q->cur_level.field,            \
+        -(gint) (val));                                                 \
+  else                                                                  \
+    q->cur_level.field -= (val);                                        \
+} G_STMT_END
+
 #define _do_init(bla) \
     GST_DEBUG_CATEGORY_INIT (queue_debug, "queue", 0, "queue element"); \
     GST_DEBUG_CATEGORY_INIT (queue_dataflow, "queue_dataflow", 0, \
@@ -186,6 +233,7 @@ static void gst_queue_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec);
 
 static GstFlowReturn gst_queue_chain (GstPad * pad, GstBuffer * buffer);
+static GstFlowReturn gst_queue_chain_list (GstPad * pad, GstBufferList * list);
 static GstFlowReturn gst_queue_bufferalloc (GstPad * pad, guint64 offset,
     guint size, GstCaps * caps, GstBuffer ** buf);
 static GstFlowReturn gst_queue_push_one (GstQueue * queue);
@@ -208,6 +256,14 @@ static gboolean gst_queue_sink_activate_push (GstPad * pad, gboolean active);
 static gboolean gst_queue_is_empty (GstQueue * queue);
 static gboolean gst_queue_is_filled (GstQueue * queue);
 
+static guint gst_queue_n_items (GstQueue * queue);
+static gpointer gst_queue_pop_head (GstQueue * queue);
+static guint64 gst_queue_level_time (GstQueue * queue);
+static void gst_queue_ring_wait (GstQueue * queue, GCond * cond,
+    volatile gint * waiting, gint * spins,
+    gboolean (*must_wait) (GstQueue * queue));
+static void gst_queue_setup_ring (GstQueue * queue);
+
 #define GST_TYPE_QUEUE_LEAKY (queue_leaky_get_type ())
 
 static GType
@@ -351,6 +407,21 @@ gst_queue_class_init (GstQueueClass * klass)
           GST_TYPE_QUEUE_LEAKY, GST_QUEUE_NO_LEAK,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue:lock-free
+   *
+   * Hand buffers from upstream to the streaming thread without taking the
+   * queue lock when the queue is not filled. The streaming thread polls for
+   * new data for a short while before it goes to sleep. Changes take effect
+   * the next time the queue starts streaming.
+   *
+   * Since: 0.10.30
+   */
+  g_object_class_install_property (gobject_class, ARG_LOCK_FREE,
+      g_param_spec_boolean ("lock-free", "Lock-free",
+          "Hand buffers to the streaming thread without the queue lock",
+          DEFAULT_LOCK_FREE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
   /* Registering debug symbols for function pointers */
@@ -373,6 +444,7 @@ gst_queue_init (GstQueue * queue, GstQueueClass * g_class)
   queue->sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
 
   gst_pad_set_chain_function (queue->sinkpad, gst_queue_chain);
+  gst_pad_set_chain_list_function (queue->sinkpad, gst_queue_chain_list);
   gst_pad_set_activatepush_function (queue->sinkpad,
       gst_queue_sink_activate_push);
   gst_pad_set_event_function (queue->sinkpad, gst_queue_handle_sink_event);
@@ -404,6 +476,7 @@ gst_queue_init (GstQueue * queue, GstQueueClass * g_class)
   queue->head_needs_discont = queue->tail_needs_discont = FALSE;
 
   queue->leaky = GST_QUEUE_NO_LEAK;
+  queue->lock_free = DEFAULT_LOCK_FREE;
   queue->srcresult = GST_FLOW_WRONG_STATE;
 
   queue->qlock = g_mutex_new ();
@@ -429,12 +502,13 @@ gst_queue_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (queue, "finalizing queue");
 
-  while (!g_queue_is_empty (queue->queue)) {
-    GstMiniObject *data = g_queue_pop_head (queue->queue);
+  while (gst_queue_n_items (queue) > 0) {
+    GstMiniObject *data = gst_queue_pop_head (queue);
 
     gst_mini_object_unref (data);
   }
   g_queue_free (queue->queue);
+  g_free (queue->ring);
   g_mutex_free (queue->qlock);
   g_cond_free (queue->item_add);
   g_cond_free (queue->item_del);
@@ -525,13 +599,205 @@ gst_queue_bufferalloc (GstPad * pad, guint64 offset, guint size, GstCaps * caps,
   return result;
 }
 
+/* Lock-free mode.
+ *
+ * Only upstream adds items to the queue, the chain function and serialized
+ * events are serialized by the stream lock, and items are only removed with
+ * the queue lock. In lock-free mode the items go through a single-producer,
+ * single-consumer ring, so that upstream can add a buffer without taking the
+ * queue lock when nothing else has to happen: we're not flushing, EOS or
+ * UNEXPECTED and the queue is not filled. Everything else still takes the
+ * lock.
+ *
+ * Items that don't fit in the ring go to queue->queue. Upstream only adds to
+ * the ring again when that is empty, so the order of the items is kept.
+ *
+ * The buffer and byte levels are changed with atomic operations. Each side
+ * only updates its own running time, guarded by a sequence count, and the
+ * time level is calculated from both without the lock.
+ *
+ * The waiting side polls the queue without the lock for a while before it
+ * goes to sleep. The number of polls doubles when polling was enough and is
+ * halved when it wasn't. The streaming thread sets waiting_add before it goes
+ * to sleep so that upstream knows it has to take the lock and signal it.
+ */
+struct _GstQueueRing
+{
+  /* written with the queue lock */
+  volatile gint head;
+  guint8 _head_pad[RING_CACHE_LINE - sizeof (gint)];
+  /* written by upstream */
+  volatile gint tail;
+  guint8 _tail_pad[RING_CACHE_LINE - sizeof (gint)];
+
+  guint mask;
+  gpointer slots[1];
+};
+
+static GstQueueRing *
+gst_queue_ring_new (guint size)
+{
+  GstQueueRing *ring;
+  guint n_slots = RING_MIN_SIZE;
+
+  while (n_slots < size && n_slots < RING_MAX_SIZE)
+    n_slots <<= 1;
+
+  ring = g_malloc0 (G_STRUCT_OFFSET (GstQueueRing, slots) +
+      n_slots * sizeof (gpointer));
+  ring->mask = n_slots - 1;
+
+  return ring;
+}
+
+static inline guint
+gst_queue_ring_length (GstQueueRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->tail) -
+      (guint) g_atomic_int_get (&ring->head);
+}
+
+/* upstream only */
+static inline gboolean
+gst_queue_ring_is_full (GstQueueRing * ring)
+{
+  return gst_queue_ring_length (ring) > ring->mask;
+}
+
+/* upstream only, when the ring is not full */
+static inline void
+gst_queue_ring_push (GstQueueRing * ring, gpointer item)
+{
+  guint tail = ring->tail;
+
+  g_atomic_pointer_set (&ring->slots[tail & ring->mask], item);
+  /* publish the item, this is also a full memory barrier */
+  g_atomic_int_add (&ring->tail, 1);
+}
+
+/* with QUEUE_LOCK */
+static inline gpointer
+gst_queue_ring_pop (GstQueueRing * ring)
+{
+  guint head = ring->head;
+  gpointer item;
+
+  if (head == (guint) g_atomic_int_get (&ring->tail))
+    return NULL;
+
+  item = g_atomic_pointer_get (&ring->slots[head & ring->mask]);
+  /* give the slot back to upstream */
+  g_atomic_int_add (&ring->head, 1);
+
+  return item;
+}
+
+static void
+gst_queue_write_position (volatile gint * seq, GstClockTime * position,
+    GstClockTime time)
+{
+  g_atomic_int_inc (seq);
+  *position = time;
+  g_atomic_int_inc (seq);
+}
+
+static GstClockTime
+gst_queue_read_position (volatile gint * seq,
+    volatile GstClockTime * position)
+{
+  GstClockTime time;
+  gint start;
+
+  do {
+    while ((start = g_atomic_int_get (seq)) & 1)
+      GST_QUEUE_CPU_RELAX ();
+    time = *position;
+  } while (g_atomic_int_get (seq) != start);
+
+  return time;
+}
+
+/* the time level, see update_time_level() */
+static guint64
+gst_queue_level_time (GstQueue * queue)
+{
+  gint64 sink_time, src_time;
+
+  if (!queue->ring)
+    return queue->cur_level.time;
+
+  /* the level is 0 when the last buffer left the queue */
+  if (g_atomic_int_get ((volatile gint *) &queue->cur_level.buffers) == 0)
+    return 0;
+
+  sink_time = gst_queue_read_position (&queue->sink_seq, &queue->sinktime);
+  src_time = gst_queue_read_position (&queue->src_seq, &queue->srctime);
+
+  if (sink_time >= src_time)
+    return sink_time - src_time;
+  else
+    return 0;
+}
+
+static guint
+gst_queue_n_items (GstQueue * queue)
+{
+  if (queue->ring)
+    return gst_queue_ring_length (queue->ring) + queue->queue->length;
+
+  return queue->queue->length;
+}
+
+/* add an item at the tail, upstream only. Without QUEUE_LOCK this can only be
+ * done after gst_queue_ring_can_enqueue() */
+static inline void
+gst_queue_push_tail (GstQueue * queue, gpointer item)
+{
+  if (queue->ring && queue->queue->length == 0 &&
+      !gst_queue_ring_is_full (queue->ring))
+    gst_queue_ring_push (queue->ring, item);
+  else
+    g_queue_push_tail (queue->queue, item);
+}
+
+/* remove the item at the head, with QUEUE_LOCK. When queue->queue is not empty
+ * upstream does not add to the ring, so an empty ring means that the ring
+ * items were all older. */
+static gpointer
+gst_queue_pop_head (GstQueue * queue)
+{
+  gpointer item;
+
+  if (queue->ring && (item = gst_queue_ring_pop (queue->ring)))
+    return item;
+
+  return g_queue_pop_head (queue->queue);
+}
+
 /* calculate the diff between running time on the sink and src of the queue.
- * This is the total amount of time in the queue. */
+ * This is the total amount of time in the queue. In lock-free mode only the
+ * running time of our own side is updated and the time level is calculated
+ * from both when it is needed, see gst_queue_level_time(). */
 static void
-update_time_level (GstQueue * queue)
+update_time_level (GstQueue * queue, gboolean sink)
 {
   gint64 sink_time, src_time;
 
+  if (queue->ring) {
+    if (sink && queue->sink_tainted) {
+      gst_queue_write_position (&queue->sink_seq, &queue->sinktime,
+          gst_segment_to_running_time (&queue->sink_segment, GST_FORMAT_TIME,
+              queue->sink_segment.last_stop));
+      queue->sink_tainted = FALSE;
+    } else if (!sink && queue->src_tainted) {
+      gst_queue_write_position (&queue->src_seq, &queue->srctime,
+          gst_segment_to_running_time (&queue->src_segment, GST_FORMAT_TIME,
+              queue->src_segment.last_stop));
+      queue->src_tainted = FALSE;
+    }
+    return;
+  }
+
   if (queue->sink_tainted) {
     queue->sinktime =
         gst_segment_to_running_time (&queue->sink_segment, GST_FORMAT_TIME,
@@ -594,7 +860,7 @@ apply_segment (GstQueue * queue, GstEvent * event, GstSegment * segment,
       "configured NEWSEGMENT %" GST_SEGMENT_FORMAT, segment);
 
   /* segment can update the time level of the queue */
-  update_time_level (queue);
+  update_time_level (queue, sink);
 }
 
 /* take a buffer and update segment, updating the time level of the queue. */
@@ -627,14 +893,161 @@ apply_buffer (GstQueue * queue, GstBuffer * buffer, GstSegment * segment,
 
 
   /* calc diff with other end */
-  update_time_level (queue);
+  update_time_level (queue, sink);
+}
+
+static GstBufferListItem
+buffer_list_apply_time (GstBuffer ** buf, guint group, guint idx,
+    gpointer data)
+{
+  GstClockTime *timestamp = data;
+
+  if (GST_BUFFER_TIMESTAMP_IS_VALID (*buf))
+    *timestamp = GST_BUFFER_TIMESTAMP (*buf);
+
+  if (GST_BUFFER_DURATION_IS_VALID (*buf))
+    *timestamp += GST_BUFFER_DURATION (*buf);
+
+  return GST_BUFFER_LIST_CONTINUE;
+}
+
+/* take a buffer list and update segment, updating the time level of the queue */
+static void
+apply_buffer_list (GstQueue * queue, GstBufferList * buffer_list,
+    GstSegment * segment, gboolean sink)
+{
+  GstClockTime timestamp;
+
+  /* if no timestamp is set, assume it's continuous with the previous time */
+  timestamp = segment->last_stop;
+
+  gst_buffer_list_foreach (buffer_list, buffer_list_apply_time, &timestamp);
+
+  GST_LOG_OBJECT (queue, "last_stop updated to %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (timestamp));
+
+  gst_segment_set_last_stop (segment, GST_FORMAT_TIME, timestamp);
+
+  if (sink)
+    queue->sink_tainted = TRUE;
+  else
+    queue->src_tainted = TRUE;
+
+  update_time_level (queue, sink);
+}
+
+typedef struct
+{
+  guint buffers;
+  guint bytes;
+} BufferListSize;
+
+static GstBufferListItem
+buffer_list_calc_size (GstBuffer ** buf, guint group, guint idx, gpointer data)
+{
+  BufferListSize *size = data;
+
+  size->buffers++;
+  size->bytes += GST_BUFFER_SIZE (*buf);
+  return GST_BUFFER_LIST_CONTINUE;
+}
+
+static GstBufferListItem
+buffer_list_set_discont (GstBuffer ** buf, guint group, guint idx,
+    gpointer data)
+{
+  GstBuffer *subbuffer = gst_buffer_make_metadata_writable (*buf);
+
+  if (subbuffer) {
+    *buf = subbuffer;
+    GST_BUFFER_FLAG_SET (*buf, GST_BUFFER_FLAG_DISCONT);
+  } else {
+    GST_DEBUG ("Could not mark buffer as DISCONT");
+  }
+  /* only the first buffer */
+  return GST_BUFFER_LIST_END;
+}
+
+/* wait on @cond for as long as @must_wait returns TRUE and we are not
+ * flushing, with QUEUE_LOCK. The lock is released while polling. When
+ * @waiting is given, the other side does not take the lock to change the
+ * queue and only signals @cond when @waiting is set. This returns after one
+ * wakeup, like g_cond_wait(). */
+static void
+gst_queue_ring_wait (GstQueue * queue, GCond * cond, volatile gint * waiting,
+    gint * spins, gboolean (*must_wait) (GstQueue * queue))
+{
+  gint i;
+
+  GST_QUEUE_MUTEX_UNLOCK (queue);
+  for (i = 0; i < *spins; i++) {
+    if (!must_wait (queue) ||
+        g_atomic_int_get ((volatile gint *) &queue->srcresult) != GST_FLOW_OK)
+      break;
+    GST_QUEUE_CPU_RELAX ();
+  }
+  GST_QUEUE_MUTEX_LOCK (queue);
+
+  if (i < *spins) {
+    *spins = MIN (*spins * 2, RING_MAX_SPINS);
+    return;
+  }
+  *spins = MAX (*spins / 2, RING_MIN_SPINS);
+
+  if (waiting)
+    g_atomic_int_inc (waiting);
+  /* check again, the other side could have changed the queue before it saw
+   * us waiting */
+  if (must_wait (queue) && queue->srcresult == GST_FLOW_OK)
+    g_cond_wait (cond, queue->qlock);
+  if (waiting)
+    g_atomic_int_add (waiting, -1);
+}
+
+/* called by upstream without QUEUE_LOCK in lock-free mode, returns TRUE when
+ * all there is to do is to add the buffer to the queue */
+static inline gboolean
+gst_queue_ring_can_enqueue (GstQueue * queue)
+{
+  return g_atomic_int_get ((volatile gint *) &queue->srcresult) ==
+      GST_FLOW_OK && !queue->eos && !g_atomic_int_get (&queue->unexpected) &&
+      !queue->tail_needs_discont && queue->queue->length == 0 &&
+      !gst_queue_ring_is_full (queue->ring) && !gst_queue_is_filled (queue);
+}
+
+/* with QUEUE_LOCK, before the streaming thread is started */
+static void
+gst_queue_setup_ring (GstQueue * queue)
+{
+  /* keep what we have when upstream is running or there are items left */
+  if (GST_PAD_ACTIVATE_MODE (queue->sinkpad) != GST_ACTIVATE_NONE ||
+      gst_queue_n_items (queue) > 0)
+    return;
+
+  g_free (queue->ring);
+  queue->ring = NULL;
+
+  if (!queue->lock_free)
+    return;
+
+  queue->ring = gst_queue_ring_new (queue->max_size.buffers ?
+      queue->max_size.buffers : RING_MAX_SIZE);
+  queue->spin_add = queue->spin_del = RING_MIN_SPINS;
+
+  /* from now on each side only updates its own running time */
+  queue->sink_tainted = queue->src_tainted = TRUE;
+  update_time_level (queue, TRUE);
+  update_time_level (queue, FALSE);
+
+  GST_DEBUG_OBJECT (queue, "lock-free mode with %u slots",
+      queue->ring->mask + 1);
 }
 
 static void
 gst_queue_locked_flush (GstQueue * queue)
 {
-  while (!g_queue_is_empty (queue->queue)) {
-    GstMiniObject *data = g_queue_pop_head (queue->queue);
+  while (gst_queue_n_items (queue) > 0) {
+    GstMiniObject *data = gst_queue_pop_head (queue);
 
     /* Then lose another reference because we are supposed to destroy that
        data when flushing */
@@ -650,20 +1063,24 @@ gst_queue_locked_flush (GstQueue * queue)
 
   queue->sinktime = queue->srctime = GST_CLOCK_TIME_NONE;
   queue->sink_tainted = queue->src_tainted = TRUE;
+  if (queue->ring) {
+    /* both sides are stopped, so we can update both running times */
+    update_time_level (queue, TRUE);
+    update_time_level (queue, FALSE);
+  }
 
   /* we deleted a lot of something */
   GST_QUEUE_SIGNAL_DEL (queue);
 }
 
-/* enqueue an item an update the level stats, with QUEUE_LOCK */
+/* add a buffer to the level stats, with QUEUE_LOCK or from upstream in
+ * lock-free mode */
 static inline void
-gst_queue_locked_enqueue_buffer (GstQueue * queue, gpointer item)
+gst_queue_add_buffer (GstQueue * queue, GstBuffer * buffer)
 {
-  GstBuffer *buffer = GST_BUFFER_CAST (item);
-
   /* add buffer to the statistics */
-  queue->cur_level.buffers++;
-  queue->cur_level.bytes += GST_BUFFER_SIZE (buffer);
+  GST_QUEUE_LEVEL_ADD (queue, buffers, 1);
+  GST_QUEUE_LEVEL_ADD (queue, bytes, GST_BUFFER_SIZE (buffer));
   apply_buffer (queue, buffer, &queue->sink_segment, TRUE, TRUE);
 
   /* if this is the first buffer update the end side as well, but without the
@@ -674,8 +1091,41 @@ gst_queue_locked_enqueue_buffer (GstQueue * queue, gpointer item)
    * See #482147 */
   /*     if (queue->cur_level.buffers == 1) */
   /*       apply_buffer (queue, buffer, &queue->src_segment, FALSE); */
+}
 
-  g_queue_push_tail (queue->queue, item);
+/* add the buffers of a buffer list to the level stats, with QUEUE_LOCK or
+ * from upstream in lock-free mode */
+static inline void
+gst_queue_add_buffer_list (GstQueue * queue, GstBufferList * buffer_list)
+{
+  BufferListSize size = { 0, 0 };
+
+  gst_buffer_list_foreach (buffer_list, buffer_list_calc_size, &size);
+
+  /* add buffers to the statistics */
+  GST_QUEUE_LEVEL_ADD (queue, buffers, size.buffers);
+  GST_QUEUE_LEVEL_ADD (queue, bytes, size.bytes);
+  apply_buffer_list (queue, buffer_list, &queue->sink_segment, TRUE);
+}
+
+/* enqueue an item an update the level stats, with QUEUE_LOCK */
+static inline void
+gst_queue_locked_enqueue_buffer (GstQueue * queue, gpointer item)
+{
+  gst_queue_add_buffer (queue, GST_BUFFER_CAST (item));
+
+  gst_queue_push_tail (queue, item);
+  GST_QUEUE_SIGNAL_ADD (queue);
+}
+
+/* enqueue a buffer list and update the level stats with the buffers in it,
+ * with QUEUE_LOCK */
+static inline void
+gst_queue_locked_enqueue_buffer_list (GstQueue * queue, gpointer item)
+{
+  gst_queue_add_buffer_list (queue, GST_BUFFER_LIST_CAST (item));
+
+  gst_queue_push_tail (queue, item);
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
@@ -703,7 +1153,7 @@ gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
       break;
   }
 
-  g_queue_push_tail (queue->queue, item);
+  gst_queue_push_tail (queue, item);
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
@@ -713,7 +1163,7 @@ gst_queue_locked_dequeue (GstQueue * queue, gboolean * is_buffer)
 {
   GstMiniObject *item;
 
-  item = g_queue_pop_head (queue->queue);
+  item = gst_queue_pop_head (queue);
   if (item == NULL)
     goto no_item;
 
@@ -723,10 +1173,28 @@ gst_queue_locked_dequeue (GstQueue * queue, gboolean * is_buffer)
     GST_CAT_LOG_OBJECT (queue_dataflow, queue,
         "retrieved buffer %p from queue", buffer);
 
-    queue->cur_level.buffers--;
-    queue->cur_level.bytes -= GST_BUFFER_SIZE (buffer);
+    GST_QUEUE_LEVEL_SUB (queue, buffers, 1);
+    GST_QUEUE_LEVEL_SUB (queue, bytes, GST_BUFFER_SIZE (buffer));
     apply_buffer (queue, buffer, &queue->src_segment, TRUE, FALSE);
 
+    /* if the queue is empty now, update the other side */
+    if (queue->cur_level.buffers == 0)
+      queue->cur_level.time = 0;
+
+    *is_buffer = TRUE;
+  } else if (GST_IS_BUFFER_LIST (item)) {
+    GstBufferList *buffer_list = GST_BUFFER_LIST_CAST (item);
+    BufferListSize size = { 0, 0 };
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved buffer list %p from queue", buffer_list);
+
+    gst_buffer_list_foreach (buffer_list, buffer_list_calc_size, &size);
+
+    GST_QUEUE_LEVEL_SUB (queue, buffers, size.buffers);
+    GST_QUEUE_LEVEL_SUB (queue, bytes, size.bytes);
+    apply_buffer_list (queue, buffer_list, &queue->src_segment, FALSE);
+
     /* if the queue is empty now, update the other side */
     if (queue->cur_level.buffers == 0)
       queue->cur_level.time = 0;
@@ -858,7 +1326,7 @@ out_eos:
 static gboolean
 gst_queue_is_empty (GstQueue * queue)
 {
-  if (queue->queue->length == 0)
+  if (gst_queue_n_items (queue) == 0)
     return TRUE;
 
   /* It is possible that a max size is reached before all min thresholds are.
@@ -868,7 +1336,7 @@ gst_queue_is_empty (GstQueue * queue)
       (queue->min_threshold.bytes > 0 &&
           queue->cur_level.bytes < queue->min_threshold.bytes) ||
       (queue->min_threshold.time > 0 &&
-          queue->cur_level.time < queue->min_threshold.time)) &&
+          gst_queue_level_time (queue) < queue->min_threshold.time)) &&
       !gst_queue_is_filled (queue);
 }
 
@@ -880,7 +1348,7 @@ gst_queue_is_filled (GstQueue * queue)
           (queue->max_size.bytes > 0 &&
               queue->cur_level.bytes >= queue->max_size.bytes) ||
           (queue->max_size.time > 0 &&
-              queue->cur_level.time >= queue->max_size.time)));
+              gst_queue_level_time (queue) >= queue->max_size.time)));
 }
 
 static void
@@ -906,13 +1374,45 @@ gst_queue_leak_downstream (GstQueue * queue)
 }
 
 static GstFlowReturn
-gst_queue_chain (GstPad * pad, GstBuffer * buffer)
+gst_queue_chain_buffer_or_list (GstPad * pad, GstMiniObject * obj,
+    gboolean is_list)
 {
   GstQueue *queue;
-  GstClockTime duration, timestamp;
 
   queue = (GstQueue *) GST_OBJECT_PARENT (pad);
 
+  if (!is_list) {
+    GstBuffer *buffer = GST_BUFFER_CAST (obj);
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "received buffer %p of size %d, time %" GST_TIME_FORMAT ", duration %"
+        GST_TIME_FORMAT, buffer, GST_BUFFER_SIZE (buffer),
+        GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)),
+        GST_TIME_ARGS (GST_BUFFER_DURATION (buffer)));
+  } else {
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "received buffer list %p with %u groups", obj,
+        gst_buffer_list_n_groups (GST_BUFFER_LIST_CAST (obj)));
+  }
+
+  /* in lock-free mode we don't need the lock when all we have to do is to
+   * add the buffer */
+  if (queue->ring && gst_queue_ring_can_enqueue (queue)) {
+    if (is_list)
+      gst_queue_add_buffer_list (queue, GST_BUFFER_LIST_CAST (obj));
+    else
+      gst_queue_add_buffer (queue, GST_BUFFER_CAST (obj));
+    gst_queue_ring_push (queue->ring, obj);
+
+    /* wake up the streaming thread when it went to sleep */
+    if (g_atomic_int_get (&queue->waiting_add)) {
+      GST_QUEUE_MUTEX_LOCK (queue);
+      GST_QUEUE_SIGNAL_ADD (queue);
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+    }
+    return GST_FLOW_OK;
+  }
+
   /* we have to lock the queue since we span threads */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
   /* when we received EOS, we refuse any more data */
@@ -921,14 +1421,6 @@ gst_queue_chain (GstPad * pad, GstBuffer * buffer)
   if (queue->unexpected)
     goto out_unexpected;
 
-  timestamp = GST_BUFFER_TIMESTAMP (buffer);
-  duration = GST_BUFFER_DURATION (buffer);
-
-  GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-      "received buffer %p of size %d, time %" GST_TIME_FORMAT ", duration %"
-      GST_TIME_FORMAT, buffer, GST_BUFFER_SIZE (buffer),
-      GST_TIME_ARGS (timestamp), GST_TIME_ARGS (duration));
-
   /* We make space available if we're "full" according to whatever
    * the user defined as "full". Note that this only applies to buffers.
    * We always handle events and they don't count in our statistics. */
@@ -979,19 +1471,31 @@ gst_queue_chain (GstPad * pad, GstBuffer * buffer)
   }
 
   if (queue->tail_needs_discont) {
-    GstBuffer *subbuffer = gst_buffer_make_metadata_writable (buffer);
+    if (!is_list) {
+      GstBuffer *buffer = GST_BUFFER_CAST (obj);
+      GstBuffer *subbuffer = gst_buffer_make_metadata_writable (buffer);
 
-    if (subbuffer) {
-      buffer = subbuffer;
-      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+      if (subbuffer) {
+        obj = GST_MINI_OBJECT_CAST (subbuffer);
+        GST_BUFFER_FLAG_SET (subbuffer, GST_BUFFER_FLAG_DISCONT);
+      } else {
+        GST_DEBUG_OBJECT (queue, "Could not mark buffer as DISCONT");
+      }
     } else {
-      GST_DEBUG_OBJECT (queue, "Could not mark buffer as DISCONT");
+      GstBufferList *buffer_list;
+
+      buffer_list = gst_buffer_list_make_writable (GST_BUFFER_LIST_CAST (obj));
+      gst_buffer_list_foreach (buffer_list, buffer_list_set_discont, NULL);
+      obj = GST_MINI_OBJECT_CAST (buffer_list);
     }
     queue->tail_needs_discont = FALSE;
   }
 
   /* put buffer in queue now */
-  gst_queue_locked_enqueue_buffer (queue, buffer);
+  if (is_list)
+    gst_queue_locked_enqueue_buffer_list (queue, obj);
+  else
+    gst_queue_locked_enqueue_buffer (queue, obj);
   GST_QUEUE_MUTEX_UNLOCK (queue);
 
   return GST_FLOW_OK;
@@ -1001,7 +1505,7 @@ out_unref:
   {
     GST_QUEUE_MUTEX_UNLOCK (queue);
 
-    gst_buffer_unref (buffer);
+    gst_mini_object_unref (obj);
 
     return GST_FLOW_OK;
   }
@@ -1012,7 +1516,7 @@ out_flushing:
     GST_CAT_LOG_OBJECT (queue_dataflow, queue,
         "exit because task paused, reason: %s", gst_flow_get_name (ret));
     GST_QUEUE_MUTEX_UNLOCK (queue);
-    gst_buffer_unref (buffer);
+    gst_mini_object_unref (obj);
 
     return ret;
   }
@@ -1021,7 +1525,7 @@ out_eos:
     GST_CAT_LOG_OBJECT (queue_dataflow, queue, "exit because we received EOS");
     GST_QUEUE_MUTEX_UNLOCK (queue);
 
-    gst_buffer_unref (buffer);
+    gst_mini_object_unref (obj);
 
     return GST_FLOW_UNEXPECTED;
   }
@@ -1031,12 +1535,27 @@ out_unexpected:
         "exit because we received UNEXPECTED");
     GST_QUEUE_MUTEX_UNLOCK (queue);
 
-    gst_buffer_unref (buffer);
+    gst_mini_object_unref (obj);
 
     return GST_FLOW_UNEXPECTED;
   }
 }
 
+static GstFlowReturn
+gst_queue_chain (GstPad * pad, GstBuffer * buffer)
+{
+  return gst_queue_chain_buffer_or_list (pad, GST_MINI_OBJECT_CAST (buffer),
+      FALSE);
+}
+
+/* whole lists are queued and pushed downstream as they are, in one go */
+static GstFlowReturn
+gst_queue_chain_list (GstPad * pad, GstBufferList * buffer_list)
+{
+  return gst_queue_chain_buffer_or_list (pad,
+      GST_MINI_OBJECT_CAST (buffer_list), TRUE);
+}
+
 /* dequeue an item from the queue an push it downstream. This functions returns
  * the result of the push. */
 static GstFlowReturn
@@ -1051,7 +1570,29 @@ gst_queue_push_one (GstQueue * queue)
     goto no_item;
 
 next:
-  if (is_buffer) {
+  if (is_buffer && GST_IS_BUFFER_LIST (data)) {
+    GstBufferList *buffer_list;
+    GstBuffer *first;
+    GstCaps *caps = NULL;
+
+    buffer_list = GST_BUFFER_LIST_CAST (data);
+
+    if (queue->head_needs_discont) {
+      buffer_list = gst_buffer_list_make_writable (buffer_list);
+      gst_buffer_list_foreach (buffer_list, buffer_list_set_discont, NULL);
+      queue->head_needs_discont = FALSE;
+    }
+
+    if ((first = gst_buffer_list_get (buffer_list, 0, 0)))
+      caps = GST_BUFFER_CAPS (first);
+
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    /* set the caps of the first buffer before pushing, see below */
+    if (caps && caps != GST_PAD_CAPS (queue->srcpad))
+      gst_pad_set_caps (queue->srcpad, caps);
+
+    result = gst_pad_push_list (queue->srcpad, buffer_list);
+  } else if (is_buffer) {
     GstBuffer *buffer;
     GstCaps *caps;
 
@@ -1081,7 +1622,9 @@ next:
       gst_pad_set_caps (queue->srcpad, caps);
 
     result = gst_pad_push (queue->srcpad, buffer);
+  }
 
+  if (is_buffer) {
     /* need to check for srcresult here as well */
     GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
@@ -1096,7 +1639,7 @@ next:
         if (is_buffer) {
           GST_CAT_LOG_OBJECT (queue_dataflow, queue,
               "dropping UNEXPECTED buffer %p", data);
-          gst_buffer_unref (GST_BUFFER_CAST (data));
+          gst_mini_object_unref (data);
         } else {
           GstEvent *event = GST_EVENT_CAST (data);
           GstEventType type = GST_EVENT_TYPE (event);
@@ -1262,7 +1805,7 @@ gst_queue_handle_src_query (GstPad * pad, GstQuery * query)
           peer_pos -= queue->cur_level.bytes;
           break;
         case GST_FORMAT_TIME:
-          peer_pos -= queue->cur_level.time;
+          peer_pos -= gst_queue_level_time (queue);
           break;
         default:
           GST_DEBUG_OBJECT (queue, "Can't adjust query in %s format, don't "
@@ -1341,6 +1884,8 @@ gst_queue_src_activate_push (GstPad * pad, gboolean active)
 
   if (active) {
     GST_QUEUE_MUTEX_LOCK (queue);
+    /* the sinkpad is activated after us, so nothing is streaming yet */
+    gst_queue_setup_ring (queue);
     queue->srcresult = GST_FLOW_OK;
     queue->eos = FALSE;
     queue->unexpected = FALSE;
@@ -1430,6 +1975,9 @@ gst_queue_set_property (GObject * object,
     case ARG_LEAKY:
       queue->leaky = g_value_get_enum (value);
       break;
+    case ARG_LOCK_FREE:
+      queue->lock_free = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1454,7 +2002,7 @@ gst_queue_get_property (GObject * object,
       g_value_set_uint (value, queue->cur_level.buffers);
       break;
     case ARG_CUR_LEVEL_TIME:
-      g_value_set_uint64 (value, queue->cur_level.time);
+      g_value_set_uint64 (value, gst_queue_level_time (queue));
       break;
     case ARG_MAX_SIZE_BYTES:
       g_value_set_uint (value, queue->max_size.bytes);
@@ -1477,6 +2025,9 @@ gst_queue_get_property (GObject * object,
     case ARG_LEAKY:
       g_value_set_enum (value, queue->leaky);
       break;
+    case ARG_LOCK_FREE:
+      g_value_set_boolean (value, queue->lock_free);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
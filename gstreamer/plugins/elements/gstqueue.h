@@ -48,6 +48,7 @@ enum {
 typedef struct _GstQueue GstQueue;
 typedef struct _GstQueueSize GstQueueSize;
 typedef struct _GstQueueClass GstQueueClass;
+typedef struct _GstQueueRing GstQueueRing;
 
 /**
  * GstQueueSize:
@@ -112,6 +113,13 @@ struct _GstQueue {
   GCond *item_del;      /* signals space now available for writing */
 
   gboolean head_needs_discont, tail_needs_discont;
+
+  /* lock-free mode, see gstqueue.c */
+  gboolean lock_free;
+  GstQueueRing *ring;           /* items added without the queue lock */
+  volatile gint waiting_add;    /* the streaming thread sleeps on item_add */
+  gint spin_add, spin_del;      /* polls before sleeping on item_add/item_del */
+  volatile gint sink_seq, src_seq;      /* guard sinktime and srctime */
 };
 
 struct _GstQueueClass {
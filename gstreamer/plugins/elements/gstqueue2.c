@@ -50,6 +50,14 @@
  * property will still be used to notify the application of the allocated
  * filename, though.
  *
+ * Since 0.10.30, setting #GstQueue2:ring-buffer-max-size to a non-zero value
+ * makes the element keep at most that many bytes of the stream, in memory or,
+ * when a temp-template is set, in a temp file that never grows beyond that
+ * size. The element remembers which ranges of the stream it still has, serves
+ * pull mode reads from any of them and only seeks upstream to download data
+ * that is not cached. #GstQueue2:max-size-bytes then limits how far the
+ * download can run ahead of the reading position.
+ *
  * Last reviewed on 2009-07-10 (0.10.24)
  */
 
@@ -59,6 +67,7 @@
 
 #include "gstqueue2.h"
 
+#include <string.h>
 #include <glib/gstdio.h>
 
 #include "gst/gst-i18n-lib.h"
@@ -101,10 +110,26 @@ enum
 #define DEFAULT_LOW_PERCENT        10
 #define DEFAULT_HIGH_PERCENT       99
 #define DEFAULT_TEMP_REMOVE        TRUE
+#define DEFAULT_RING_BUFFER_MAX_SIZE 0
 
 /* other defines */
 #define DEFAULT_BUFFER_SIZE 4096
 #define QUEUE_IS_USING_TEMP_FILE(queue) ((queue)->temp_location_set || (queue)->temp_template != NULL)
+#define QUEUE_IS_USING_RING_BUFFER(queue) ((queue)->ring_buffer_max_size != 0)
+#define QUEUE_IS_USING_QUEUE(queue) (!QUEUE_IS_USING_TEMP_FILE(queue) && !QUEUE_IS_USING_RING_BUFFER (queue))
+/* the amount of bytes the download can run ahead of the reader in ring buffer
+ * mode */
+#define QUEUE_MAX_BYTES(queue) ((queue)->max_level.bytes > 0 ? \
+    MIN ((queue)->max_level.bytes, (queue)->ring_buffer_max_size) : \
+    (queue)->ring_buffer_max_size)
+
+#ifdef HAVE_FSEEKO
+#define FSEEK_FILE(file,offset) (fseeko (file, (off_t) offset, SEEK_SET) != 0)
+#elif defined (G_OS_UNIX) || defined (G_OS_WIN32)
+#define FSEEK_FILE(file,offset) (lseek (fileno (file), (off_t) offset, SEEK_SET) == (off_t) -1)
+#else
+#define FSEEK_FILE(file,offset) (fseek (file, offset, SEEK_SET) != 0)
+#endif
 
 enum
 {
@@ -122,6 +147,7 @@ enum
   PROP_TEMP_TEMPLATE,
   PROP_TEMP_LOCATION,
   PROP_TEMP_REMOVE,
+  PROP_RING_BUFFER_MAX_SIZE,
   PROP_LAST
 };
 
@@ -144,7 +170,7 @@ enum
                       queue->max_level.bytes, \
                       queue->cur_level.time, \
                       queue->max_level.time, \
-                      (guint64) (QUEUE_IS_USING_TEMP_FILE(queue) ? \
+                      (guint64) (!QUEUE_IS_USING_QUEUE(queue) ? \
                         queue->current->writing_pos - queue->current->max_reading_pos : \
                         queue->queue->length))
 
@@ -209,6 +235,7 @@ GST_BOILERPLATE_FULL (GstQueue2, gst_queue2, GstElement, GST_TYPE_ELEMENT,
     _do_init);
 
 static void gst_queue2_finalize (GObject * object);
+static void clean_ranges (GstQueue2 * queue);
 
 static void gst_queue2_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
@@ -345,6 +372,21 @@ gst_queue2_class_init (GstQueue2Class * klass)
           "Remove the temp-location after use",
           DEFAULT_TEMP_REMOVE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue2:ring-buffer-max-size
+   *
+   * The maximum size of the ring buffer in bytes. If set to 0, the ring
+   * buffer is disabled. Can only be changed in the READY or NULL state.
+   *
+   * Since: 0.10.30
+   */
+  g_object_class_install_property (gobject_class, PROP_RING_BUFFER_MAX_SIZE,
+      g_param_spec_uint64 ("ring-buffer-max-size",
+          "Max. ring buffer size (bytes)",
+          "Max. amount of data in the ring buffer (bytes, 0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_RING_BUFFER_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_queue2_finalize;
 
@@ -424,6 +466,9 @@ gst_queue2_init (GstQueue2 * queue, GstQueue2Class * g_class)
   queue->temp_location_set = FALSE;
   queue->temp_remove = DEFAULT_TEMP_REMOVE;
 
+  queue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  queue->ring_buffer = NULL;
+
   GST_DEBUG_OBJECT (queue,
       "initialized queue's not_empty & not_full conditions");
 }
@@ -452,6 +497,8 @@ gst_queue2_finalize (GObject * object)
   /* temp_file path cleanup  */
   g_free (queue->temp_template);
   g_free (queue->temp_location);
+  g_free (queue->ring_buffer);
+  clean_ranges (queue);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -462,8 +509,9 @@ debug_ranges (GstQueue2 * queue)
   GstQueue2Range *walk;
 
   for (walk = queue->ranges; walk; walk = walk->next) {
-    GST_DEBUG_OBJECT (queue, "range %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
-        walk->offset, walk->writing_pos);
+    GST_DEBUG_OBJECT (queue, "range %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT
+        ", ring buffer at %" G_GUINT64_FORMAT, walk->offset, walk->writing_pos,
+        walk->rb_offset);
   }
 }
 
@@ -478,24 +526,61 @@ clean_ranges (GstQueue2 * queue)
   queue->current = NULL;
 }
 
-/* find a range that contains @offset or NULL when nothing does */
+/* find a range that contains @offset or NULL when nothing does. When one range
+ * ends at @offset and the next one starts there, the one that has data at
+ * @offset is returned. */
 static GstQueue2Range *
 find_range (GstQueue2 * queue, guint64 offset, guint64 length)
 {
   GstQueue2Range *range = NULL;
   GstQueue2Range *walk;
 
-  /* first do a quick check for the current range */
   for (walk = queue->ranges; walk; walk = walk->next) {
-    if (offset >= walk->offset && offset <= walk->writing_pos) {
+    if (offset < walk->offset)
+      break;
+    if (offset <= walk->writing_pos) {
       /* we can reuse an existing range */
       range = walk;
-      break;
+      if (offset < walk->writing_pos)
+        break;
     }
   }
   return range;
 }
 
+/* check if we can continue writing to @range at @offset. In ring buffer mode
+ * the data of a range must be contiguous in the ring buffer, so we can only
+ * append to the range that was written last. */
+static gboolean
+can_reuse_range (GstQueue2 * queue, GstQueue2Range * range, guint64 offset)
+{
+  if (!QUEUE_IS_USING_RING_BUFFER (queue))
+    return TRUE;
+
+  return offset == range->writing_pos &&
+      range->rb_offset + (range->writing_pos - range->offset) ==
+      queue->rb_writing_pos;
+}
+
+/* remove the ranges without data, except @keep */
+static void
+remove_empty_ranges (GstQueue2 * queue, GstQueue2Range * keep)
+{
+  GstQueue2Range **walk, *range;
+
+  walk = &queue->ranges;
+  while ((range = *walk)) {
+    if (range != keep && range->offset == range->writing_pos) {
+      GST_DEBUG_OBJECT (queue, "removing empty range %" G_GUINT64_FORMAT,
+          range->offset);
+      *walk = range->next;
+      g_slice_free (GstQueue2Range, range);
+    } else {
+      walk = &range->next;
+    }
+  }
+}
+
 /* make a new range for @offset or reuse an existing range */
 static GstQueue2Range *
 add_range (GstQueue2 * queue, guint64 offset)
@@ -504,7 +589,8 @@ add_range (GstQueue2 * queue, guint64 offset)
 
   GST_DEBUG_OBJECT (queue, "find range for %" G_GUINT64_FORMAT, offset);
 
-  if ((range = find_range (queue, offset, 0))) {
+  if ((range = find_range (queue, offset, 0))
+      && can_reuse_range (queue, range, offset)) {
     GST_DEBUG_OBJECT (queue,
         "reusing range %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT, range->offset,
         range->writing_pos);
@@ -513,11 +599,17 @@ add_range (GstQueue2 * queue, guint64 offset)
     GST_DEBUG_OBJECT (queue,
         "new range %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT, offset, offset);
 
+    /* the new range takes over everything from @offset, cut the range that
+     * contains it. Its data stays where it is in the ring buffer. */
+    if (range)
+      range->writing_pos = offset;
+
     range = g_slice_new0 (GstQueue2Range);
     range->offset = offset;
     range->writing_pos = offset;
     range->reading_pos = offset;
     range->max_reading_pos = offset;
+    range->rb_offset = queue->rb_writing_pos;
 
     /* insert sorted */
     prev = NULL;
@@ -540,11 +632,46 @@ add_range (GstQueue2 * queue, guint64 offset)
     else
       queue->ranges = range;
   }
+  remove_empty_ranges (queue, range);
   debug_ranges (queue);
 
   return range;
 }
 
+/* in ring buffer mode, forget the data that was overwritten after writing
+ * to the ring buffer */
+static void
+trim_ranges (GstQueue2 * queue)
+{
+  GstQueue2Range **walk, *range;
+  guint64 oldest, lost;
+
+  if (queue->rb_writing_pos <= queue->ring_buffer_max_size)
+    return;
+
+  /* everything written before this has been overwritten */
+  oldest = queue->rb_writing_pos - queue->ring_buffer_max_size;
+
+  walk = &queue->ranges;
+  while ((range = *walk)) {
+    if (range->rb_offset < oldest) {
+      lost = MIN (oldest - range->rb_offset,
+          range->writing_pos - range->offset);
+
+      GST_DEBUG_OBJECT (queue, "range %" G_GUINT64_FORMAT " lost %"
+          G_GUINT64_FORMAT " bytes", range->offset, lost);
+      range->offset += lost;
+      range->rb_offset += lost;
+
+      if (range->offset == range->writing_pos && range != queue->current) {
+        *walk = range->next;
+        g_slice_free (GstQueue2Range, range);
+        continue;
+      }
+    }
+    walk = &range->next;
+  }
+}
 
 /* clear and init the download ranges for offset 0 */
 static void
@@ -554,6 +681,8 @@ init_ranges (GstQueue2 * queue)
 
   /* get rid of all the current ranges */
   clean_ranges (queue);
+  queue->rb_writing_pos = 0;
+  queue->rb_reading_pos = 0;
   /* make a range for offset 0 */
   queue->current = add_range (queue, 0);
 }
@@ -698,14 +827,11 @@ apply_buffer (GstQueue2 * queue, GstBuffer * buffer, GstSegment * segment)
   update_time_level (queue);
 }
 
-static void
-update_buffering (GstQueue2 * queue)
+/* get the percentage the queue is filled, not scaled to the high watermark */
+static gint64
+get_buffering_percent (GstQueue2 * queue)
 {
   gint64 percent;
-  gboolean post = FALSE;
-
-  if (!queue->use_buffering || queue->high_percent <= 0)
-    return;
 
 #define GET_PERCENT(format) ((queue->max_level.format) > 0 ? \
 		(queue->cur_level.format) * 100 / (queue->max_level.format) : 0)
@@ -716,7 +842,10 @@ update_buffering (GstQueue2 * queue)
     percent = 100;
   } else {
     /* figure out the percent we are filled, we take the max of all formats. */
-    percent = GET_PERCENT (bytes);
+    if (QUEUE_IS_USING_RING_BUFFER (queue))
+      percent = queue->cur_level.bytes * 100 / QUEUE_MAX_BYTES (queue);
+    else
+      percent = GET_PERCENT (bytes);
     percent = MAX (percent, GET_PERCENT (time));
     percent = MAX (percent, GET_PERCENT (buffers));
 
@@ -724,6 +853,21 @@ update_buffering (GstQueue2 * queue)
     if (queue->use_rate_estimate)
       percent = MAX (percent, GET_PERCENT (rate_time));
   }
+#undef GET_PERCENT
+
+  return percent;
+}
+
+static void
+update_buffering (GstQueue2 * queue)
+{
+  gint64 percent;
+  gboolean post = FALSE;
+
+  if (!queue->use_buffering || queue->high_percent <= 0)
+    return;
+
+  percent = get_buffering_percent (queue);
 
   if (queue->is_buffering) {
     post = TRUE;
@@ -752,7 +896,7 @@ update_buffering (GstQueue2 * queue)
 
     queue->buffering_percent = percent;
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+    if (!QUEUE_IS_USING_QUEUE (queue)) {
       GstFormat fmt = GST_FORMAT_BYTES;
       gint64 duration;
 
@@ -780,8 +924,6 @@ update_buffering (GstQueue2 * queue)
   } else {
     GST_DEBUG_OBJECT (queue, "filled %d percent", (gint) percent);
   }
-
-#undef GET_PERCENT
 }
 
 static void
@@ -892,6 +1034,12 @@ update_cur_level (GstQueue2 * queue, GstQueue2Range * range)
 {
   guint64 max_reading_pos, writing_pos;
 
+  if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+    /* everything in the ring buffer that the reader still needs */
+    queue->cur_level.bytes = queue->rb_writing_pos - queue->rb_reading_pos;
+    return;
+  }
+
   writing_pos = range->writing_pos;
   max_reading_pos = range->max_reading_pos;
 
@@ -901,66 +1049,138 @@ update_cur_level (GstQueue2 * queue, GstQueue2Range * range)
     queue->cur_level.bytes = 0;
 }
 
+/* read or write @size bytes of @data at @pos in the temp file or in the ring
+ * buffer memory */
 static gboolean
-gst_queue2_write_buffer_to_file (GstQueue2 * queue, GstBuffer * buffer)
+gst_queue2_access_data (GstQueue2 * queue, guint64 pos, guint8 * data,
+    guint size, gboolean write)
 {
-  guint size;
-  guint8 *data;
-  guint64 writing_pos, max_reading_pos;
-  GstQueue2Range *next;
+  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+    if (FSEEK_FILE (queue->temp_file, pos))
+      return FALSE;
+    if (write)
+      return fwrite (data, size, 1, queue->temp_file) == 1;
+    else
+      return fread (data, size, 1, queue->temp_file) == 1;
+  }
 
-  writing_pos = queue->current->writing_pos;
-  max_reading_pos = queue->current->max_reading_pos;
+  if (write)
+    memcpy (queue->ring_buffer + pos, data, size);
+  else
+    memcpy (data, queue->ring_buffer + pos, size);
 
-#ifdef HAVE_FSEEKO
-  fseeko (queue->temp_file, (off_t) writing_pos, SEEK_SET);
-#elif defined (G_OS_UNIX) || defined (G_OS_WIN32)
-  lseek (fileno (queue->temp_file), (off_t) writing_pos, SEEK_SET);
-#else
-  fseek (queue->temp_file, writing_pos, SEEK_SET);
-#endif
+  return TRUE;
+}
+
+/* read or write @size bytes of @data at stream offset @offset of @range. The
+ * temp file keeps the data at the stream offset, the ring buffer where it was
+ * written, wrapping around at its end. */
+static gboolean
+gst_queue2_transfer_data (GstQueue2 * queue, GstQueue2Range * range,
+    guint64 offset, guint8 * data, guint size, gboolean write)
+{
+  guint64 pos, rb_size;
+  guint chunk;
+
+  if (!QUEUE_IS_USING_RING_BUFFER (queue))
+    return gst_queue2_access_data (queue, offset, data, size, write);
+
+  rb_size = queue->ring_buffer_max_size;
+  pos = (range->rb_offset + (offset - range->offset)) % rb_size;
+  chunk = MIN (size, rb_size - pos);
+
+  if (!gst_queue2_access_data (queue, pos, data, chunk, write))
+    return FALSE;
+  if (chunk < size)
+    return gst_queue2_access_data (queue, 0, data + chunk, size - chunk, write);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
+{
+  guint8 *data;
+  guint size, to_write;
+  GstQueue2Range *range, *next;
 
   data = GST_BUFFER_DATA (buffer);
   size = GST_BUFFER_SIZE (buffer);
 
-  if (fwrite (data, size, 1, queue->temp_file) != 1)
-    goto handle_error;
+  while (size > 0) {
+    to_write = size;
 
-  writing_pos += size;
+    if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+      /* don't overwrite the data the reader still needs, wait until it has
+       * read enough and write as much as fits */
+      while (queue->rb_writing_pos - queue->rb_reading_pos >=
+          QUEUE_MAX_BYTES (queue)) {
+        GST_QUEUE2_WAIT_DEL_CHECK (queue, queue->sinkresult, out_flushing);
+      }
+      to_write = MIN (size, queue->ring_buffer_max_size -
+          (queue->rb_writing_pos - queue->rb_reading_pos));
+    }
 
-  GST_INFO_OBJECT (queue,
-      "writing %" G_GUINT64_FORMAT ", max_reading %" G_GUINT64_FORMAT,
-      writing_pos, max_reading_pos);
+    range = queue->current;
+    if (!gst_queue2_transfer_data (queue, range, range->writing_pos, data,
+            to_write, TRUE))
+      goto handle_error;
 
-  if (writing_pos > max_reading_pos)
-    queue->cur_level.bytes = writing_pos - max_reading_pos;
-  else
-    queue->cur_level.bytes = 0;
+    range->writing_pos += to_write;
+    data += to_write;
+    size -= to_write;
 
-  /* try to merge with next range */
-  while ((next = queue->current->next)) {
     GST_INFO_OBJECT (queue,
-        "checking merge with next range %" G_GUINT64_FORMAT " < %"
-        G_GUINT64_FORMAT, writing_pos, next->offset);
-    if (writing_pos < next->offset)
-      break;
+        "writing %" G_GUINT64_FORMAT ", max_reading %" G_GUINT64_FORMAT,
+        range->writing_pos, range->max_reading_pos);
+
+    if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+      queue->rb_writing_pos += to_write;
+      trim_ranges (queue);
+    }
 
-    GST_DEBUG_OBJECT (queue, "merging ranges %" G_GUINT64_FORMAT,
-        next->writing_pos);
-    /* we ran over the offset of the next group */
-    queue->current->writing_pos = writing_pos = next->writing_pos;
+    /* try to merge with next range */
+    while ((next = range->next)) {
+      GST_INFO_OBJECT (queue,
+          "checking merge with next range %" G_GUINT64_FORMAT " < %"
+          G_GUINT64_FORMAT, range->writing_pos, next->offset);
+      if (range->writing_pos < next->offset)
+        break;
+
+      if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+        /* the data of the next range is elsewhere in the ring buffer, so we
+         * can't merge. We downloaded its start again, drop it there. */
+        if (next->writing_pos > range->writing_pos) {
+          next->rb_offset += range->writing_pos - next->offset;
+          next->offset = range->writing_pos;
+          break;
+        }
+        GST_DEBUG_OBJECT (queue, "removing range %" G_GUINT64_FORMAT,
+            next->offset);
+      } else {
+        GST_DEBUG_OBJECT (queue, "merging ranges %" G_GUINT64_FORMAT,
+            next->writing_pos);
+        /* we ran over the offset of the next group */
+        range->writing_pos = next->writing_pos;
+      }
 
-    /* remove the group */
-    queue->current->next = next->next;
-    g_slice_free (GstQueue2Range, next);
+      /* remove the group */
+      range->next = next->next;
+      g_slice_free (GstQueue2Range, next);
 
-    debug_ranges (queue);
+      debug_ranges (queue);
+    }
   }
-  queue->current->writing_pos = writing_pos;
+  update_cur_level (queue, queue->current);
 
-  return TRUE;
+  return GST_FLOW_OK;
 
   /* ERRORS */
+out_flushing:
+  {
+    GST_DEBUG_OBJECT (queue, "we are flushing");
+    return queue->sinkresult;
+  }
 handle_error:
   {
     switch (errno) {
@@ -974,7 +1194,7 @@ handle_error:
             ("%s", g_strerror (errno)));
       }
     }
-    return FALSE;
+    return GST_FLOW_ERROR;
   }
 }
 
@@ -1018,42 +1238,80 @@ perform_seek_to_offset (GstQueue2 * queue, guint64 offset)
   return res;
 }
 
+/* get the last range of the ranges that continue each other from @range on,
+ * stopping at the current range */
+static GstQueue2Range *
+find_last_range (GstQueue2 * queue, GstQueue2Range * range)
+{
+  while (range != queue->current && range->next &&
+      range->next->offset == range->writing_pos)
+    range = range->next;
+
+  return range;
+}
+
 /* see if there is enough data in the file to read a full buffer */
 static gboolean
 gst_queue2_have_data (GstQueue2 * queue, guint64 offset, guint length)
 {
-  GstQueue2Range *range;
+  GstQueue2Range *range, *last;
 
   GST_DEBUG_OBJECT (queue, "looking for offset %" G_GUINT64_FORMAT ", len %u",
       offset, length);
 
   if ((range = find_range (queue, offset, length))) {
-    if (queue->current != range) {
+    last = find_last_range (queue, range);
+
+    if (queue->current != last) {
       GST_DEBUG_OBJECT (queue, "switching ranges, do seek to range position");
-      perform_seek_to_offset (queue, range->writing_pos);
+      perform_seek_to_offset (queue, last->writing_pos);
+
+      /* the ranges can change while we are seeking */
+      if (!(range = find_range (queue, offset, length)))
+        return FALSE;
+      last = find_last_range (queue, range);
     }
 
     /* update the current reading position in the range */
     update_cur_pos (queue, queue->current, offset + length);
 
+    if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+      /* the data from @offset on must not be overwritten anymore */
+      queue->rb_reading_pos = range->rb_offset + (offset - range->offset);
+      update_cur_level (queue, queue->current);
+      GST_QUEUE2_SIGNAL_DEL (queue);
+    }
+    /* we might have all the data we need cached already */
+    update_buffering (queue);
+
     /* we have a range for offset */
     GST_DEBUG_OBJECT (queue,
         "we have a range %p, offset %" G_GUINT64_FORMAT ", writing_pos %"
-        G_GUINT64_FORMAT, range, range->offset, range->writing_pos);
+        G_GUINT64_FORMAT, range, range->offset, last->writing_pos);
 
     if (queue->is_eos)
       return TRUE;
 
-    if (offset + length < range->writing_pos)
+    if (offset + length < last->writing_pos)
       return TRUE;
 
   } else {
     GST_INFO_OBJECT (queue, "not found in any range");
     /* we don't have the range, see how far away we are, FIXME, find a good
      * threshold based on the incomming rate. */
-    if (queue->current) {
+    if (queue->current && offset >= queue->current->offset) {
       if (offset < queue->current->writing_pos + 200000) {
+        /* nothing more is coming after EOS */
+        if (queue->is_eos)
+          return TRUE;
+
         update_cur_pos (queue, queue->current, offset + length);
+        if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+          /* the reader needs data that is not written yet */
+          queue->rb_reading_pos = queue->rb_writing_pos;
+          update_cur_level (queue, queue->current);
+          GST_QUEUE2_SIGNAL_DEL (queue);
+        }
         GST_INFO_OBJECT (queue, "wait for data");
         return FALSE;
       }
@@ -1070,8 +1328,11 @@ static GstFlowReturn
 gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
-  size_t res;
+  GstQueue2Range *range;
   GstBuffer *buf;
+  guint8 *data;
+  guint64 pos;
+  guint left, chunk;
 
   /* check if we have enough data at @offset. If there is not enough data, we
    * block and wait. */
@@ -1079,34 +1340,34 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
     GST_QUEUE2_WAIT_ADD_CHECK (queue, queue->srcresult, out_flushing);
   }
 
-#ifdef HAVE_FSEEKO
-  if (fseeko (queue->temp_file, (off_t) offset, SEEK_SET) != 0)
-    goto seek_failed;
-#elif defined (G_OS_UNIX) || defined (G_OS_WIN32)
-  if (lseek (fileno (queue->temp_file), (off_t) offset,
-          SEEK_SET) == (off_t) - 1)
-    goto seek_failed;
-#else
-  if (fseek (queue->temp_file, (long) offset, SEEK_SET) != 0)
-    goto seek_failed;
-#endif
-
   buf = gst_buffer_new_and_alloc (length);
-
-  /* this should not block */
-  GST_LOG_OBJECT (queue, "Reading %d bytes", length);
-  res = fread (GST_BUFFER_DATA (buf), 1, length, queue->temp_file);
-  GST_LOG_OBJECT (queue, "read %" G_GSIZE_FORMAT " bytes", res);
-
-  if (G_UNLIKELY (res == 0)) {
-    /* check for errors or EOF */
-    if (ferror (queue->temp_file))
+  data = GST_BUFFER_DATA (buf);
+
+  /* copy from the range that has @offset and from the ranges that continue
+   * it, this only gives us less than @length at EOS */
+  pos = offset;
+  left = length;
+  range = find_range (queue, offset, length);
+  while (left > 0 && range && pos >= range->offset && pos < range->writing_pos) {
+    chunk = MIN (left, range->writing_pos - pos);
+
+    /* this should not block */
+    GST_LOG_OBJECT (queue, "Reading %u bytes from %" G_GUINT64_FORMAT, chunk,
+        pos);
+    if (!gst_queue2_transfer_data (queue, range, pos, data, chunk, FALSE))
       goto could_not_read;
-    if (feof (queue->temp_file) && length > 0)
-      goto eos;
+
+    pos += chunk;
+    data += chunk;
+    left -= chunk;
+    range = range->next;
   }
 
-  length = res;
+  if (G_UNLIKELY (pos == offset && length > 0))
+    goto eos;
+
+  length = pos - offset;
+  GST_LOG_OBJECT (queue, "read %u bytes", length);
 
   GST_BUFFER_SIZE (buf) = length;
   GST_BUFFER_OFFSET (buf) = offset;
@@ -1122,11 +1383,6 @@ out_flushing:
     GST_DEBUG_OBJECT (queue, "we are flushing");
     return GST_FLOW_WRONG_STATE;
   }
-seek_failed:
-  {
-    GST_ELEMENT_ERROR (queue, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
-    return GST_FLOW_ERROR;
-  }
 could_not_read:
   {
     GST_ELEMENT_ERROR (queue, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
@@ -1163,6 +1419,8 @@ gst_queue2_read_item_from_file (GstQueue2 * queue)
     switch (ret) {
       case GST_FLOW_OK:
         item = GST_MINI_OBJECT_CAST (buffer);
+        /* continue after this buffer the next time */
+        queue->current->reading_pos += GST_BUFFER_SIZE (buffer);
         break;
       case GST_FLOW_UNEXPECTED:
         item = GST_MINI_OBJECT_CAST (gst_event_new_eos ());
@@ -1175,6 +1433,26 @@ gst_queue2_read_item_from_file (GstQueue2 * queue)
   return item;
 }
 
+/* allocate the memory of the ring buffer, when it's not kept in a file */
+static void
+gst_queue2_open_ring_buffer (GstQueue2 * queue)
+{
+  if (queue->ring_buffer == NULL) {
+    GST_DEBUG_OBJECT (queue, "allocating ring buffer of %" G_GUINT64_FORMAT
+        " bytes", queue->ring_buffer_max_size);
+    queue->ring_buffer = g_malloc (queue->ring_buffer_max_size);
+  }
+  init_ranges (queue);
+}
+
+static void
+gst_queue2_close_ring_buffer (GstQueue2 * queue)
+{
+  g_free (queue->ring_buffer);
+  queue->ring_buffer = NULL;
+  clean_ranges (queue);
+}
+
 static gboolean
 gst_queue2_open_temp_location_file (GstQueue2 * queue)
 {
@@ -1294,6 +1572,9 @@ gst_queue2_locked_flush (GstQueue2 * queue)
 {
   if (QUEUE_IS_USING_TEMP_FILE (queue)) {
     gst_queue2_flush_temp_file (queue);
+  } else if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+    if (queue->ring_buffer)
+      init_ranges (queue);
   } else {
     while (!g_queue_is_empty (queue->queue)) {
       GstMiniObject *data = g_queue_pop_head (queue->queue);
@@ -1315,19 +1596,30 @@ gst_queue2_locked_flush (GstQueue2 * queue)
   GST_QUEUE2_SIGNAL_DEL (queue);
 }
 
-/* enqueue an item an update the level stats */
-static void
+/* enqueue an item an update the level stats. Returns something else than
+ * GST_FLOW_OK when a buffer could not be stored, the item is unreffed then. */
+static GstFlowReturn
 gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
 {
   if (GST_IS_BUFFER (item)) {
     GstBuffer *buffer;
+    GstFlowReturn ret;
     guint size;
 
     buffer = GST_BUFFER_CAST (item);
     size = GST_BUFFER_SIZE (buffer);
 
+    /* store the buffer first, this can wait for the ring buffer to have space
+     * and fail when we are flushing */
+    if (!QUEUE_IS_USING_QUEUE (queue)) {
+      if ((ret = gst_queue2_create_write (queue, buffer)) != GST_FLOW_OK) {
+        gst_buffer_unref (buffer);
+        return ret;
+      }
+    }
+
     /* add buffer to the statistics */
-    if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+    if (QUEUE_IS_USING_QUEUE (queue)) {
       queue->cur_level.buffers++;
       queue->cur_level.bytes += size;
     }
@@ -1338,10 +1630,6 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
     /* update the byterate stats */
     update_in_rates (queue);
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-      gst_queue2_write_buffer_to_file (queue, buffer);
-    }
-
   } else if (GST_IS_EVENT (item)) {
     GstEvent *event;
 
@@ -1358,7 +1646,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
         apply_segment (queue, event, &queue->sink_segment);
         /* This is our first new segment, we hold it
          * as we can't save it on the temp file */
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (!QUEUE_IS_USING_QUEUE (queue)) {
           if (queue->segment_event_received)
             goto unexpected_event;
 
@@ -1373,7 +1661,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
         queue->unexpected = FALSE;
         break;
       default:
-        if (QUEUE_IS_USING_TEMP_FILE (queue))
+        if (!QUEUE_IS_USING_QUEUE (queue))
           goto unexpected_event;
         break;
     }
@@ -1388,7 +1676,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
     /* update the buffering status */
     update_buffering (queue);
 
-    if (!QUEUE_IS_USING_TEMP_FILE (queue))
+    if (QUEUE_IS_USING_QUEUE (queue))
       g_queue_push_tail (queue->queue, item);
     else
       gst_mini_object_unref (GST_MINI_OBJECT_CAST (item));
@@ -1396,7 +1684,7 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item)
     GST_QUEUE2_SIGNAL_ADD (queue);
   }
 
-  return;
+  return GST_FLOW_OK;
 
   /* ERRORS */
 unexpected_event:
@@ -1406,7 +1694,7 @@ unexpected_event:
         gst_event_type_get_name (GST_EVENT_TYPE (item)),
         GST_OBJECT_NAME (queue));
     gst_event_unref (GST_EVENT_CAST (item));
-    return;
+    return GST_FLOW_OK;
   }
 }
 
@@ -1416,7 +1704,7 @@ gst_queue2_locked_dequeue (GstQueue2 * queue)
 {
   GstMiniObject *item;
 
-  if (QUEUE_IS_USING_TEMP_FILE (queue))
+  if (!QUEUE_IS_USING_QUEUE (queue))
     item = gst_queue2_read_item_from_file (queue);
   else
     item = g_queue_pop_head (queue->queue);
@@ -1434,7 +1722,7 @@ gst_queue2_locked_dequeue (GstQueue2 * queue)
     GST_CAT_LOG_OBJECT (queue_dataflow, queue,
         "retrieved buffer %p from queue", buffer);
 
-    if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+    if (QUEUE_IS_USING_QUEUE (queue)) {
       queue->cur_level.buffers--;
       queue->cur_level.bytes -= size;
     }
@@ -1492,7 +1780,7 @@ gst_queue2_handle_sink_event (GstPad * pad, GstEvent * event)
     case GST_EVENT_FLUSH_START:
     {
       GST_CAT_LOG_OBJECT (queue_dataflow, queue, "received flush start event");
-      if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_QUEUE (queue)) {
         /* forward event */
         gst_pad_push_event (queue->srcpad, event);
 
@@ -1509,6 +1797,14 @@ gst_queue2_handle_sink_event (GstPad * pad, GstEvent * event)
          * flush_start downstream. */
         gst_pad_pause_task (queue->srcpad);
         GST_CAT_LOG_OBJECT (queue_dataflow, queue, "loop stopped");
+      } else {
+        /* unblock the chain function when it waits for space in the ring
+         * buffer, upstream needs that to complete the seek */
+        GST_QUEUE2_MUTEX_LOCK (queue);
+        queue->sinkresult = GST_FLOW_WRONG_STATE;
+        GST_QUEUE2_SIGNAL_DEL (queue);
+        GST_QUEUE2_MUTEX_UNLOCK (queue);
+        gst_event_unref (event);
       }
       goto done;
     }
@@ -1516,7 +1812,7 @@ gst_queue2_handle_sink_event (GstPad * pad, GstEvent * event)
     {
       GST_CAT_LOG_OBJECT (queue_dataflow, queue, "received flush stop event");
 
-      if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_QUEUE (queue)) {
         /* forward event */
         gst_pad_push_event (queue->srcpad, event);
 
@@ -1534,9 +1830,11 @@ gst_queue2_handle_sink_event (GstPad * pad, GstEvent * event)
       } else {
         GST_QUEUE2_MUTEX_LOCK (queue);
         queue->segment_event_received = FALSE;
+        queue->sinkresult = GST_FLOW_OK;
         queue->is_eos = FALSE;
         queue->unexpected = FALSE;
         GST_QUEUE2_MUTEX_UNLOCK (queue);
+        gst_event_unref (event);
       }
       goto done;
     }
@@ -1582,7 +1880,7 @@ gst_queue2_is_empty (GstQueue2 * queue)
   if (queue->is_eos)
     return FALSE;
 
-  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+  if (!QUEUE_IS_USING_QUEUE (queue)) {
     return queue->current->writing_pos == queue->current->max_reading_pos;
   } else {
     if (queue->queue->length == 0)
@@ -1601,6 +1899,11 @@ gst_queue2_is_filled (GstQueue2 * queue)
   if (queue->is_eos)
     return TRUE;
 
+  /* the ring buffer is filled when the download is as far ahead of the
+   * reader as we allow */
+  if (QUEUE_IS_USING_RING_BUFFER (queue))
+    return queue->cur_level.bytes >= QUEUE_MAX_BYTES (queue);
+
   /* if using file, we're never filled if we don't have EOS */
   if (QUEUE_IS_USING_TEMP_FILE (queue))
     return FALSE;
@@ -1628,6 +1931,7 @@ static GstFlowReturn
 gst_queue2_chain (GstPad * pad, GstBuffer * buffer)
 {
   GstQueue2 *queue;
+  GstFlowReturn ret;
 
   queue = GST_QUEUE2 (GST_OBJECT_PARENT (pad));
 
@@ -1670,15 +1974,15 @@ gst_queue2_chain (GstPad * pad, GstBuffer * buffer)
   }
 
   /* put buffer in queue now */
-  gst_queue2_locked_enqueue (queue, buffer);
+  ret = gst_queue2_locked_enqueue (queue, buffer);
   GST_QUEUE2_MUTEX_UNLOCK (queue);
 
-  return GST_FLOW_OK;
+  return ret;
 
   /* special conditions */
 out_flushing:
   {
-    GstFlowReturn ret = queue->sinkresult;
+    ret = queue->sinkresult;
 
     GST_CAT_LOG_OBJECT (queue_dataflow, queue,
         "exit because task paused, reason: %s", gst_flow_get_name (ret));
@@ -1885,7 +2189,7 @@ gst_queue2_handle_src_event (GstPad * pad, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_START:
-      if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_QUEUE (queue)) {
         /* just forward upstream */
         res = gst_pad_push_event (queue->sinkpad, event);
       } else {
@@ -1902,7 +2206,7 @@ gst_queue2_handle_src_event (GstPad * pad, GstEvent * event)
       }
       break;
     case GST_EVENT_FLUSH_STOP:
-      if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_QUEUE (queue)) {
         /* just forward upstream */
         res = gst_pad_push_event (queue->sinkpad, event);
       } else {
@@ -1991,43 +2295,78 @@ gst_queue2_handle_src_query (GstPad * pad, GstQuery * query)
 
       GST_DEBUG_OBJECT (queue, "query buffering");
 
-      if (!QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_QUEUE (queue)) {
         /* no temp file, just forward to the peer */
         if (!gst_queue2_peer_query (queue, queue->sinkpad, query))
           goto peer_failed;
         GST_DEBUG_OBJECT (queue, "buffering forwarded to peer");
       } else {
         gint64 start, stop;
-        guint64 writing_pos;
-        gint percent;
+        guint64 range_start, range_end, writing_pos;
+        gint64 percent;
         gint64 estimated_total, buffering_left;
         GstFormat peer_fmt;
-        gint64 duration;
+        gint64 duration, req_start;
         gboolean peer_res, is_buffering, is_eos;
         gdouble byte_in_rate, byte_out_rate;
+        GstQueue2Range *range;
+
+        gst_query_parse_buffering_range (query, &format, &req_start, NULL,
+            NULL);
 
+        /* get duration of upstream in bytes */
+        peer_fmt = GST_FORMAT_BYTES;
+        peer_res = gst_pad_query_peer_duration (queue->sinkpad, &peer_fmt,
+            &duration);
+
+        GST_QUEUE2_MUTEX_LOCK (queue);
         /* we need a current download region */
-        if (queue->current == NULL)
+        if (queue->current == NULL) {
+          GST_QUEUE2_MUTEX_UNLOCK (queue);
           return FALSE;
+        }
 
         writing_pos = queue->current->writing_pos;
         byte_in_rate = queue->byte_in_rate;
         byte_out_rate = queue->byte_out_rate;
         is_buffering = queue->is_buffering;
         is_eos = queue->is_eos;
-        percent = queue->buffering_percent;
+
+        /* answer with what is cached for the reader now instead of with the
+         * last buffering message, so that it is known right away after a
+         * seek into a cached range */
+        percent = get_buffering_percent (queue);
+        if (queue->high_percent > 0)
+          percent = percent * 100 / queue->high_percent;
+        if (percent > 100)
+          percent = 100;
 
         if (is_eos) {
           /* we're EOS, we know the duration in bytes now */
           peer_res = TRUE;
           duration = writing_pos;
-        } else {
-          /* get duration of upstream in bytes */
-          peer_fmt = GST_FORMAT_BYTES;
-          peer_res = gst_pad_query_peer_duration (queue->sinkpad, &peer_fmt,
-              &duration);
         }
 
+        /* the application can ask about the data at a position, convert it
+         * to bytes */
+        if (format == GST_FORMAT_PERCENT && req_start > 0) {
+          if (peer_res && duration != -1)
+            req_start = req_start * duration / GST_FORMAT_PERCENT_MAX;
+          else
+            req_start = -1;
+        }
+
+        /* report the cached data that continues from that position, or the
+         * range we are downloading into */
+        range = NULL;
+        if (req_start > 0)
+          range = find_range (queue, req_start, 0);
+        if (range == NULL)
+          range = queue->current;
+        range_start = range->offset;
+        range_end = find_last_range (queue, range)->writing_pos;
+        GST_QUEUE2_MUTEX_UNLOCK (queue);
+
         /* calculate remaining and total download time */
         if (peer_res && byte_in_rate > 0.0) {
           estimated_total = (duration * 1000) / byte_in_rate;
@@ -2039,34 +2378,35 @@ gst_queue2_handle_src_query (GstPad * pad, GstQuery * query)
         GST_DEBUG_OBJECT (queue, "estimated %" G_GINT64_FORMAT ", left %"
             G_GINT64_FORMAT, estimated_total, buffering_left);
 
-        gst_query_parse_buffering_range (query, &format, NULL, NULL, NULL);
-
         switch (format) {
           case GST_FORMAT_PERCENT:
             /* we need duration */
             if (!peer_res)
               goto peer_failed;
 
-            GST_DEBUG_OBJECT (queue, "duration %" G_GINT64_FORMAT ", writing %"
-                G_GINT64_FORMAT, duration, writing_pos);
+            GST_DEBUG_OBJECT (queue, "duration %" G_GINT64_FORMAT ", range %"
+                G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT, duration, range_start,
+                range_end);
 
-            start = 0;
             /* get our available data relative to the duration */
-            if (duration != -1)
-              stop = GST_FORMAT_PERCENT_MAX * writing_pos / duration;
-            else
+            if (duration != -1) {
+              start = GST_FORMAT_PERCENT_MAX * range_start / duration;
+              stop = GST_FORMAT_PERCENT_MAX * range_end / duration;
+            } else {
+              start = 0;
               stop = -1;
+            }
             break;
           case GST_FORMAT_BYTES:
-            start = 0;
-            stop = writing_pos;
+            start = range_start;
+            stop = range_end;
             break;
           default:
             start = -1;
             stop = -1;
             break;
         }
-        gst_query_set_buffering_percent (query, is_buffering, percent);
+        gst_query_set_buffering_percent (query, is_buffering, (gint) percent);
         gst_query_set_buffering_range (query, format, start, stop,
             estimated_total);
         gst_query_set_buffering_stats (query, GST_BUFFERING_DOWNLOAD,
@@ -2139,7 +2479,7 @@ gst_queue2_src_checkgetrange_function (GstPad * pad)
   queue = GST_QUEUE2 (gst_pad_get_parent (pad));
 
   /* we can operate in pull mode when we are using a tempfile */
-  ret = QUEUE_IS_USING_TEMP_FILE (queue);
+  ret = !QUEUE_IS_USING_QUEUE (queue);
 
   gst_object_unref (GST_OBJECT (queue));
 
@@ -2227,9 +2567,17 @@ gst_queue2_src_activate_pull (GstPad * pad, gboolean active)
   queue = GST_QUEUE2 (gst_pad_get_parent (pad));
 
   if (active) {
-    if (QUEUE_IS_USING_TEMP_FILE (queue)) {
-      /* open the temp file now */
-      result = gst_queue2_open_temp_location_file (queue);
+    if (!QUEUE_IS_USING_QUEUE (queue)) {
+      if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        /* open the temp file now */
+        result = gst_queue2_open_temp_location_file (queue);
+      } else {
+        GST_QUEUE2_MUTEX_LOCK (queue);
+        if (queue->ring_buffer == NULL)
+          gst_queue2_open_ring_buffer (queue);
+        GST_QUEUE2_MUTEX_UNLOCK (queue);
+        result = TRUE;
+      }
 
       GST_QUEUE2_MUTEX_LOCK (queue);
       GST_DEBUG_OBJECT (queue, "activating pull mode");
@@ -2242,7 +2590,7 @@ gst_queue2_src_activate_pull (GstPad * pad, gboolean active)
       GST_QUEUE2_MUTEX_LOCK (queue);
       GST_DEBUG_OBJECT (queue, "no temp file, cannot activate pull mode");
       /* this is not allowed, we cannot operate in pull mode without a temp
-       * file. */
+       * file or a ring buffer. */
       queue->srcresult = GST_FLOW_WRONG_STATE;
       queue->sinkresult = GST_FLOW_WRONG_STATE;
       result = FALSE;
@@ -2278,6 +2626,10 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
       if (QUEUE_IS_USING_TEMP_FILE (queue)) {
         if (!gst_queue2_open_temp_location_file (queue))
           ret = GST_STATE_CHANGE_FAILURE;
+      } else if (QUEUE_IS_USING_RING_BUFFER (queue)) {
+        GST_QUEUE2_MUTEX_LOCK (queue);
+        gst_queue2_open_ring_buffer (queue);
+        GST_QUEUE2_MUTEX_UNLOCK (queue);
       }
       queue->segment_event_received = FALSE;
       queue->starting_segment = NULL;
@@ -2296,6 +2648,8 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       if (QUEUE_IS_USING_TEMP_FILE (queue))
         gst_queue2_close_temp_location_file (queue);
+      else if (QUEUE_IS_USING_RING_BUFFER (queue))
+        gst_queue2_close_ring_buffer (queue);
       if (queue->starting_segment != NULL) {
         gst_event_unref (queue->starting_segment);
         queue->starting_segment = NULL;
@@ -2349,6 +2703,31 @@ wrong_state:
   }
 }
 
+static void
+gst_queue2_set_ring_buffer_max_size (GstQueue2 * queue, guint64 size)
+{
+  GstState state;
+
+  /* the element must be stopped in order to do this */
+  GST_OBJECT_LOCK (queue);
+  state = GST_STATE (queue);
+  if (state != GST_STATE_READY && state != GST_STATE_NULL)
+    goto wrong_state;
+  GST_OBJECT_UNLOCK (queue);
+
+  queue->ring_buffer_max_size = size;
+
+  return;
+
+/* ERROR */
+wrong_state:
+  {
+    GST_WARNING_OBJECT (queue,
+        "setting ring-buffer-max-size property in wrong state");
+    GST_OBJECT_UNLOCK (queue);
+  }
+}
+
 static void
 gst_queue2_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
@@ -2400,6 +2779,9 @@ gst_queue2_set_property (GObject * object,
     case PROP_TEMP_REMOVE:
       queue->temp_remove = g_value_get_boolean (value);
       break;
+    case PROP_RING_BUFFER_MAX_SIZE:
+      gst_queue2_set_ring_buffer_max_size (queue, g_value_get_uint64 (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2456,6 +2838,9 @@ gst_queue2_get_property (GObject * object,
     case PROP_TEMP_REMOVE:
       g_value_set_boolean (value, queue->temp_remove);
       break;
+    case PROP_RING_BUFFER_MAX_SIZE:
+      g_value_set_uint64 (value, queue->ring_buffer_max_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -64,6 +64,9 @@ struct _GstQueue2Range
   guint64 writing_pos;
   guint64 reading_pos;
   guint64 max_reading_pos;
+  /* position of offset in the ring buffer, in bytes written since the
+   * ring buffer was created */
+  guint64 rb_offset;
 };
 
 struct _GstQueue2
@@ -132,6 +135,14 @@ struct _GstQueue2
    * because we can't save it on the file */
   gboolean segment_event_received;
   GstEvent *starting_segment;
+
+  /* ring buffer, kept in memory or in the temp file */
+  guint64 ring_buffer_max_size;
+  guint8 *ring_buffer;
+  /* total bytes written to the ring buffer and the position of the oldest
+   * byte that the reader still needs */
+  guint64 rb_writing_pos;
+  guint64 rb_reading_pos;
 };
 
 struct _GstQueue2Class
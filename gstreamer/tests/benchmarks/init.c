@@ -20,12 +20,124 @@
  */
 
 
+/* Measures gst_init() with an up to date registry cache and the first uses
+ * of the registry after it, which create the features they need from the
+ * cache. With a number as argument, runs itself that many times and prints
+ * the average time per process. */
+
+#include <stdlib.h>
 #include <gst/gst.h>
 
+static GstClockTime
+gst_get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return GST_TIMEVAL_TO_TIME (tv);
+}
+
+static void
+lookup_factories (void)
+{
+  static const gchar *names[] = { "filesrc", "queue", "fakesink" };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++) {
+    GstElementFactory *factory = gst_element_factory_find (names[i]);
+
+    if (factory)
+      gst_object_unref (factory);
+  }
+}
+
+static guint
+query_media_type (void)
+{
+  GList *list;
+  guint len;
+
+  list = gst_registry_get_feature_list_by_media_type (gst_registry_get_default
+      (), "audio/x-raw-int");
+  len = g_list_length (list);
+  gst_plugin_feature_list_free (list);
+
+  return len;
+}
+
+static guint
+list_element_factories (void)
+{
+  GList *list;
+  guint len;
+
+  list = gst_registry_get_feature_list (gst_registry_get_default (),
+      GST_TYPE_ELEMENT_FACTORY);
+  len = g_list_length (list);
+  gst_plugin_feature_list_free (list);
+
+  return len;
+}
+
+static gint
+run_children (gchar * program, guint runs)
+{
+  gchar *child_argv[] = { program, NULL };
+  GstClockTime start, end;
+  guint i;
+
+  start = gst_get_current_time ();
+  for (i = 0; i < runs; i++) {
+    GError *err = NULL;
+
+    if (!g_spawn_sync (NULL, child_argv, NULL, G_SPAWN_STDOUT_TO_DEV_NULL,
+            NULL, NULL, NULL, NULL, NULL, &err)) {
+      g_printerr ("Could not run %s: %s\n", program, err->message);
+      g_error_free (err);
+      return 1;
+    }
+  }
+  end = gst_get_current_time ();
+
+  g_print ("%" GST_TIME_FORMAT " - %u processes\n",
+      GST_TIME_ARGS (end - start), runs);
+  g_print ("%" GST_TIME_FORMAT " per process\n",
+      GST_TIME_ARGS ((end - start) / runs));
+
+  return 0;
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
+  GstClockTime start, end;
+  guint n;
+
+  if (argc > 1 && atoi (argv[1]) > 0)
+    return run_children (argv[0], atoi (argv[1]));
+
+  start = gst_get_current_time ();
   gst_init (&argc, &argv);
+  end = gst_get_current_time ();
+  g_print ("%" GST_TIME_FORMAT " - gst_init\n", GST_TIME_ARGS (end - start));
+
+  start = gst_get_current_time ();
+  lookup_factories ();
+  end = gst_get_current_time ();
+  g_print ("%" GST_TIME_FORMAT " - looking up 3 element factories\n",
+      GST_TIME_ARGS (end - start));
+
+  start = gst_get_current_time ();
+  n = query_media_type ();
+  end = gst_get_current_time ();
+  g_print ("%" GST_TIME_FORMAT " - finding %u features for audio/x-raw-int\n",
+      GST_TIME_ARGS (end - start), n);
+
+  start = gst_get_current_time ();
+  n = list_element_factories ();
+  end = gst_get_current_time ();
+  g_print ("%" GST_TIME_FORMAT " - listing %u element factories\n",
+      GST_TIME_ARGS (end - start), n);
 
   return 0;
 }
@@ -0,0 +1,107 @@
+/* GStreamer
+ *
+ * queue-throughput.c: push many small buffers through a queue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the per-buffer cost of fakesrc ! queue ! fakesink with tiny
+ * buffers, which is dominated by buffer creation and destruction and by the
+ * handover between the streaming threads on both sides of the queue. The
+ * pipeline runs with the queue in its default and in its lock-free mode. */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define BUFFER_COUNT (10 * 1000 * 1000)
+#define BUFFER_SIZE (64)
+
+static GstClockTime
+gst_get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return GST_TIMEVAL_TO_TIME (tv);
+}
+
+static void
+run (guint buffers, guint size, gboolean lock_free)
+{
+  GstElement *pipeline, *src, *queue, *sink;
+  GstMessage *msg;
+  GstClockTime start, end;
+
+  g_print ("*** benchmarking this pipeline: fakesrc num-buffers=%u "
+      "sizemax=%u ! queue lock-free=%s ! fakesink\n", buffers, size,
+      lock_free ? "true" : "false");
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  queue = gst_element_factory_make ("queue", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_assert (pipeline && src && queue && sink);
+
+  g_object_set (src, "num-buffers", buffers, "sizemax", size,
+      "silent", TRUE, NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+  g_object_set (queue, "lock-free", lock_free, NULL);
+  g_object_set (sink, "silent", TRUE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, queue, sink, NULL);
+  if (!gst_element_link_many (src, queue, sink, NULL))
+    g_assert_not_reached ();
+
+  start = gst_get_current_time ();
+  if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    g_assert_not_reached ();
+
+  msg = gst_bus_poll (gst_element_get_bus (pipeline),
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  end = gst_get_current_time ();
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_assert_not_reached ();
+  gst_message_unref (msg);
+
+  g_print ("%" GST_TIME_FORMAT " - putting %u buffers through\n",
+      GST_TIME_ARGS (end - start), buffers);
+  if (buffers)
+    g_print ("%" G_GUINT64_FORMAT " ns per buffer\n",
+        (end - start) / buffers);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint buffers = BUFFER_COUNT, size = BUFFER_SIZE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    buffers = atoi (argv[1]);
+  if (argc > 2)
+    size = atoi (argv[2]);
+
+  /* the queue with its lock and in lock-free mode */
+  run (buffers, size, FALSE);
+  run (buffers, size, TRUE);
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+/* GStreamer
+ *
+ * typefind.c: typefind the heads of a corpus of container files
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures gst_type_find_helper_for_buffer() on the first bytes of the files
+ * given on the command line, or on a built-in corpus of container headers.
+ * The typefind functions come from the registry, so this needs the plugins
+ * with the typefinders (typefindfunctions from gst-plugins-base) to be
+ * found in the plugin path. */
+
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/base/gsttypefindhelper.h>
+
+#define HEAD_SIZE (4096)
+#define MIN_TIME (GST_SECOND)
+
+typedef struct
+{
+  const gchar *name;
+  const guint8 *data;
+  guint size;
+} CorpusEntry;
+
+/* an Ogg page with a Vorbis identification header */
+static const guint8 ogg_vorbis[] = {
+  'O', 'g', 'g', 'S', 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x01, 0x1e, 0x01, 'v', 'o', 'r', 'b', 'i', 's', 0x00,
+  0x00, 0x00, 0x00, 0x02, 0x44, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0xf4, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0xb8, 0x01
+};
+
+/* an EBML header with doctype matroska */
+static const guint8 matroska[] = {
+  0x1a, 0x45, 0xdf, 0xa3, 0x93, 0x42, 0x82, 0x88, 'm', 'a', 't', 'r',
+  'o', 's', 'k', 'a', 0x42, 0x87, 0x81, 0x02, 0x42, 0x85, 0x81, 0x02
+};
+
+/* a RIFF WAVE header for 16 bit stereo at 44100 Hz */
+static const guint8 wave[] = {
+  'R', 'I', 'F', 'F', 0x24, 0x00, 0x01, 0x00, 'W', 'A', 'V', 'E',
+  'f', 'm', 't', ' ', 0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00,
+  0x44, 0xac, 0x00, 0x00, 0x10, 0xb1, 0x02, 0x00, 0x04, 0x00, 0x10, 0x00,
+  'd', 'a', 't', 'a', 0x00, 0x00, 0x01, 0x00
+};
+
+static GstClockTime
+gst_get_current_time (void)
+{
+  GTimeVal tv;
+
+  g_get_current_time (&tv);
+  return GST_TIMEVAL_TO_TIME (tv);
+}
+
+static GstBuffer *
+make_head (const guint8 * data, guint size)
+{
+  GstBuffer *buf;
+  guint i;
+
+  /* pad with noise, like the rest of a real file */
+  buf = gst_buffer_new_and_alloc (HEAD_SIZE);
+  for (i = 0; i < HEAD_SIZE; i++)
+    GST_BUFFER_DATA (buf)[i] = (i * 2654435761U) >> 24;
+  if (data)
+    memcpy (GST_BUFFER_DATA (buf), data, MIN (size, HEAD_SIZE));
+  GST_BUFFER_OFFSET (buf) = 0;
+
+  return buf;
+}
+
+static void
+run (const gchar * name, GstBuffer * buf)
+{
+  GstClockTime start, elapsed;
+  GstCaps *caps;
+  guint runs = 0;
+  gchar *str;
+
+  start = gst_get_current_time ();
+  do {
+    caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+    if (caps)
+      gst_caps_unref (caps);
+    runs++;
+    elapsed = gst_get_current_time () - start;
+  } while (elapsed < MIN_TIME);
+
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  str = caps ? gst_caps_to_string (caps) : g_strdup ("(none)");
+  g_print ("%-24s %10" G_GUINT64_FORMAT " ns per typefind  %s\n", name,
+      elapsed / runs, str);
+  g_free (str);
+  if (caps)
+    gst_caps_unref (caps);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const CorpusEntry corpus[] = {
+    {"ogg", ogg_vorbis, sizeof (ogg_vorbis)},
+    {"matroska", matroska, sizeof (matroska)},
+    {"wav", wave, sizeof (wave)},
+    {"noise", NULL, 0}
+  };
+  GstBuffer *buf;
+  gint i;
+
+  gst_init (&argc, &argv);
+
+  g_print ("*** benchmarking gst_type_find_helper_for_buffer() on %s\n",
+      argc > 1 ? "the given files" : "the built-in corpus");
+
+  if (argc > 1) {
+    for (i = 1; i < argc; i++) {
+      GError *err = NULL;
+      gchar *contents;
+      gsize len;
+
+      if (!g_file_get_contents (argv[i], &contents, &len, &err)) {
+        g_printerr ("%s: %s\n", argv[i], err->message);
+        g_error_free (err);
+        continue;
+      }
+      buf = make_head ((const guint8 *) contents, len);
+      if (len < HEAD_SIZE)
+        GST_BUFFER_SIZE (buf) = len;
+      run (argv[i], buf);
+      gst_buffer_unref (buf);
+      g_free (contents);
+    }
+  } else {
+    for (i = 0; i < (gint) G_N_ELEMENTS (corpus); i++) {
+      buf = make_head (corpus[i].data, corpus[i].size);
+      run (corpus[i].name, buf);
+      gst_buffer_unref (buf);
+    }
+  }
+
+  return 0;
+}
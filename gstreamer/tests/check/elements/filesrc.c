@@ -18,11 +18,21 @@
  * Boston, MA 02111-1307, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#if defined (HAVE_MMAP) && defined (HAVE_SIGACTION) && defined (__linux__)
+#include <signal.h>
+#endif
+
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 
 static gboolean have_eos = FALSE;
@@ -288,6 +298,146 @@ GST_START_TEST (test_pull)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_read_ahead)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  gchar *contents;
+  gsize size;
+  guint64 offset;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &size, NULL));
+
+  src = setup_filesrc ();
+
+  /* small, so that we get a few requests ahead even in this small file */
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "read-ahead", 1024,
+      NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_pull (pad, TRUE));
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* a jump to the end first, which doesn't read ahead */
+  ret = gst_pad_get_range (pad, size - 100, 100, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (memcmp (GST_BUFFER_DATA (buffer), contents + size - 100,
+          100) == 0);
+  gst_buffer_unref (buffer);
+
+  /* then through the whole file, with a few reads straddling the blocks that
+   * were read ahead */
+  for (offset = 0; offset < size; offset += 100) {
+    guint length = (offset % 700 == 300) ? 150 : 100;
+
+    ret = gst_pad_get_range (pad, offset, length, &buffer);
+    fail_unless (ret == GST_FLOW_OK);
+    fail_unless (GST_BUFFER_OFFSET (buffer) == offset);
+    fail_unless (GST_BUFFER_SIZE (buffer) == MIN (length, size - offset));
+    fail_unless (memcmp (GST_BUFFER_DATA (buffer), contents + offset,
+            GST_BUFFER_SIZE (buffer)) == 0);
+    gst_buffer_unref (buffer);
+  }
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+#if defined (HAVE_MMAP) && defined (HAVE_SIGACTION) && defined (__linux__)
+GST_START_TEST (test_mmap_truncated)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  GstBus *bus;
+  GstMessage *msg;
+  GError *err = NULL;
+  struct sigaction before, after;
+  gchar *tmp_fn, *data;
+  gint fd;
+
+  tmp_fn = g_build_filename (g_get_tmp_dir (),
+      "gstreamer-filesrc-test-XXXXXX", NULL);
+  fd = g_mkstemp (tmp_fn);
+  fail_unless (fd >= 0, "can't create temp file: %s", g_strerror (errno));
+
+  data = g_malloc (65536);
+  memset (data, 0xaa, 65536);
+  fail_unless (write (fd, data, 65536) == 65536);
+  g_free (data);
+
+  fail_unless (sigaction (SIGBUS, NULL, &before) == 0);
+
+  src = setup_filesrc ();
+  bus = gst_bus_new ();
+  gst_element_set_bus (src, bus);
+  g_object_set (G_OBJECT (src), "location", tmp_fn, "use-mmap", TRUE, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_pull (pad, TRUE));
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  ret = gst_pad_get_range (pad, 32768, 4096, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (GST_BUFFER_SIZE (buffer) == 4096);
+  gst_buffer_unref (buffer);
+
+  /* the rest of the mapped region is gone now, pulling from it must post
+   * an error instead of killing us or handing out zeroes */
+  fail_unless (ftruncate (fd, 0) == 0);
+  ret = gst_pad_get_range (pad, 40960, 4096, &buffer);
+  fail_unless (ret == GST_FLOW_ERROR);
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR);
+  gst_message_parse_error (msg, &err, NULL);
+  fail_unless (g_error_matches (err, GST_RESOURCE_ERROR,
+          GST_RESOURCE_ERROR_READ));
+  g_error_free (err);
+  gst_message_unref (msg);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* the last filesrc using mmap puts the previous handler back */
+  fail_unless (sigaction (SIGBUS, NULL, &after) == 0);
+  fail_unless (after.sa_handler == before.sa_handler);
+
+  gst_object_unref (pad);
+  gst_element_set_bus (src, NULL);
+  gst_object_unref (bus);
+  cleanup_filesrc (src);
+
+  close (fd);
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+#endif
+
 GST_START_TEST (test_coverage)
 {
   GstElement *src;
@@ -386,6 +536,10 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_read_ahead);
+#if defined (HAVE_MMAP) && defined (HAVE_SIGACTION) && defined (__linux__)
+  tcase_add_test (tc_chain, test_mmap_truncated);
+#endif
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
 
@@ -357,7 +357,7 @@ mq_dummypad_event (GstPad * sinkpad, GstEvent * event)
 }
 
 static void
-run_output_order_test (gint n_linked)
+run_output_order_test (gint n_linked, guint worker_threads)
 {
   /* This test creates a multiqueue with 2 linked output, and 3 outputs that 
    * return 'not-linked' when data is pushed, then verifies that all buffers 
@@ -392,6 +392,7 @@ run_output_order_test (gint n_linked)
       "max-size-time", (guint64) 0,
       "extra-size-bytes", (guint) 0,
       "extra-size-buffers", (guint) 0, "extra-size-time", (guint64) 0, NULL);
+  g_object_set (mq, "worker-threads", worker_threads, NULL);
 
   /* Construct NPADS dummy output pads. The first 'n_linked' return FLOW_OK, the rest
    * return NOT_LINKED. The not-linked ones check the expected ordering of 
@@ -506,8 +507,18 @@ run_output_order_test (gint n_linked)
 
 GST_START_TEST (test_output_order)
 {
-  run_output_order_test (2);
-  run_output_order_test (0);
+  run_output_order_test (2, 0);
+  run_output_order_test (0, 0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_output_order_worker_pool)
+{
+  /* a single worker servicing all streams keeps the not-linked ordering */
+  run_output_order_test (2, 1);
+  run_output_order_test (0, 1);
+  run_output_order_test (2, 2);
 }
 
 GST_END_TEST;
@@ -527,6 +538,7 @@ multiqueue_suite (void)
   tcase_add_test (tc_chain, test_request_pads);
 
   tcase_add_test (tc_chain, test_output_order);
+  tcase_add_test (tc_chain, test_output_order_worker_pool);
   return s;
 }
 
@@ -430,6 +430,162 @@ GST_START_TEST (test_time_level)
 
 GST_END_TEST;
 
+static GstBufferList *received_list = NULL;
+
+static GstFlowReturn
+chain_list_func (GstPad * pad, GstBufferList * list)
+{
+  g_mutex_lock (check_mutex);
+  received_list = list;
+  g_cond_signal (check_cond);
+  g_mutex_unlock (check_mutex);
+
+  return GST_FLOW_OK;
+}
+
+/* hold back data with a min-threshold of 4 buffers
+ * push a list of 3 buffers
+ * check the levels count every buffer of the list
+ * release the threshold
+ * check the list arrives downstream in one piece
+ */
+GST_START_TEST (test_buffer_list)
+{
+  GstElement *queue;
+  GstBufferList *list;
+  GstBufferListIterator *it;
+  GstBuffer *buffer;
+  guint level_buffers, level_bytes;
+  guint64 level_time;
+  gint i;
+
+  queue = setup_queue ();
+  mysrcpad = gst_check_setup_src_pad (queue, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate, NULL);
+  gst_pad_set_chain_list_function (mysinkpad, chain_list_func);
+  g_object_set (G_OBJECT (queue), "min-threshold-buffers", 4, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  list = gst_buffer_list_new ();
+  it = gst_buffer_list_iterate (list);
+  gst_buffer_list_iterator_add_group (it);
+  for (i = 0; i < 3; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_SECOND;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND;
+    gst_buffer_list_iterator_add (it, buffer);
+  }
+  gst_buffer_list_iterator_free (it);
+
+  fail_unless (gst_pad_push_list (mysrcpad, list) == GST_FLOW_OK);
+
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      "current-level-bytes", &level_bytes, "current-level-time", &level_time,
+      NULL);
+  fail_unless_equals_int (level_buffers, 3);
+  fail_unless_equals_int (level_bytes, 12);
+  fail_unless_equals_uint64 (level_time, 3 * GST_SECOND);
+
+  g_mutex_lock (check_mutex);
+  g_object_set (G_OBJECT (queue), "min-threshold-buffers", 0, NULL);
+  while (received_list == NULL)
+    g_cond_wait (check_cond, check_mutex);
+  g_mutex_unlock (check_mutex);
+
+  gst_pad_set_active (mysinkpad, FALSE);
+
+  fail_unless (received_list == list);
+  fail_unless_equals_int (gst_buffer_list_n_groups (received_list), 1);
+  fail_unless (g_list_length (buffers) == 0);
+
+  /* cleanup */
+  gst_buffer_list_unref (received_list);
+  received_list = NULL;
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (queue);
+  gst_check_teardown_sink_pad (queue);
+  cleanup_queue (queue);
+}
+
+GST_END_TEST;
+
+/* lock-free mode
+ * hold back data with a min-threshold of 10 buffers
+ * push 5 buffers
+ * check the levels
+ * release the threshold and push 100 more buffers
+ * check they all arrive in order
+ */
+GST_START_TEST (test_lock_free)
+{
+  GstElement *queue;
+  GstBuffer *buffer;
+  guint level_buffers, level_bytes;
+  guint64 level_time;
+  GList *l;
+  gint i;
+
+  queue = setup_queue ();
+  mysrcpad = gst_check_setup_src_pad (queue, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate, NULL);
+  g_object_set (G_OBJECT (queue), "lock-free", TRUE, "max-size-time",
+      G_GUINT64_CONSTANT (0), "min-threshold-buffers", 10, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  for (i = 0; i < 5; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_SECOND;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  g_object_get (G_OBJECT (queue), "current-level-buffers", &level_buffers,
+      "current-level-bytes", &level_bytes, "current-level-time", &level_time,
+      NULL);
+  fail_unless_equals_int (level_buffers, 5);
+  fail_unless_equals_int (level_bytes, 20);
+  fail_unless_equals_uint64 (level_time, 5 * GST_SECOND);
+  fail_unless (buffers == NULL);
+
+  g_object_set (G_OBJECT (queue), "min-threshold-buffers", 0, NULL);
+
+  for (i = 5; i < 105; i++) {
+    buffer = gst_buffer_new_and_alloc (4);
+    GST_BUFFER_TIMESTAMP (buffer) = i * GST_SECOND;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+
+  g_mutex_lock (check_mutex);
+  while (g_list_length (buffers) < 105)
+    g_cond_wait (check_cond, check_mutex);
+  g_mutex_unlock (check_mutex);
+
+  for (l = buffers, i = 0; l; l = l->next, i++)
+    fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (l->data),
+        i * GST_SECOND);
+  gst_check_drop_buffers ();
+
+  /* cleanup */
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (queue);
+  gst_check_teardown_sink_pad (queue);
+  cleanup_queue (queue);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -442,6 +598,8 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_leaky_upstream);
   tcase_add_test (tc_chain, test_leaky_downstream);
   tcase_add_test (tc_chain, test_time_level);
+  tcase_add_test (tc_chain, test_buffer_list);
+  tcase_add_test (tc_chain, test_lock_free);
 
   return s;
 }
@@ -0,0 +1,280 @@
+/* GStreamer unit tests for queue2
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* the stream has the byte offset % 251 at every offset */
+static GstBuffer *
+make_buffer (guint64 offset, guint size)
+{
+  GstBuffer *buf;
+  guint i;
+
+  buf = gst_buffer_new_and_alloc (size);
+  for (i = 0; i < size; i++)
+    GST_BUFFER_DATA (buf)[i] = (offset + i) % 251;
+  GST_BUFFER_OFFSET (buf) = offset;
+
+  return buf;
+}
+
+static void
+check_buffer (GstBuffer * buf, guint64 offset, guint size)
+{
+  guint i;
+
+  fail_unless_equals_int (GST_BUFFER_SIZE (buf), size);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+  for (i = 0; i < size; i++)
+    fail_unless_equals_int (GST_BUFFER_DATA (buf)[i], (offset + i) % 251);
+}
+
+static guint64 received;
+
+static void
+handoff_cb (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  guint i;
+
+  /* fakesrc fills the buffers with a pattern that spans buffers */
+  for (i = 0; i < GST_BUFFER_SIZE (buf); i++)
+    fail_unless_equals_int (GST_BUFFER_DATA (buf)[i], (received + i) & 0xff);
+  received += GST_BUFFER_SIZE (buf);
+}
+
+GST_START_TEST (test_ring_buffer_push)
+{
+  GstElement *pipe, *src, *queue, *sink;
+  GstMessage *msg;
+  GstBus *bus;
+
+  pipe = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("fakesrc", NULL);
+  queue = gst_element_factory_make ("queue2", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (pipe && src && queue && sink);
+
+  g_object_set (src, "num-buffers", 200, "sizemax", 1000, NULL);
+  gst_util_set_object_arg (G_OBJECT (src), "sizetype", "fixed");
+  gst_util_set_object_arg (G_OBJECT (src), "filltype", "pattern-span");
+  /* the stream is 20 times bigger than the ring buffer */
+  g_object_set (queue, "ring-buffer-max-size", (guint64) 10000, NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (handoff_cb), NULL);
+
+  gst_bin_add_many (GST_BIN (pipe), src, queue, sink, NULL);
+  fail_unless (gst_element_link_many (src, queue, sink, NULL));
+
+  received = 0;
+  fail_unless (gst_element_set_state (pipe,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  bus = gst_element_get_bus (pipe);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, 10 * GST_SECOND);
+  fail_unless (msg != NULL, "timeout waiting for EOS");
+  fail_unless_equals_string (GST_MESSAGE_TYPE_NAME (msg), "eos");
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  fail_unless_equals_uint64 (received, 200 * 1000);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
+static GMutex *seek_lock;
+static GCond *seek_cond;
+static gint n_seeks;
+static gint64 seek_offset;
+
+/* plays the seekable source upstream of the queue */
+static gboolean
+src_event_func (GstPad * pad, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    GstFormat format;
+    gint64 start;
+
+    gst_event_parse_seek (event, NULL, &format, NULL, NULL, &start, NULL,
+        NULL);
+    fail_unless_equals_int (format, GST_FORMAT_BYTES);
+
+    gst_pad_push_event (pad, gst_event_new_flush_start ());
+    gst_pad_push_event (pad, gst_event_new_flush_stop ());
+
+    g_mutex_lock (seek_lock);
+    seek_offset = start;
+    n_seeks++;
+    g_cond_signal (seek_cond);
+    g_mutex_unlock (seek_lock);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+/* get the start of the cached bytes that contain @offset */
+static gint64
+query_cached_start (GstElement * queue, gint64 offset)
+{
+  GstQuery *query;
+  gint64 start;
+
+  query = gst_query_new_buffering (GST_FORMAT_BYTES);
+  gst_query_set_buffering_range (query, GST_FORMAT_BYTES, offset, -1, -1);
+  fail_unless (gst_element_query (queue, query));
+  gst_query_parse_buffering_range (query, NULL, &start, NULL, NULL);
+  gst_query_unref (query);
+
+  return start;
+}
+
+static GstBuffer *pulled;
+
+static gpointer
+pull_thread (gpointer data)
+{
+  guint64 offset = GPOINTER_TO_UINT (data);
+
+  fail_unless (gst_pad_pull_range (mysinkpad, offset, 1024,
+          &pulled) == GST_FLOW_OK);
+
+  return NULL;
+}
+
+static void
+pull_and_check (guint64 offset, guint size)
+{
+  GstBuffer *buf = NULL;
+
+  fail_unless (gst_pad_pull_range (mysinkpad, offset, size,
+          &buf) == GST_FLOW_OK);
+  check_buffer (buf, offset, size);
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (test_ring_buffer_pull)
+{
+  GstElement *queue;
+  GstPad *sinkpad;
+  GThread *thread;
+  guint64 offset;
+
+  seek_lock = g_mutex_new ();
+  seek_cond = g_cond_new ();
+  n_seeks = 0;
+
+  queue = gst_check_setup_element ("queue2");
+  g_object_set (queue, "ring-buffer-max-size", (guint64) 16384,
+      "max-size-bytes", 0, NULL);
+  mysrcpad = gst_check_setup_src_pad (queue, &srctemplate, NULL);
+  gst_pad_set_event_function (mysrcpad, src_event_func);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate, NULL);
+
+  sinkpad = gst_element_get_static_pad (queue, "sink");
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_activate_pull (mysinkpad, TRUE));
+
+  /* download the first 8192 bytes */
+  for (offset = 0; offset < 8192; offset += 1024)
+    fail_unless (gst_pad_push (mysrcpad, make_buffer (offset,
+                1024)) == GST_FLOW_OK);
+
+  /* reading what we have does not seek */
+  pull_and_check (0, 1024);
+  pull_and_check (4096, 2048);
+  fail_unless_equals_int (n_seeks, 0);
+
+  /* reading far away seeks there and waits for the data */
+  g_mutex_lock (seek_lock);
+  thread = g_thread_create (pull_thread, GUINT_TO_POINTER (500000), TRUE,
+      NULL);
+  while (n_seeks == 0)
+    g_cond_wait (seek_cond, seek_lock);
+  g_mutex_unlock (seek_lock);
+  fail_unless_equals_uint64 (seek_offset, 500000);
+
+  /* wait until the queue made the new range before we download into it */
+  while (query_cached_start (queue, 500000) != 500000)
+    g_usleep (1000);
+  for (offset = 500000; offset < 503072; offset += 1024)
+    fail_unless (gst_pad_push (mysrcpad, make_buffer (offset,
+                1024)) == GST_FLOW_OK);
+
+  g_thread_join (thread);
+  check_buffer (pulled, 500000, 1024);
+  gst_buffer_unref (pulled);
+
+  /* the start is still cached, reading it only seeks to download what
+   * follows it */
+  pull_and_check (0, 1024);
+  fail_unless_equals_int (n_seeks, 2);
+  fail_unless_equals_uint64 (seek_offset, 8192);
+
+  /* and so is the data we downloaded last */
+  pull_and_check (500000, 1024);
+  fail_unless_equals_int (n_seeks, 3);
+  fail_unless_equals_uint64 (seek_offset, 503072);
+  fail_unless_equals_int (query_cached_start (queue, 500512), 500000);
+
+  fail_unless (gst_pad_activate_pull (mysinkpad, FALSE));
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_object_unref (sinkpad);
+
+  gst_check_teardown_src_pad (queue);
+  gst_check_teardown_sink_pad (queue);
+  gst_check_teardown_element (queue);
+
+  g_mutex_free (seek_lock);
+  g_cond_free (seek_cond);
+}
+
+GST_END_TEST;
+
+static Suite *
+queue2_suite (void)
+{
+  Suite *s = suite_create ("queue2");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_ring_buffer_push);
+  tcase_add_test (tc_chain, test_ring_buffer_pull);
+
+  return s;
+}
+
+GST_CHECK_MAIN (queue2)
@@ -451,6 +451,107 @@ GST_START_TEST (test_try_new_and_alloc)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pooled_alloc)
+{
+  GstBufferPoolStats stats, after;
+  GstBuffer *buf;
+  guint8 *data;
+  gint i;
+
+  gst_buffer_pool_trim ();
+  gst_buffer_pool_get_stats (&stats);
+
+  /* the first allocation of a size needs new memory */
+  buf = gst_buffer_new_and_alloc_pooled (640 * 480 * 3 / 2);
+  fail_unless (GST_BUFFER_SIZE (buf) == 640 * 480 * 3 / 2);
+  fail_unless (GST_BUFFER_DATA (buf) != NULL);
+  fail_unless (GST_BUFFER_DATA (buf) == GST_BUFFER_MALLOCDATA (buf));
+  data = GST_BUFFER_DATA (buf);
+  memset (data, 0xff, GST_BUFFER_SIZE (buf));
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_get_stats (&after);
+  fail_unless_equals_int (after.misses - stats.misses, 1);
+  fail_unless_equals_int (after.hits - stats.hits, 0);
+
+  /* after that the memory is recycled, also for slightly different sizes
+   * and for sub-buffers outliving their parent */
+  for (i = 0; i < 10; i++) {
+    GstBuffer *sub;
+
+    buf = gst_buffer_new_and_alloc_pooled (640 * 480 * 3 / 2 - i);
+    fail_unless (GST_BUFFER_DATA (buf) == data);
+    sub = gst_buffer_create_sub (buf, 1, 100);
+    gst_buffer_unref (buf);
+    gst_buffer_unref (sub);
+  }
+
+  gst_buffer_pool_get_stats (&after);
+  fail_unless_equals_int (after.misses - stats.misses, 1);
+  fail_unless_equals_int (after.hits - stats.hits, 10);
+
+  /* trimming gives the memory back */
+  gst_buffer_pool_trim ();
+  gst_buffer_pool_get_stats (&after);
+  fail_unless_equals_int (after.frees - stats.frees, 1);
+  fail_unless_equals_int (after.cached, 0);
+
+  /* sizes outside of the pool still work */
+  buf = gst_buffer_try_new_and_alloc_pooled (0);
+  fail_unless (buf != NULL);
+  fail_unless (GST_BUFFER_DATA (buf) == NULL);
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_try_new_and_alloc_pooled (7);
+  fail_unless (buf != NULL);
+  fail_unless (GST_BUFFER_SIZE (buf) == 7);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+/* freed buffers are reused by gst_buffer_new(), check that nothing of their
+ * previous life shows */
+GST_START_TEST (test_recycled_buffer)
+{
+  GstBuffer *buf, *sub;
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_from_string ("audio/x-raw-int");
+  for (i = 0; i < 100; i++) {
+    buf = gst_buffer_new_and_alloc (16);
+    GST_BUFFER_TIMESTAMP (buf) = i;
+    GST_BUFFER_DURATION (buf) = 1;
+    GST_BUFFER_OFFSET (buf) = i;
+    GST_BUFFER_OFFSET_END (buf) = i + 1;
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    gst_buffer_set_caps (buf, caps);
+    sub = gst_buffer_create_sub (buf, 4, 8);
+    gst_buffer_unref (buf);
+    gst_buffer_unref (sub);
+
+    buf = gst_buffer_new ();
+    ASSERT_BUFFER_REFCOUNT (buf, "buf", 1);
+    fail_unless (GST_BUFFER_DATA (buf) == NULL);
+    fail_unless (GST_BUFFER_MALLOCDATA (buf) == NULL);
+    fail_unless (GST_BUFFER_SIZE (buf) == 0);
+    fail_unless (GST_BUFFER_CAPS (buf) == NULL);
+    fail_unless (GST_BUFFER_FLAGS (buf) == 0);
+    fail_unless (GST_BUFFER_TIMESTAMP (buf) == GST_CLOCK_TIME_NONE);
+    fail_unless (GST_BUFFER_DURATION (buf) == GST_CLOCK_TIME_NONE);
+    fail_unless (GST_BUFFER_OFFSET (buf) == GST_BUFFER_OFFSET_NONE);
+    fail_unless (GST_BUFFER_OFFSET_END (buf) == GST_BUFFER_OFFSET_NONE);
+    fail_unless (GST_BUFFER_FREE_FUNC (buf) == g_free);
+    fail_unless (buf->parent == NULL);
+    gst_buffer_unref (buf);
+  }
+  ASSERT_CAPS_REFCOUNT (caps, "caps", 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_suite (void)
 {
@@ -467,6 +568,8 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_metadata_writable);
   tcase_add_test (tc_chain, test_copy);
   tcase_add_test (tc_chain, test_try_new_and_alloc);
+  tcase_add_test (tc_chain, test_pooled_alloc);
+  tcase_add_test (tc_chain, test_recycled_buffer);
 
   return s;
 }
@@ -728,6 +728,64 @@ GST_START_TEST (test_intersect2)
 
 GST_END_TEST;
 
+GST_START_TEST (test_intersect_cached)
+{
+  GstCaps *caps1, *caps2, *icaps1, *icaps2, *icaps3;
+  GstStructure *s;
+
+  caps1 = gst_caps_from_string ("video/x-raw-yuv, width=(int)[1, 1000]; "
+      "video/x-raw-rgb, width=(int)[1, 1000]; audio/x-raw-int");
+  caps2 = gst_caps_from_string ("video/x-raw-yuv, width=(int)320; "
+      "video/x-raw-rgb, width=(int)320");
+
+  /* the second time the result comes from the cache */
+  icaps1 = gst_caps_intersect (caps1, caps2);
+  icaps2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (icaps1 != icaps2);
+  fail_unless (gst_caps_get_size (icaps1) == 2, NULL);
+  fail_unless (gst_caps_is_equal (icaps1, icaps2));
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_unless (gst_caps_is_subset (caps2, caps1));
+  fail_unless (gst_caps_is_subset (caps2, caps1));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+
+  /* changing the returned caps does not change the cached ones */
+  s = gst_caps_get_structure (icaps2, 0);
+  gst_structure_set (s, "width", G_TYPE_INT, 640, NULL);
+  icaps3 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (icaps1, icaps3));
+  gst_caps_unref (icaps2);
+  gst_caps_unref (icaps3);
+
+  /* neither does changing the operands */
+  s = gst_caps_get_structure (caps2, 0);
+  gst_structure_set (s, "width", G_TYPE_INT, 2000, NULL);
+  icaps2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_get_size (icaps2) == 1, NULL);
+  fail_if (gst_caps_is_equal (icaps1, icaps2));
+  fail_if (gst_caps_is_subset (caps2, caps1));
+
+  gst_caps_unref (icaps1);
+  gst_caps_unref (icaps2);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+
+  /* identical fixed caps */
+  caps1 = gst_caps_from_string ("video/x-raw-yuv, width=(int)320, "
+      "height=(int)240, framerate=(fraction)25/1");
+  caps2 = gst_caps_copy (caps1);
+  icaps1 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (icaps1, caps1));
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  fail_unless (gst_caps_is_subset (caps1, caps2));
+  gst_caps_unref (icaps1);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_caps_suite (void)
 {
@@ -747,6 +805,7 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_merge_subset);
   tcase_add_test (tc_chain, test_intersect);
   tcase_add_test (tc_chain, test_intersect2);
+  tcase_add_test (tc_chain, test_intersect_cached);
 
   return s;
 }
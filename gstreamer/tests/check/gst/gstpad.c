@@ -980,6 +980,68 @@ GST_START_TEST (test_block_async_replace_callback_no_flush)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pad_stats)
+{
+  GstPad *src, *sink;
+  GstPadStats stats;
+  guint64 hist;
+  gint i;
+
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_if (sink == NULL);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  fail_if (src == NULL);
+
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  /* nothing is collected while disabled */
+  fail_if (gst_pad_stats_get_enabled ());
+  fail_unless (gst_pad_push (src, gst_buffer_new_and_alloc (10)) ==
+      GST_FLOW_OK);
+  fail_if (gst_pad_get_stats (src, &stats));
+  fail_if (gst_pad_get_stats (sink, &stats));
+
+  gst_pad_stats_set_enabled (TRUE);
+  fail_unless (gst_pad_stats_get_enabled ());
+  for (i = 0; i < 3; i++)
+    fail_unless (gst_pad_push (src, gst_buffer_new_and_alloc (10)) ==
+        GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 4);
+
+  fail_unless (gst_pad_get_stats (src, &stats));
+  fail_unless_equals_uint64 (stats.buffers, 3);
+  fail_unless_equals_uint64 (stats.bytes, 30);
+  for (hist = 0, i = 0; i < GST_PAD_STATS_HISTOGRAM_SIZE; i++)
+    hist += stats.histogram[i];
+  fail_unless_equals_uint64 (hist, 3);
+
+  fail_unless (gst_pad_get_stats (sink, &stats));
+  fail_unless_equals_uint64 (stats.buffers, 3);
+  fail_unless_equals_uint64 (stats.bytes, 30);
+
+  gst_pad_reset_stats (src);
+  fail_unless (gst_pad_get_stats (src, &stats));
+  fail_unless_equals_uint64 (stats.buffers, 0);
+  fail_unless_equals_uint64 (stats.bytes, 0);
+
+  /* disabling keeps the values collected so far */
+  gst_pad_stats_set_enabled (FALSE);
+  fail_unless (gst_pad_push (src, gst_buffer_new_and_alloc (10)) ==
+      GST_FLOW_OK);
+  fail_unless (gst_pad_get_stats (sink, &stats));
+  fail_unless_equals_uint64 (stats.buffers, 3);
+
+  gst_check_drop_buffers ();
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_pad_suite (void)
@@ -1011,6 +1073,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy);
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
+  tcase_add_test (tc_chain, test_pad_stats);
 
   return s;
 }
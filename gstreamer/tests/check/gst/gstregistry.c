@@ -203,6 +203,92 @@ GST_START_TEST (test_registry_update)
 
 GST_END_TEST;
 
+typedef GstElement GstMediaTypeTest;
+typedef GstElementClass GstMediaTypeTestClass;
+
+static GstStaticPadTemplate media_type_test_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-registry-test, rate = (int) 44100; "
+        "video/x-registry-test"));
+
+GST_BOILERPLATE (GstMediaTypeTest, gst_media_type_test, GstElement,
+    GST_TYPE_ELEMENT);
+
+static void
+gst_media_type_test_base_init (gpointer g_class)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&media_type_test_sink_template));
+  gst_element_class_set_details_simple (element_class, "Media type test",
+      "Testing", "Sink with test caps", "GStreamer");
+}
+
+static void
+gst_media_type_test_class_init (GstMediaTypeTestClass * klass)
+{
+}
+
+static void
+gst_media_type_test_init (GstMediaTypeTest * element,
+    GstMediaTypeTestClass * klass)
+{
+}
+
+static gboolean
+feature_list_has (GList * list, const gchar * name)
+{
+  for (; list; list = list->next) {
+    if (strcmp (GST_PLUGIN_FEATURE_NAME (list->data), name) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+GST_START_TEST (test_registry_media_type)
+{
+  GstRegistry *registry = gst_registry_get_default ();
+  GstPluginFeature *feature;
+  GList *list;
+
+  fail_unless (gst_element_register (NULL, "mediatypetest", GST_RANK_NONE,
+          gst_media_type_test_get_type ()));
+
+  list = gst_registry_get_feature_list_by_media_type (registry,
+      "audio/x-registry-test");
+  fail_unless_equals_int (g_list_length (list), 1);
+  fail_unless (feature_list_has (list, "mediatypetest"));
+  gst_plugin_feature_list_free (list);
+
+  list = gst_registry_get_feature_list_by_media_type (registry,
+      "video/x-registry-test");
+  fail_unless (feature_list_has (list, "mediatypetest"));
+  gst_plugin_feature_list_free (list);
+
+  list = gst_registry_get_feature_list_by_media_type (registry,
+      "audio/x-registry-nothing");
+  fail_unless (list == NULL);
+
+  /* features of the cache are still found by name, and only once */
+  feature = gst_registry_lookup_feature (registry, "identity");
+  fail_unless (feature != NULL);
+  fail_unless (GST_IS_ELEMENT_FACTORY (feature));
+  gst_object_unref (feature);
+
+  list = gst_registry_get_feature_list (registry, GST_TYPE_ELEMENT_FACTORY);
+  fail_unless (feature_list_has (list, "identity"));
+  fail_unless (feature_list_has (list, "mediatypetest"));
+  gst_plugin_feature_list_free (list);
+
+  list = gst_registry_get_feature_list_by_plugin (registry, "coreelements");
+  fail_unless (feature_list_has (list, "identity"));
+  fail_unless (feature_list_has (list, "filesrc"));
+  gst_plugin_feature_list_free (list);
+}
+
+GST_END_TEST;
+
 static Suite *
 registry_suite (void)
 {
@@ -212,6 +298,7 @@ registry_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_registry_update);
+  tcase_add_test (tc_chain, test_registry_media_type);
 
   return s;
 }
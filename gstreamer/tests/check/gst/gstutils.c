@@ -948,6 +948,13 @@ GST_END_TEST;
 #endif
 #endif
 
+GST_START_TEST (test_num_cpus)
+{
+  fail_unless (gst_util_get_num_cpus () >= 1);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_utils_suite (void)
 {
@@ -978,6 +985,7 @@ gst_utils_suite (void)
   tcase_add_test (tc_chain, test_element_unlink);
   tcase_add_test (tc_chain, test_set_value_from_string);
   tcase_add_test (tc_chain, test_binary_search);
+  tcase_add_test (tc_chain, test_num_cpus);
   return s;
 }
 
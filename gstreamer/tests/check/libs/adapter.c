@@ -22,6 +22,8 @@
 
 #include <gst/check/gstcheck.h>
 
+#include <string.h>
+
 #include <gst/base/gstadapter.h>
 
 /* does some implementation dependent checking that should 
@@ -601,6 +603,84 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+/* pushes buffers of 10, 20 and 30 bytes holding the values 0 to 59 */
+static GstAdapter *
+create_adapter_with_sizes (GstBuffer * bufs[3])
+{
+  static const guint sizes[3] = { 10, 20, 30 };
+  GstAdapter *adapter;
+  guint i, j, val = 0;
+
+  adapter = gst_adapter_new ();
+  for (i = 0; i < 3; i++) {
+    bufs[i] = gst_buffer_new_and_alloc (sizes[i]);
+    for (j = 0; j < sizes[i]; j++)
+      GST_BUFFER_DATA (bufs[i])[j] = val++;
+    gst_adapter_push (adapter, gst_buffer_ref (bufs[i]));
+  }
+
+  return adapter;
+}
+
+GST_START_TEST (test_peek_spans)
+{
+  GstAdapter *adapter;
+  GstBuffer *bufs[3];
+  GstAdapterSpan spans[3];
+  guint n, i;
+
+  adapter = create_adapter_with_sizes (bufs);
+
+  /* a range inside the first buffer */
+  n = gst_adapter_peek_spans (adapter, 2, 8, spans, 3);
+  fail_unless_equals_int (n, 1);
+  fail_unless (spans[0].data == GST_BUFFER_DATA (bufs[0]) + 2);
+  fail_unless_equals_int (spans[0].size, 8);
+
+  /* a range over all buffers, pointing into them */
+  n = gst_adapter_peek_spans (adapter, 5, 40, spans, 3);
+  fail_unless_equals_int (n, 3);
+  fail_unless (spans[0].data == GST_BUFFER_DATA (bufs[0]) + 5);
+  fail_unless_equals_int (spans[0].size, 5);
+  fail_unless (spans[1].data == GST_BUFFER_DATA (bufs[1]));
+  fail_unless_equals_int (spans[1].size, 20);
+  fail_unless (spans[2].data == GST_BUFFER_DATA (bufs[2]));
+  fail_unless_equals_int (spans[2].size, 15);
+
+  /* a short array only gets the first spans, but the count is complete */
+  memset (spans, 0, sizeof (spans));
+  n = gst_adapter_peek_spans (adapter, 5, 40, spans, 1);
+  fail_unless_equals_int (n, 3);
+  fail_unless_equals_int (spans[0].size, 5);
+  fail_unless_equals_int (spans[1].size, 0);
+  fail_unless_equals_int (gst_adapter_peek_spans (adapter, 0, 60, NULL, 0), 3);
+
+  /* not enough data */
+  fail_unless_equals_int (gst_adapter_peek_spans (adapter, 0, 61, spans, 3),
+      0);
+  fail_unless_equals_int (gst_adapter_peek_spans (adapter, 59, 2, spans, 3),
+      0);
+
+  /* offsets are relative to what was flushed already */
+  gst_adapter_flush (adapter, 12);
+  n = gst_adapter_peek_spans (adapter, 17, 2, spans, 3);
+  fail_unless_equals_int (n, 2);
+  fail_unless_equals_int (spans[0].data[0], 29);
+  fail_unless_equals_int (spans[0].size, 1);
+  fail_unless_equals_int (spans[1].data[0], 30);
+  fail_unless_equals_int (spans[1].size, 1);
+
+  /* nothing was merged */
+  for (i = 0; i < 3; i++)
+    ASSERT_BUFFER_REFCOUNT (bufs[i], "buf", i == 0 ? 1 : 2);
+
+  g_object_unref (adapter);
+  for (i = 0; i < 3; i++)
+    gst_buffer_unref (bufs[i]);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_adapter_suite (void)
 {
@@ -618,6 +698,7 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_take_buf_order);
   tcase_add_test (tc_chain, test_timestamp);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_peek_spans);
 
   return s;
 }
@@ -73,6 +73,117 @@ GST_START_TEST (test_buffer_range)
 
 GST_END_TEST;
 
+static GstStaticCaps match_caps = GST_STATIC_CAPS ("sig/x-match");
+
+static void
+match_typefind (GstTypeFind * tf, gpointer unused)
+{
+  gst_type_find_suggest (tf, GST_TYPE_FIND_MAXIMUM,
+      gst_static_caps_get (&match_caps));
+}
+
+static void
+skip_typefind (GstTypeFind * tf, gpointer unused)
+{
+  fail ("typefind function called for data not matching its signature");
+}
+
+/* make sure functions are only called for data that matches their signature */
+GST_START_TEST (test_signature)
+{
+  GstBuffer *buf;
+  GstCaps *caps;
+
+  fail_unless (gst_type_find_register_with_signature (NULL, "sig/x-skip",
+          GST_RANK_PRIMARY + 70, skip_typefind, NULL, NULL, NULL, NULL,
+          0, (const guint8 *) "OggS", 4));
+  fail_unless (gst_type_find_register_with_signature (NULL, "sig/x-skip2",
+          GST_RANK_PRIMARY + 70, skip_typefind, NULL, NULL, NULL, NULL,
+          1, (const guint8 *) "vorbix", 6));
+  fail_unless (gst_type_find_register_with_signature (NULL, "sig/x-skip3",
+          GST_RANK_PRIMARY + 70, skip_typefind, NULL, NULL, NULL, NULL,
+          28, (const guint8 *) "\001\002\003", 3));
+  fail_unless (gst_type_find_register_with_signature (NULL, "sig/x-match",
+          GST_RANK_PRIMARY + 60, match_typefind, NULL, NULL, NULL, NULL,
+          1, (const guint8 *) "vorbis", 6));
+
+  buf = gst_buffer_new ();
+  fail_unless (buf != NULL);
+  GST_BUFFER_DATA (buf) = (guint8 *) vorbisid;
+  GST_BUFFER_SIZE (buf) = 30;
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_READONLY);
+
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "sig/x-match"));
+
+  gst_caps_unref (caps);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+static GstStaticCaps late_caps = GST_STATIC_CAPS ("late/x-match");
+
+static void
+late_typefind (GstTypeFind * tf, gpointer unused)
+{
+  gst_type_find_suggest (tf, GST_TYPE_FIND_MAXIMUM,
+      gst_static_caps_get (&late_caps));
+}
+
+static gboolean
+register_late_typefinders (GstPlugin * plugin)
+{
+  return gst_type_find_register_with_signature (plugin, "late/x-match",
+      GST_RANK_PRIMARY + 80, late_typefind, NULL, NULL, NULL, NULL,
+      1, (const guint8 *) "vorbis", 6);
+}
+
+/* make sure typefinders of a plugin loaded after a first typefind are used
+ * by later ones in the same process */
+GST_START_TEST (test_plugin_loaded_later)
+{
+  GstBuffer *buf;
+  GstCaps *caps;
+
+  buf = gst_buffer_new ();
+  fail_unless (buf != NULL);
+  GST_BUFFER_DATA (buf) = (guint8 *) vorbisid;
+  GST_BUFFER_SIZE (buf) = 30;
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_READONLY);
+
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  if (caps != NULL) {
+    fail_if (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+            "late/x-match"));
+    gst_caps_unref (caps);
+  }
+
+  fail_unless (gst_plugin_register_static (GST_VERSION_MAJOR,
+          GST_VERSION_MINOR, "late-typefinders", "late typefinders",
+          register_late_typefinders, VERSION, GST_LICENSE, PACKAGE,
+          GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN));
+
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "late/x-match"));
+  gst_caps_unref (caps);
+
+  /* and once more with the rebuilt dispatcher */
+  caps = gst_type_find_helper_for_buffer (NULL, buf, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "late/x-match"));
+  gst_caps_unref (caps);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_typefindhelper_suite (void)
 {
@@ -81,6 +192,8 @@ gst_typefindhelper_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_buffer_range);
+  tcase_add_test (tc_chain, test_signature);
+  tcase_add_test (tc_chain, test_plugin_loaded_later);
 
   return s;
 }
@@ -22,8 +22,9 @@
 # include "internal.h"
 # include "bitpack.h"
 
-typedef struct th_setup_info oc_setup_info;
-typedef struct th_dec_ctx    oc_dec_ctx;
+typedef struct th_setup_info      oc_setup_info;
+typedef struct th_dec_ctx         oc_dec_ctx;
+typedef struct oc_dec_thread_pool oc_dec_thread_pool;
 
 # include "huffdec.h"
 # include "dequant.h"
@@ -33,6 +34,30 @@ typedef struct th_dec_ctx    oc_dec_ctx;
 /*Next packet to read: Data packet.*/
 #define OC_PACKET_DATA (0)
 
+/*Reconstruct frames with a pool of worker threads on platforms that have
+   them.*/
+#if !defined(OC_DISABLE_THREADS)&& \
+ (defined(_WIN32)||defined(__unix__)||defined(__APPLE__))
+# define OC_DEC_THREADS (1)
+#endif
+
+/*The maximum number of threads th_decode_ctl() will accept.*/
+#define OC_DEC_THREADS_MAX (16)
+
+#if !defined(TH_DECCTL_SET_THREADS)
+/*Sets the number of threads used to decode each frame, including the calling
+   thread.
+  \param[in] _buf <tt>int</tt>: The number of threads, from 1 (the default,
+   decode in the calling thread only) up to #OC_DEC_THREADS_MAX.
+  \retval TH_EFAULT \a _dec_ctx or \a _buf is <tt>NULL</tt>, or the worker
+   threads could not be started.
+  \retval TH_EINVAL \a _buf_sz is not <tt>sizeof(int)</tt>, or the number of
+   threads is out of range.
+  \retval TH_EIMPL   Multi-threaded decoding is not supported by this
+   build.*/
+# define TH_DECCTL_SET_THREADS (17)
+#endif
+
 
 
 struct th_setup_info{
@@ -87,6 +112,11 @@ struct th_dec_ctx{
   th_ycbcr_buffer      pp_frame_buf;
   /*The striped decode callback function.*/
   th_stripe_callback   stripe_cb;
+  /*The number of threads used to decode each frame, including the calling
+     thread.*/
+  int                  nthreads;
+  /*The worker threads, if there are any.*/
+  oc_dec_thread_pool  *thread_pool;
 # if defined(HAVE_CAIRO)
   /*Output metrics for debugging.*/
   int                  telemetry;
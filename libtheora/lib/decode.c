@@ -26,6 +26,13 @@
 #if defined(HAVE_CAIRO)
 # include <cairo.h>
 #endif
+#if defined(OC_DEC_THREADS)
+# if defined(_WIN32)
+#  include <windows.h>
+# else
+#  include <pthread.h>
+# endif
+#endif
 
 
 /*No post-processing.*/
@@ -412,6 +419,8 @@ static int oc_dec_init(oc_dec_ctx *_dec,const th_info *_info,
   _dec->pp_frame_data=NULL;
   _dec->stripe_cb.ctx=NULL;
   _dec->stripe_cb.stripe_decoded=NULL;
+  _dec->nthreads=1;
+  _dec->thread_pool=NULL;
 #if defined(HAVE_CAIRO)
   _dec->telemetry=0;
   _dec->telemetry_bits=0;
@@ -1492,45 +1501,41 @@ static void oc_dec_dc_unpredict_mcu_plane(oc_dec_ctx *_dec,
    (fragy_end-fragy0)*(ptrdiff_t)nhfrags-ncoded_fragis;
 }
 
-/*Reconstructs all coded fragments in a single MCU (one or two super block
-   rows).
-  This requires that each coded fragment have a proper macro block mode and
-   motion vector (if not in INTRA mode), and have it's DC value decoded, with
-   the DC prediction process reversed, and the number of coded and uncoded
-   fragments in this plane of the MCU be counted.
-  The token lists for each color plane and coefficient should also be filled
-   in, along with initial token offsets, extra bits offsets, and EOB run
-   counts.*/
-static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
- oc_dec_pipeline_state *_pipe,int _pli){
+/*Reconstructs a list of coded fragments in a single plane.
+  The token indices and EOB run counts for the plane are advanced past the
+   tokens consumed.
+  If _coeffs is not NULL, the reconstruction itself is deferred: the
+   dequantized coefficients of each fragment are stored in consecutive blocks
+   of 64 (plus one extra element at the end) and its last coded zig-zag index
+   in _last_zzis, to be passed to oc_state_frag_recon() later.*/
+static void oc_dec_frags_recon(oc_dec_ctx *_dec,
+ const oc_dec_pipeline_state *_pipe,int _pli,const ptrdiff_t *_coded_fragis,
+ ptrdiff_t _ncoded_fragis,ptrdiff_t _ti[64],ptrdiff_t _eob_runs[64],
+ ogg_int16_t *_coeffs,unsigned char *_last_zzis){
   unsigned char       *dct_tokens;
   const unsigned char *dct_fzig_zag;
   ogg_uint16_t         dc_quant[2];
   const oc_fragment   *frags;
-  const ptrdiff_t     *coded_fragis;
-  ptrdiff_t            ncoded_fragis;
   ptrdiff_t            fragii;
-  ptrdiff_t           *ti;
-  ptrdiff_t           *eob_runs;
   int                  qti;
   dct_tokens=_dec->dct_tokens;
   dct_fzig_zag=_dec->state.opt_data.dct_fzig_zag;
   frags=_dec->state.frags;
-  coded_fragis=_pipe->coded_fragis[_pli];
-  ncoded_fragis=_pipe->ncoded_fragis[_pli];
-  ti=_pipe->ti[_pli];
-  eob_runs=_pipe->eob_runs[_pli];
   for(qti=0;qti<2;qti++)dc_quant[qti]=_pipe->dequant[_pli][0][qti][0];
-  for(fragii=0;fragii<ncoded_fragis;fragii++){
+  for(fragii=0;fragii<_ncoded_fragis;fragii++){
     /*This array is made one element larger because the zig-zag index array
        uses the final element as a dumping ground for out-of-range indices
        to protect us from buffer overflow.*/
-    OC_ALIGN8(ogg_int16_t dct_coeffs[65]);
+    OC_ALIGN16(ogg_int16_t dct_buf[65]);
+    ogg_int16_t        *dct_coeffs;
     const ogg_uint16_t *ac_quant;
     ptrdiff_t           fragi;
     int                 last_zzi;
     int                 zzi;
-    fragi=coded_fragis[fragii];
+    fragi=_coded_fragis[fragii];
+    /*When deferring, the next block doubles as our dumping ground; it gets
+       cleared before it is used.*/
+    dct_coeffs=_coeffs!=NULL?_coeffs+(fragii<<6):dct_buf;
     for(zzi=0;zzi<64;zzi++)dct_coeffs[zzi]=0;
     qti=frags[fragi].mb_mode!=OC_MODE_INTRA;
     ac_quant=_pipe->dequant[_pli][frags[fragi].qii][qti];
@@ -1538,8 +1543,8 @@ static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
     for(zzi=0;zzi<64;){
       int token;
       last_zzi=zzi;
-      if(eob_runs[zzi]){
-        eob_runs[zzi]--;
+      if(_eob_runs[zzi]){
+        _eob_runs[zzi]--;
         break;
       }
       else{
@@ -1548,7 +1553,7 @@ static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
         int       rlen;
         int       coeff;
         int       lti;
-        lti=ti[zzi];
+        lti=_ti[zzi];
         token=dct_tokens[lti++];
         cw=OC_DCT_CODE_WORD[token];
         /*These parts could be done branchless, but the branches are fairly
@@ -1565,8 +1570,8 @@ static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
         rlen=(unsigned char)(cw>>OC_DCT_CW_RLEN_SHIFT);
         cw^=-(cw&1<<OC_DCT_CW_FLIP_BIT);
         coeff=cw>>OC_DCT_CW_MAG_SHIFT;
-        eob_runs[zzi]=eob;
-        ti[zzi]=lti;
+        _eob_runs[zzi]=eob;
+        _ti[zzi]=lti;
         zzi+=rlen;
         dct_coeffs[dct_fzig_zag[zzi]]=(ogg_int16_t)(coeff*(int)ac_quant[zzi]);
         zzi+=!eob;
@@ -1578,10 +1583,29 @@ static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
     dct_coeffs[0]=(ogg_int16_t)frags[fragi].dc;
     /*last_zzi is always initialized.
       If your compiler thinks otherwise, it is dumb.*/
-    oc_state_frag_recon(&_dec->state,fragi,_pli,
-     dct_coeffs,last_zzi,dc_quant[qti]);
+    if(_coeffs!=NULL)_last_zzis[fragii]=(unsigned char)last_zzi;
+    else{
+      oc_state_frag_recon(&_dec->state,fragi,_pli,
+       dct_coeffs,last_zzi,dc_quant[qti]);
+    }
   }
-  _pipe->coded_fragis[_pli]+=ncoded_fragis;
+}
+
+/*Reconstructs all coded fragments in a single MCU (one or two super block
+   rows).
+  This requires that each coded fragment have a proper macro block mode and
+   motion vector (if not in INTRA mode), and have it's DC value decoded, with
+   the DC prediction process reversed, and the number of coded and uncoded
+   fragments in this plane of the MCU be counted.
+  The token lists for each color plane and coefficient should also be filled
+   in, along with initial token offsets, extra bits offsets, and EOB run
+   counts.*/
+static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
+ oc_dec_pipeline_state *_pipe,int _pli){
+  oc_dec_frags_recon(_dec,_pipe,_pli,_pipe->coded_fragis[_pli],
+   _pipe->ncoded_fragis[_pli],_pipe->ti[_pli],_pipe->eob_runs[_pli],
+   NULL,NULL);
+  _pipe->coded_fragis[_pli]+=_pipe->ncoded_fragis[_pli];
   /*Right now the reconstructed MCU has only the coded blocks in it.*/
   /*TODO: We make the decision here to always copy the uncoded blocks into it
      from the reference frame.
@@ -1598,6 +1622,378 @@ static void oc_dec_frags_recon_mcu_plane(oc_dec_ctx *_dec,
    _pipe->nuncoded_fragis[_pli],OC_FRAME_SELF,OC_FRAME_PREV,_pli);
 }
 
+#if defined(OC_DEC_THREADS)
+/*Multi-threaded reconstruction.
+  Unpacking the tokens of an MCU has to be done in order, since the position
+   of each fragment's tokens depends on every fragment before it, but once its
+   coefficients are known, a fragment can be reconstructed independently of
+   every other: it only reads from the reference frames and only writes its own
+   block (and likewise for copying an uncoded one).
+  So with worker threads, the calling thread undoes the DC prediction and
+   unpacks the coefficients of the next few MCUs, handing off the iDCT, motion
+   compensation and uncoded fragment copies to the workers.
+  It then runs the loop filter, border extension, post-processing and stripe
+   callbacks in exactly the same order as the single-threaded decoder, waiting
+   for (or doing itself) the reconstruction each MCU needs, so the output is
+   bit-exact regardless of the number of threads.*/
+
+# if defined(_WIN32)
+typedef CRITICAL_SECTION oc_mutex;
+typedef HANDLE           oc_sem;
+typedef HANDLE           oc_thread;
+
+#  define oc_mutex_init(_mutex) (InitializeCriticalSection(_mutex),0)
+#  define oc_mutex_clear(_mutex) DeleteCriticalSection(_mutex)
+#  define oc_mutex_lock(_mutex) EnterCriticalSection(_mutex)
+#  define oc_mutex_unlock(_mutex) LeaveCriticalSection(_mutex)
+
+static int oc_sem_init(oc_sem *_sem){
+  *_sem=CreateSemaphore(NULL,0,LONG_MAX,NULL);
+  return *_sem==NULL;
+}
+
+#  define oc_sem_clear(_sem) CloseHandle(*(_sem))
+#  define oc_sem_post(_sem,_n) ReleaseSemaphore(*(_sem),(_n),NULL)
+#  define oc_sem_wait(_sem) WaitForSingleObject(*(_sem),INFINITE)
+
+# else
+typedef pthread_mutex_t oc_mutex;
+typedef pthread_t       oc_thread;
+
+#  define oc_mutex_init(_mutex) pthread_mutex_init(_mutex,NULL)
+#  define oc_mutex_clear(_mutex) pthread_mutex_destroy(_mutex)
+#  define oc_mutex_lock(_mutex) pthread_mutex_lock(_mutex)
+#  define oc_mutex_unlock(_mutex) pthread_mutex_unlock(_mutex)
+
+/*Unnamed POSIX semaphores are not available everywhere (e.g., Mac OS X), so
+   we build a counting semaphore out of a mutex and a condition variable.*/
+typedef struct{
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  unsigned        count;
+}oc_sem;
+
+static int oc_sem_init(oc_sem *_sem){
+  if(pthread_mutex_init(&_sem->mutex,NULL))return 1;
+  if(pthread_cond_init(&_sem->cond,NULL)){
+    pthread_mutex_destroy(&_sem->mutex);
+    return 1;
+  }
+  _sem->count=0;
+  return 0;
+}
+
+static void oc_sem_clear(oc_sem *_sem){
+  pthread_cond_destroy(&_sem->cond);
+  pthread_mutex_destroy(&_sem->mutex);
+}
+
+static void oc_sem_post(oc_sem *_sem,int _n){
+  pthread_mutex_lock(&_sem->mutex);
+  _sem->count+=_n;
+  if(_n>1)pthread_cond_broadcast(&_sem->cond);
+  else pthread_cond_signal(&_sem->cond);
+  pthread_mutex_unlock(&_sem->mutex);
+}
+
+static void oc_sem_wait(oc_sem *_sem){
+  pthread_mutex_lock(&_sem->mutex);
+  while(!_sem->count)pthread_cond_wait(&_sem->cond,&_sem->mutex);
+  _sem->count--;
+  pthread_mutex_unlock(&_sem->mutex);
+}
+# endif
+
+
+
+/*The reconstruction of a single plane of a single MCU.*/
+typedef struct{
+  const ptrdiff_t *coded_fragis;
+  const ptrdiff_t *uncoded_fragis;
+  ptrdiff_t        ncoded_fragis;
+  ptrdiff_t        nuncoded_fragis;
+  /*The dequantized coefficients and last coded zig-zag index of each coded
+     fragment.*/
+  ogg_int16_t     *coeffs;
+  unsigned char   *last_zzis;
+  int              pli;
+  int              done;
+}oc_dec_recon_job;
+
+struct oc_dec_thread_pool{
+  oc_dec_ctx                   *dec;
+  /*The pipeline state of the frame being decoded.*/
+  const oc_dec_pipeline_state  *pipe;
+  /*A ring of jobs: one per plane for each MCU in flight.*/
+  oc_dec_recon_job             *jobs;
+  int                           njob_slots;
+  /*The number of jobs posted so far this frame, and the index of the next one
+     to be claimed.
+    Both are protected by the mutex, as is the done flag of each job.*/
+  int                           njobs;
+  int                           next_job;
+  int                           quit;
+  oc_mutex                      mutex;
+  /*Counts jobs waiting for a worker.*/
+  oc_sem                        work;
+  /*Counts jobs finished by a worker.*/
+  oc_sem                        done;
+  oc_thread                    *threads;
+  int                           nthreads;
+  /*The storage for the coefficients of every job.*/
+  ogg_int16_t                  *coeff_data;
+  unsigned char                *last_zzi_data;
+};
+
+
+
+static void oc_dec_recon_job_run(oc_dec_thread_pool *_pool,
+ oc_dec_recon_job *_job){
+  const oc_dec_pipeline_state *pipe;
+  oc_dec_ctx                  *dec;
+  const oc_fragment           *frags;
+  ptrdiff_t                    fragii;
+  int                          pli;
+  dec=_pool->dec;
+  pipe=_pool->pipe;
+  frags=dec->state.frags;
+  pli=_job->pli;
+  for(fragii=0;fragii<_job->ncoded_fragis;fragii++){
+    ptrdiff_t fragi;
+    int       qti;
+    fragi=_job->coded_fragis[fragii];
+    qti=frags[fragi].mb_mode!=OC_MODE_INTRA;
+    oc_state_frag_recon(&dec->state,fragi,pli,_job->coeffs+(fragii<<6),
+     _job->last_zzis[fragii],pipe->dequant[pli][0][qti][0]);
+  }
+  oc_state_frag_copy_list(&dec->state,_job->uncoded_fragis,
+   _job->nuncoded_fragis,OC_FRAME_SELF,OC_FRAME_PREV,pli);
+}
+
+/*Claims the next unclaimed job, if any, and runs it.
+  The pool mutex must be held on entry, and is held again on exit.
+  Return: 1 if a job was run, or 0 if there were none available.*/
+static int oc_dec_recon_job_claim(oc_dec_thread_pool *_pool){
+  oc_dec_recon_job *job;
+  if(_pool->next_job>=_pool->njobs)return 0;
+  job=_pool->jobs+_pool->next_job++%_pool->njob_slots;
+  oc_mutex_unlock(&_pool->mutex);
+  oc_dec_recon_job_run(_pool,job);
+  oc_mutex_lock(&_pool->mutex);
+  job->done=1;
+  return 1;
+}
+
+# if defined(_WIN32)
+static DWORD WINAPI oc_dec_worker(LPVOID _arg){
+# else
+static void *oc_dec_worker(void *_arg){
+# endif
+  oc_dec_thread_pool *pool;
+  pool=(oc_dec_thread_pool *)_arg;
+  for(;;){
+    int ran;
+    oc_sem_wait(&pool->work);
+    oc_mutex_lock(&pool->mutex);
+    if(pool->quit){
+      oc_mutex_unlock(&pool->mutex);
+      break;
+    }
+    /*The calling thread may have already taken the job this wake-up was
+       for.*/
+    ran=oc_dec_recon_job_claim(pool);
+    oc_mutex_unlock(&pool->mutex);
+    if(ran){
+      oc_restore_fpu(&pool->dec->state);
+      oc_sem_post(&pool->done,1);
+    }
+  }
+  return 0;
+}
+
+static void oc_dec_thread_pool_free(oc_dec_thread_pool *_pool){
+  int i;
+  if(_pool==NULL)return;
+  oc_mutex_lock(&_pool->mutex);
+  _pool->quit=1;
+  oc_mutex_unlock(&_pool->mutex);
+  oc_sem_post(&_pool->work,_pool->nthreads);
+  for(i=0;i<_pool->nthreads;i++){
+# if defined(_WIN32)
+    WaitForSingleObject(_pool->threads[i],INFINITE);
+    CloseHandle(_pool->threads[i]);
+# else
+    pthread_join(_pool->threads[i],NULL);
+# endif
+  }
+  oc_sem_clear(&_pool->done);
+  oc_sem_clear(&_pool->work);
+  oc_mutex_clear(&_pool->mutex);
+  _ogg_free(_pool->last_zzi_data);
+  _ogg_free(_pool->coeff_data);
+  _ogg_free(_pool->threads);
+  _ogg_free(_pool->jobs);
+  _ogg_free(_pool);
+}
+
+/*Creates a pool of _nthreads worker threads, with room for the calling thread
+   to run _nmcus MCUs ahead of the one it is filtering.*/
+static oc_dec_thread_pool *oc_dec_thread_pool_alloc(oc_dec_ctx *_dec,
+ int _nthreads,int _nmcus){
+  oc_dec_thread_pool *pool;
+  size_t              mcu_nfrags[3];
+  size_t              ncoeffs;
+  size_t              nfrags;
+  int                 mcu_nvfrags;
+  int                 pli;
+  int                 jobi;
+  pool=(oc_dec_thread_pool *)_ogg_calloc(1,sizeof(*pool));
+  if(pool==NULL)return NULL;
+  pool->dec=_dec;
+  /*Size the coefficient storage for a full MCU in each plane.*/
+  mcu_nvfrags=4<<!(_dec->state.info.pixel_fmt&2);
+  nfrags=0;
+  for(pli=0;pli<3;pli++){
+    int frag_shift;
+    frag_shift=pli!=0&&!(_dec->state.info.pixel_fmt&2);
+    mcu_nfrags[pli]=_dec->state.fplanes[pli].nhfrags*
+     (size_t)(mcu_nvfrags>>frag_shift);
+    nfrags+=mcu_nfrags[pli];
+  }
+  pool->njob_slots=3*_nmcus;
+  ncoeffs=(nfrags<<6)+3*8;
+  pool->jobs=(oc_dec_recon_job *)_ogg_malloc(
+   pool->njob_slots*sizeof(*pool->jobs));
+  pool->threads=(oc_thread *)_ogg_malloc(_nthreads*sizeof(*pool->threads));
+  pool->coeff_data=(ogg_int16_t *)_ogg_malloc(
+   _nmcus*ncoeffs*sizeof(*pool->coeff_data));
+  pool->last_zzi_data=(unsigned char *)_ogg_malloc(
+   _nmcus*nfrags*sizeof(*pool->last_zzi_data));
+  if(pool->jobs==NULL||pool->threads==NULL||pool->coeff_data==NULL||
+   pool->last_zzi_data==NULL||oc_mutex_init(&pool->mutex)){
+    _ogg_free(pool->last_zzi_data);
+    _ogg_free(pool->coeff_data);
+    _ogg_free(pool->threads);
+    _ogg_free(pool->jobs);
+    _ogg_free(pool);
+    return NULL;
+  }
+  if(oc_sem_init(&pool->work)){
+    oc_mutex_clear(&pool->mutex);
+    _ogg_free(pool->last_zzi_data);
+    _ogg_free(pool->coeff_data);
+    _ogg_free(pool->threads);
+    _ogg_free(pool->jobs);
+    _ogg_free(pool);
+    return NULL;
+  }
+  if(oc_sem_init(&pool->done)){
+    oc_sem_clear(&pool->work);
+    oc_mutex_clear(&pool->mutex);
+    _ogg_free(pool->last_zzi_data);
+    _ogg_free(pool->coeff_data);
+    _ogg_free(pool->threads);
+    _ogg_free(pool->jobs);
+    _ogg_free(pool);
+    return NULL;
+  }
+  for(jobi=0;jobi<pool->njob_slots;jobi++){
+    size_t mcui;
+    mcui=jobi/3;
+    pli=jobi%3;
+    /*Each plane gets an extra coefficient for the zig-zag dumping ground,
+       padded to keep the blocks aligned.*/
+    pool->jobs[jobi].coeffs=pool->coeff_data+mcui*ncoeffs+
+     ((pli>0?mcu_nfrags[0]:0)+(pli>1?mcu_nfrags[1]:0)<<6)+(pli<<3);
+    pool->jobs[jobi].last_zzis=pool->last_zzi_data+mcui*nfrags+
+     (pli>0?mcu_nfrags[0]:0)+(pli>1?mcu_nfrags[1]:0);
+    pool->jobs[jobi].done=1;
+  }
+  for(pool->nthreads=0;pool->nthreads<_nthreads;pool->nthreads++){
+    oc_thread *thread;
+    thread=pool->threads+pool->nthreads;
+# if defined(_WIN32)
+    *thread=CreateThread(NULL,0,oc_dec_worker,pool,0,NULL);
+    if(*thread==NULL)break;
+# else
+    if(pthread_create(thread,NULL,oc_dec_worker,pool))break;
+# endif
+  }
+  if(pool->nthreads<_nthreads){
+    oc_dec_thread_pool_free(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+/*Undoes the DC prediction and unpacks the coefficients for every plane of the
+   MCU starting at the given fragment row, and posts their reconstruction to
+   the worker threads.*/
+static void oc_dec_recon_jobs_post(oc_dec_ctx *_dec,
+ oc_dec_pipeline_state *_pipe,int _stripe_fragy){
+  oc_dec_thread_pool *pool;
+  int                 jobi;
+  int                 pli;
+  pool=_dec->thread_pool;
+  jobi=3*(_stripe_fragy/_pipe->mcu_nvfrags);
+  if(jobi==0){
+    oc_mutex_lock(&pool->mutex);
+    pool->pipe=_pipe;
+    pool->njobs=pool->next_job=0;
+    oc_mutex_unlock(&pool->mutex);
+  }
+  for(pli=0;pli<3;pli++){
+    oc_fragment_plane *fplane;
+    oc_dec_recon_job  *job;
+    int                frag_shift;
+    fplane=_dec->state.fplanes+pli;
+    frag_shift=pli!=0&&!(_dec->state.info.pixel_fmt&2);
+    _pipe->fragy0[pli]=_stripe_fragy>>frag_shift;
+    _pipe->fragy_end[pli]=OC_MINI(fplane->nvfrags,
+     _pipe->fragy0[pli]+(_pipe->mcu_nvfrags>>frag_shift));
+    oc_dec_dc_unpredict_mcu_plane(_dec,_pipe,pli);
+    /*The job that last used this slot has already been waited for.*/
+    job=pool->jobs+(jobi+pli)%pool->njob_slots;
+    job->pli=pli;
+    job->done=0;
+    job->coded_fragis=_pipe->coded_fragis[pli];
+    job->ncoded_fragis=_pipe->ncoded_fragis[pli];
+    oc_dec_frags_recon(_dec,_pipe,pli,job->coded_fragis,job->ncoded_fragis,
+     _pipe->ti[pli],_pipe->eob_runs[pli],job->coeffs,job->last_zzis);
+    _pipe->coded_fragis[pli]+=job->ncoded_fragis;
+    job->nuncoded_fragis=_pipe->nuncoded_fragis[pli];
+    _pipe->uncoded_fragis[pli]-=job->nuncoded_fragis;
+    job->uncoded_fragis=_pipe->uncoded_fragis[pli];
+    oc_mutex_lock(&pool->mutex);
+    pool->njobs=jobi+pli+1;
+    oc_mutex_unlock(&pool->mutex);
+    oc_sem_post(&pool->work,1);
+  }
+}
+
+/*Waits for the reconstruction of a given job to finish, helping out with any
+   outstanding jobs in the meantime.*/
+static void oc_dec_recon_job_wait(oc_dec_ctx *_dec,int _jobi){
+  oc_dec_thread_pool *pool;
+  oc_dec_recon_job   *job;
+  pool=_dec->thread_pool;
+  job=pool->jobs+_jobi%pool->njob_slots;
+  oc_mutex_lock(&pool->mutex);
+  while(!job->done){
+    if(!oc_dec_recon_job_claim(pool)){
+      oc_mutex_unlock(&pool->mutex);
+      oc_sem_wait(&pool->done);
+      oc_mutex_lock(&pool->mutex);
+    }
+  }
+  oc_mutex_unlock(&pool->mutex);
+  /*We might have run some of the reconstruction ourselves.*/
+  oc_restore_fpu(&_dec->state);
+}
+#endif
+
+
+
 /*Filter a horizontal block edge.*/
 static void oc_filter_hedge(unsigned char *_dst,int _dst_ystride,
  const unsigned char *_src,int _src_ystride,int _qstep,int _flimit,
@@ -1964,6 +2360,9 @@ th_dec_ctx *th_decode_alloc(const th_info *_info,const th_setup_info *_setup){
 
 void th_decode_free(th_dec_ctx *_dec){
   if(_dec!=NULL){
+#if defined(OC_DEC_THREADS)
+    oc_dec_thread_pool_free(_dec->thread_pool);
+#endif
     oc_dec_clear(_dec);
     _ogg_free(_dec);
   }
@@ -2009,6 +2408,31 @@ int th_decode_ctl(th_dec_ctx *_dec,int _req,void *_buf,
     _dec->stripe_cb.stripe_decoded=cb->stripe_decoded;
     return 0;
   }break;
+  case TH_DECCTL_SET_THREADS:{
+    int nthreads;
+    if(_dec==NULL||_buf==NULL)return TH_EFAULT;
+    if(_buf_sz!=sizeof(int))return TH_EINVAL;
+    nthreads=*(int *)_buf;
+    if(nthreads<1||nthreads>OC_DEC_THREADS_MAX)return TH_EINVAL;
+#if defined(OC_DEC_THREADS)
+    if(nthreads!=_dec->nthreads){
+      oc_dec_thread_pool *pool;
+      /*The calling thread does its share of the work, so we need one fewer
+         worker.*/
+      pool=NULL;
+      if(nthreads>1){
+        pool=oc_dec_thread_pool_alloc(_dec,nthreads-1,nthreads+1);
+        if(pool==NULL)return TH_EFAULT;
+      }
+      oc_dec_thread_pool_free(_dec->thread_pool);
+      _dec->thread_pool=pool;
+      _dec->nthreads=nthreads;
+    }
+    return 0;
+#else
+    return nthreads>1?TH_EIMPL:0;
+#endif
+  }break;
 #ifdef HAVE_CAIRO
   case TH_DECCTL_SET_TELEMETRY_MBMODE:{
     if(_dec==NULL||_buf==NULL)return TH_EFAULT;
@@ -2078,6 +2502,10 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
     oc_dec_pipeline_state pipe;
     th_ycbcr_buffer       stripe_buf;
     int                   stripe_fragy;
+#if defined(OC_DEC_THREADS)
+    int                   post_fragy;
+#endif
+    int                   jobi;
     int                   refi;
     int                   pli;
     int                   notstart;
@@ -2164,9 +2592,26 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
     oc_ycbcr_buffer_flip(stripe_buf,_dec->pp_frame_buf);
     notstart=0;
     notdone=1;
+    jobi=0;
+#if defined(OC_DEC_THREADS)
+    post_fragy=0;
+#endif
     for(stripe_fragy=0;notdone;stripe_fragy+=pipe.mcu_nvfrags){
       int avail_fragy0;
       int avail_fragy_end;
+#if defined(OC_DEC_THREADS)
+      /*With worker threads, the reconstruction of the next few MCUs is
+         started ahead of time, and the steps below wait for it as they
+         reach it.
+        Keeping the window small keeps the rows we filter in cache.*/
+      if(_dec->thread_pool!=NULL){
+        while(post_fragy<_dec->state.fplanes[0].nvfrags&&
+         post_fragy<=stripe_fragy+_dec->nthreads*pipe.mcu_nvfrags){
+          oc_dec_recon_jobs_post(_dec,&pipe,post_fragy);
+          post_fragy+=pipe.mcu_nvfrags;
+        }
+      }
+#endif
       avail_fragy0=avail_fragy_end=_dec->state.fplanes[0].nvfrags;
       notdone=stripe_fragy+pipe.mcu_nvfrags<avail_fragy_end;
       for(pli=0;pli<3;pli++){
@@ -2182,8 +2627,15 @@ int th_decode_packetin(th_dec_ctx *_dec,const ogg_packet *_op,
         pipe.fragy0[pli]=stripe_fragy>>frag_shift;
         pipe.fragy_end[pli]=OC_MINI(fplane->nvfrags,
          pipe.fragy0[pli]+(pipe.mcu_nvfrags>>frag_shift));
-        oc_dec_dc_unpredict_mcu_plane(_dec,&pipe,pli);
-        oc_dec_frags_recon_mcu_plane(_dec,&pipe,pli);
+#if defined(OC_DEC_THREADS)
+        if(_dec->thread_pool!=NULL)oc_dec_recon_job_wait(_dec,jobi);
+        else
+#endif
+        {
+          oc_dec_dc_unpredict_mcu_plane(_dec,&pipe,pli);
+          oc_dec_frags_recon_mcu_plane(_dec,&pipe,pli);
+        }
+        jobi++;
         sdelay=edelay=0;
         if(pipe.loop_filter){
           sdelay+=notstart;
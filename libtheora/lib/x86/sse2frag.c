@@ -0,0 +1,183 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggTheora SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE Theora SOURCE CODE IS COPYRIGHT (C) 2002-2009                *
+ * by the Xiph.Org Foundation and contributors http://www.xiph.org/ *
+ *                                                                  *
+ ********************************************************************
+
+  function:
+    last mod: $Id$
+
+ ********************************************************************/
+
+/*SSE2 acceleration of fragment reconstruction for motion compensation.
+  A whole row of residue fits in one register, so each pair of rows is packed
+   into one register and written out with a low and a high 8 byte store.
+  The residue must be 16-byte aligned.*/
+#include <stddef.h>
+#include "x86int.h"
+
+#if defined(OC_X86_64_ASM)
+
+void oc_frag_recon_intra_sse2(unsigned char *_dst,int _ystride,
+ const ogg_int16_t *_residue){
+  __asm__ __volatile__(
+    /*Set xmm0 to 0x0080 in each word.*/
+    "pcmpeqw %%xmm0,%%xmm0\n\t"
+    "psllw $15,%%xmm0\n\t"
+    "psrlw $8,%%xmm0\n\t"
+    /*#0...#7 Load residue.*/
+    "movdqa 0*16(%[residue]),%%xmm1\n\t"
+    "movdqa 1*16(%[residue]),%%xmm2\n\t"
+    "movdqa 2*16(%[residue]),%%xmm3\n\t"
+    "movdqa 3*16(%[residue]),%%xmm4\n\t"
+    "movdqa 4*16(%[residue]),%%xmm5\n\t"
+    "movdqa 5*16(%[residue]),%%xmm6\n\t"
+    "movdqa 6*16(%[residue]),%%xmm7\n\t"
+    "movdqa 7*16(%[residue]),%%xmm8\n\t"
+    /*#0...#7 Bias residue.*/
+    "paddsw %%xmm0,%%xmm1\n\t"
+    "paddsw %%xmm0,%%xmm2\n\t"
+    "paddsw %%xmm0,%%xmm3\n\t"
+    "paddsw %%xmm0,%%xmm4\n\t"
+    "paddsw %%xmm0,%%xmm5\n\t"
+    "paddsw %%xmm0,%%xmm6\n\t"
+    "paddsw %%xmm0,%%xmm7\n\t"
+    "paddsw %%xmm0,%%xmm8\n\t"
+    /*#0,#1...#6,#7 Pack to byte.*/
+    "packuswb %%xmm2,%%xmm1\n\t"
+    "packuswb %%xmm4,%%xmm3\n\t"
+    "packuswb %%xmm6,%%xmm5\n\t"
+    "packuswb %%xmm8,%%xmm7\n\t"
+    /*#0...#7 Write rows.*/
+    "movq %%xmm1,(%[dst])\n\t"
+    "movhps %%xmm1,(%[dst],%[ystride])\n\t"
+    "movq %%xmm3,(%[dst],%[ystride],2)\n\t"
+    "movhps %%xmm3,(%[dst],%[ystride3])\n\t"
+    "movq %%xmm5,(%[dst4])\n\t"
+    "movhps %%xmm5,(%[dst4],%[ystride])\n\t"
+    "movq %%xmm7,(%[dst4],%[ystride],2)\n\t"
+    "movhps %%xmm7,(%[dst4],%[ystride3])\n\t"
+    :
+    :[residue]"r"(_residue),
+     [dst]"r"(_dst),
+     [dst4]"r"(_dst+(_ystride<<2)),
+     [ystride]"r"((ptrdiff_t)_ystride),
+     [ystride3]"r"((ptrdiff_t)_ystride*3)
+    :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7","xmm8"
+  );
+}
+
+void oc_frag_recon_inter_sse2(unsigned char *_dst,const unsigned char *_src,
+ int _ystride,const ogg_int16_t *_residue){
+  int i;
+  for(i=2;i-->0;){
+    __asm__ __volatile__(
+      /*Zero xmm0.*/
+      "pxor %%xmm0,%%xmm0\n\t"
+      /*#0...#3 Load source.*/
+      "movq (%[src]),%%xmm1\n\t"
+      "movq (%[src],%[ystride]),%%xmm2\n\t"
+      "movq (%[src],%[ystride],2),%%xmm3\n\t"
+      "movq (%[src],%[ystride3]),%%xmm4\n\t"
+      /*#0...#3 Expand source.*/
+      "punpcklbw %%xmm0,%%xmm1\n\t"
+      "punpcklbw %%xmm0,%%xmm2\n\t"
+      "punpcklbw %%xmm0,%%xmm3\n\t"
+      "punpcklbw %%xmm0,%%xmm4\n\t"
+      /*#0...#3 Add residue.*/
+      "paddsw 0*16(%[residue]),%%xmm1\n\t"
+      "paddsw 1*16(%[residue]),%%xmm2\n\t"
+      "paddsw 2*16(%[residue]),%%xmm3\n\t"
+      "paddsw 3*16(%[residue]),%%xmm4\n\t"
+      /*#0,#1 and #2,#3 Pack final row pixels.*/
+      "packuswb %%xmm2,%%xmm1\n\t"
+      "packuswb %%xmm4,%%xmm3\n\t"
+      /*#0...#3 Write rows.*/
+      "movq %%xmm1,(%[dst])\n\t"
+      "movhps %%xmm1,(%[dst],%[ystride])\n\t"
+      "movq %%xmm3,(%[dst],%[ystride],2)\n\t"
+      "movhps %%xmm3,(%[dst],%[ystride3])\n\t"
+      /*Advance residue, src and dst.*/
+      "lea 4*16(%[residue]),%[residue]\n\t"
+      "lea (%[src],%[ystride],4),%[src]\n\t"
+      "lea (%[dst],%[ystride],4),%[dst]\n\t"
+      :[residue]"+r"(_residue),[dst]"+r"(_dst),[src]"+r"(_src)
+      :[ystride]"r"((ptrdiff_t)_ystride),
+       [ystride3]"r"((ptrdiff_t)_ystride*3)
+      :"memory","xmm0","xmm1","xmm2","xmm3","xmm4"
+    );
+  }
+}
+
+void oc_frag_recon_inter2_sse2(unsigned char *_dst,const unsigned char *_src1,
+ const unsigned char *_src2,int _ystride,const ogg_int16_t *_residue){
+  int i;
+  for(i=2;i-->0;){
+    __asm__ __volatile__(
+      /*Zero xmm0.*/
+      "pxor %%xmm0,%%xmm0\n\t"
+      /*#0...#3 Load src1.*/
+      "movq (%[src1]),%%xmm1\n\t"
+      "movq (%[src1],%[ystride]),%%xmm2\n\t"
+      "movq (%[src1],%[ystride],2),%%xmm3\n\t"
+      "movq (%[src1],%[ystride3]),%%xmm4\n\t"
+      /*#0...#3 Load src2.*/
+      "movq (%[src2]),%%xmm5\n\t"
+      "movq (%[src2],%[ystride]),%%xmm6\n\t"
+      "movq (%[src2],%[ystride],2),%%xmm7\n\t"
+      "movq (%[src2],%[ystride3]),%%xmm8\n\t"
+      /*#0...#3 Expand src1 and src2.*/
+      "punpcklbw %%xmm0,%%xmm1\n\t"
+      "punpcklbw %%xmm0,%%xmm2\n\t"
+      "punpcklbw %%xmm0,%%xmm3\n\t"
+      "punpcklbw %%xmm0,%%xmm4\n\t"
+      "punpcklbw %%xmm0,%%xmm5\n\t"
+      "punpcklbw %%xmm0,%%xmm6\n\t"
+      "punpcklbw %%xmm0,%%xmm7\n\t"
+      "punpcklbw %%xmm0,%%xmm8\n\t"
+      /*#0...#3 src1+src2.*/
+      "paddw %%xmm5,%%xmm1\n\t"
+      "paddw %%xmm6,%%xmm2\n\t"
+      "paddw %%xmm7,%%xmm3\n\t"
+      "paddw %%xmm8,%%xmm4\n\t"
+      /*#0...#3 Build average.
+        We can't use pavgb, since it rounds up, and C truncates.*/
+      "psrlw $1,%%xmm1\n\t"
+      "psrlw $1,%%xmm2\n\t"
+      "psrlw $1,%%xmm3\n\t"
+      "psrlw $1,%%xmm4\n\t"
+      /*#0...#3 Add residue.*/
+      "paddsw 0*16(%[residue]),%%xmm1\n\t"
+      "paddsw 1*16(%[residue]),%%xmm2\n\t"
+      "paddsw 2*16(%[residue]),%%xmm3\n\t"
+      "paddsw 3*16(%[residue]),%%xmm4\n\t"
+      /*#0,#1 and #2,#3 Pack and saturate.*/
+      "packuswb %%xmm2,%%xmm1\n\t"
+      "packuswb %%xmm4,%%xmm3\n\t"
+      /*#0...#3 Write rows.*/
+      "movq %%xmm1,(%[dst])\n\t"
+      "movhps %%xmm1,(%[dst],%[ystride])\n\t"
+      "movq %%xmm3,(%[dst],%[ystride],2)\n\t"
+      "movhps %%xmm3,(%[dst],%[ystride3])\n\t"
+      /*Advance residue, src1, src2 and dst.*/
+      "lea 4*16(%[residue]),%[residue]\n\t"
+      "lea (%[src1],%[ystride],4),%[src1]\n\t"
+      "lea (%[src2],%[ystride],4),%[src2]\n\t"
+      "lea (%[dst],%[ystride],4),%[dst]\n\t"
+      :[dst]"+r"(_dst),[residue]"+r"(_residue),
+       [src1]"+r"(_src1),[src2]"+r"(_src2)
+      :[ystride]"r"((ptrdiff_t)_ystride),
+       [ystride3]"r"((ptrdiff_t)_ystride*3)
+      :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7",
+       "xmm8"
+    );
+  }
+}
+
+#endif
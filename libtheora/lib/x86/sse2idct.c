@@ -0,0 +1,431 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggTheora SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE Theora SOURCE CODE IS COPYRIGHT (C) 2002-2009                *
+ * by the Xiph.Org Foundation and contributors http://www.xiph.org/ *
+ *                                                                  *
+ ********************************************************************
+
+  function:
+    last mod: $Id$
+
+ ********************************************************************/
+
+/*SSE2 acceleration of Theora's iDCT for x86_64.
+  Unlike the MMX version, this keeps the whole block in registers, and follows
+   the C reference exactly, including the reduced transforms it uses for
+   blocks with only a few coefficients.*/
+#include "x86int.h"
+#include "../dct.h"
+
+#if defined(OC_X86_64_ASM)
+
+/*A table of constants used by the SSE2 routines.
+  Each row holds one value replicated 8 times.
+  Cosines larger than 32767 are stored as negative numbers; the code adds the
+   input back in after the multiply to compensate.*/
+static const ogg_uint16_t __attribute__((aligned(16),used))
+ OC_IDCT_CONSTS_SSE2[8][8]={
+  {
+    (ogg_uint16_t)OC_C1S7,(ogg_uint16_t)OC_C1S7,
+    (ogg_uint16_t)OC_C1S7,(ogg_uint16_t)OC_C1S7,
+    (ogg_uint16_t)OC_C1S7,(ogg_uint16_t)OC_C1S7,
+    (ogg_uint16_t)OC_C1S7,(ogg_uint16_t)OC_C1S7
+  },
+  {
+    (ogg_uint16_t)OC_C2S6,(ogg_uint16_t)OC_C2S6,
+    (ogg_uint16_t)OC_C2S6,(ogg_uint16_t)OC_C2S6,
+    (ogg_uint16_t)OC_C2S6,(ogg_uint16_t)OC_C2S6,
+    (ogg_uint16_t)OC_C2S6,(ogg_uint16_t)OC_C2S6
+  },
+  {
+    (ogg_uint16_t)OC_C3S5,(ogg_uint16_t)OC_C3S5,
+    (ogg_uint16_t)OC_C3S5,(ogg_uint16_t)OC_C3S5,
+    (ogg_uint16_t)OC_C3S5,(ogg_uint16_t)OC_C3S5,
+    (ogg_uint16_t)OC_C3S5,(ogg_uint16_t)OC_C3S5
+  },
+  {
+    (ogg_uint16_t)OC_C4S4,(ogg_uint16_t)OC_C4S4,
+    (ogg_uint16_t)OC_C4S4,(ogg_uint16_t)OC_C4S4,
+    (ogg_uint16_t)OC_C4S4,(ogg_uint16_t)OC_C4S4,
+    (ogg_uint16_t)OC_C4S4,(ogg_uint16_t)OC_C4S4
+  },
+  {
+    (ogg_uint16_t)OC_C5S3,(ogg_uint16_t)OC_C5S3,
+    (ogg_uint16_t)OC_C5S3,(ogg_uint16_t)OC_C5S3,
+    (ogg_uint16_t)OC_C5S3,(ogg_uint16_t)OC_C5S3,
+    (ogg_uint16_t)OC_C5S3,(ogg_uint16_t)OC_C5S3
+  },
+  {
+    (ogg_uint16_t)OC_C6S2,(ogg_uint16_t)OC_C6S2,
+    (ogg_uint16_t)OC_C6S2,(ogg_uint16_t)OC_C6S2,
+    (ogg_uint16_t)OC_C6S2,(ogg_uint16_t)OC_C6S2,
+    (ogg_uint16_t)OC_C6S2,(ogg_uint16_t)OC_C6S2
+  },
+  {
+    (ogg_uint16_t)OC_C7S1,(ogg_uint16_t)OC_C7S1,
+    (ogg_uint16_t)OC_C7S1,(ogg_uint16_t)OC_C7S1,
+    (ogg_uint16_t)OC_C7S1,(ogg_uint16_t)OC_C7S1,
+    (ogg_uint16_t)OC_C7S1,(ogg_uint16_t)OC_C7S1
+  },
+  {     4,    4,    4,    4,    4,    4,    4,    4 }
+};
+
+/*Masks selecting the coefficients the C reference uses when _last_zzi<3 or
+   _last_zzi<10, respectively.
+  The input is stored transposed, so row i of each mask covers column i of the
+   block.*/
+static const ogg_uint16_t __attribute__((aligned(16),used))
+ OC_IDCT_MASKS_SSE2[2][4][8]={
+  {
+    {0xFFFF,0xFFFF,     0,     0,     0,     0,     0,     0},
+    {0xFFFF,     0,     0,     0,     0,     0,     0,     0},
+    {     0,     0,     0,     0,     0,     0,     0,     0},
+    {     0,     0,     0,     0,     0,     0,     0,     0}
+  },
+  {
+    {0xFFFF,0xFFFF,0xFFFF,0xFFFF,     0,     0,     0,     0},
+    {0xFFFF,0xFFFF,0xFFFF,     0,     0,     0,     0,     0},
+    {0xFFFF,0xFFFF,     0,     0,     0,     0,     0,     0},
+    {0xFFFF,     0,     0,     0,     0,     0,     0,     0}
+  }
+};
+
+/*Converts the expression in the argument to a string.*/
+#define OC_M2STR(_s) #_s
+
+#define OC_C(_i)      OC_M2STR(((_i)-1)*16)"(%[c])"
+#define OC_4          OC_M2STR(7*16)"(%[c])"
+
+/*Performs an 8 point iDCT on each of the 8 columns of xmm0...xmm7, exactly
+   like idct8() in the C reference.
+  On exit, the outputs 0...7 are in xmm0, xmm1, xmm4, xmm3, xmm6, xmm7, xmm2
+   and xmm11; xmm5, xmm8, xmm9 and xmm10 are clobbered.*/
+#define OC_IDCT8_SSE2 \
+ "#OC_IDCT8_SSE2\n\t" \
+ /*Stage 1:*/ \
+ /*xmm8=t[4]=(OC_C7S1*x[1]>>16)-(OC_C1S7*x[7]>>16)*/ \
+ "movdqa %%xmm1,%%xmm8\n\t" \
+ "pmulhw "OC_C(7)",%%xmm8\n\t" \
+ "movdqa %%xmm7,%%xmm9\n\t" \
+ "pmulhw "OC_C(1)",%%xmm9\n\t" \
+ "paddw %%xmm7,%%xmm9\n\t" \
+ "psubw %%xmm9,%%xmm8\n\t" \
+ /*xmm9=t[7]=(OC_C1S7*x[1]>>16)+(OC_C7S1*x[7]>>16)*/ \
+ "movdqa %%xmm1,%%xmm9\n\t" \
+ "pmulhw "OC_C(1)",%%xmm9\n\t" \
+ "paddw %%xmm1,%%xmm9\n\t" \
+ "pmulhw "OC_C(7)",%%xmm7\n\t" \
+ "paddw %%xmm7,%%xmm9\n\t" \
+ /*xmm10=t[5]=(OC_C3S5*x[5]>>16)-(OC_C5S3*x[3]>>16)*/ \
+ "movdqa %%xmm5,%%xmm10\n\t" \
+ "pmulhw "OC_C(3)",%%xmm10\n\t" \
+ "paddw %%xmm5,%%xmm10\n\t" \
+ "movdqa %%xmm3,%%xmm11\n\t" \
+ "pmulhw "OC_C(5)",%%xmm11\n\t" \
+ "paddw %%xmm3,%%xmm11\n\t" \
+ "psubw %%xmm11,%%xmm10\n\t" \
+ /*xmm11=t[6]=(OC_C5S3*x[5]>>16)+(OC_C3S5*x[3]>>16)*/ \
+ "movdqa %%xmm5,%%xmm11\n\t" \
+ "pmulhw "OC_C(5)",%%xmm11\n\t" \
+ "paddw %%xmm5,%%xmm11\n\t" \
+ "movdqa %%xmm3,%%xmm1\n\t" \
+ "pmulhw "OC_C(3)",%%xmm1\n\t" \
+ "paddw %%xmm3,%%xmm1\n\t" \
+ "paddw %%xmm1,%%xmm11\n\t" \
+ /*xmm1=t[2]=(OC_C6S2*x[2]>>16)-(OC_C2S6*x[6]>>16)*/ \
+ "movdqa %%xmm2,%%xmm1\n\t" \
+ "pmulhw "OC_C(6)",%%xmm1\n\t" \
+ "movdqa %%xmm6,%%xmm3\n\t" \
+ "pmulhw "OC_C(2)",%%xmm3\n\t" \
+ "paddw %%xmm6,%%xmm3\n\t" \
+ "psubw %%xmm3,%%xmm1\n\t" \
+ /*xmm3=t[3]=(OC_C2S6*x[2]>>16)+(OC_C6S2*x[6]>>16)*/ \
+ "movdqa %%xmm2,%%xmm3\n\t" \
+ "pmulhw "OC_C(2)",%%xmm3\n\t" \
+ "paddw %%xmm2,%%xmm3\n\t" \
+ "pmulhw "OC_C(6)",%%xmm6\n\t" \
+ "paddw %%xmm6,%%xmm3\n\t" \
+ /*xmm0=t[0]=OC_C4S4*(x[0]+x[4])>>16*/ \
+ /*xmm2=t[1]=OC_C4S4*(x[0]-x[4])>>16*/ \
+ "movdqa %%xmm0,%%xmm2\n\t" \
+ "paddw %%xmm4,%%xmm0\n\t" \
+ "psubw %%xmm4,%%xmm2\n\t" \
+ "movdqa %%xmm0,%%xmm4\n\t" \
+ "pmulhw "OC_C(4)",%%xmm0\n\t" \
+ "paddw %%xmm4,%%xmm0\n\t" \
+ "movdqa %%xmm2,%%xmm4\n\t" \
+ "pmulhw "OC_C(4)",%%xmm2\n\t" \
+ "paddw %%xmm4,%%xmm2\n\t" \
+ OC_IDCT8_STAGE2_SSE2 \
+
+/*Performs an 8 point iDCT on each of the 8 columns of xmm0...xmm3, assuming
+   the other 4 inputs are zero, exactly like idct8_4() in the C reference.
+  The outputs are placed as in OC_IDCT8_SSE2.*/
+#define OC_IDCT8_4_SSE2 \
+ "#OC_IDCT8_4_SSE2\n\t" \
+ /*Stage 1:*/ \
+ /*xmm8=t[4]=OC_C7S1*x[1]>>16*/ \
+ /*xmm9=t[7]=OC_C1S7*x[1]>>16*/ \
+ "movdqa %%xmm1,%%xmm8\n\t" \
+ "movdqa %%xmm1,%%xmm9\n\t" \
+ "pmulhw "OC_C(7)",%%xmm8\n\t" \
+ "pmulhw "OC_C(1)",%%xmm9\n\t" \
+ "paddw %%xmm1,%%xmm9\n\t" \
+ /*xmm10=t[5]=-(OC_C5S3*x[3]>>16)*/ \
+ /*xmm11=t[6]=OC_C3S5*x[3]>>16*/ \
+ "movdqa %%xmm3,%%xmm1\n\t" \
+ "movdqa %%xmm3,%%xmm11\n\t" \
+ "pxor %%xmm10,%%xmm10\n\t" \
+ "pmulhw "OC_C(5)",%%xmm1\n\t" \
+ "pmulhw "OC_C(3)",%%xmm11\n\t" \
+ "paddw %%xmm3,%%xmm1\n\t" \
+ "paddw %%xmm3,%%xmm11\n\t" \
+ "psubw %%xmm1,%%xmm10\n\t" \
+ /*xmm1=t[2]=OC_C6S2*x[2]>>16*/ \
+ /*xmm3=t[3]=OC_C2S6*x[2]>>16*/ \
+ "movdqa %%xmm2,%%xmm1\n\t" \
+ "movdqa %%xmm2,%%xmm3\n\t" \
+ "pmulhw "OC_C(6)",%%xmm1\n\t" \
+ "pmulhw "OC_C(2)",%%xmm3\n\t" \
+ "paddw %%xmm2,%%xmm3\n\t" \
+ /*xmm0=t[0]=OC_C4S4*x[0]>>16*/ \
+ /*xmm2=t[1]=t[0]*/ \
+ "movdqa %%xmm0,%%xmm4\n\t" \
+ "pmulhw "OC_C(4)",%%xmm0\n\t" \
+ "paddw %%xmm4,%%xmm0\n\t" \
+ "movdqa %%xmm0,%%xmm2\n\t" \
+ OC_IDCT8_STAGE2_SSE2 \
+
+/*The remaining stages of the 8 point iDCT, shared by the full and reduced
+   versions.
+  On entry, t[0]...t[7] are in xmm0, xmm2, xmm1, xmm3, xmm8, xmm10, xmm11 and
+   xmm9.*/
+#define OC_IDCT8_STAGE2_SSE2 \
+ /*Stage 2:*/ \
+ /*xmm8=t[4]'=t[4]+t[5]*/ \
+ /*xmm4=t[5]'=OC_C4S4*(t[4]-t[5])>>16*/ \
+ "movdqa %%xmm8,%%xmm4\n\t" \
+ "paddw %%xmm10,%%xmm8\n\t" \
+ "psubw %%xmm10,%%xmm4\n\t" \
+ "movdqa %%xmm4,%%xmm5\n\t" \
+ "pmulhw "OC_C(4)",%%xmm4\n\t" \
+ "paddw %%xmm5,%%xmm4\n\t" \
+ /*xmm9=t[7]'=t[7]+t[6]*/ \
+ /*xmm5=t[6]'=OC_C4S4*(t[7]-t[6])>>16*/ \
+ "movdqa %%xmm9,%%xmm5\n\t" \
+ "paddw %%xmm11,%%xmm9\n\t" \
+ "psubw %%xmm11,%%xmm5\n\t" \
+ "movdqa %%xmm5,%%xmm10\n\t" \
+ "pmulhw "OC_C(4)",%%xmm5\n\t" \
+ "paddw %%xmm10,%%xmm5\n\t" \
+ /*Stage 3:*/ \
+ /*xmm0=t[0]''=t[0]+t[3]*/ \
+ /*xmm6=t[3]''=t[0]-t[3]*/ \
+ "movdqa %%xmm0,%%xmm6\n\t" \
+ "paddw %%xmm3,%%xmm0\n\t" \
+ "psubw %%xmm3,%%xmm6\n\t" \
+ /*xmm2=t[1]''=t[1]+t[2]*/ \
+ /*xmm7=t[2]''=t[1]-t[2]*/ \
+ "movdqa %%xmm2,%%xmm7\n\t" \
+ "paddw %%xmm1,%%xmm2\n\t" \
+ "psubw %%xmm1,%%xmm7\n\t" \
+ /*xmm5=t[6]''=t[6]'+t[5]'*/ \
+ /*xmm10=t[5]''=t[6]'-t[5]'*/ \
+ "movdqa %%xmm5,%%xmm10\n\t" \
+ "paddw %%xmm4,%%xmm5\n\t" \
+ "psubw %%xmm4,%%xmm10\n\t" \
+ /*Stage 4:*/ \
+ /*xmm0=y[0]=t[0]''+t[7]', xmm11=y[7]=t[0]''-t[7]'*/ \
+ "movdqa %%xmm0,%%xmm11\n\t" \
+ "paddw %%xmm9,%%xmm0\n\t" \
+ "psubw %%xmm9,%%xmm11\n\t" \
+ /*xmm1=y[1]=t[1]''+t[6]'', xmm2=y[6]=t[1]''-t[6]''*/ \
+ "movdqa %%xmm2,%%xmm1\n\t" \
+ "paddw %%xmm5,%%xmm1\n\t" \
+ "psubw %%xmm5,%%xmm2\n\t" \
+ /*xmm4=y[2]=t[2]''+t[5]'', xmm7=y[5]=t[2]''-t[5]''*/ \
+ "movdqa %%xmm7,%%xmm4\n\t" \
+ "paddw %%xmm10,%%xmm4\n\t" \
+ "psubw %%xmm10,%%xmm7\n\t" \
+ /*xmm3=y[3]=t[3]''+t[4]', xmm6=y[4]=t[3]''-t[4]'*/ \
+ "movdqa %%xmm6,%%xmm3\n\t" \
+ "paddw %%xmm8,%%xmm3\n\t" \
+ "psubw %%xmm8,%%xmm6\n\t" \
+
+/*Transposes the 8x8 matrix whose rows are the outputs of OC_IDCT8_SSE2,
+   leaving row i of the result in xmmi.*/
+#define OC_TRANSPOSE8x8_SSE2 \
+ "#OC_TRANSPOSE8x8_SSE2\n\t" \
+ /*xmm8 = b3 a3 b2 a2 b1 a1 b0 a0*/ \
+ /*xmm0 = b7 a7 b6 a6 b5 a5 b4 a4*/ \
+ "movdqa %%xmm0,%%xmm8\n\t" \
+ "punpcklwd %%xmm1,%%xmm8\n\t" \
+ "punpckhwd %%xmm1,%%xmm0\n\t" \
+ /*xmm9 = d3 c3 d2 c2 d1 c1 d0 c0*/ \
+ /*xmm4 = d7 c7 d6 c6 d5 c5 d4 c4*/ \
+ "movdqa %%xmm4,%%xmm9\n\t" \
+ "punpcklwd %%xmm3,%%xmm9\n\t" \
+ "punpckhwd %%xmm3,%%xmm4\n\t" \
+ /*xmm10 = f3 e3 f2 e2 f1 e1 f0 e0*/ \
+ /*xmm6 = f7 e7 f6 e6 f5 e5 f4 e4*/ \
+ "movdqa %%xmm6,%%xmm10\n\t" \
+ "punpcklwd %%xmm7,%%xmm10\n\t" \
+ "punpckhwd %%xmm7,%%xmm6\n\t" \
+ /*xmm5 = h3 g3 h2 g2 h1 g1 h0 g0*/ \
+ /*xmm2 = h7 g7 h6 g6 h5 g5 h4 g4*/ \
+ "movdqa %%xmm2,%%xmm5\n\t" \
+ "punpcklwd %%xmm11,%%xmm5\n\t" \
+ "punpckhwd %%xmm11,%%xmm2\n\t" \
+ /*xmm1 = d1 c1 b1 a1 d0 c0 b0 a0*/ \
+ /*xmm8 = d3 c3 b3 a3 d2 c2 b2 a2*/ \
+ "movdqa %%xmm8,%%xmm1\n\t" \
+ "punpckldq %%xmm9,%%xmm1\n\t" \
+ "punpckhdq %%xmm9,%%xmm8\n\t" \
+ /*xmm3 = d5 c5 b5 a5 d4 c4 b4 a4*/ \
+ /*xmm0 = d7 c7 b7 a7 d6 c6 b6 a6*/ \
+ "movdqa %%xmm0,%%xmm3\n\t" \
+ "punpckldq %%xmm4,%%xmm3\n\t" \
+ "punpckhdq %%xmm4,%%xmm0\n\t" \
+ /*xmm9 = h1 g1 f1 e1 h0 g0 f0 e0*/ \
+ /*xmm10 = h3 g3 f3 e3 h2 g2 f2 e2*/ \
+ "movdqa %%xmm10,%%xmm9\n\t" \
+ "punpckldq %%xmm5,%%xmm9\n\t" \
+ "punpckhdq %%xmm5,%%xmm10\n\t" \
+ /*xmm7 = h5 g5 f5 e5 h4 g4 f4 e4*/ \
+ /*xmm6 = h7 g7 f7 e7 h6 g6 f6 e6*/ \
+ "movdqa %%xmm6,%%xmm7\n\t" \
+ "punpckldq %%xmm2,%%xmm7\n\t" \
+ "punpckhdq %%xmm2,%%xmm6\n\t" \
+ /*xmm11 = h0 g0 f0 e0 d0 c0 b0 a0*/ \
+ /*xmm1 = h1 g1 f1 e1 d1 c1 b1 a1*/ \
+ "movdqa %%xmm1,%%xmm11\n\t" \
+ "punpcklqdq %%xmm9,%%xmm11\n\t" \
+ "punpckhqdq %%xmm9,%%xmm1\n\t" \
+ /*xmm2 = h2 g2 f2 e2 d2 c2 b2 a2*/ \
+ /*xmm8 = h3 g3 f3 e3 d3 c3 b3 a3*/ \
+ "movdqa %%xmm8,%%xmm2\n\t" \
+ "punpcklqdq %%xmm10,%%xmm2\n\t" \
+ "punpckhqdq %%xmm10,%%xmm8\n\t" \
+ /*xmm4 = h4 g4 f4 e4 d4 c4 b4 a4*/ \
+ /*xmm3 = h5 g5 f5 e5 d5 c5 b5 a5*/ \
+ "movdqa %%xmm3,%%xmm4\n\t" \
+ "punpcklqdq %%xmm7,%%xmm4\n\t" \
+ "punpckhqdq %%xmm7,%%xmm3\n\t" \
+ /*xmm9 = h6 g6 f6 e6 d6 c6 b6 a6*/ \
+ /*xmm7 = h7 g7 f7 e7 d7 c7 b7 a7*/ \
+ "movdqa %%xmm0,%%xmm9\n\t" \
+ "punpcklqdq %%xmm6,%%xmm9\n\t" \
+ "punpckhqdq %%xmm6,%%xmm0\n\t" \
+ "movdqa %%xmm0,%%xmm7\n\t" \
+ "movdqa %%xmm11,%%xmm0\n\t" \
+ "movdqa %%xmm3,%%xmm5\n\t" \
+ "movdqa %%xmm8,%%xmm3\n\t" \
+ "movdqa %%xmm9,%%xmm6\n\t" \
+
+/*Rounds the outputs of the column transform, (y+8)>>4, and stores them.
+  This is computed as (y>>1)+4>>3 so it cannot overflow.*/
+#define OC_IDCT8x8_STORE_SSE2 \
+ "#OC_IDCT8x8_STORE_SSE2\n\t" \
+ "movdqa "OC_4",%%xmm5\n\t" \
+ "psraw $1,%%xmm0\n\t" \
+ "psraw $1,%%xmm1\n\t" \
+ "psraw $1,%%xmm4\n\t" \
+ "psraw $1,%%xmm3\n\t" \
+ "psraw $1,%%xmm6\n\t" \
+ "psraw $1,%%xmm7\n\t" \
+ "psraw $1,%%xmm2\n\t" \
+ "psraw $1,%%xmm11\n\t" \
+ "paddw %%xmm5,%%xmm0\n\t" \
+ "paddw %%xmm5,%%xmm1\n\t" \
+ "paddw %%xmm5,%%xmm4\n\t" \
+ "paddw %%xmm5,%%xmm3\n\t" \
+ "paddw %%xmm5,%%xmm6\n\t" \
+ "paddw %%xmm5,%%xmm7\n\t" \
+ "paddw %%xmm5,%%xmm2\n\t" \
+ "paddw %%xmm5,%%xmm11\n\t" \
+ "psraw $3,%%xmm0\n\t" \
+ "psraw $3,%%xmm1\n\t" \
+ "psraw $3,%%xmm4\n\t" \
+ "psraw $3,%%xmm3\n\t" \
+ "psraw $3,%%xmm6\n\t" \
+ "psraw $3,%%xmm7\n\t" \
+ "psraw $3,%%xmm2\n\t" \
+ "psraw $3,%%xmm11\n\t" \
+ "movdqa %%xmm0,0x00(%[y])\n\t" \
+ "movdqa %%xmm1,0x10(%[y])\n\t" \
+ "movdqa %%xmm4,0x20(%[y])\n\t" \
+ "movdqa %%xmm3,0x30(%[y])\n\t" \
+ "movdqa %%xmm6,0x40(%[y])\n\t" \
+ "movdqa %%xmm7,0x50(%[y])\n\t" \
+ "movdqa %%xmm2,0x60(%[y])\n\t" \
+ "movdqa %%xmm11,0x70(%[y])\n\t" \
+
+static void oc_idct8x8_slow_sse2(ogg_int16_t _y[64]){
+  /*The input is stored transposed, so each row we load holds one column of
+     the block, and the first pass transforms the rows of the block.*/
+  __asm__ __volatile__(
+    "movdqa 0x00(%[y]),%%xmm0\n\t"
+    "movdqa 0x10(%[y]),%%xmm1\n\t"
+    "movdqa 0x20(%[y]),%%xmm2\n\t"
+    "movdqa 0x30(%[y]),%%xmm3\n\t"
+    "movdqa 0x40(%[y]),%%xmm4\n\t"
+    "movdqa 0x50(%[y]),%%xmm5\n\t"
+    "movdqa 0x60(%[y]),%%xmm6\n\t"
+    "movdqa 0x70(%[y]),%%xmm7\n\t"
+    OC_IDCT8_SSE2
+    OC_TRANSPOSE8x8_SSE2
+    OC_IDCT8_SSE2
+    OC_IDCT8x8_STORE_SSE2
+    :
+    :[y]"r"(_y),[c]"r"(OC_IDCT_CONSTS_SSE2)
+    :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7",
+     "xmm8","xmm9","xmm10","xmm11"
+  );
+}
+
+/*Performs the iDCT when only the coefficients selected by _mask can be
+   non-zero, all of which lie in the upper-left 4x4 quadrant.*/
+static void oc_idct8x8_10_sse2(ogg_int16_t _y[64],
+ const ogg_uint16_t _mask[4][8]){
+  __asm__ __volatile__(
+    "movdqa 0x00(%[y]),%%xmm0\n\t"
+    "movdqa 0x10(%[y]),%%xmm1\n\t"
+    "movdqa 0x20(%[y]),%%xmm2\n\t"
+    "movdqa 0x30(%[y]),%%xmm3\n\t"
+    "pand 0x00(%[m]),%%xmm0\n\t"
+    "pand 0x10(%[m]),%%xmm1\n\t"
+    "pand 0x20(%[m]),%%xmm2\n\t"
+    "pand 0x30(%[m]),%%xmm3\n\t"
+    OC_IDCT8_4_SSE2
+    /*Only the first 4 rows of the block were non-zero, so only the first 4
+       columns of the transposed result are, too.*/
+    OC_TRANSPOSE8x8_SSE2
+    OC_IDCT8_4_SSE2
+    OC_IDCT8x8_STORE_SSE2
+    :
+    :[y]"r"(_y),[m]"r"(_mask),[c]"r"(OC_IDCT_CONSTS_SSE2)
+    :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7",
+     "xmm8","xmm9","xmm10","xmm11"
+  );
+}
+
+/*Performs an inverse 8x8 Type-II DCT transform.
+  The input is assumed to be scaled by a factor of 4 relative to orthonormal
+   version of the transform, stored in the transposed order given by
+   OC_FZIG_ZAG_SSE2, and 16-byte aligned.
+  The output is in natural order.
+  See oc_idct8x8_c() for the meaning of _last_zzi.*/
+void oc_idct8x8_sse2(ogg_int16_t _y[64],int _last_zzi){
+  /*The masks reproduce the reduced transforms the C version uses, which
+     ignore any coefficients outside the region _last_zzi implies.*/
+  if(_last_zzi<3)oc_idct8x8_10_sse2(_y,OC_IDCT_MASKS_SSE2[0]);
+  else if(_last_zzi<10)oc_idct8x8_10_sse2(_y,OC_IDCT_MASKS_SSE2[1]);
+  else oc_idct8x8_slow_sse2(_y);
+}
+
+#endif
@@ -0,0 +1,176 @@
+#if !defined(_x86_sse2loop_H)
+# define _x86_sse2loop_H (1)
+# include <stddef.h>
+# include "x86int.h"
+
+#if defined(OC_X86_64_ASM)
+
+/*On entry, xmm0={a0,...,a7}, xmm1={b0,...,b7}, xmm2={c0,...,c7} and
+   xmm3={d0,...d7}, all as 16-bit words, and [ll] points to 8 copies of 2*L.
+  On exit, xmm1={b0+lflim(R_0,L),...,b7+lflim(R_7,L),
+   c0-lflim(R_0,L),...,c7-lflim(R_7,L)} as unsigned bytes; xmm0 and xmm2...xmm7
+   are clobbered.
+  Unlike the MMX version, this works in 16 bits throughout, which makes it
+   simple to follow Section 7.10 of the spec exactly.*/
+#define OC_LOOP_FILTER8_SSE2 \
+ "#OC_LOOP_FILTER8_SSE2\n\t" \
+ /*xmm0={a0-d0,...,a7-d7}*/ \
+ "psubw %%xmm3,%%xmm0\n\t" \
+ /*xmm4=xmm5={c0-b0,...,c7-b7}*/ \
+ "movdqa %%xmm2,%%xmm4\n\t" \
+ "psubw %%xmm1,%%xmm4\n\t" \
+ "movdqa %%xmm4,%%xmm5\n\t" \
+ /*xmm7={4}x8*/ \
+ "pcmpeqw %%xmm7,%%xmm7\n\t" \
+ "psrlw $15,%%xmm7\n\t" \
+ "psllw $2,%%xmm7\n\t" \
+ /*Scale by 3.*/ \
+ "paddw %%xmm4,%%xmm4\n\t" \
+ "paddw %%xmm5,%%xmm0\n\t" \
+ "paddw %%xmm4,%%xmm0\n\t" \
+ /*xmm0=R_i=f+4>>3, with f={a0-d0+3*(c0-b0),...,a7-d7+3*(c7-b7)}*/ \
+ "paddw %%xmm7,%%xmm0\n\t" \
+ "psraw $3,%%xmm0\n\t" \
+ /*xmm6=mask of which R_i are negative*/ \
+ "movdqa %%xmm0,%%xmm6\n\t" \
+ "psraw $15,%%xmm6\n\t" \
+ /*xmm0=abs(R_i)*/ \
+ "pxor %%xmm6,%%xmm0\n\t" \
+ "psubw %%xmm6,%%xmm0\n\t" \
+ /*xmm5=max(2*L-abs(R_i),0)*/ \
+ "movdqa (%[ll]),%%xmm5\n\t" \
+ "pxor %%xmm7,%%xmm7\n\t" \
+ "psubw %%xmm0,%%xmm5\n\t" \
+ "pmaxsw %%xmm7,%%xmm5\n\t" \
+ /*xmm0=abs(lflim(R_i,L))=min(abs(R_i),max(2*L-abs(R_i),0))*/ \
+ "pminsw %%xmm5,%%xmm0\n\t" \
+ /*Restore the sign.*/ \
+ "pxor %%xmm6,%%xmm0\n\t" \
+ "psubw %%xmm6,%%xmm0\n\t" \
+ /*xmm1={b0+lflim(R_0,L),...,b7+lflim(R_7,L)}*/ \
+ /*xmm2={c0-lflim(R_0,L),...,c7-lflim(R_7,L)}*/ \
+ "paddw %%xmm0,%%xmm1\n\t" \
+ "psubw %%xmm0,%%xmm2\n\t" \
+ /*Saturate and pack them together.*/ \
+ "packuswb %%xmm2,%%xmm1\n\t" \
+
+#define OC_LOOP_FILTER_V_SSE2(_pix,_ystride,_ll) \
+  do{ \
+    ptrdiff_t ystride3__; \
+    __asm__ __volatile__( \
+      /*xmm0={a0,...,a7}*/ \
+      "movq (%[pix]),%%xmm0\n\t" \
+      /*ystride3=_ystride*3*/ \
+      "lea (%[ystride],%[ystride],2),%[ystride3]\n\t" \
+      /*xmm1={b0,...,b7}*/ \
+      "movq (%[pix],%[ystride]),%%xmm1\n\t" \
+      /*xmm2={c0,...,c7}*/ \
+      "movq (%[pix],%[ystride],2),%%xmm2\n\t" \
+      /*xmm3={d0,...,d7}*/ \
+      "movq (%[pix],%[ystride3]),%%xmm3\n\t" \
+      /*Expand everything to words.*/ \
+      "pxor %%xmm7,%%xmm7\n\t" \
+      "punpcklbw %%xmm7,%%xmm0\n\t" \
+      "punpcklbw %%xmm7,%%xmm1\n\t" \
+      "punpcklbw %%xmm7,%%xmm2\n\t" \
+      "punpcklbw %%xmm7,%%xmm3\n\t" \
+      OC_LOOP_FILTER8_SSE2 \
+      /*Write it back out.*/ \
+      "movq %%xmm1,(%[pix],%[ystride])\n\t" \
+      "movhps %%xmm1,(%[pix],%[ystride],2)\n\t" \
+      :[ystride3]"=&r"(ystride3__) \
+      :[pix]"r"(_pix-_ystride*2),[ystride]"r"((ptrdiff_t)(_ystride)), \
+       [ll]"r"(_ll) \
+      :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7" \
+    ); \
+  } \
+  while(0)
+
+#define OC_LOOP_FILTER_H_SSE2(_pix,_ystride,_ll) \
+  do{ \
+    unsigned char *pix__; \
+    ptrdiff_t      ystride3__; \
+    ptrdiff_t      d__; \
+    pix__=(_pix)-2; \
+    __asm__ __volatile__( \
+      /*x x x x d0 c0 b0 a0*/ \
+      "movd (%[pix]),%%xmm0\n\t" \
+      /*x x x x d1 c1 b1 a1*/ \
+      "movd (%[pix],%[ystride]),%%xmm1\n\t" \
+      /*ystride3=_ystride*3*/ \
+      "lea (%[ystride],%[ystride],2),%[ystride3]\n\t" \
+      /*x x x x d2 c2 b2 a2*/ \
+      "movd (%[pix],%[ystride],2),%%xmm2\n\t" \
+      /*x x x x d3 c3 b3 a3*/ \
+      "lea (%[pix],%[ystride],4),%[d]\n\t" \
+      "movd (%[pix],%[ystride3]),%%xmm3\n\t" \
+      /*x x x x d4 c4 b4 a4*/ \
+      "movd (%[d]),%%xmm4\n\t" \
+      /*x x x x d5 c5 b5 a5*/ \
+      "movd (%[d],%[ystride]),%%xmm5\n\t" \
+      /*x x x x d6 c6 b6 a6*/ \
+      "movd (%[d],%[ystride],2),%%xmm6\n\t" \
+      /*x x x x d7 c7 b7 a7*/ \
+      "movd (%[d],%[ystride3]),%%xmm7\n\t" \
+      /*xmm0=d1 d0 c1 c0 b1 b0 a1 a0*/ \
+      "punpcklbw %%xmm1,%%xmm0\n\t" \
+      /*xmm2=d3 d2 c3 c2 b3 b2 a3 a2*/ \
+      "punpcklbw %%xmm3,%%xmm2\n\t" \
+      /*xmm4=d5 d4 c5 c4 b5 b4 a5 a4*/ \
+      "punpcklbw %%xmm5,%%xmm4\n\t" \
+      /*xmm6=d7 d6 c7 c6 b7 b6 a7 a6*/ \
+      "punpcklbw %%xmm7,%%xmm6\n\t" \
+      /*xmm0=d3 d2 d1 d0 c3 c2 c1 c0 b3 b2 b1 b0 a3 a2 a1 a0*/ \
+      "punpcklwd %%xmm2,%%xmm0\n\t" \
+      /*xmm4=d7 d6 d5 d4 c7 c6 c5 c4 b7 b6 b5 b4 a7 a6 a5 a4*/ \
+      "punpcklwd %%xmm6,%%xmm4\n\t" \
+      /*xmm2=d3 d2 d1 d0 c3 c2 c1 c0 b3 b2 b1 b0 a3 a2 a1 a0*/ \
+      "movdqa %%xmm0,%%xmm2\n\t" \
+      /*xmm0=b7 ... b0 a7 ... a0*/ \
+      "punpckldq %%xmm4,%%xmm0\n\t" \
+      /*xmm2=d7 ... d0 c7 ... c0*/ \
+      "punpckhdq %%xmm4,%%xmm2\n\t" \
+      /*Expand everything to words.*/ \
+      "pxor %%xmm7,%%xmm7\n\t" \
+      "movdqa %%xmm0,%%xmm1\n\t" \
+      "movdqa %%xmm2,%%xmm3\n\t" \
+      /*xmm0={a0,...,a7}*/ \
+      "punpcklbw %%xmm7,%%xmm0\n\t" \
+      /*xmm1={b0,...,b7}*/ \
+      "punpckhbw %%xmm7,%%xmm1\n\t" \
+      /*xmm2={c0,...,c7}*/ \
+      "punpcklbw %%xmm7,%%xmm2\n\t" \
+      /*xmm3={d0,...,d7}*/ \
+      "punpckhbw %%xmm7,%%xmm3\n\t" \
+      OC_LOOP_FILTER8_SSE2 \
+      /*xmm1={b0+R_0'',c0-R_0'',...,b7+R_7'',c7-R_7''}*/ \
+      "movdqa %%xmm1,%%xmm0\n\t" \
+      "psrldq $8,%%xmm0\n\t" \
+      "punpcklbw %%xmm0,%%xmm1\n\t" \
+      /*Write out each pair of pixels.*/ \
+      "pextrw $0,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix])\n\t" \
+      "pextrw $1,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride])\n\t" \
+      "pextrw $2,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride],2)\n\t" \
+      "pextrw $3,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride3])\n\t" \
+      "lea (%[pix],%[ystride],4),%[pix]\n\t" \
+      "pextrw $4,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix])\n\t" \
+      "pextrw $5,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride])\n\t" \
+      "pextrw $6,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride],2)\n\t" \
+      "pextrw $7,%%xmm1,%k[d]\n\t" \
+      "movw %w[d],1(%[pix],%[ystride3])\n\t" \
+      :[pix]"+r"(pix__),[ystride3]"=&r"(ystride3__),[d]"=&r"(d__) \
+      :[ystride]"r"((ptrdiff_t)(_ystride)),[ll]"r"(_ll) \
+      :"memory","xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7" \
+    ); \
+  } \
+  while(0)
+
+# endif
+#endif
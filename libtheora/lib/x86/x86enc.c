@@ -43,6 +43,8 @@ void oc_enc_vtable_init_x86(oc_enc_ctx *_enc){
   if(cpu_flags&OC_CPU_X86_SSE2){
 # if defined(OC_X86_64_ASM)
     /*_enc->opt_vtable.fdct8x8=oc_enc_fdct8x8_x86_64sse2;*/
+    _enc->opt_vtable.frag_recon_intra=oc_frag_recon_intra_sse2;
+    _enc->opt_vtable.frag_recon_inter=oc_frag_recon_inter_sse2;
 # endif
   }
 }
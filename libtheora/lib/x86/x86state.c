@@ -42,6 +42,30 @@ static const unsigned char OC_FZIG_ZAG_MMX[128]={
   64,64,64,64,64,64,64,64,
 };
 
+#if defined(OC_X86_64_ASM)
+/*This table has been modified from OC_FZIG_ZAG by transposing the whole
+   destination, so that each row of coefficients the SSE2 iDCT loads holds one
+   column of the block.*/
+static const unsigned char OC_FZIG_ZAG_SSE2[128]={
+   0, 8, 1, 2, 9,16,24,17,
+  10, 3, 4,11,18,25,32,40,
+  33,26,19,12, 5, 6,13,20,
+  27,34,41,48,56,49,42,35,
+  28,21,14, 7,15,22,29,36,
+  43,50,57,58,51,44,37,30,
+  23,31,38,45,52,59,60,53,
+  46,39,47,54,61,62,55,63,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+  64,64,64,64,64,64,64,64,
+};
+#endif
+
 void oc_state_vtable_init_x86(oc_theora_state *_state){
   _state->cpu_flags=oc_cpu_flags_get();
   if(_state->cpu_flags&OC_CPU_X86_MMX){
@@ -58,5 +82,20 @@ void oc_state_vtable_init_x86(oc_theora_state *_state){
     _state->opt_data.dct_fzig_zag=OC_FZIG_ZAG_MMX;
   }
   else oc_state_vtable_init_c(_state);
+  if(_state->cpu_flags&OC_CPU_X86_SSE2){
+# if defined(OC_X86_64_ASM)
+    /*frag_copy, state_frag_copy_list and restore_fpu stay MMX: the copies
+       already move a whole row per instruction, and the encoder relies on the
+       emms.*/
+    _state->opt_vtable.frag_recon_intra=oc_frag_recon_intra_sse2;
+    _state->opt_vtable.frag_recon_inter=oc_frag_recon_inter_sse2;
+    _state->opt_vtable.frag_recon_inter2=oc_frag_recon_inter2_sse2;
+    _state->opt_vtable.idct8x8=oc_idct8x8_sse2;
+    _state->opt_vtable.state_frag_recon=oc_state_frag_recon_sse2;
+    _state->opt_vtable.state_loop_filter_frag_rows=
+     oc_state_loop_filter_frag_rows_sse2;
+    _state->opt_data.dct_fzig_zag=OC_FZIG_ZAG_SSE2;
+# endif
+  }
 }
 #endif
@@ -0,0 +1,203 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggTheora SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE Theora SOURCE CODE IS COPYRIGHT (C) 2002-2009                *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+  function: routines for validating the SSE2 kernels against the C ones
+  last mod: $Id$
+
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tests.h"
+
+/* The kernels are not exported from the libraries, so build them into the
+   test directly. */
+#include "../lib/internal.c"
+#include "../lib/idct.c"
+#include "../lib/fragment.c"
+#if defined(OC_X86_64_ASM)
+#include "../lib/cpu.c"
+#include "../lib/x86/sse2idct.c"
+#include "../lib/x86/sse2frag.c"
+#include "../lib/x86/sse2loop.h"
+#endif
+
+#define NITERS 20000
+
+#if defined(OC_X86_64_ASM)
+
+/* Random coefficients, with a fair share of extreme values to exercise the
+   16-bit wraparound of the reference. */
+static ogg_int16_t
+rand_coeff (void)
+{
+  switch (rand () & 7) {
+    case 0:
+      return (ogg_int16_t) (rand () & 0xFFFF);
+    case 1:
+      return (rand () & 1) ? 32767 : -32768;
+    case 2:
+    case 3:
+      return (ogg_int16_t) ((rand () & 8191) - 4096);
+    default:
+      return (ogg_int16_t) ((rand () & 255) - 128);
+  }
+}
+
+static void
+sse2_idct_test (void)
+{
+  static const int last_zzis[] = { 0, 1, 2, 3, 5, 9, 10, 20, 64 };
+  OC_ALIGN16 (ogg_int16_t sse2[64]);
+  ogg_int16_t ref[64];
+  int i, j, zzi;
+
+  for (i = 0; i < NITERS; i++) {
+    for (j = 0; j < sizeof (last_zzis) / sizeof (last_zzis[0]); j++) {
+      int ncoeffs;
+
+      /* Usually only the first last_zzi coefficients are set, like the
+         decoder produces, but sometimes fill the whole block, since the
+         reduced transforms must ignore the rest in exactly the same way. */
+      ncoeffs = (i & 3) ? OC_MAXI (last_zzis[j], 1) : 64;
+      memset (ref, 0, sizeof (ref));
+      for (zzi = 0; zzi < ncoeffs; zzi++)
+        ref[OC_FZIG_ZAG[zzi]] = rand_coeff ();
+      for (zzi = 0; zzi < 64; zzi++)
+        sse2[(zzi & 7) << 3 | zzi >> 3] = ref[zzi];
+
+      oc_idct8x8_c (ref, last_zzis[j]);
+      oc_idct8x8_sse2 (sse2, last_zzis[j]);
+      if (memcmp (ref, sse2, sizeof (ref)) != 0)
+        FAIL ("SSE2 iDCT does not match the C reference");
+    }
+  }
+}
+
+static void
+sse2_frag_recon_test (void)
+{
+  OC_ALIGN16 (ogg_int16_t residue[64]);
+  unsigned char src1[8 * 24];
+  unsigned char src2[8 * 24];
+  unsigned char ref[8 * 24];
+  unsigned char sse2[8 * 24];
+  int i, j;
+
+  for (i = 0; i < NITERS; i++) {
+    for (j = 0; j < 64; j++)
+      residue[j] = (i & 1) ? rand_coeff () : (ogg_int16_t) ((rand () & 511) -
+          256);
+    for (j = 0; j < sizeof (src1); j++) {
+      src1[j] = (unsigned char) rand ();
+      src2[j] = (unsigned char) rand ();
+      ref[j] = sse2[j] = (unsigned char) rand ();
+    }
+
+    oc_frag_recon_intra_c (ref + 3, 24, residue);
+    oc_frag_recon_intra_sse2 (sse2 + 3, 24, residue);
+    if (memcmp (ref, sse2, sizeof (ref)) != 0)
+      FAIL ("SSE2 intra reconstruction does not match the C reference");
+
+    oc_frag_recon_inter_c (ref + 5, src1 + 1, 24, residue);
+    oc_frag_recon_inter_sse2 (sse2 + 5, src1 + 1, 24, residue);
+    if (memcmp (ref, sse2, sizeof (ref)) != 0)
+      FAIL ("SSE2 inter reconstruction does not match the C reference");
+
+    oc_frag_recon_inter2_c (ref, src1 + 7, src2 + 2, 24, residue);
+    oc_frag_recon_inter2_sse2 (sse2, src1 + 7, src2 + 2, 24, residue);
+    if (memcmp (ref, sse2, sizeof (ref)) != 0)
+      FAIL ("SSE2 inter2 reconstruction does not match the C reference");
+  }
+}
+
+/* lflim() from Section 7.10 of the spec, as tabulated by
+   oc_state_loop_filter_init(). */
+static int
+lflim (int r, int l)
+{
+  int a = abs (r);
+  int v = a < l ? a : a < 2 * l ? 2 * l - a : 0;
+  return r < 0 ? -v : v;
+}
+
+static void
+ref_loop_filter (unsigned char *pix, int step, int stride, int l)
+{
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    unsigned char *p = pix + i * stride - 2 * step;
+    int f = p[0] - p[3 * step] + 3 * (p[2 * step] - p[step]);
+    f = lflim (f + 4 >> 3, l);
+    p[step] = OC_CLAMP255 (p[step] + f);
+    p[2 * step] = OC_CLAMP255 (p[2 * step] - f);
+  }
+}
+
+static void
+sse2_loop_filter_test (void)
+{
+  OC_ALIGN16 (ogg_int16_t ll[8]);
+  unsigned char ref[16 * 32];
+  unsigned char sse2[16 * 32];
+  int i, j;
+
+  for (i = 0; i < NITERS; i++) {
+    int l = 1 + rand () % 127;
+
+    for (j = 0; j < 8; j++)
+      ll[j] = (ogg_int16_t) (l << 1);
+    /* Mix smooth areas, where the filter actually does something, with
+       noise, which pushes R outside the limits. */
+    for (j = 0; j < sizeof (ref); j++) {
+      ref[j] = sse2[j] = (i & 1) ? (unsigned char) rand () :
+          (unsigned char) (128 + (j & 31) * (i % 7) - (rand () % (l + 1)));
+    }
+
+    /* The vertical edge of a fragment at (8,8), then the horizontal one. */
+    ref_loop_filter (ref + 8 * 32 + 8, 1, 32, l);
+    OC_LOOP_FILTER_H_SSE2 (sse2 + 8 * 32 + 8, 32, ll);
+    if (memcmp (ref, sse2, sizeof (ref)) != 0)
+      FAIL ("SSE2 horizontal loop filter does not match the C reference");
+
+    ref_loop_filter (ref + 8 * 32 + 8, 32, 1, l);
+    OC_LOOP_FILTER_V_SSE2 (sse2 + 8 * 32 + 8, 32, ll);
+    if (memcmp (ref, sse2, sizeof (ref)) != 0)
+      FAIL ("SSE2 vertical loop filter does not match the C reference");
+  }
+}
+
+#endif
+
+int main(int argc, char *argv[])
+{
+#if defined(OC_X86_64_ASM)
+  if (!(oc_cpu_flags_get () & OC_CPU_X86_SSE2)) {
+    INFO ("+ SSE2 not available, skipping");
+    exit (0);
+  }
+
+  srand (0);
+  INFO ("+ Comparing the SSE2 iDCT");
+  sse2_idct_test ();
+  INFO ("+ Comparing SSE2 fragment reconstruction");
+  sse2_frag_recon_test ();
+  INFO ("+ Comparing the SSE2 loop filter");
+  sse2_loop_filter_test ();
+#else
+  INFO ("+ SSE2 kernels not built, skipping");
+#endif
+
+  exit (0);
+}
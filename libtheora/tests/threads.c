@@ -0,0 +1,243 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggTheora SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE Theora SOURCE CODE IS COPYRIGHT (C) 2002-2009                *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+  function: routines for validating multi-threaded decoding
+  last mod: $Id$
+
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <theora/theoraenc.h>
+#include <theora/theoradec.h>
+
+#include "tests.h"
+
+#ifndef TH_DECCTL_SET_THREADS
+#define TH_DECCTL_SET_THREADS (17)
+#endif
+
+#define NFRAMES 12
+
+static ogg_packet packets[3 + NFRAMES];
+static int npackets;
+
+static void
+store_packet (ogg_packet *op)
+{
+  packets[npackets] = *op;
+  packets[npackets].packet = malloc (op->bytes);
+  memcpy (packets[npackets].packet, op->packet, op->bytes);
+  npackets++;
+}
+
+/* Fill a frame with moving gradients and noise, so that every block type
+   and a good number of tokens get used. */
+static void
+fill_frame (th_ycbcr_buffer yuv, int frame)
+{
+  int pli, x, y;
+
+  for (pli = 0; pli < 3; pli++) {
+    for (y = 0; y < yuv[pli].height; y++) {
+      for (x = 0; x < yuv[pli].width; x++) {
+        int v = ((x + frame * 3) ^ (y + frame)) + (rand () & 31);
+        if (pli == 0 && ((x >> 4) + (y >> 4) + frame / 4) & 1)
+          v *= 3;
+        yuv[pli].data[y * yuv[pli].stride + x] = (unsigned char) v;
+      }
+    }
+  }
+}
+
+static void
+threads_encode (th_pixel_fmt pixel_fmt)
+{
+  th_info ti;
+  th_comment tc;
+  th_enc_ctx *te;
+  th_ycbcr_buffer yuv;
+  ogg_packet op;
+  int frame, pli;
+
+  th_info_init (&ti);
+  ti.frame_width = 176;
+  ti.frame_height = 144;
+  ti.pic_width = ti.frame_width;
+  ti.pic_height = ti.frame_height;
+  ti.fps_numerator = 25;
+  ti.fps_denominator = 1;
+  ti.aspect_numerator = 1;
+  ti.aspect_denominator = 1;
+  ti.pixel_fmt = pixel_fmt;
+  ti.quality = 48;
+  ti.keyframe_granule_shift = 3;
+
+  te = th_encode_alloc (&ti);
+  if (te == NULL)
+    FAIL ("negative return code initializing encoder");
+
+  for (pli = 0; pli < 3; pli++) {
+    yuv[pli].width = ti.frame_width >> (pli && !(pixel_fmt & 1));
+    yuv[pli].height = ti.frame_height >> (pli && !(pixel_fmt & 2));
+    yuv[pli].stride = yuv[pli].width;
+    yuv[pli].data = malloc (yuv[pli].width * yuv[pli].height);
+  }
+
+  th_comment_init (&tc);
+  npackets = 0;
+  while (th_encode_flushheader (te, &tc, &op) > 0)
+    store_packet (&op);
+
+  srand (0);
+  for (frame = 0; frame < NFRAMES; frame++) {
+    fill_frame (yuv, frame);
+    if (th_encode_ycbcr_in (te, yuv) < 0)
+      FAIL ("negative error code submitting frame for compression");
+    if (th_encode_packetout (te, frame == NFRAMES - 1, &op) <= 0)
+      FAIL ("failed to retrieve compressed frame");
+    store_packet (&op);
+  }
+
+  for (pli = 0; pli < 3; pli++)
+    free (yuv[pli].data);
+  th_comment_clear (&tc);
+  th_info_clear (&ti);
+  th_encode_free (te);
+}
+
+/* Decode all the stored packets, and return the concatenation of the
+   decoded frames. */
+static unsigned char *
+threads_decode (int nthreads, int pp_level, size_t *sz)
+{
+  th_info ti;
+  th_comment tc;
+  th_setup_info *ts = NULL;
+  th_dec_ctx *td;
+  unsigned char *out, *p;
+  size_t frame_sz;
+  int i, pli, y;
+
+  th_info_init (&ti);
+  th_comment_init (&tc);
+  for (i = 0; i < npackets; i++) {
+    int result = th_decode_headerin (&ti, &tc, &ts, &packets[i]);
+    if (result == 0)
+      break;
+    if (result < 0)
+      FAIL ("error decoding headers");
+  }
+
+  td = th_decode_alloc (&ti, ts);
+  if (td == NULL)
+    FAIL ("th_decode_alloc returned a null pointer");
+  if (th_decode_ctl (td, TH_DECCTL_SET_THREADS, &nthreads,
+          sizeof (nthreads)) < 0)
+    FAIL ("failed to set the number of threads");
+  if (th_decode_ctl (td, TH_DECCTL_SET_PPLEVEL, &pp_level,
+          sizeof (pp_level)) < 0)
+    FAIL ("failed to set the post-processing level");
+
+  frame_sz = ti.frame_width * ti.frame_height * 3;
+  p = out = malloc (frame_sz * NFRAMES);
+  for (; i < npackets; i++) {
+    th_ycbcr_buffer yuv;
+
+    if (th_decode_packetin (td, &packets[i], NULL) < 0)
+      FAIL ("error decoding frame");
+    th_decode_ycbcr_out (td, yuv);
+    for (pli = 0; pli < 3; pli++) {
+      for (y = 0; y < yuv[pli].height; y++) {
+        memcpy (p, yuv[pli].data + y * yuv[pli].stride, yuv[pli].width);
+        p += yuv[pli].width;
+      }
+    }
+  }
+
+  *sz = p - out;
+
+  th_decode_free (td);
+  th_setup_free (ts);
+  th_comment_clear (&tc);
+  th_info_clear (&ti);
+
+  return out;
+}
+
+static void
+threads_test (th_pixel_fmt pixel_fmt)
+{
+  static const int nthreads[] = { 2, 3, 4, 16 };
+  static const int pp_levels[] = { 0, 4, 7 };
+  size_t ref_sz, sz;
+  int i, j;
+
+  threads_encode (pixel_fmt);
+
+  for (j = 0; j < sizeof (pp_levels) / sizeof (pp_levels[0]); j++) {
+    unsigned char *ref = threads_decode (1, pp_levels[j], &ref_sz);
+
+    for (i = 0; i < sizeof (nthreads) / sizeof (nthreads[0]); i++) {
+      unsigned char *out = threads_decode (nthreads[i], pp_levels[j], &sz);
+
+      if (sz != ref_sz || memcmp (ref, out, sz) != 0)
+        FAIL ("multi-threaded decoding does not match single-threaded");
+      free (out);
+    }
+    free (ref);
+  }
+
+  for (i = 0; i < npackets; i++)
+    free (packets[i].packet);
+}
+
+int main(int argc, char *argv[])
+{
+  th_info ti;
+  th_comment tc;
+  th_setup_info *ts = NULL;
+  th_dec_ctx *td;
+  th_enc_ctx *te;
+  ogg_packet op;
+  int nthreads = 2;
+  int i;
+
+  /* Check whether this build supports threads at all. */
+  th_info_init (&ti);
+  ti.frame_width = ti.pic_width = 16;
+  ti.frame_height = ti.pic_height = 16;
+  te = th_encode_alloc (&ti);
+  th_comment_init (&tc);
+  for (i = 0; th_encode_flushheader (te, &tc, &op) > 0; i++)
+    th_decode_headerin (&ti, &tc, &ts, &op);
+  td = th_decode_alloc (&ti, ts);
+  if (th_decode_ctl (td, TH_DECCTL_SET_THREADS, &nthreads,
+          sizeof (nthreads)) == TH_EIMPL) {
+    INFO ("+ Multi-threaded decoding not supported, skipping");
+    exit (0);
+  }
+  th_decode_free (td);
+  th_setup_free (ts);
+  th_comment_clear (&tc);
+  th_info_clear (&ti);
+  th_encode_free (te);
+
+  INFO ("+ Comparing multi-threaded 4:2:0 decoding");
+  threads_test (TH_PF_420);
+  INFO ("+ Comparing multi-threaded 4:2:2 decoding");
+  threads_test (TH_PF_422);
+  INFO ("+ Comparing multi-threaded 4:4:4 decoding");
+  threads_test (TH_PF_444);
+
+  exit (0);
+}
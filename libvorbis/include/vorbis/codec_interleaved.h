@@ -0,0 +1,37 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis SOURCE CODE IS (C) COPYRIGHT 1994-2009             *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: synthesis straight into an interleaved float buffer
+
+ ********************************************************************/
+
+#ifndef _vorbis_codec_interleaved_h_
+#define _vorbis_codec_interleaved_h_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+#include <vorbis/codec.h>
+
+/* kept out of codec.h so that code built against a stock libvorbis
+   does not see it; implemented in lib/block.c */
+extern int vorbis_synthesis_blockin_interleaved(vorbis_dsp_state *v,
+                                                vorbis_block *vb,
+                                                float *out);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <ogg/ogg.h>
 #include "vorbis/codec.h"
+#include "vorbis/codec_interleaved.h"
 #include "codec_internal.h"
 
 #include "window.h"
@@ -30,6 +31,7 @@
 #include "lpc.h"
 #include "registry.h"
 #include "misc.h"
+#include "os.h"
 
 static int ilog2(unsigned int v){
   int ret=0;
@@ -713,18 +715,95 @@ int vorbis_synthesis_init(vorbis_dsp_state *v,vorbis_info *vi){
   return 0;
 }
 
+/* d[(i-a)*step]=pcm[i]*w[n-i-1] + p[i]*w[i] for a<=i<b.  d may alias
+   pcm+a when step is 1; n is a multiple of four, as even the smallest
+   half-rate window is 16 samples long */
+static void _overlap_add(float *d,int step,const float *pcm,const float *p,
+                         const float *w,int n,int a,int b){
+  int i=a;
+#ifdef VORBIS_SSE
+  for(;i+4<=b;i+=4,d+=4*step){
+    __m128 r=_mm_loadu_ps(w+n-i-4);
+    r=_mm_shuffle_ps(r,r,_MM_SHUFFLE(0,1,2,3));
+    r=_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pcm+i),r),
+                 _mm_mul_ps(_mm_loadu_ps(p+i),_mm_loadu_ps(w+i)));
+    if(step==1){
+      _mm_storeu_ps(d,r);
+    }else{
+      _mm_store_ss(d,r);
+      _mm_store_ss(d+step,_mm_shuffle_ps(r,r,_MM_SHUFFLE(1,1,1,1)));
+      _mm_store_ss(d+2*step,_mm_shuffle_ps(r,r,_MM_SHUFFLE(2,2,2,2)));
+      _mm_store_ss(d+3*step,_mm_shuffle_ps(r,r,_MM_SHUFFLE(3,3,3,3)));
+    }
+  }
+#endif
+  for(;i<b;i++,d+=step)
+    *d=pcm[i]*w[n-i-1] + p[i]*w[i];
+}
+
+/* the part of [pos,pos+n) that lies within [ret,cur), relative to pos */
+static void _clip(int pos,int n,int ret,int cur,int *lo,int *hi){
+  *lo=ret-pos;
+  *hi=cur-pos;
+  if(*lo<0)*lo=0;
+  if(*hi>n)*hi=n;
+  if(*hi<*lo)*hi=*lo;
+}
+
+/* Overlap/adds n samples of channel j at v->pcm[j]+pos.  Whatever falls
+   within [ret,cur) goes to the interleaved output instead, if there is
+   one; the rest stays in v->pcm where lapout expects it. */
+static void _lap_channel(vorbis_dsp_state *v,float *out,int ret,int cur,
+                         int j,int pos,const float *p,const float *w,int n){
+  float *pcm=v->pcm[j]+pos;
+  int ch=v->vi->channels;
+  int lo=0,hi=0;
+
+  if(out)_clip(pos,n,ret,cur,&lo,&hi);
+  _overlap_add(pcm,1,pcm,p,w,n,0,lo);
+  if(lo<hi)_overlap_add(out+(pos+lo-ret)*ch+j,ch,pcm,p,w,n,lo,hi);
+  _overlap_add(pcm+hi,1,pcm,p,w,n,hi,n);
+}
+
+/* copies n samples of channel j to v->pcm[j]+pos, or to the output as
+   above */
+static void _copy_channel(vorbis_dsp_state *v,float *out,int ret,int cur,
+                          int j,int pos,const float *p,int n){
+  float *pcm=v->pcm[j]+pos;
+  int ch=v->vi->channels;
+  int lo=0,hi=0;
+  int i;
+
+  if(out)_clip(pos,n,ret,cur,&lo,&hi);
+  for(i=0;i<lo;i++)
+    pcm[i]=p[i];
+  for(;i<hi;i++)
+    out[(pos+i-ret)*ch+j]=p[i];
+  for(;i<n;i++)
+    pcm[i]=p[i];
+}
+
 /* Unlike in analysis, the window is only partially applied for each
    block.  The time domain envelope is not yet handled at the point of
-   calling (as it relies on the previous block). */
+   calling (as it relies on the previous block).
 
-int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
+   With out set, the samples that become available are interleaved
+   into it rather than left in v->pcm, and returned as read. */
+
+static int _synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb,
+                              float *out){
   vorbis_info *vi=v->vi;
   codec_setup_info *ci=vi->codec_setup;
   private_state *b=v->backend_state;
   int hs=ci->halfrate_flag;
+  int n=ci->blocksizes[vb->W]>>(hs+1);
+  int n0=ci->blocksizes[0]>>(hs+1);
+  int n1=ci->blocksizes[1]>>(hs+1);
+  int thisCenter=0;
+  int prevCenter=0;
+  int ret,cur;
   int i,j;
 
-  if(!vb)return(OV_EINVAL);
   if(v->pcm_current>v->pcm_returned  && v->pcm_returned!=-1)return(OV_EINVAL);
 
   v->lW=v->W;
@@ -741,13 +820,6 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
 
   if(vb->pcm){  /* no pcm to process if vorbis_synthesis_trackonly
                    was called on block */
-    int n=ci->blocksizes[v->W]>>(hs+1);
-    int n0=ci->blocksizes[0]>>(hs+1);
-    int n1=ci->blocksizes[1]>>(hs+1);
-
-    int thisCenter;
-    int prevCenter;
-
     v->glue_bits+=vb->glue_bits;
     v->time_bits+=vb->time_bits;
     v->floor_bits+=vb->floor_bits;
@@ -761,57 +833,6 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
       prevCenter=n1;
     }
 
-    /* v->pcm is now used like a two-stage double buffer.  We don't want
-       to have to constantly shift *or* adjust memory usage.  Don't
-       accept a new block until the old is shifted out */
-
-    for(j=0;j<vi->channels;j++){
-      /* the overlap/add section */
-      if(v->lW){
-        if(v->W){
-          /* large/large */
-          float *w=_vorbis_window_get(b->window[1]-hs);
-          float *pcm=v->pcm[j]+prevCenter;
-          float *p=vb->pcm[j];
-          for(i=0;i<n1;i++)
-            pcm[i]=pcm[i]*w[n1-i-1] + p[i]*w[i];
-        }else{
-          /* large/small */
-          float *w=_vorbis_window_get(b->window[0]-hs);
-          float *pcm=v->pcm[j]+prevCenter+n1/2-n0/2;
-          float *p=vb->pcm[j];
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
-        }
-      }else{
-        if(v->W){
-          /* small/large */
-          float *w=_vorbis_window_get(b->window[0]-hs);
-          float *pcm=v->pcm[j]+prevCenter;
-          float *p=vb->pcm[j]+n1/2-n0/2;
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
-          for(;i<n1/2+n0/2;i++)
-            pcm[i]=p[i];
-        }else{
-          /* small/small */
-          float *w=_vorbis_window_get(b->window[0]-hs);
-          float *pcm=v->pcm[j]+prevCenter;
-          float *p=vb->pcm[j];
-          for(i=0;i<n0;i++)
-            pcm[i]=pcm[i]*w[n0-i-1] +p[i]*w[i];
-        }
-      }
-
-      /* the copy section */
-      {
-        float *pcm=v->pcm[j]+thisCenter;
-        float *p=vb->pcm[j]+n;
-        for(i=0;i<n;i++)
-          pcm[i]=p[i];
-      }
-    }
-
     if(v->centerW)
       v->centerW=0;
     else
@@ -899,8 +920,72 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
   /* Update, cleanup */
 
   if(vb->eofflag)v->eofflag=1;
-  return(0);
+  if(!vb->pcm)return(0);
+
+  /* The data only goes in now that the trimming above has settled
+     which part of it gets returned.  v->pcm is used like a two-stage
+     double buffer.  We don't want to have to constantly shift *or*
+     adjust memory usage.  Don't accept a new block until the old is
+     shifted out */
+
+  ret=v->pcm_returned;
+  cur=v->pcm_current;
+  for(j=0;j<vi->channels;j++){
+    /* the overlap/add section */
+    if(v->lW){
+      if(v->W){
+        /* large/large */
+        float *w=_vorbis_window_get(b->window[1]-hs);
+        _lap_channel(v,out,ret,cur,j,prevCenter,vb->pcm[j],w,n1);
+      }else{
+        /* large/small */
+        float *w=_vorbis_window_get(b->window[0]-hs);
+        _copy_channel(v,out,ret,cur,j,prevCenter,
+                      v->pcm[j]+prevCenter,n1/2-n0/2);
+        _lap_channel(v,out,ret,cur,j,prevCenter+n1/2-n0/2,vb->pcm[j],w,n0);
+      }
+    }else{
+      float *w=_vorbis_window_get(b->window[0]-hs);
+      if(v->W){
+        /* small/large */
+        float *p=vb->pcm[j]+n1/2-n0/2;
+        _lap_channel(v,out,ret,cur,j,prevCenter,p,w,n0);
+        _copy_channel(v,out,ret,cur,j,prevCenter+n0,p+n0,n1/2-n0/2);
+      }else{
+        /* small/small */
+        _lap_channel(v,out,ret,cur,j,prevCenter,vb->pcm[j],w,n0);
+      }
+    }
+
+    /* the copy section */
+    {
+      float *pcm=v->pcm[j]+thisCenter;
+      float *p=vb->pcm[j]+n;
+      for(i=0;i<n;i++)
+        pcm[i]=p[i];
+    }
+  }
+
+  if(!out)return(0);
+  v->pcm_returned=cur;
+  return(cur-ret);
+}
+
+int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
+  if(!vb)return(OV_EINVAL);
+  return _synthesis_blockin(v,vb,NULL);
+}
 
+/* Like vorbis_synthesis_blockin() followed by vorbis_synthesis_pcmout()
+   and vorbis_synthesis_read(), but the samples are written to out,
+   interleaved, as the overlap/add produces them, saving a pass over the
+   data for callers that want them that way.  out must have room for
+   vorbis_info_blocksize(vi,1)/2 sample frames.  Returns the number of
+   sample frames written. */
+int vorbis_synthesis_blockin_interleaved(vorbis_dsp_state *v,
+                                         vorbis_block *vb,float *out){
+  if(!vb || !out)return(OV_EINVAL);
+  return _synthesis_blockin(v,vb,out);
 }
 
 /* pcm==NULL indicates we just want the pending samples, no more */
@@ -46,6 +46,13 @@
 #include "os.h"
 #include "misc.h"
 
+/* The SSE paths do the same float arithmetic as the C code they
+   replace, two complex values (four floats) at a time.  They're only
+   written for the float transform. */
+#if defined(VORBIS_SSE) && !defined(MDCT_INTEGERIZED)
+#  define MDCT_SSE
+#endif
+
 /* build lookups for trig functions; also pre-figure scaling and
    some window function algebra. */
 
@@ -314,6 +321,57 @@ STIN void mdct_butterfly_generic(DATA_TYPE *T,
   }while(x2>=x);
 }
 
+#ifdef MDCT_SSE
+
+/* the butterfly rotation of two complex values at once:
+   {r0,r1} by {tr,ti} gives {r1*ti+r0*tr,r1*tr-r0*ti} */
+STIN __m128 mdct_cmul_sse(__m128 r,__m128 t){
+  const __m128 odd=_mm_set_ps(-0.f,0.f,-0.f,0.f);
+  __m128 a=_mm_mul_ps(_mm_shuffle_ps(r,r,_MM_SHUFFLE(3,3,1,1)),
+                      _mm_shuffle_ps(t,t,_MM_SHUFFLE(2,3,0,1)));
+  __m128 b=_mm_mul_ps(_mm_shuffle_ps(r,r,_MM_SHUFFLE(2,2,0,0)),t);
+  return _mm_add_ps(a,_mm_xor_ps(b,odd));
+}
+
+/* both the first stage and the generic butterfly; the first stage is
+   the generic one with a trig step of 4 */
+STIN void mdct_butterfly_generic_sse(DATA_TYPE *T,
+                                     DATA_TYPE *x,
+                                     int points,
+                                     int trigint){
+
+  DATA_TYPE *x1        = x          + points      - 8;
+  DATA_TYPE *x2        = x          + (points>>1) - 8;
+  __m128     t;
+  __m128     a;
+  __m128     b;
+
+  do{
+
+    /* {x[4],x[5]} use the second twiddle, {x[6],x[7]} the first */
+    t=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(T+trigint));
+    t=_mm_loadh_pi(t,(const __m64 *)T);
+    a=_mm_loadu_ps(x1+4);
+    b=_mm_loadu_ps(x2+4);
+    _mm_storeu_ps(x1+4,_mm_add_ps(a,b));
+    _mm_storeu_ps(x2+4,mdct_cmul_sse(_mm_sub_ps(a,b),t));
+
+    t=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(T+trigint*3));
+    t=_mm_loadh_pi(t,(const __m64 *)(T+trigint*2));
+    a=_mm_loadu_ps(x1);
+    b=_mm_loadu_ps(x2);
+    _mm_storeu_ps(x1,_mm_add_ps(a,b));
+    _mm_storeu_ps(x2,mdct_cmul_sse(_mm_sub_ps(a,b),t));
+
+    T+=trigint*4;
+    x1-=8;
+    x2-=8;
+
+  }while(x2>=x);
+}
+
+#endif
+
 STIN void mdct_butterflies(mdct_lookup *init,
                              DATA_TYPE *x,
                              int points){
@@ -322,6 +380,16 @@ STIN void mdct_butterflies(mdct_lookup *init,
   int stages=init->log2n-5;
   int i,j;
 
+#ifdef MDCT_SSE
+  if(--stages>0){
+    mdct_butterfly_generic_sse(T,x,points,4);
+  }
+
+  for(i=1;--stages>0;i++){
+    for(j=0;j<(1<<i);j++)
+      mdct_butterfly_generic_sse(T,x+(points>>i)*j,points>>i,4<<i);
+  }
+#else
   if(--stages>0){
     mdct_butterfly_first(T,x,points);
   }
@@ -330,6 +398,7 @@ STIN void mdct_butterflies(mdct_lookup *init,
     for(j=0;j<(1<<i);j++)
       mdct_butterfly_generic(T,x+(points>>i)*j,points>>i,4<<i);
   }
+#endif
 
   for(j=0;j<points;j+=32)
     mdct_butterfly_32(x+j);
@@ -352,6 +421,43 @@ STIN void mdct_bitreverse(mdct_lookup *init,
   DATA_TYPE *w1      = x = w0+(n>>1);
   DATA_TYPE *T       = init->trig+n;
 
+#ifdef MDCT_SSE
+  const __m128 odd   = _mm_set_ps(-0.f,0.f,-0.f,0.f);
+  const __m128 half  = _mm_set1_ps(.5f);
+
+  __m128 a,b,s,d,t,r,h;
+
+  do{
+    /* a={x0[0],x0[1],x0'[0],x0'[1]}, b likewise for x1 */
+    a=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(x+bit[0]));
+    a=_mm_loadh_pi(a,(const __m64 *)(x+bit[2]));
+    b=_mm_loadl_pi(_mm_setzero_ps(),(const __m64 *)(x+bit[1]));
+    b=_mm_loadh_pi(b,(const __m64 *)(x+bit[3]));
+    s=_mm_add_ps(a,b);
+    d=_mm_sub_ps(a,b);
+    t=_mm_loadu_ps(T);
+    /* {r2,r3,r2',r3'} */
+    r=_mm_mul_ps(_mm_shuffle_ps(d,d,_MM_SHUFFLE(3,3,1,1)),
+                 _mm_shuffle_ps(t,t,_MM_SHUFFLE(2,3,0,1)));
+    r=_mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(s,s,_MM_SHUFFLE(2,2,0,0)),t),
+                 _mm_xor_ps(r,odd));
+    /* {r0,r1,r0',r1'} after halving */
+    h=_mm_shuffle_ps(s,d,_MM_SHUFFLE(2,0,3,1));
+    h=_mm_mul_ps(_mm_shuffle_ps(h,h,_MM_SHUFFLE(3,1,2,0)),half);
+
+    w1-=4;
+
+    _mm_storeu_ps(w0,_mm_add_ps(h,r));
+    /* {r0-r2,r3-r1,...}, with the halves swapped */
+    r=_mm_sub_ps(_mm_xor_ps(h,odd),_mm_xor_ps(r,odd));
+    _mm_storeu_ps(w1,_mm_shuffle_ps(r,r,_MM_SHUFFLE(1,0,3,2)));
+
+    T     += 4;
+    bit   += 4;
+    w0    += 4;
+
+  }while(w0<w1);
+#else
   do{
     DATA_TYPE *x0    = x+bit[0];
     DATA_TYPE *x1    = x+bit[1];
@@ -392,6 +498,7 @@ STIN void mdct_bitreverse(mdct_lookup *init,
               w0    += 4;
 
   }while(w0<w1);
+#endif
 }
 
 void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
@@ -405,6 +512,107 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
   DATA_TYPE *oX = out+n2+n4;
   DATA_TYPE *T  = init->trig+n4;
 
+#ifdef MDCT_SSE
+  const __m128 odd  = _mm_set_ps(-0.f,0.f,-0.f,0.f);
+  const __m128 even = _mm_set_ps(0.f,-0.f,0.f,-0.f);
+  const __m128 all  = _mm_set1_ps(-0.f);
+  __m128 lo,hi,ev,od,t,tev,tod;
+
+  do{
+    /* ev={iX[0],iX[2],iX[4],iX[6]}; iX[7] may be past the input */
+    lo=_mm_loadu_ps(iX);
+    hi=_mm_loadu_ps(iX+3);
+    ev=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(3,1,2,0));
+    t=_mm_loadu_ps(T);
+    oX         -= 4;
+    od=_mm_xor_ps(_mm_shuffle_ps(ev,ev,_MM_SHUFFLE(2,3,0,1)),even);
+    _mm_storeu_ps(oX,
+      _mm_sub_ps(_mm_mul_ps(od,_mm_shuffle_ps(t,t,_MM_SHUFFLE(1,1,3,3))),
+                 _mm_mul_ps(ev,_mm_shuffle_ps(t,t,_MM_SHUFFLE(0,0,2,2)))));
+    iX         -= 8;
+    T          += 4;
+  }while(iX>=in);
+
+  iX            = in+n2-8;
+  oX            = out+n2+n4;
+  T             = init->trig+n4;
+
+  do{
+    lo=_mm_loadu_ps(iX);
+    hi=_mm_loadu_ps(iX+4);
+    ev=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(2,0,2,0));
+    T          -= 4;
+    t=_mm_loadu_ps(T);
+    od=_mm_mul_ps(_mm_shuffle_ps(ev,ev,_MM_SHUFFLE(1,1,3,3)),
+                  _mm_shuffle_ps(t,t,_MM_SHUFFLE(1,0,3,2)));
+    _mm_storeu_ps(oX,
+      _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(ev,ev,_MM_SHUFFLE(0,0,2,2)),
+                            _mm_shuffle_ps(t,t,_MM_SHUFFLE(0,1,2,3))),
+                 _mm_xor_ps(od,odd)));
+    iX         -= 8;
+    oX         += 4;
+  }while(iX>=in);
+
+  mdct_butterflies(init,out+n2,n2);
+  mdct_bitreverse(init,out);
+
+  /* roatate + window */
+
+  {
+    DATA_TYPE *oX1=out+n2+n4;
+    DATA_TYPE *oX2=out+n2+n4;
+    DATA_TYPE *iX =out;
+    T             =init->trig+n2;
+
+    do{
+      lo=_mm_loadu_ps(iX);
+      hi=_mm_loadu_ps(iX+4);
+      ev=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(2,0,2,0));
+      od=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(3,1,3,1));
+      lo=_mm_loadu_ps(T);
+      hi=_mm_loadu_ps(T+4);
+      tev=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(2,0,2,0));
+      tod=_mm_shuffle_ps(lo,hi,_MM_SHUFFLE(3,1,3,1));
+
+      oX1-=4;
+
+      t=_mm_sub_ps(_mm_mul_ps(ev,tod),_mm_mul_ps(od,tev));
+      _mm_storeu_ps(oX1,_mm_shuffle_ps(t,t,_MM_SHUFFLE(0,1,2,3)));
+      t=_mm_add_ps(_mm_mul_ps(ev,tev),_mm_mul_ps(od,tod));
+      _mm_storeu_ps(oX2,_mm_xor_ps(t,all));
+
+      oX2+=4;
+      iX    +=   8;
+      T     +=   8;
+    }while(iX<oX1);
+
+    iX=out+n2+n4;
+    oX1=out+n4;
+    oX2=oX1;
+
+    do{
+      oX1-=4;
+      iX-=4;
+
+      t=_mm_loadu_ps(iX);
+      _mm_storeu_ps(oX1,t);
+      t=_mm_shuffle_ps(t,t,_MM_SHUFFLE(0,1,2,3));
+      _mm_storeu_ps(oX2,_mm_xor_ps(t,all));
+
+      oX2+=4;
+    }while(oX2<iX);
+
+    iX=out+n2+n4;
+    oX1=out+n2+n4;
+    oX2=out+n2;
+    do{
+      oX1-=4;
+      t=_mm_loadu_ps(iX);
+      _mm_storeu_ps(oX1,_mm_shuffle_ps(t,t,_MM_SHUFFLE(0,1,2,3)));
+      iX+=4;
+    }while(oX1>oX2);
+  }
+#else
   do{
     oX         -= 4;
     oX[0]       = MULT_NORM(-iX[2] * T[3] - iX[0]  * T[2]);
@@ -488,6 +696,7 @@ void mdct_backward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
       iX+=4;
     }while(oX1>oX2);
   }
+#endif
 }
 
 void mdct_forward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
@@ -561,3 +770,82 @@ void mdct_forward(mdct_lookup *init, DATA_TYPE *in, DATA_TYPE *out){
     T+=2;
   }
 }
+
+#ifdef _V_SELFTEST
+
+/* Checks both transforms against a direct evaluation of the MDCT sums
+   for every block size Vorbis allows; this exercises whichever
+   implementation (C or SSE) the library is built with. */
+
+#include <stdio.h>
+
+/* cos(2*pi/n*(i+.5+n/4)*(k+.5)) is cos(2*pi/(4n)*m) for an integer
+   m=(2i+1+n/2)*(2k+1) */
+static double ref_cos(const double *c,int n,int i,int k){
+  return c[((long)(2*i+1+n/2)*(2*k+1))%(4*n)];
+}
+
+static int check(const char *what,int n,const float *out,const double *ref,
+                 int len){
+  double max=0,err=0;
+  int i;
+  for(i=0;i<len;i++){
+    if(fabs(ref[i])>max)max=fabs(ref[i]);
+    if(fabs(out[i]-ref[i])>err)err=fabs(out[i]-ref[i]);
+  }
+  fprintf(stderr,"%s n=%d: max error %g of %g... ",what,n,err,max);
+  if(err>max*1e-5){
+    fprintf(stderr,"FAILED\n");
+    return 1;
+  }
+  fprintf(stderr,"ok\n");
+  return 0;
+}
+
+int main(){
+  int n;
+  int failed=0;
+  srand(1);
+  for(n=64;n<=8192;n<<=1){
+    mdct_lookup m;
+    float  *in=_ogg_malloc(n*sizeof(*in));
+    float  *out=_ogg_malloc(n*sizeof(*out));
+    double *x=_ogg_malloc(n*sizeof(*x));
+    double *ref=_ogg_malloc(n*sizeof(*ref));
+    double *c=_ogg_malloc(4*n*sizeof(*c));
+    int     i,k;
+
+    for(i=0;i<4*n;i++)c[i]=cos(2*M_PI/(4*n)*i);
+    for(i=0;i<n;i++)x[i]=in[i]=(float)rand()/RAND_MAX-.5f;
+    mdct_init(&m,n);
+
+    /* forward: n in, n/2 out, scaled by 4/n */
+    mdct_forward(&m,in,out);
+    for(k=0;k<n/2;k++){
+      double s=0;
+      for(i=0;i<n;i++)s+=x[i]*ref_cos(c,n,i,k);
+      ref[k]=s*4/n;
+    }
+    failed|=check("mdct_forward ",n,out,ref,n/2);
+
+    /* backward: n/2 in, n out, unscaled */
+    for(k=0;k<n/2;k++)in[k]=(float)x[k];
+    mdct_backward(&m,in,out);
+    for(i=0;i<n;i++){
+      double s=0;
+      for(k=0;k<n/2;k++)s+=x[k]*ref_cos(c,n,i,k);
+      ref[i]=s;
+    }
+    failed|=check("mdct_backward",n,out,ref,n);
+
+    mdct_clear(&m);
+    _ogg_free(in);
+    _ogg_free(out);
+    _ogg_free(x);
+    _ogg_free(ref);
+    _ogg_free(c);
+  }
+  return failed;
+}
+
+#endif
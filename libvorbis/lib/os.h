@@ -164,6 +164,17 @@ static __inline void vorbis_fpu_restore(vorbis_fpu_control fpu){
 #endif /* Special MSVC x64 implementation */
 
 
+/* SSE float code paths for the MDCT and the synthesis overlap/add.
+   Like the above, this is decided at build time: every x86_64 CPU has
+   SSE, and 32 bit builds get it when the compiler targets it. */
+#if (defined(_MSC_VER) && (defined(_WIN64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP>=1))) || \
+    (defined(__GNUC__) && defined(__SSE__))
+#  define VORBIS_SSE
+#  include <xmmintrin.h>
+#endif
+
+
 /* If no special implementation was found for the current compiler / platform,
    use the default implementation here: */
 #ifndef VORBIS_FPU_CONTROL
@@ -0,0 +1,302 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis SOFTWARE CODEC SOURCE CODE.   *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis SOURCE CODE IS (C) COPYRIGHT 1994-2010             *
+ * by the Xiph.Org Foundation http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: decode speed benchmark
+ last mod: $Id$
+
+ Decodes a fixed corpus from memory and reports the time spent per
+ decoded sample.  Without arguments the corpus is synthesized and
+ encoded at startup (always the same streams for a given encoder);
+ otherwise the named Ogg Vorbis files are used.  Run 'make bench' to
+ build it; it is not part of 'make check'.
+
+ ********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <vorbis/codec.h>
+#include <vorbis/vorbisenc.h>
+
+#include "util.h"
+
+#define RATE     44100
+#define SECONDS  5
+#define MIN_TIME 2.0 /* seconds of decoding per stream */
+
+typedef struct {
+  char          name[64];
+  unsigned char *data;
+  long          bytes;
+  long          storage;
+} stream;
+
+static void append(stream *s,const unsigned char *data,long bytes){
+  if(s->bytes+bytes>s->storage){
+    s->storage=(s->bytes+bytes)*2;
+    s->data=realloc(s->data,s->storage);
+    if(!s->data){
+      fprintf(stderr,"Out of memory\n");
+      exit(1);
+    }
+  }
+  memcpy(s->data+s->bytes,data,bytes);
+  s->bytes+=bytes;
+}
+
+/* the synthetic corpus: a few kinds of material at low, medium and
+   high quality, all stereo */
+
+static float gen_sample(int kind,int ch,long i){
+  double t=(double)i/RATE;
+  switch(kind){
+  case 0:
+    /* log sweep 50Hz..15kHz, phase shifted between channels */
+    return .7*sin(2*M_PI*50*SECONDS/log(300.)*(exp(t/SECONDS*log(300.))-1)+ch);
+  case 1:
+    /* a chord with tremolo */
+    return .25*(sin(2*M_PI*220*t)+sin(2*M_PI*277.18*t)+sin(2*M_PI*329.63*t))*
+      (.6+.4*sin(2*M_PI*(3+ch)*t));
+  default:
+    {
+      /* white noise, hashed from the position so it never changes */
+      ogg_uint32_t x=(ogg_uint32_t)(i*2+ch)*2654435761U;
+      x^=x>>15;
+      x*=2246822519U;
+      x^=x>>13;
+      return .5*((long)(x&0xFFFF)-32768)/32768.;
+    }
+  }
+}
+
+static void encode(stream *s,int kind,float q){
+  static const char *kinds[]={"sweep","chord","noise"};
+  ogg_stream_state os;
+  ogg_page         og;
+  ogg_packet       op;
+  ogg_packet       hdr;
+  ogg_packet       hdr_comm;
+  ogg_packet       hdr_code;
+  vorbis_info      vi;
+  vorbis_comment   vc;
+  vorbis_dsp_state vd;
+  vorbis_block     vb;
+  long             i;
+  long             done=0;
+
+  memset(s,0,sizeof(*s));
+  snprintf(s->name,sizeof(s->name),"%s q%.1f",kinds[kind],q*10);
+
+  vorbis_info_init(&vi);
+  if(vorbis_encode_init_vbr(&vi,2,RATE,q)){
+    fprintf(stderr,"vorbis_encode_init_vbr failed\n");
+    exit(1);
+  }
+  vorbis_comment_init(&vc);
+  vorbis_analysis_init(&vd,&vi);
+  vorbis_block_init(&vd,&vb);
+  ogg_stream_init(&os,kind+1);
+
+  vorbis_analysis_headerout(&vd,&vc,&hdr,&hdr_comm,&hdr_code);
+  ogg_stream_packetin(&os,&hdr);
+  ogg_stream_packetin(&os,&hdr_comm);
+  ogg_stream_packetin(&os,&hdr_code);
+  while(ogg_stream_flush(&os,&og)){
+    append(s,og.header,og.header_len);
+    append(s,og.body,og.body_len);
+  }
+
+  for(;;){
+    long n=RATE*SECONDS-done;
+    if(n>1024)n=1024;
+    if(n>0){
+      float **buffer=vorbis_analysis_buffer(&vd,n);
+      for(i=0;i<n;i++){
+        buffer[0][i]=gen_sample(kind,0,done+i);
+        buffer[1][i]=gen_sample(kind,1,done+i);
+      }
+      done+=n;
+    }
+    vorbis_analysis_wrote(&vd,n);
+
+    while(vorbis_analysis_blockout(&vd,&vb)==1){
+      vorbis_analysis(&vb,NULL);
+      vorbis_bitrate_addblock(&vb);
+      while(vorbis_bitrate_flushpacket(&vd,&op)){
+        ogg_stream_packetin(&os,&op);
+        while(ogg_stream_pageout(&os,&og)){
+          append(s,og.header,og.header_len);
+          append(s,og.body,og.body_len);
+        }
+      }
+    }
+    if(n<=0)break;
+  }
+  while(ogg_stream_flush(&os,&og)){
+    append(s,og.header,og.header_len);
+    append(s,og.body,og.body_len);
+  }
+
+  ogg_stream_clear(&os);
+  vorbis_block_clear(&vb);
+  vorbis_dsp_clear(&vd);
+  vorbis_comment_clear(&vc);
+  vorbis_info_clear(&vi);
+}
+
+static int load(stream *s,const char *filename){
+  unsigned char buf[4096];
+  FILE *f=fopen(filename,"rb");
+  size_t n;
+
+  memset(s,0,sizeof(*s));
+  snprintf(s->name,sizeof(s->name),"%s",filename);
+  if(!f)return -1;
+  while((n=fread(buf,1,sizeof(buf),f))>0)append(s,buf,n);
+  fclose(f);
+  return 0;
+}
+
+/* Decodes the first logical stream in s, the way a player would, and
+   returns the number of sample frames decoded.  *checksum accumulates the
+   output so that runs can be compared with each other. */
+static long decode(const stream *s,int *channels,long *rate,
+                   double *checksum){
+  ogg_sync_state   oy;
+  ogg_stream_state os;
+  ogg_page         og;
+  ogg_packet       op;
+  vorbis_info      vi;
+  vorbis_comment   vc;
+  vorbis_dsp_state vd;
+  vorbis_block     vb;
+  char            *buffer;
+  int              headers=0;
+  int              started=0;
+  long             frames=0;
+  double           sum=0;
+
+  ogg_sync_init(&oy);
+  buffer=ogg_sync_buffer(&oy,s->bytes);
+  memcpy(buffer,s->data,s->bytes);
+  ogg_sync_wrote(&oy,s->bytes);
+  vorbis_info_init(&vi);
+  vorbis_comment_init(&vc);
+
+  while(ogg_sync_pageout(&oy,&og)==1){
+    if(!started){
+      ogg_stream_init(&os,ogg_page_serialno(&og));
+      started=1;
+    }
+    if(ogg_stream_pagein(&os,&og))continue;
+    while(ogg_stream_packetout(&os,&op)==1){
+      if(headers<3){
+        if(vorbis_synthesis_headerin(&vi,&vc,&op)){
+          fprintf(stderr,"%s: not a Vorbis stream\n",s->name);
+          exit(1);
+        }
+        if(++headers==3){
+          vorbis_synthesis_init(&vd,&vi);
+          vorbis_block_init(&vd,&vb);
+        }
+      }else{
+        float **pcm;
+        int n;
+        if(vorbis_synthesis(&vb,&op)==0)
+          vorbis_synthesis_blockin(&vd,&vb);
+        while((n=vorbis_synthesis_pcmout(&vd,&pcm))>0){
+          int i,j;
+          for(j=0;j<vi.channels;j++)
+            for(i=0;i<n;i++)
+              sum+=fabs(pcm[j][i]);
+          frames+=n;
+          vorbis_synthesis_read(&vd,n);
+        }
+      }
+    }
+  }
+
+  if(headers<3){
+    fprintf(stderr,"%s: missing Vorbis headers\n",s->name);
+    exit(1);
+  }
+  *channels=vi.channels;
+  *rate=vi.rate;
+  *checksum=sum;
+
+  vorbis_block_clear(&vb);
+  vorbis_dsp_clear(&vd);
+  ogg_stream_clear(&os);
+  vorbis_comment_clear(&vc);
+  vorbis_info_clear(&vi);
+  ogg_sync_clear(&oy);
+  return frames;
+}
+
+int main(int argc,char **argv){
+  static const float qualities[]={.1f,.5f,.9f};
+  stream *corpus;
+  int     nstreams;
+  int     i;
+  double  total_time=0;
+  double  total_frames=0;
+
+  if(argc>1){
+    nstreams=argc-1;
+    corpus=calloc(nstreams,sizeof(*corpus));
+    for(i=0;i<nstreams;i++)
+      if(load(corpus+i,argv[i+1])){
+        fprintf(stderr,"Could not read %s\n",argv[i+1]);
+        exit(1);
+      }
+  }else{
+    nstreams=3*ARRAY_LEN(qualities);
+    corpus=calloc(nstreams,sizeof(*corpus));
+    fprintf(stderr,"Encoding the corpus...\n");
+    for(i=0;i<nstreams;i++)
+      encode(corpus+i,i/ARRAY_LEN(qualities),qualities[i%ARRAY_LEN(qualities)]);
+  }
+
+  printf("%-24s %8s %12s %14s %16s\n",
+         "stream","kbps","ns/sample","ns/sample/ch","checksum");
+  for(i=0;i<nstreams;i++){
+    clock_t start=clock();
+    double  elapsed;
+    double  checksum=0;
+    long    frames=0;
+    long    runs=0;
+    long    rate=0;
+    int     channels=0;
+
+    do{
+      frames=decode(corpus+i,&channels,&rate,&checksum);
+      runs++;
+      elapsed=(double)(clock()-start)/CLOCKS_PER_SEC;
+    }while(elapsed<MIN_TIME);
+
+    printf("%-24s %8.1f %12.2f %14.2f %16.4f\n",corpus[i].name,
+           frames?corpus[i].bytes*8./frames*rate/1000:0,
+           elapsed*1e9/((double)frames*runs),
+           elapsed*1e9/((double)frames*runs*channels),
+           checksum);
+    total_time+=elapsed;
+    total_frames+=(double)frames*runs;
+    free(corpus[i].data);
+  }
+  printf("%-24s %8s %12.2f\n","all","",total_time*1e9/total_frames);
+
+  free(corpus);
+  return 0;
+}
@@ -22,6 +22,7 @@
 #include <errno.h>
 
 #include <vorbis/codec.h>
+#include <vorbis/codec_interleaved.h>
 #include <vorbis/vorbisenc.h>
 
 #include "write_read.h"
@@ -142,12 +143,21 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
   vorbis_dsp_state vd;
   vorbis_block     vb;
 
+  /* a second decoder, to check that vorbis_synthesis_blockin_interleaved
+     gives exactly what blockin and pcmout do */
+  vorbis_info      vi2;
+  vorbis_comment   vc2;
+  vorbis_dsp_state vd2;
+  vorbis_block     vb2;
+  float           *out;
+
   FILE *file;
   char *buffer;
   int  bytes;
   int eos = 0;
   int i;
   int read_total = 0 ;
+  int out_total = 0 ;
 
   if ((file = fopen (filename, "rb")) == NULL) {
     printf("\n\nError : fopen failed : %s\n", strerror (errno)) ;
@@ -177,6 +187,8 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
 
     vorbis_info_init (&vi);
     vorbis_comment_init (&vc);
+    vorbis_info_init (&vi2);
+    vorbis_comment_init (&vc2);
     if (ogg_stream_pagein (&os,&og) < 0) {
       fprintf (stderr,"Error reading first page of Ogg bitstream data.\n");
       exit (1);
@@ -187,7 +199,8 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
       exit (1);
     }
 
-    if (vorbis_synthesis_headerin (&vi,&vc,&op) < 0) {
+    if (vorbis_synthesis_headerin (&vi,&vc,&op) < 0 ||
+        vorbis_synthesis_headerin (&vi2,&vc2,&op) < 0) {
       fprintf (stderr,"This Ogg bitstream does not contain Vorbis "
           "audio data.\n");
       exit (1);
@@ -211,6 +224,7 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
               exit(1);
             }
             vorbis_synthesis_headerin (&vi,&vc,&op);
+            vorbis_synthesis_headerin (&vi2,&vc2,&op);
             i++;
           }
         }
@@ -233,6 +247,9 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
 
     vorbis_synthesis_init (&vd,&vi);
     vorbis_block_init (&vd,&vb);
+    vorbis_synthesis_init (&vd2,&vi2);
+    vorbis_block_init (&vd2,&vb2);
+    out = malloc (vorbis_info_blocksize (&vi2,1) / 2 * vi2.channels * sizeof (float));
 
     while(!eos) {
       while (!eos) {
@@ -266,6 +283,20 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
                 vorbis_synthesis_read (&vd,bout);
                 read_total += bout ;
               }
+
+              if (vorbis_synthesis (&vb2,&op) == 0) {
+                samples = vorbis_synthesis_blockin_interleaved (&vd2,&vb2,out);
+                if (samples < 0) {
+                  printf ("\n\nError : vorbis_synthesis_blockin_interleaved failed.\n");
+                  exit (1);
+                }
+                for (i = 0; i < samples && out_total + i < read_total; i++)
+                  if (out [i * vi2.channels] != data [out_total + i]) {
+                    printf ("\n\nError : interleaved output differs at sample %d.\n", out_total + i);
+                    exit (1);
+                  }
+                out_total += samples ;
+              }
             }
           }
 
@@ -287,6 +318,12 @@ read_vorbis_data_or_die (const char *filename, int srate, float * data, int coun
     vorbis_dsp_clear (&vd);
     vorbis_comment_clear (&vc);
     vorbis_info_clear (&vi);
+
+    free (out);
+    vorbis_block_clear (&vb2);
+    vorbis_dsp_clear (&vd2);
+    vorbis_comment_clear (&vc2);
+    vorbis_info_clear (&vi2);
   }
 done_decode:
 